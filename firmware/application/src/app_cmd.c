@@ -15,6 +15,8 @@
 #include "settings.h"
 #include "delayed_reset.h"
 #include "netdata.h"
+#include "nfc_14a_trace.h"
+#include "app_timer.h"
 
 #if defined(PROJECT_CHAMELEON_ULTRA)
 #include "rfid/reader/lf/lf_hidprox_data.h"
@@ -90,6 +92,8 @@ static data_frame_tx_t *cmd_processor_enter_bootloader(uint16_t cmd, uint16_t st
 #define BOOTLOADER_DFU_START    (BOOTLOADER_DFU_GPREGRET_MASK |         BOOTLOADER_DFU_START_BIT_MASK)
     APP_ERROR_CHECK(sd_power_gpregret_clr(0, 0xffffffff));
     APP_ERROR_CHECK(sd_power_gpregret_set(0, BOOTLOADER_DFU_START));
+    // queued flash writes must not be lost
+    fds_flush_sync();
     nrf_pwr_mgmt_shutdown(NRF_PWR_MGMT_SHUTDOWN_GOTO_DFU);
     // Never into here...
     while (1) __NOP();
@@ -207,35 +211,107 @@ static data_frame_tx_t *cmd_processor_get_ble_pairing_enable(uint16_t cmd, uint1
 }
 
 static data_frame_tx_t *cmd_processor_set_ble_pairing_enable(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
-    if (length != 1 && data[0] > 1) {
+    if (length != 1 || data[0] > 1) {
         return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
     }
     settings_set_ble_pairing_enable(data[0]);
     return data_frame_make(cmd, STATUS_SUCCESS, 0, NULL);
 }
 
+static data_frame_tx_t *cmd_processor_set_max_data_length(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    if (length != 2) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+    uint16_t max_length = MIN(U16NTOHS(*(uint16_t *)data), NETDATA_MAX_DATA_LENGTH);
+    if (!is_usb_working() && is_nus_working()) {
+        // Over BLE, align the whole frame on the notification size so that no frame ends with a short packet.
+        // Not below the default length, rounding up instead would give the host longer frames than it asked for.
+        uint16_t chunk = nus_get_max_data_len();
+        uint16_t frame_length = ((max_length + NETDATA_FRAME_OVERHEAD) / chunk) * chunk;
+        if (frame_length >= NETDATA_DEFAULT_DATA_LENGTH + NETDATA_FRAME_OVERHEAD) {
+            max_length = frame_length - NETDATA_FRAME_OVERHEAD;
+        }
+    }
+    data_frame_set_max_length(max_length);
+    uint16_t payload = U16HTONS(data_frame_get_max_length());
+    return data_frame_make(cmd, STATUS_SUCCESS, sizeof(payload), (uint8_t *)&payload);
+}
+
 #if defined(PROJECT_CHAMELEON_ULTRA)
 
+// uidlen[1]|uid[uidlen]|atqa[2]|sak[1]|atslen[1]|ats[atslen] of each tag
+// dynamic length, so no struct. One tag with the longest ATS, or HF14A_SCAN_TAGS_MAX tags enumerated without ATS
+#define HF14A_SCAN_TAGS_MAX 16
+static uint8_t m_scan_payload[1 + 10 + 2 + 1 + 1 + 254];
+static uint16_t m_scan_payload_length;
+
+static void hf14a_scan_append(picc_14a_tag_t *taginfo) {
+    uint16_t offset = m_scan_payload_length;
+    m_scan_payload[offset++] = taginfo->uid_len;
+    memcpy(&m_scan_payload[offset], taginfo->uid, taginfo->uid_len);
+    offset += taginfo->uid_len;
+    memcpy(&m_scan_payload[offset], taginfo->atqa, sizeof(taginfo->atqa));
+    offset += sizeof(taginfo->atqa);
+    m_scan_payload[offset++] = taginfo->sak;
+    m_scan_payload[offset++] = taginfo->ats_len;
+    memcpy(&m_scan_payload[offset], taginfo->ats, taginfo->ats_len);
+    offset += taginfo->ats_len;
+    m_scan_payload_length = offset;
+}
+
 static data_frame_tx_t *cmd_processor_hf14a_scan(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
     picc_14a_tag_t taginfo;
+    m_scan_payload_length = 0;
     status = pcd_14a_reader_scan_auto(&taginfo);
+    if (status == STATUS_HF_COLLISION) {
+        // several tags answered, enumerate them all
+        uint8_t count;
+        status = pcd_14a_reader_scan_all(&taginfo, HF14A_SCAN_TAGS_MAX, hf14a_scan_append, &count);
+        if (status != STATUS_HF_TAG_OK) {
+            return data_frame_make(cmd, status, 0, NULL);
+        }
+        return data_frame_make(cmd, STATUS_HF_TAG_OK, m_scan_payload_length, m_scan_payload);
+    }
     if (status != STATUS_HF_TAG_OK) {
         return data_frame_make(cmd, status, 0, NULL);
     }
-    // uidlen[1]|uid[uidlen]|atqa[2]|sak[1]|atslen[1]|ats[atslen]
-    // dynamic length, so no struct
-    uint8_t payload[1 + sizeof(taginfo.uid) + sizeof(taginfo.atqa) + sizeof(taginfo.sak) + 1 + 254];
-    uint16_t offset = 0;
-    payload[offset++] = taginfo.uid_len;
-    memcpy(&payload[offset], taginfo.uid, taginfo.uid_len);
-    offset += taginfo.uid_len;
-    memcpy(&payload[offset], taginfo.atqa, sizeof(taginfo.atqa));
-    offset += sizeof(taginfo.atqa);
-    payload[offset++] = taginfo.sak;
-    payload[offset++] = taginfo.ats_len;
-    memcpy(&payload[offset], taginfo.ats, taginfo.ats_len);
-    offset += taginfo.ats_len;
-    return data_frame_make(cmd, STATUS_HF_TAG_OK, offset, payload);
+    hf14a_scan_append(&taginfo);
+    return data_frame_make(cmd, STATUS_HF_TAG_OK, m_scan_payload_length, m_scan_payload);
+}
+
+static data_frame_tx_t *cmd_processor_hf14a_set_reader_target(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    // no uid selects whichever tag answers again
+    if (length != 0 && length != 4 && length != 7 && length != 10) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+    pcd_14a_reader_target_set(data, length);
+    return data_frame_make(cmd, STATUS_SUCCESS, 0, NULL);
+}
+
+static data_frame_tx_t *cmd_processor_hf14a_reader_timing(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    if (length > 1) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+    pcd_14a_reader_timing_t timing;
+    pcd_14a_reader_timing_get(&timing, length == 1 && data[0] != 0);
+
+    struct {
+        uint32_t transfers;
+        uint32_t transfer_us;
+        uint32_t auths;
+        uint32_t auths_ok;
+        uint32_t auth_us;
+        uint32_t timeouts;
+        uint32_t auth_timeout_us;
+    } PACKED payload;
+    payload.transfers = U32HTONL(timing.transfers);
+    payload.transfer_us = U32HTONL((uint32_t)(timing.transfer_cycles / timing.cycles_per_us));
+    payload.auths = U32HTONL(timing.auths);
+    payload.auths_ok = U32HTONL(timing.auths_ok);
+    payload.auth_us = U32HTONL((uint32_t)(timing.auth_cycles / timing.cycles_per_us));
+    payload.timeouts = U32HTONL(timing.timeouts);
+    payload.auth_timeout_us = U32HTONL(timing.auth_timeout_us);
+    return data_frame_make(cmd, STATUS_SUCCESS, sizeof(payload), (uint8_t *)&payload);
 }
 
 static data_frame_tx_t *cmd_processor_mf1_detect_support(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
@@ -295,6 +371,36 @@ static data_frame_tx_t *cmd_processor_mf1_darkside_acquire(uint16_t cmd, uint16_
     return data_frame_make(cmd, STATUS_HF_TAG_OK, sizeof(payload), (uint8_t *)&payload);
 }
 
+static void mf1_darkside_on_core(DarksideCore_t *dc) {
+    stream_response_data(DATA_CMD_MF1_DARKSIDE_ACQUIRE_BATCH, sizeof(DarksideCore_t), (uint8_t *)dc);
+}
+
+static data_frame_tx_t *cmd_processor_mf1_darkside_acquire_batch(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    typedef struct {
+        uint8_t type_target;
+        uint8_t block_target;
+        uint8_t first_recover;
+        uint8_t sync_max;
+        uint8_t sets;
+    } PACKED payload_t;
+    if (length != sizeof(payload_t)) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+
+    payload_t *payload = (payload_t *)data;
+    if (payload->sets == 0 || payload->sets > DARKSIDE_SETS_MAX) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+    // every set is streamed as one frame, the final response carries the darkside status which ended the batch
+    uint8_t darkside_status;
+    status = darkside_recover_key_batch(payload->block_target, payload->type_target, payload->first_recover, payload->sync_max,
+                                        payload->sets, mf1_darkside_on_core, (mf1_darkside_status_t *)&darkside_status);
+    if (status != STATUS_HF_TAG_OK) {
+        return data_frame_make(cmd, status, 0, NULL);
+    }
+    return data_frame_make(cmd, STATUS_HF_TAG_OK, sizeof(darkside_status), &darkside_status);
+}
+
 static data_frame_tx_t *cmd_processor_mf1_detect_nt_dist(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
     typedef struct {
         uint8_t type_known;
@@ -335,6 +441,36 @@ static data_frame_tx_t *cmd_processor_mf1_nested_acquire(uint16_t cmd, uint16_t
     return data_frame_make(cmd, STATUS_HF_TAG_OK, sizeof(ncs), (uint8_t *)(&ncs));
 }
 
+static void mf1_nested_on_set(mf1_nested_core_t *nc) {
+    stream_response_data(DATA_CMD_MF1_NESTED_ACQUIRE_STREAM, sizeof(mf1_nested_core_t), (uint8_t *)nc);
+}
+
+static data_frame_tx_t *cmd_processor_mf1_nested_acquire_stream(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    typedef struct {
+        nested_common_payload_t nested;
+        uint8_t sets;
+    } PACKED payload_t;
+    if (length != sizeof(payload_t)) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+
+    payload_t *payload = (payload_t *)data;
+    if (payload->sets < SETS_NR || payload->sets > NESTED_SETS_MAX) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+    // every set is streamed as one frame, the final response only carries the status
+    status = nested_recover_key_stream(
+        bytes_to_num(payload->nested.key_known, 6),
+        payload->nested.block_known,
+        payload->nested.type_known,
+        payload->nested.block_target,
+        payload->nested.type_target,
+        payload->sets,
+        mf1_nested_on_set
+    );
+    return data_frame_make(cmd, status, 0, NULL);
+}
+
 static data_frame_tx_t *cmd_processor_mf1_auth_one_key_block(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
     typedef struct {
         uint8_t type;
@@ -351,10 +487,38 @@ static data_frame_tx_t *cmd_processor_mf1_auth_one_key_block(uint16_t cmd, uint1
     return data_frame_make(cmd, status, 0, NULL);
 }
 
+static data_frame_tx_t *cmd_processor_mf1_check_keys_on_block(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    typedef struct {
+        uint8_t type;
+        uint8_t block;
+        mf1_key_t keys[];
+    } PACKED payload_t;
+    // keys_len is a byte, 255 keys at most
+    if (length < sizeof(payload_t) + sizeof(mf1_key_t) || (length - sizeof(payload_t)) % sizeof(mf1_key_t) != 0 ||
+            (length - sizeof(payload_t)) / sizeof(mf1_key_t) > 255) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+
+    payload_t *payload = (payload_t *)data;
+    struct {
+        uint8_t index;
+        mf1_key_t key;
+    } PACKED resp;
+    status = mf1_toolbox_check_keys_on_block(payload->block, payload->type, payload->keys,
+                                             (length - sizeof(payload_t)) / sizeof(mf1_key_t), &resp.index);
+    if (status != STATUS_HF_TAG_OK) {
+        return data_frame_make(cmd, status, 0, NULL);
+    }
+    resp.key = payload->keys[resp.index];
+    return data_frame_make(cmd, STATUS_HF_TAG_OK, sizeof(resp), (uint8_t *)&resp);
+}
+
 static data_frame_tx_t *cmd_processor_mf1_check_keys_of_sectors(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
-    if (length < 16 || (length - 10) % 6 != 0) {
+    // keys_len is a byte, 255 keys at most. A flags byte may follow the keys, bit 0 asks for the stats of the search
+    if (length < 16 || (length - 10) % 6 > 1 || (length - 10) / 6 > 255) {
         return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
     }
+    bool with_stats = (length - 10) % 6 == 1 && (data[length - 1] & 0x01);
 
     // init
     mf1_toolbox_check_keys_of_sectors_in_t in = {
@@ -362,10 +526,18 @@ static data_frame_tx_t *cmd_processor_mf1_check_keys_of_sectors(uint16_t cmd, ui
         .keys_len = (length - 10) / 6,
         .keys = (mf1_key_t *) &data[10]
     };
-    mf1_toolbox_check_keys_of_sectors_out_t out;
-    status = mf1_toolbox_check_keys_of_sectors(&in, &out);
+    // The 490 byte result, then the auths tried and the sectorKeys searched if asked for
+    struct {
+        mf1_toolbox_check_keys_of_sectors_out_t out;
+        uint16_t auths;
+        uint16_t sector_keys;
+    } PACKED resp;
+    mf1_toolbox_check_keys_of_sectors_stats_t stats;
+    status = mf1_toolbox_check_keys_of_sectors(&in, &resp.out, &stats);
+    resp.auths = U16HTONS(stats.auths);
+    resp.sector_keys = U16HTONS(stats.sector_keys);
 
-    return data_frame_make(cmd, status, sizeof(out), (uint8_t *)&out);
+    return data_frame_make(cmd, status, with_stats ? sizeof(resp) : sizeof(resp.out), (uint8_t *)&resp);
 }
 
 static data_frame_tx_t *cmd_processor_mf1_hardnested_nonces_acquire(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
@@ -406,6 +578,208 @@ static data_frame_tx_t *cmd_processor_mf1_hardnested_nonces_acquire(uint16_t cmd
     return data_frame_make(cmd, status, nonces[0] * 4.5, (uint8_t *)(nonces + 1));
 }
 
+// frame of DATA_CMD_MF1_HARDNESTED_ACQUIRE_STREAM, the progress followed by as many nonce pairs as the data length allows
+typedef struct {
+    uint16_t msb_count;
+    uint16_t msb_sum;
+    uint32_t nonces;
+    uint8_t pairs[(NETDATA_MAX_DATA_LENGTH - 8) / 9 * 9];
+} PACKED hardnested_frame_t;
+static hardnested_frame_t m_hardnested_frame;
+static mf1_hardnested_progress_t m_hardnested_progress;
+
+static void hardnested_frame_fill_progress(void) {
+    m_hardnested_frame.msb_count = U16HTONS(m_hardnested_progress.msb_count);
+    m_hardnested_frame.msb_sum = U16HTONS(m_hardnested_progress.msb_sum);
+    m_hardnested_frame.nonces = U32HTONL(m_hardnested_progress.nonces);
+}
+
+static void hardnested_on_chunk(uint8_t *chunk, uint16_t length) {
+    hardnested_frame_fill_progress();
+    stream_response_data(DATA_CMD_MF1_HARDNESTED_ACQUIRE_STREAM, offsetof(hardnested_frame_t, pairs) + length, (uint8_t *)&m_hardnested_frame);
+}
+
+static data_frame_tx_t *cmd_processor_mf1_hardnested_nonces_stream(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    typedef struct {
+        uint8_t slow;
+        uint8_t type_known;
+        uint8_t block_known;
+        uint8_t key_known[6];
+        uint8_t type_target;
+        uint8_t block_target;
+        uint32_t nonces_target;
+        uint32_t nonces_max;
+    } PACKED payload_t;
+    if (length != sizeof(payload_t)) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+
+    payload_t *payload = (payload_t *)data;
+    uint16_t pairs_length = 0;
+    status = mf1_hardnested_nonces_stream(
+        payload->slow,
+        payload->block_known,
+        payload->type_known,
+        bytes_to_num(payload->key_known, 6),
+        payload->block_target,
+        payload->type_target,
+        U32NTOHL(payload->nonces_target),
+        U32NTOHL(payload->nonces_max),
+        m_hardnested_frame.pairs,
+        MIN(sizeof(m_hardnested_frame.pairs), data_frame_get_max_length() - offsetof(hardnested_frame_t, pairs)),
+        &pairs_length,
+        hardnested_on_chunk,
+        &m_hardnested_progress
+    );
+    // the pairs left over go with the final response, whatever the status
+    hardnested_frame_fill_progress();
+    return data_frame_make(cmd, status, offsetof(hardnested_frame_t, pairs) + pairs_length, (uint8_t *)&m_hardnested_frame);
+}
+
+// records of a streamed reader command not yet sent to the host, @see stream_record_alloc
+static uint8_t m_stream_records[NETDATA_MAX_DATA_LENGTH];
+static uint16_t m_stream_records_length;
+static uint16_t m_stream_records_header_length;
+
+// Start collecting records, every frame starts with the same header_length bytes at m_stream_records
+static void stream_records_begin(uint16_t header_length) {
+    m_stream_records_header_length = header_length;
+    m_stream_records_length = header_length;
+}
+
+// Reserve room for a record, the records collected so far are streamed first if it doesn't fit anymore
+static uint8_t *stream_record_alloc(uint16_t cmd, uint16_t length) {
+    if (m_stream_records_length + length > data_frame_get_max_length()) {
+        stream_response_data(cmd, m_stream_records_length, m_stream_records);
+        m_stream_records_length = m_stream_records_header_length;
+    }
+    uint8_t *record = &m_stream_records[m_stream_records_length];
+    m_stream_records_length += length;
+    return record;
+}
+
+static void mf1_dump_on_sector(uint8_t sector, uint8_t authed, uint16_t read_mask, uint8_t *blocks, uint8_t block_count) {
+    typedef struct {
+        uint8_t sector;
+        uint8_t authed;
+        uint16_t read_mask;
+        uint8_t blocks[];
+    } PACKED record_t;
+    record_t *record = (record_t *)stream_record_alloc(DATA_CMD_MF1_DUMP, sizeof(record_t) + block_count * 16);
+    record->sector = sector;
+    record->authed = authed;
+    record->read_mask = U16HTONS(read_mask);
+    memcpy(record->blocks, blocks, block_count * 16);
+}
+
+static data_frame_tx_t *cmd_processor_mf1_dump(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    typedef struct {
+        uint8_t sectors;
+        mf1_toolbox_check_keys_of_sectors_out_t keys;
+    } PACKED payload_t;
+    if (length != sizeof(payload_t) || data[0] == 0 || data[0] > 40) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+
+    payload_t *payload = (payload_t *)data;
+    stream_records_begin(0);
+    status = mf1_toolbox_dump_sectors(&payload->keys, payload->sectors, mf1_dump_on_sector);
+    // the last records go with the final response, also when the card was lost on the way
+    return data_frame_make(cmd, status, m_stream_records_length, m_stream_records);
+}
+
+static uint32_t m_nested_nonces_uid;
+
+static void mf1_nested_nonces_on_sector(uint8_t sector, uint8_t type, uint8_t *nonces, uint8_t count) {
+    typedef struct {
+        uint8_t sector;
+        uint8_t type;
+        uint8_t count;
+        uint8_t nonces[];
+    } PACKED record_t;
+    // the uid is known once the first sectorKey is done, every frame starts with it
+    *(uint32_t *)m_stream_records = U32HTONL(m_nested_nonces_uid);
+    record_t *record = (record_t *)stream_record_alloc(DATA_CMD_MF1_NESTED_NONCES_OF_SECTORS, sizeof(record_t) + count * 5);
+    record->sector = sector;
+    record->type = type;
+    record->count = count;
+    memcpy(record->nonces, nonces, count * 5);
+}
+
+static data_frame_tx_t *cmd_processor_mf1_nested_nonces_of_sectors(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    typedef struct {
+        uint8_t type_known;
+        uint8_t block_known;
+        uint8_t key_known[6];
+        uint8_t sectors;
+        uint8_t count;
+        mf1_toolbox_check_keys_of_sectors_mask_t mask;
+    } PACKED payload_t;
+    if (length != sizeof(payload_t)) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+
+    payload_t *payload = (payload_t *)data;
+    if (payload->sectors == 0 || payload->sectors > 40 || payload->count == 0 || payload->count > 8) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+    stream_records_begin(sizeof(m_nested_nonces_uid));
+    status = mf1_toolbox_nested_nonces_of_sectors(
+        payload->block_known,
+        payload->type_known,
+        bytes_to_num(payload->key_known, 6),
+        &payload->mask,
+        payload->sectors,
+        payload->count,
+        &m_nested_nonces_uid,
+        mf1_nested_nonces_on_sector
+    );
+    if (status != STATUS_HF_TAG_OK) {
+        return data_frame_make(cmd, status, 0, NULL);
+    }
+    *(uint32_t *)m_stream_records = U32HTONL(m_nested_nonces_uid);
+    return data_frame_make(cmd, status, m_stream_records_length, m_stream_records);
+}
+
+// every frame of the dump starts with the info, @see mf0_toolbox_dump_info_t
+static mf0_toolbox_dump_info_t m_mf0_dump_info;
+
+static void mf0_dump_on_pages(uint8_t page, uint8_t *pages, uint8_t count) {
+    typedef struct {
+        uint8_t page;
+        uint8_t count;
+        uint8_t pages[];
+    } PACKED record_t;
+    memcpy(m_stream_records, &m_mf0_dump_info, sizeof(m_mf0_dump_info));
+    record_t *record = (record_t *)stream_record_alloc(DATA_CMD_MF0_NTAG_DUMP, sizeof(record_t) + count * 4);
+    record->page = page;
+    record->count = count;
+    memcpy(record->pages, pages, count * 4);
+}
+
+static data_frame_tx_t *cmd_processor_mf0_ntag_dump(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    typedef struct {
+        uint8_t page;
+        uint16_t stop;
+        uint8_t use_pwd;
+        uint8_t pwd[4];
+    } PACKED payload_t;
+    if (length != sizeof(payload_t)) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+
+    payload_t *payload = (payload_t *)data;
+    uint16_t stop = U16NTOHS(payload->stop);
+    if (stop > 256 || payload->page >= stop) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+    stream_records_begin(sizeof(m_mf0_dump_info));
+    status = mf0_toolbox_dump_pages(payload->use_pwd ? payload->pwd : NULL, payload->page, stop, &m_mf0_dump_info, mf0_dump_on_pages);
+    // the info goes with a failure too, a tag refusing the password still tells its version
+    memcpy(m_stream_records, &m_mf0_dump_info, sizeof(m_mf0_dump_info));
+    return data_frame_make(cmd, status, m_stream_records_length, m_stream_records);
+}
+
 static data_frame_tx_t *cmd_processor_mf1_read_one_block(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
     typedef struct {
         uint8_t type;
@@ -678,7 +1052,22 @@ static data_frame_tx_t *cmd_processor_set_slot_enable(uint16_t cmd, uint16_t sta
 
 static data_frame_tx_t *cmd_processor_slot_data_config_save(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
     tag_emulation_save();
-    return data_frame_make(cmd, STATUS_SUCCESS, 0, NULL);
+    tag_save_stats_t stats;
+    tag_emulation_get_save_stats(&stats);
+
+    struct {
+        uint32_t saves;
+        uint32_t bytes_total;
+        uint16_t bytes_last;
+        uint8_t chunks_last;
+        uint8_t chunk_count;
+    } PACKED payload;
+    payload.saves = U32HTONL(stats.saves);
+    payload.bytes_total = U32HTONL(stats.bytes_total);
+    payload.bytes_last = U16HTONS(stats.bytes_last);
+    payload.chunks_last = stats.chunks_last;
+    payload.chunk_count = stats.chunk_count;
+    return data_frame_make(cmd, STATUS_SUCCESS, sizeof(payload), (uint8_t *)&payload);
 }
 
 static data_frame_tx_t *cmd_processor_get_active_slot(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
@@ -818,7 +1207,7 @@ static data_frame_tx_t *cmd_processor_hf14a_get_anti_coll_data(uint16_t cmd, uin
 
     // uidlen[1]|uid[uidlen]|atqa[2]|sak[1]|atslen[1]|ats[atslen]
     // dynamic length, so no struct
-    uint8_t payload[1 + *info->size + 2 + 1 + 1 + 254];
+    uint8_t payload[1 + *info->size + 2 + 1 + 1 + sizeof(info->ats->data)];
     uint16_t offset = 0;
     payload[offset++] = *info->size;
     memcpy(&payload[offset], info->uid, *info->size);
@@ -837,10 +1226,11 @@ static data_frame_tx_t *cmd_processor_hf14a_get_anti_coll_data(uint16_t cmd, uin
 }
 
 static data_frame_tx_t *cmd_processor_mf1_set_detection_enable(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
-    if (length != 1 || data[0] > 1) {
+    // the mode of the log is optional, the log stops once full by default
+    if (length < 1 || length > 2 || data[0] > 1 || (length == 2 && data[1] > NFC_TAG_MF1_AUTH_LOG_MODE_RING)) {
         return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
     }
-    nfc_tag_mf1_detection_log_clear();
+    nfc_tag_mf1_detection_log_clear(length == 2 ? data[1] : NFC_TAG_MF1_AUTH_LOG_MODE_STOP);
     nfc_tag_mf1_set_detection_enable(data[0]);
     return data_frame_make(cmd, STATUS_SUCCESS, 0, NULL);
 }
@@ -859,24 +1249,80 @@ static data_frame_tx_t *cmd_processor_mf1_get_detection_count(uint16_t cmd, uint
     return data_frame_make(cmd, STATUS_SUCCESS, sizeof(uint32_t), (uint8_t *)&payload);
 }
 
-static data_frame_tx_t *cmd_processor_mf1_get_detection_log(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+// entries of the detection log taken for the host, @see mf1_get_auth_log
+typedef struct {
     uint32_t count;
-    uint32_t index;
-    uint8_t *resp = NULL;
-    nfc_tag_mf1_auth_log_t *logs = mf1_get_auth_log(&count);
-    if (length != 4 || count == 0xFFFFFFFF) {
+    uint32_t dropped;
+    uint8_t uid_count;
+    uint8_t data[NETDATA_MAX_DATA_LENGTH - sizeof(uint32_t) - sizeof(uint32_t) - sizeof(uint8_t)];    // uids then entries
+} PACKED mf1_detection_log_frame_t;
+static mf1_detection_log_frame_t m_mf1_detection_log_frame;
+
+static data_frame_tx_t *cmd_processor_mf1_get_detection_log(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    if (length != 4) {
         return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
     }
-    index = U32NTOHL(*(uint32_t *)data);
-    // NRF_LOG_INFO("index = %d", index);
-    if (index >= count) {
+    uint32_t index = U32NTOHL(*(uint32_t *)data);
+    if (index >= nfc_tag_mf1_detection_log_count()) {
         return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
     }
-    resp = (uint8_t *)(logs + index);
-    length = MIN(count - index, NETDATA_MAX_DATA_LENGTH / sizeof(nfc_tag_mf1_auth_log_t)) * sizeof(nfc_tag_mf1_auth_log_t);
+    // the entries are expanded to nfc_tag_mf1_auth_log_t
+    uint8_t *resp = (uint8_t *)&m_mf1_detection_log_frame;
+    length = mf1_get_auth_log(index, resp, MIN(sizeof(m_mf1_detection_log_frame), data_frame_get_max_length()), false);
     return data_frame_make(cmd, STATUS_SUCCESS, length, resp);
 }
 
+static data_frame_tx_t *cmd_processor_mf1_get_detection_log_compact(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    if (length != 4) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+    uint32_t index = U32NTOHL(*(uint32_t *)data);
+    uint8_t uid_count;
+    uint8_t *uids = mf1_get_auth_log_uids(&uid_count);
+    m_mf1_detection_log_frame.count = U32HTONL(nfc_tag_mf1_detection_log_count());
+    m_mf1_detection_log_frame.dropped = U32HTONL(nfc_tag_mf1_detection_log_dropped());
+    m_mf1_detection_log_frame.uid_count = uid_count;
+    memcpy(m_mf1_detection_log_frame.data, uids, uid_count * 4);
+    length = offsetof(mf1_detection_log_frame_t, data) + uid_count * 4;
+    length += mf1_get_auth_log(index, (uint8_t *)&m_mf1_detection_log_frame + length, MIN(sizeof(m_mf1_detection_log_frame), data_frame_get_max_length()) - length, true);
+    return data_frame_make(cmd, STATUS_SUCCESS, length, (uint8_t *)&m_mf1_detection_log_frame);
+}
+
+// A live push of the trace is sent once this much is pending, or this long after the last one
+#define HF14A_TRACE_LIVE_BATCH          256
+#define HF14A_TRACE_LIVE_INTERVAL_MS    50
+
+// records of the 14a emulation trace taken for the host, @see hf14a_trace_make_frame
+typedef struct {
+    uint32_t dropped;
+    uint16_t pending;
+    uint8_t records[NETDATA_MAX_DATA_LENGTH - sizeof(uint32_t) - sizeof(uint16_t)];
+} PACKED hf14a_trace_frame_t;
+static hf14a_trace_frame_t m_hf14a_trace_frame;
+static bool m_hf14a_trace_live = false;
+static uint32_t m_hf14a_trace_live_ticks = 0;
+
+// Take the oldest records of the trace, behind the count of records overwritten and the bytes still pending
+static data_frame_tx_t *hf14a_trace_make_frame(uint16_t cmd, uint16_t status) {
+    uint16_t length = nfc_14a_trace_read(m_hf14a_trace_frame.records, data_frame_get_max_length() - offsetof(hf14a_trace_frame_t, records));
+    m_hf14a_trace_frame.dropped = U32HTONL(nfc_14a_trace_take_dropped());
+    m_hf14a_trace_frame.pending = U16HTONS(nfc_14a_trace_pending());
+    return data_frame_make(cmd, status, offsetof(hf14a_trace_frame_t, records) + length, (uint8_t *)&m_hf14a_trace_frame);
+}
+
+static data_frame_tx_t *cmd_processor_hf14a_set_emu_trace(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    if (length != 2 || data[0] > 1 || data[1] > 1) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+    nfc_14a_trace_set_enable(data[0]);
+    m_hf14a_trace_live = data[0] && data[1];
+    return data_frame_make(cmd, STATUS_SUCCESS, 0, NULL);
+}
+
+static data_frame_tx_t *cmd_processor_hf14a_get_emu_trace(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    return hf14a_trace_make_frame(cmd, STATUS_SUCCESS);
+}
+
 static data_frame_tx_t *cmd_processor_mf1_write_emu_block_data(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
     if (length == 0 || (((length - 1) % NFC_TAG_MF1_DATA_SIZE) != 0)) {
         return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
@@ -884,7 +1330,7 @@ static data_frame_tx_t *cmd_processor_mf1_write_emu_block_data(uint16_t cmd, uin
     uint8_t block_index = data[0];
     uint8_t block_count = (length - 1) / NFC_TAG_MF1_DATA_SIZE;
     if (block_index + block_count > NFC_TAG_MF1_BLOCK_MAX) {
-        status = STATUS_PAR_ERR;
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
     }
     tag_data_buffer_t *buffer = get_buffer_by_tag_type(TAG_TYPE_MIFARE_4096);
     nfc_tag_mf1_information_t *info = (nfc_tag_mf1_information_t *)buffer->buffer;
@@ -896,19 +1342,15 @@ static data_frame_tx_t *cmd_processor_mf1_write_emu_block_data(uint16_t cmd, uin
 }
 
 static data_frame_tx_t *cmd_processor_mf1_read_emu_block_data(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
-    if ((length != 2) || (data[1] < 1) || (data[1] > 32) || (data[0] + data[1] > NFC_TAG_MF1_BLOCK_MAX)) {
+    if ((length != 2) || (data[1] < 1) || (data[1] > data_frame_get_max_length() / NFC_TAG_MF1_DATA_SIZE) || (data[0] + data[1] > NFC_TAG_MF1_BLOCK_MAX)) {
         return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
     }
     uint8_t block_index = data[0];
     uint8_t block_count = data[1];
     tag_data_buffer_t *buffer = get_buffer_by_tag_type(TAG_TYPE_MIFARE_4096);
     nfc_tag_mf1_information_t *info = (nfc_tag_mf1_information_t *)buffer->buffer;
-    uint16_t result_length = block_count * NFC_TAG_MF1_DATA_SIZE;
-    uint8_t result_buffer[result_length];
-    for (int i = 0, j = block_index; i < result_length; i += NFC_TAG_MF1_DATA_SIZE, j++) {
-        memcpy(&result_buffer[i], info->memory[j], NFC_TAG_MF1_DATA_SIZE);
-    }
-    return data_frame_make(cmd, STATUS_SUCCESS, result_length, result_buffer);
+    // blocks are contiguous in the emulator memory, no need to copy them on the stack first
+    return data_frame_make(cmd, STATUS_SUCCESS, block_count * NFC_TAG_MF1_DATA_SIZE, info->memory[block_index]);
 }
 
 static data_frame_tx_t *cmd_processor_mf0_ntag_write_emu_page_data(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
@@ -1177,7 +1619,7 @@ static data_frame_tx_t *cmd_processor_mf1_get_gen1a_mode(uint16_t cmd, uint16_t
 }
 
 static data_frame_tx_t *cmd_processor_mf1_set_gen1a_mode(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
-    if (length != 1 && data[0] > 1) {
+    if (length != 1 || data[0] > 1) {
         return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
     }
     nfc_tag_mf1_set_gen1a_magic_mode(data[0]);
@@ -1190,7 +1632,7 @@ static data_frame_tx_t *cmd_processor_mf1_get_gen2_mode(uint16_t cmd, uint16_t s
 }
 
 static data_frame_tx_t *cmd_processor_mf1_set_gen2_mode(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
-    if (length != 1 && data[0] > 1) {
+    if (length != 1 || data[0] > 1) {
         return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
     }
     nfc_tag_mf1_set_gen2_magic_mode(data[0]);
@@ -1203,7 +1645,7 @@ static data_frame_tx_t *cmd_processor_mf1_get_block_anti_coll_mode(uint16_t cmd,
 }
 
 static data_frame_tx_t *cmd_processor_mf1_set_block_anti_coll_mode(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
-    if (length != 1 && data[0] > 1) {
+    if (length != 1 || data[0] > 1) {
         return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
     }
     nfc_tag_mf1_set_use_mf1_coll_res(data[0]);
@@ -1307,6 +1749,7 @@ static data_frame_tx_t *after_hf_reader_run(uint16_t cmd, uint16_t status, uint1
 
 // fct will be defined after m_data_cmd_map because we need to know its size
 data_frame_tx_t *cmd_processor_get_device_capabilities(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data);
+data_frame_tx_t *cmd_processor_batch(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data);
 
 static data_frame_tx_t *cmd_processor_mf0_ntag_get_uid_mode(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
     int rc = nfc_tag_mf0_ntag_get_uid_mode();
@@ -1379,6 +1822,8 @@ static cmd_data_map_t m_data_cmd_map[] = {
     {    DATA_CMD_GET_DEVICE_CAPABILITIES,      NULL,                        cmd_processor_get_device_capabilities,       NULL                   },
     {    DATA_CMD_GET_BLE_PAIRING_ENABLE,       NULL,                        cmd_processor_get_ble_pairing_enable,        NULL                   },
     {    DATA_CMD_SET_BLE_PAIRING_ENABLE,       NULL,                        cmd_processor_set_ble_pairing_enable,        NULL                   },
+    {    DATA_CMD_SET_MAX_DATA_LENGTH,          NULL,                        cmd_processor_set_max_data_length,           NULL                   },
+    {    DATA_CMD_BATCH,                        NULL,                        cmd_processor_batch,                         NULL                   },
 
 #if defined(PROJECT_CHAMELEON_ULTRA)
 
@@ -1397,6 +1842,15 @@ static cmd_data_map_t m_data_cmd_map[] = {
     {    DATA_CMD_MF1_MANIPULATE_VALUE_BLOCK,   before_hf_reader_run,        cmd_processor_mf1_manipulate_value_block,    after_hf_reader_run    },
     {    DATA_CMD_MF1_CHECK_KEYS_OF_SECTORS,    before_hf_reader_run,        cmd_processor_mf1_check_keys_of_sectors,     after_hf_reader_run    },
     {    DATA_CMD_MF1_HARDNESTED_ACQUIRE,       before_hf_reader_run,        cmd_processor_mf1_hardnested_nonces_acquire, after_hf_reader_run    },
+    {    DATA_CMD_MF1_DUMP,                     before_hf_reader_run,        cmd_processor_mf1_dump,                      after_hf_reader_run    },
+    {    DATA_CMD_MF1_HARDNESTED_ACQUIRE_STREAM, before_hf_reader_run,       cmd_processor_mf1_hardnested_nonces_stream,  after_hf_reader_run    },
+    {    DATA_CMD_MF1_NESTED_NONCES_OF_SECTORS, before_hf_reader_run,        cmd_processor_mf1_nested_nonces_of_sectors,  after_hf_reader_run    },
+    {    DATA_CMD_HF14A_READER_TIMING,          NULL,                        cmd_processor_hf14a_reader_timing,           NULL                   },
+    {    DATA_CMD_MF0_NTAG_DUMP,                before_hf_reader_run,        cmd_processor_mf0_ntag_dump,                 after_hf_reader_run    },
+    {    DATA_CMD_MF1_NESTED_ACQUIRE_STREAM,    before_hf_reader_run,        cmd_processor_mf1_nested_acquire_stream,     after_hf_reader_run    },
+    {    DATA_CMD_MF1_DARKSIDE_ACQUIRE_BATCH,   before_hf_reader_run,        cmd_processor_mf1_darkside_acquire_batch,    after_hf_reader_run    },
+    {    DATA_CMD_MF1_CHECK_KEYS_ON_BLOCK,      before_hf_reader_run,        cmd_processor_mf1_check_keys_on_block,       after_hf_reader_run    },
+    {    DATA_CMD_HF14A_SET_READER_TARGET,      NULL,                        cmd_processor_hf14a_set_reader_target,       NULL                   },
 
     {    DATA_CMD_EM410X_SCAN,                  before_reader_run,           cmd_processor_em410x_scan,                   NULL                   },
     {    DATA_CMD_EM410X_WRITE_TO_T55XX,        before_reader_run,           cmd_processor_em410x_write_to_t55XX,         NULL                   },
@@ -1411,6 +1865,7 @@ static cmd_data_map_t m_data_cmd_map[] = {
     {    DATA_CMD_MF1_GET_DETECTION_COUNT,      NULL,                        cmd_processor_mf1_get_detection_count,       NULL                   },
     {    DATA_CMD_MF1_GET_DETECTION_LOG,        NULL,                        cmd_processor_mf1_get_detection_log,         NULL                   },
     {    DATA_CMD_MF1_GET_DETECTION_ENABLE,     NULL,                        cmd_processor_mf1_get_detection_enable,      NULL                   },
+    {    DATA_CMD_MF1_GET_DETECTION_LOG_COMPACT, NULL,                       cmd_processor_mf1_get_detection_log_compact, NULL                   },
     {    DATA_CMD_MF1_READ_EMU_BLOCK_DATA,      NULL,                        cmd_processor_mf1_read_emu_block_data,       NULL                   },
     {    DATA_CMD_MF1_GET_EMULATOR_CONFIG,      NULL,                        cmd_processor_mf1_get_emulator_config,       NULL                   },
     {    DATA_CMD_MF1_GET_GEN1A_MODE,           NULL,                        cmd_processor_mf1_get_gen1a_mode,            NULL                   },
@@ -1436,6 +1891,8 @@ static cmd_data_map_t m_data_cmd_map[] = {
     {    DATA_CMD_MF0_NTAG_GET_PAGE_COUNT,      NULL,                        cmd_processor_mf0_ntag_get_emu_page_count,   NULL                   },
     {    DATA_CMD_MF0_NTAG_GET_WRITE_MODE,      NULL,                        cmd_processor_mf0_ntag_get_write_mode,       NULL                   },
     {    DATA_CMD_MF0_NTAG_SET_WRITE_MODE,      NULL,                        cmd_processor_mf0_ntag_set_write_mode,       NULL                   },
+    {    DATA_CMD_HF14A_SET_EMU_TRACE,          NULL,                        cmd_processor_hf14a_set_emu_trace,           NULL                   },
+    {    DATA_CMD_HF14A_GET_EMU_TRACE,          NULL,                        cmd_processor_hf14a_get_emu_trace,           NULL                   },
     {    DATA_CMD_EM410X_SET_EMU_ID,            NULL,                        cmd_processor_em410x_set_emu_id,             NULL                   },
     {    DATA_CMD_EM410X_GET_EMU_ID,            NULL,                        cmd_processor_em410x_get_emu_id,             NULL                   },
 #if defined(PROJECT_CHAMELEON_ULTRA)
@@ -1473,10 +1930,126 @@ static void auto_response_data(data_frame_tx_t *resp) {
     }
 }
 
+// a streamed response is being sent, @see stream_response_data
+static bool m_is_streaming = false;
 
-/**@brief Function to process data frame(cmd)
+// results of the batch being run, sent each time a frame is full, @see cmd_processor_batch
+static netdata_frame_raw_t m_batch_frame;
+static uint16_t m_batch_length = 0;
+static bool m_is_batch_running = false;
+
+/**
+ * @brief Send an intermediate frame, switching the link to bulk mode on the first one
+ *
+ * @param frame frame to send
  */
-void on_data_frame_received(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+static void send_stream_frame(data_frame_tx_t *frame) {
+    if (!m_is_streaming) {
+        m_is_streaming = true;
+        if (!is_usb_working() && is_nus_working()) {
+            // link parameters are restored once the final frame is queued
+            ble_bulk_transfer_begin();
+        }
+    }
+    auto_response_data(frame);
+}
+
+/**
+ * @brief Send the batch results collected so far as an intermediate frame
+ */
+static void batch_flush(void) {
+    data_frame_tx_t frame = {
+        .buffer = (uint8_t *) &m_batch_frame,
+        .length = data_frame_wrap(&m_batch_frame, DATA_CMD_BATCH, STATUS_STREAM_DATA, m_batch_length),
+    };
+    send_stream_frame(&frame);
+    m_batch_length = 0;
+}
+
+/**
+ * @brief Append bytes to the batch results, records may span several frames
+ */
+static void batch_append(const uint8_t *data, uint16_t length) {
+    uint16_t max_length = data_frame_get_max_length();
+    while (length > 0) {
+        if (m_batch_length >= max_length) {
+            batch_flush();
+        }
+        uint16_t chunk = MIN(length, max_length - m_batch_length);
+        memcpy(&m_batch_frame.data[m_batch_length], data, chunk);
+        m_batch_length += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+/**
+ * @brief Append the response of a sub command to the batch results
+ */
+static void batch_append_record(uint16_t cmd, uint16_t status, uint16_t length, const uint8_t *data) {
+    struct {
+        uint16_t cmd;
+        uint16_t status;
+        uint16_t length;
+    } PACKED header = {
+        .cmd = U16HTONS(cmd),
+        .status = U16HTONS(status),
+        .length = U16HTONS(length),
+    };
+    batch_append((uint8_t *)&header, sizeof(header));
+    batch_append(data, length);
+}
+
+/**
+ * @brief Send an intermediate frame of a streamed response right away.
+ *        The processor sends as many of them as needed and then returns the final frame as usual.
+ *        Inside a batch, the data is added to the batch results instead.
+ *
+ * @param cmd command being processed
+ * @param length data length, up to the negotiated frame size
+ * @param data data
+ */
+void stream_response_data(uint16_t cmd, uint16_t length, uint8_t *data) {
+    if (m_is_batch_running) {
+        batch_append_record(cmd, STATUS_STREAM_DATA, length, data);
+        return;
+    }
+    data_frame_tx_t *frame = data_frame_make(cmd, STATUS_STREAM_DATA, length, data);
+    if (frame != NULL) {
+        send_stream_frame(frame);
+    }
+}
+
+/**
+ * @brief Push the new records of the 14a emulation trace to the host while it is live.
+ *        They are gathered while the reader talks and all sent once the field is lost,
+ *        with no link they stay in the trace for DATA_CMD_HF14A_GET_EMU_TRACE.
+ */
+void hf14a_trace_live_process(void) {
+    uint16_t pending = nfc_14a_trace_pending();
+    if (!m_hf14a_trace_live || pending == 0) {
+        return;
+    }
+    uint32_t ticks = app_timer_cnt_get();
+    if (g_is_tag_emulating && pending < HF14A_TRACE_LIVE_BATCH &&
+            app_timer_cnt_diff_compute(ticks, m_hf14a_trace_live_ticks) < APP_TIMER_TICKS(HF14A_TRACE_LIVE_INTERVAL_MS)) {
+        return;
+    }
+    if (!is_usb_working() && !is_nus_working()) {
+        return;
+    }
+    m_hf14a_trace_live_ticks = ticks;
+    data_frame_tx_t *frame = hf14a_trace_make_frame(DATA_CMD_HF14A_EMU_TRACE_LIVE, STATUS_STREAM_DATA);
+    if (frame != NULL) {
+        auto_response_data(frame);
+    }
+}
+
+/**@brief Function to run a cmd through its before, processor and after handlers
+ *
+ * @return response to send
+ */
+static data_frame_tx_t *cmd_dispatch(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
     data_frame_tx_t *response = NULL;
     bool is_cmd_support = false;
     for (int i = 0; i < ARRAY_SIZE(m_data_cmd_map); i++) {
@@ -1502,15 +2075,75 @@ void on_data_frame_received(uint16_t cmd, uint16_t status, uint16_t length, uint
             break;
         }
     }
-    if (is_cmd_support) {
-        // check and response
-        if (response != NULL) {
-            auto_response_data(response);
-        }
-    } else {
+    if (!is_cmd_support) {
         // response cmd unsupported.
         response = data_frame_make(cmd, STATUS_INVALID_CMD, 0, NULL);
-        auto_response_data(response);
         NRF_LOG_INFO("Data frame cmd invalid: %d,", cmd);
     }
+    return response;
+}
+
+/**
+ * @brief Run a list of sub commands back to back and return all their responses.
+ *        Request records are cmd(u16) length(u16) data(length),
+ *        response records are cmd(u16) status(u16) length(u16) data(length),
+ *        concatenated over the intermediate frames and the final frame.
+ *        Sub commands that stream their response produce STATUS_STREAM_DATA records before their final one.
+ */
+data_frame_tx_t *cmd_processor_batch(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    typedef struct {
+        uint16_t cmd;
+        uint16_t length;
+        uint8_t data[];
+    } PACKED batch_record_t;
+
+    if (m_is_batch_running) {
+        return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+    }
+    // check all the records first, a malformed batch runs nothing
+    for (uint16_t offset = 0; offset < length;) {
+        if (length - offset < sizeof(batch_record_t)) {
+            return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+        }
+        batch_record_t *record = (batch_record_t *)&data[offset];
+        uint16_t record_length = U16NTOHS(record->length);
+        if (record_length > length - offset - sizeof(batch_record_t)) {
+            return data_frame_make(cmd, STATUS_PAR_ERR, 0, NULL);
+        }
+        offset += sizeof(batch_record_t) + record_length;
+    }
+
+    m_is_batch_running = true;
+    m_batch_length = 0;
+    for (uint16_t offset = 0; offset < length;) {
+        batch_record_t *record = (batch_record_t *)&data[offset];
+        uint16_t record_cmd = U16NTOHS(record->cmd);
+        uint16_t record_length = U16NTOHS(record->length);
+        data_frame_tx_t *response;
+        if (record_cmd == DATA_CMD_BATCH) {
+            response = data_frame_make(record_cmd, STATUS_PAR_ERR, 0, NULL);
+        } else {
+            response = cmd_dispatch(record_cmd, 0, record_length, record_length > 0 ? record->data : NULL);
+        }
+        if (response != NULL) {
+            netdata_frame_raw_t *frame = (netdata_frame_raw_t *)response->buffer;
+            batch_append_record(record_cmd, U16NTOHS(frame->pre.status), U16NTOHS(frame->pre.len), frame->data);
+        }
+        offset += sizeof(batch_record_t) + record_length;
+    }
+    m_is_batch_running = false;
+    return data_frame_make(cmd, STATUS_SUCCESS, m_batch_length, m_batch_frame.data);
+}
+
+/**@brief Function to process data frame(cmd)
+ */
+void on_data_frame_received(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    data_frame_tx_t *response = cmd_dispatch(cmd, status, length, data);
+    if (response != NULL) {
+        auto_response_data(response);
+    }
+    if (m_is_streaming) {
+        m_is_streaming = false;
+        ble_bulk_transfer_end();
+    }
 }
@@ -15,5 +15,7 @@ typedef struct {
 } cmd_data_map_t;
 
 void on_data_frame_received(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data);
+void stream_response_data(uint16_t cmd, uint16_t length, uint8_t *data);
+void hf14a_trace_live_process(void);
 
 #endif
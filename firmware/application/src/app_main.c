@@ -33,6 +33,7 @@ NRF_LOG_MODULE_REGISTER();
 #include "dataframe.h"
 #include "fds_util.h"
 #include "hex_utils.h"
+#include "nonce_pool.h"
 #include "rfid_main.h"
 #include "syssleep.h"
 #include "tag_emulation.h"
@@ -129,6 +130,9 @@ void rng_drv_and_srand_init(void) {
 
     // Finally initialize the srand seeds in the c standard library
     srand(rand_int);
+
+    // The emulated tags take their nonces from the pool
+    nonce_pool_refill();
 }
 
 /**@brief Initialize GPIO matrix library
@@ -244,8 +248,9 @@ static void button_init(void) {
 static void system_off_enter(void) {
     ret_code_t ret;
     m_system_off_processing = true;
-    // Save tag data
+    // Save tag data, the writes are queued so wait for them before the power goes
     tag_emulation_save();
+    fds_flush_sync();
 
     if (g_is_low_battery_shutdown) {
         // Don't create too complex animations, just blink LED1 three times.
@@ -874,6 +879,14 @@ int main(void) {
         while (NRF_LOG_PROCESS());
         // USB event process
         while (app_usbd_event_queue_process());
+        // Nonce pool refill, the emulation took nonces since the last pass
+        nonce_pool_refill();
+        // Emulation trace push to the host, when it is live
+        hf14a_trace_live_process();
+        // Flash garbage collection ahead of the next saves, erasing would break the timing of an emulation
+        if (!g_is_tag_emulating) {
+            fds_gc_idle_process();
+        }
         // WDT refresh
         bsp_wdt_feed();
         // No task to process, system sleep enter.
@@ -33,4 +33,5 @@
 #define     STATUS_FLASH_WRITE_FAIL                 (0x70)  // Flash writing failed
 #define     STATUS_FLASH_READ_FAIL                  (0x71)  // Flash read failed
 #define     STATUS_INVALID_SLOT_TYPE                (0x72)  // Invalid slot type
+#define     STATUS_STREAM_DATA                      (0x73)  // Intermediate frame of a streamed response, the final frame carries the real status
 #endif
@@ -22,6 +22,7 @@
 #include "syssleep.h"
 #include "ble_main.h"
 #include "dataframe.h"
+#include "netdata.h"
 #include "hw_connect.h"
 #include "settings.h"
 
@@ -62,6 +63,11 @@ NRF_LOG_MODULE_REGISTER();
 #define FIRST_CONN_PARAMS_UPDATE_DELAY  APP_TIMER_TICKS(5000)                       /**< Time from initiating event (connect or start of notification) to first time sd_ble_gap_conn_param_update is called (5 seconds). */
 #define NEXT_CONN_PARAMS_UPDATE_DELAY   APP_TIMER_TICKS(30000)                      /**< Time between each call to sd_ble_gap_conn_param_update after the first call (30 seconds). */
 #define MAX_CONN_PARAMS_UPDATE_COUNT    3                                           /**< Number of attempts before giving up the connection parameter negotiation. */
+#define BULK_MIN_CONN_INTERVAL          MSEC_TO_UNITS(15, UNIT_1_25_MS)             /**< Minimum connection interval during bulk transfers (15 ms, lowest value accepted by iOS centrals). */
+#define BULK_MAX_CONN_INTERVAL          MSEC_TO_UNITS(30, UNIT_1_25_MS)             /**< Maximum connection interval during bulk transfers (30 ms). */
+
+#define NUS_TX_QUEUE_SIZE               2                                           /**< Number of response frames that can wait for notification. */
+#define NUS_HVN_TX_QUEUE_SIZE           6                                           /**< Number of notifications the SoftDevice queues, a 512 bytes frame is 3 of them at the largest MTU. */
 
 // #define BATTERY_LEVEL_MEAS_INTERVAL     APP_TIMER_TICKS(1000)                       /**< Battery level measurement interval (ticks). This value corresponds to 1 seconds. */
 #define BATTERY_LEVEL_MEAS_INTERVAL     APP_TIMER_TICKS(5000)                     /**< Battery level measurement interval (ticks). This value corresponds to N seconds. */
@@ -99,6 +105,19 @@ static ble_uuid_t m_adv_uuids[]          =
 volatile bool g_is_ble_connected = false;
 volatile bool g_is_low_battery_shutdown = false;
 static ble_opt_t m_static_pin_option;
+static bool       m_ble_bulk_transfer    = false;                                   /**< Fast link parameters requested for a streamed response. */
+static volatile bool m_ble_bulk_end_pending = false;                                /**< The streamed response is queued, restore the parameters once it is sent. */
+static bool       m_ble_conn_params_own  = false;                                   /**< Connection parameters of this connection were requested here, a refusal is not worth a disconnection. */
+
+typedef struct {
+    uint16_t length;
+    uint16_t offset;                                                                /**< Bytes of the frame already handed to the SoftDevice. */
+    uint8_t  buffer[NETDATA_FRAME_OVERHEAD + NETDATA_MAX_DATA_LENGTH];
+} nus_tx_frame_t;
+
+static nus_tx_frame_t   m_nus_tx_queue[NUS_TX_QUEUE_SIZE];                          /**< Response frames waiting for notification, the head one is being sent. */
+static volatile uint8_t m_nus_tx_queue_head  = 0;
+static volatile uint8_t m_nus_tx_queue_count = 0;
 
 
 /**@brief Function for the ble connect key setup.
@@ -177,36 +196,162 @@ static void nus_data_handler(ble_nus_evt_t *p_evt) {
 }
 /**@snippet [Handling the data received over BLE] */
 
+/**@brief Function for queueing as many notifications as the SoftDevice accepts.
+ *
+ * @details Called when a frame is queued and again on each BLE_GATTS_EVT_HVN_TX_COMPLETE,
+ *          so the SoftDevice TX buffers stay full and several packets go out per connection event.
+ */
+static void nus_tx_queue_pump(void) {
+    CRITICAL_REGION_ENTER();
+    while (m_nus_tx_queue_count > 0) {
+        nus_tx_frame_t *frame = &m_nus_tx_queue[m_nus_tx_queue_head];
+        uint16_t chunk = MIN(m_ble_nus_max_data_len, frame->length - frame->offset);
+        ret_code_t err_code = ble_nus_data_send(&m_nus, frame->buffer + frame->offset, &chunk, m_conn_handle);
+        if ((err_code == NRF_ERROR_RESOURCES) || (err_code == NRF_ERROR_BUSY)) {
+            // SoftDevice queue full, resume on BLE_GATTS_EVT_HVN_TX_COMPLETE
+            break;
+        }
+        if (err_code != NRF_SUCCESS) {
+            // Disconnected or notifications disabled, nobody will read the queued frames.
+            if ((err_code != NRF_ERROR_INVALID_STATE) && (err_code != NRF_ERROR_NOT_FOUND)) {
+                APP_ERROR_CHECK(err_code);
+            }
+            m_nus_tx_queue_head = 0;
+            m_nus_tx_queue_count = 0;
+            break;
+        }
+        frame->offset += chunk;
+        if (frame->offset == frame->length) {
+            m_nus_tx_queue_head = (m_nus_tx_queue_head + 1) % NUS_TX_QUEUE_SIZE;
+            m_nus_tx_queue_count--;
+        }
+    }
+    CRITICAL_REGION_EXIT();
+}
+
+/**@brief Function for queueing a response frame for notification.
+ *
+ * @details Returns as soon as the frame is copied, only waits when all the queue slots are in use.
+ */
 void nus_data_response(uint8_t *p_data, uint16_t length) {
     NRF_LOG_INFO("BLE nus service response data length: %d", length);
     NRF_LOG_HEXDUMP_DEBUG(p_data, length);
 
+    if (length > sizeof(m_nus_tx_queue[0].buffer)) {
+        NRF_LOG_ERROR("BLE nus frame too long: %d", length);
+        return;
+    }
+    // slots are released from the BLE_GATTS_EVT_HVN_TX_COMPLETE interrupt
+    while (m_nus_tx_queue_count == NUS_TX_QUEUE_SIZE && g_is_ble_connected);
+    if (!g_is_ble_connected) {
+        return;
+    }
+    // head + count stays the same slot even if the head frame completes meanwhile
+    nus_tx_frame_t *frame = &m_nus_tx_queue[(m_nus_tx_queue_head + m_nus_tx_queue_count) % NUS_TX_QUEUE_SIZE];
+    memcpy(frame->buffer, p_data, length);
+    frame->length = length;
+    frame->offset = 0;
+    CRITICAL_REGION_ENTER();
+    m_nus_tx_queue_count++;
+    CRITICAL_REGION_EXIT();
+    nus_tx_queue_pump();
+}
+
+bool is_nus_working(void) {
+    return g_is_ble_connected;
+}
+
+/**@brief Function for getting the payload size of one NUS notification, as negotiated with the ATT MTU.
+ */
+uint16_t nus_get_max_data_len(void) {
+    return m_ble_nus_max_data_len;
+}
+
+/**@brief Function for requesting fast link parameters while a streamed response is sent.
+ *
+ * @details Requests the 2M PHY, the maximum data length and a short connection interval.
+ *          The peer may refuse any of them, the transfer then simply runs slower.
+ */
+void ble_bulk_transfer_begin(void) {
     ret_code_t err_code;
-    uint16_t remain = length;
-    uint16_t count = 0;
-    do {
-        remain = MIN(m_ble_nus_max_data_len, remain);
-        err_code = ble_nus_data_send(&m_nus, p_data + count, &remain, m_conn_handle);
-        // NRF_LOG_INFO("Data send length(amount): %d", remain);
-        if (err_code == NRF_SUCCESS) {
-            count += remain;
-            remain = length - count;
-        }
-        // NRF_LOG_INFO("Data send length(count): %d", count);
-        if (err_code == NRF_ERROR_BUSY) {
-            continue;
-        }
-        if ((err_code != NRF_ERROR_INVALID_STATE) &&
-                (err_code != NRF_ERROR_RESOURCES) &&
-                (err_code != NRF_ERROR_NOT_FOUND)) {
-            APP_ERROR_CHECK(err_code);
+
+    // a new stream before the restore of the last one keeps the fast parameters
+    m_ble_bulk_end_pending = false;
+    if (!g_is_ble_connected || m_ble_bulk_transfer) {
+        return;
+    }
+    m_ble_bulk_transfer = true;
+    m_ble_conn_params_own = true;
+
+    ble_gap_phys_t const phys = {
+        .rx_phys = BLE_GAP_PHY_2MBPS,
+        .tx_phys = BLE_GAP_PHY_2MBPS,
+    };
+    err_code = sd_ble_gap_phy_update(m_conn_handle, &phys);
+    if (err_code != NRF_SUCCESS) {
+        NRF_LOG_WARNING("2M PHY request failed: %d", err_code);
+    }
+
+    uint8_t data_length;
+    err_code = nrf_ble_gatt_data_length_get(&m_gatt, m_conn_handle, &data_length);
+    if ((err_code == NRF_SUCCESS) && (data_length < NRF_SDH_BLE_GAP_DATA_LENGTH)) {
+        err_code = nrf_ble_gatt_data_length_set(&m_gatt, m_conn_handle, NRF_SDH_BLE_GAP_DATA_LENGTH);
+        if (err_code != NRF_SUCCESS) {
+            NRF_LOG_WARNING("Data length request failed: %d", err_code);
         }
+    }
 
-    } while (count != length && g_is_ble_connected);
+    ble_gap_conn_params_t conn_params = {
+        .min_conn_interval = BULK_MIN_CONN_INTERVAL,
+        .max_conn_interval = BULK_MAX_CONN_INTERVAL,
+        .slave_latency     = SLAVE_LATENCY,
+        .conn_sup_timeout  = CONN_SUP_TIMEOUT,
+    };
+    err_code = ble_conn_params_change_conn_params(m_conn_handle, &conn_params);
+    if (err_code != NRF_SUCCESS) {
+        NRF_LOG_WARNING("Bulk connection parameters request failed: %d", err_code);
+    }
 }
 
-bool is_nus_working(void) {
-    return g_is_ble_connected;
+/**@brief Function for requesting the low power connection interval again.
+ */
+static void ble_bulk_transfer_restore(void) {
+    m_ble_bulk_end_pending = false;
+    m_ble_bulk_transfer = false;
+    if (!g_is_ble_connected) {
+        return;
+    }
+
+    ble_gap_conn_params_t conn_params = {
+        .min_conn_interval = MIN_CONN_INTERVAL,
+        .max_conn_interval = MAX_CONN_INTERVAL,
+        .slave_latency     = SLAVE_LATENCY,
+        .conn_sup_timeout  = CONN_SUP_TIMEOUT,
+    };
+    ret_code_t err_code = ble_conn_params_change_conn_params(m_conn_handle, &conn_params);
+    if (err_code != NRF_SUCCESS) {
+        NRF_LOG_WARNING("Connection parameters restore failed: %d", err_code);
+    }
+}
+
+/**@brief Function for restoring the low power connection interval after a streamed response.
+ *
+ * @details Called once the last frame is queued, the restore waits until the queue is drained
+ *          on BLE_GATTS_EVT_HVN_TX_COMPLETE. The 2M PHY is kept, it needs less radio time than 1M for the same data.
+ */
+void ble_bulk_transfer_end(void) {
+    if (!m_ble_bulk_transfer) {
+        return;
+    }
+    // the HVN_TX_COMPLETE that drains the queue may come in between
+    bool drained;
+    CRITICAL_REGION_ENTER();
+    drained = m_nus_tx_queue_count == 0;
+    m_ble_bulk_end_pending = !drained;
+    CRITICAL_REGION_EXIT();
+    if (drained) {
+        ble_bulk_transfer_restore();
+    }
 }
 
 /**@brief Function for handling Queued Write Module errors.
@@ -331,7 +476,8 @@ static void services_init(void) {
 static void on_conn_params_evt(ble_conn_params_evt_t *p_evt) {
     uint32_t err_code;
 
-    if (p_evt->evt_type == BLE_CONN_PARAMS_EVT_FAILED) {
+    // a refused bulk transfer request or restore is not worth a disconnection, even when it fails late
+    if (p_evt->evt_type == BLE_CONN_PARAMS_EVT_FAILED && !m_ble_conn_params_own) {
         err_code = sd_ble_gap_disconnect(m_conn_handle, BLE_HCI_CONN_INTERVAL_UNACCEPTABLE);
         APP_ERROR_CHECK(err_code);
     }
@@ -409,6 +555,14 @@ static void ble_evt_handler(ble_evt_t const *p_ble_evt, void *p_context) {
             // LED indication will be changed when advertising starts.
             m_conn_handle = BLE_CONN_HANDLE_INVALID;
             g_is_ble_connected = false;
+            m_ble_nus_max_data_len = BLE_GATT_ATT_MTU_DEFAULT - 3;
+            m_ble_bulk_transfer = false;
+            m_ble_bulk_end_pending = false;
+            m_ble_conn_params_own = false;
+            m_nus_tx_queue_head = 0;
+            m_nus_tx_queue_count = 0;
+            // the next client has to negotiate the frame size again
+            data_frame_set_max_length(NETDATA_DEFAULT_DATA_LENGTH);
             // call sleep_timer_start *after* unsetting g_is_ble_connected
             sleep_timer_start(SLEEP_DELAY_MS_BLE_DISCONNECTED);
             break;
@@ -443,6 +597,14 @@ static void ble_evt_handler(ble_evt_t const *p_ble_evt, void *p_context) {
         }
         break;
 
+        case BLE_GATTS_EVT_HVN_TX_COMPLETE:
+            // room in the SoftDevice queue, keep it full
+            nus_tx_queue_pump();
+            if (m_ble_bulk_end_pending && m_nus_tx_queue_count == 0) {
+                ble_bulk_transfer_restore();
+            }
+            break;
+
         case BLE_GATTS_EVT_SYS_ATTR_MISSING:
             // No system attributes have been stored.
             err_code = sd_ble_gatts_sys_attr_set(m_conn_handle, NULL, 0, 0);
@@ -487,10 +649,25 @@ static void ble_stack_init(void) {
     err_code = nrf_sdh_ble_default_cfg_set(APP_BLE_CONN_CFG_TAG, &ram_start);
     APP_ERROR_CHECK(err_code);
 
+    // Let the SoftDevice queue several notifications, so that a connection event can carry several packets.
+    ble_cfg_t ble_cfg;
+    memset(&ble_cfg, 0, sizeof(ble_cfg));
+    ble_cfg.conn_cfg.conn_cfg_tag = APP_BLE_CONN_CFG_TAG;
+    ble_cfg.conn_cfg.params.gatts_conn_cfg.hvn_tx_queue_size = NUS_HVN_TX_QUEUE_SIZE;
+    err_code = sd_ble_cfg_set(BLE_CONN_CFG_GATTS, &ble_cfg, ram_start);
+    APP_ERROR_CHECK(err_code);
+
     // Enable BLE stack.
     err_code = nrf_sdh_ble_enable(&ram_start);
     APP_ERROR_CHECK(err_code);
 
+    // Let connection events run past the event length when more packets are queued.
+    ble_opt_t ble_opt;
+    memset(&ble_opt, 0, sizeof(ble_opt));
+    ble_opt.common_opt.conn_evt_ext.enable = 1;
+    err_code = sd_ble_opt_set(BLE_COMMON_OPT_CONN_EVT_EXT, &ble_opt);
+    APP_ERROR_CHECK(err_code);
+
     // Register a handler for BLE events.
     NRF_SDH_BLE_OBSERVER(m_ble_observer, APP_BLE_OBSERVER_PRIO, ble_evt_handler, NULL);
 }
@@ -15,6 +15,9 @@ void advertising_stop(void);
 void delete_bonds_all(void);
 void nus_data_response(uint8_t *p_data, uint16_t length);
 bool is_nus_working(void);
+uint16_t nus_get_max_data_len(void);
+void ble_bulk_transfer_begin(void);
+void ble_bulk_transfer_end(void);
 void set_ble_connect_key(uint8_t *key);
 
 #endif
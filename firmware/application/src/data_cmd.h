@@ -45,6 +45,8 @@
 #define DATA_CMD_GET_DEVICE_CAPABILITIES        (1035)
 #define DATA_CMD_GET_BLE_PAIRING_ENABLE         (1036)
 #define DATA_CMD_SET_BLE_PAIRING_ENABLE         (1037)
+#define DATA_CMD_SET_MAX_DATA_LENGTH            (1038)
+#define DATA_CMD_BATCH                          (1039)
 
 //
 // ******************************************************************
@@ -69,6 +71,15 @@
 #define DATA_CMD_MF1_MANIPULATE_VALUE_BLOCK     (2011)
 #define DATA_CMD_MF1_CHECK_KEYS_OF_SECTORS      (2012)
 #define DATA_CMD_MF1_HARDNESTED_ACQUIRE         (2013)
+#define DATA_CMD_MF1_DUMP                       (2014)
+#define DATA_CMD_MF1_HARDNESTED_ACQUIRE_STREAM  (2015)
+#define DATA_CMD_MF1_NESTED_NONCES_OF_SECTORS   (2016)
+#define DATA_CMD_HF14A_READER_TIMING            (2017)
+#define DATA_CMD_MF0_NTAG_DUMP                  (2018)
+#define DATA_CMD_MF1_NESTED_ACQUIRE_STREAM      (2019)
+#define DATA_CMD_MF1_DARKSIDE_ACQUIRE_BATCH     (2020)
+#define DATA_CMD_MF1_CHECK_KEYS_ON_BLOCK        (2021)
+#define DATA_CMD_HF14A_SET_READER_TARGET        (2022)
 
 //
 // ******************************************************************
@@ -124,6 +135,10 @@
 #define DATA_CMD_MF0_NTAG_GET_PAGE_COUNT        (4030)
 #define DATA_CMD_MF0_NTAG_GET_WRITE_MODE        (4031)
 #define DATA_CMD_MF0_NTAG_SET_WRITE_MODE        (4032)
+#define DATA_CMD_HF14A_SET_EMU_TRACE            (4033)
+#define DATA_CMD_HF14A_GET_EMU_TRACE            (4034)
+#define DATA_CMD_HF14A_EMU_TRACE_LIVE           (4035)
+#define DATA_CMD_MF1_GET_DETECTION_LOG_COMPACT  (4036)
 //
 // ******************************************************************
 
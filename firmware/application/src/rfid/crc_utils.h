@@ -3,6 +3,12 @@
 
 #include <stdint.h>
 
+// Bytes taken at a time by calc_14a_crc_lut, 1, 4 or 8, with as many 512 bytes tables in flash
+#ifndef CRC_14A_SLICE_BY
+#define CRC_14A_SLICE_BY 4
+#endif
+
 void calc_14a_crc_lut(uint8_t *data, int length, uint8_t *output);
+uint8_t calc_lrc(const uint8_t *data, uint32_t length);
 
 #endif
@@ -270,43 +270,7 @@ static const uint8_t TableC0[32] = {
     FC(1, 1, 1, 0, 0), FC(1, 1, 1, 0, 1), FC(1, 1, 1, 1, 0), FC(1, 1, 1, 1, 1)
 };
 
-/* Special table for byte processing, feedback at bit 7 */
-static const uint8_t TableC7[32] = {
-    /* fc with Input {4,3,2,1,0} = (0,0,0,0,0) to (1,1,1,1,1) */
-    FC(0, 0, 0, 0, 0) << 7, FC(0, 0, 0, 0, 1) << 7, FC(0, 0, 0, 1, 0) << 7, FC(0, 0, 0, 1, 1) << 7,
-                      FC(0, 0, 1, 0, 0) << 7, FC(0, 0, 1, 0, 1) << 7, FC(0, 0, 1, 1, 0) << 7, FC(0, 0, 1, 1, 1) << 7,
-                      FC(0, 1, 0, 0, 0) << 7, FC(0, 1, 0, 0, 1) << 7, FC(0, 1, 0, 1, 0) << 7, FC(0, 1, 0, 1, 1) << 7,
-                      FC(0, 1, 1, 0, 0) << 7, FC(0, 1, 1, 0, 1) << 7, FC(0, 1, 1, 1, 0) << 7, FC(0, 1, 1, 1, 1) << 7,
-                      FC(1, 0, 0, 0, 0) << 7, FC(1, 0, 0, 0, 1) << 7, FC(1, 0, 0, 1, 0) << 7, FC(1, 0, 0, 1, 1) << 7,
-                      FC(1, 0, 1, 0, 0) << 7, FC(1, 0, 1, 0, 1) << 7, FC(1, 0, 1, 1, 0) << 7, FC(1, 0, 1, 1, 1) << 7,
-                      FC(1, 1, 0, 0, 0) << 7, FC(1, 1, 0, 0, 1) << 7, FC(1, 1, 0, 1, 0) << 7, FC(1, 1, 0, 1, 1) << 7,
-                      FC(1, 1, 1, 0, 0) << 7, FC(1, 1, 1, 0, 1) << 7, FC(1, 1, 1, 1, 0) << 7, FC(1, 1, 1, 1, 1) << 7
-};
-
-/* Special table for nibble processing (e.g. ack), feedback at bit 3 */
-static const uint8_t TableC3[32] = {
-    /* fc with Input {4,3,2,1,0} = (0,0,0,0,0) to (1,1,1,1,1) */
-    FC(0, 0, 0, 0, 0) << 3, FC(0, 0, 0, 0, 1) << 3, FC(0, 0, 0, 1, 0) << 3, FC(0, 0, 0, 1, 1) << 3,
-                      FC(0, 0, 1, 0, 0) << 3, FC(0, 0, 1, 0, 1) << 3, FC(0, 0, 1, 1, 0) << 3, FC(0, 0, 1, 1, 1) << 3,
-                      FC(0, 1, 0, 0, 0) << 3, FC(0, 1, 0, 0, 1) << 3, FC(0, 1, 0, 1, 0) << 3, FC(0, 1, 0, 1, 1) << 3,
-                      FC(0, 1, 1, 0, 0) << 3, FC(0, 1, 1, 0, 1) << 3, FC(0, 1, 1, 1, 0) << 3, FC(0, 1, 1, 1, 1) << 3,
-                      FC(1, 0, 0, 0, 0) << 3, FC(1, 0, 0, 0, 1) << 3, FC(1, 0, 0, 1, 0) << 3, FC(1, 0, 0, 1, 1) << 3,
-                      FC(1, 0, 1, 0, 0) << 3, FC(1, 0, 1, 0, 1) << 3, FC(1, 0, 1, 1, 0) << 3, FC(1, 0, 1, 1, 1) << 3,
-                      FC(1, 1, 0, 0, 0) << 3, FC(1, 1, 0, 0, 1) << 3, FC(1, 1, 0, 1, 0) << 3, FC(1, 1, 0, 1, 1) << 3,
-                      FC(1, 1, 1, 0, 0) << 3, FC(1, 1, 1, 0, 1) << 3, FC(1, 1, 1, 1, 0) << 3, FC(1, 1, 1, 1, 1) << 3
-};
-
 /* Filter Output Macros */
-/* Output at bit 7 for optimized byte processing */
-#define CRYPTO1_FILTER_OUTPUT_B7_24(__O0, __O1, __O2) TableC7[ abFilterTable[0][__O0] | \
-                    abFilterTable[1][__O1] | \
-                    abFilterTable[2][__O2]]
-
-/* Output at bit 3 for optimized nibble processing */
-#define CRYPTO1_FILTER_OUTPUT_B3_24(__O0, __O1, __O2) TableC3[ abFilterTable[0][__O0] | \
-                    abFilterTable[1][__O1] | \
-                    abFilterTable[2][__O2]]
-
 /* Output at bit 0 for general purpose */
 #define CRYPTO1_FILTER_OUTPUT_B0_24(__O0, __O1, __O2) TableC0[ abFilterTable[0][__O0] | \
                     abFilterTable[1][__O1] | \
@@ -420,6 +384,73 @@ uint8_t Crypto1FilterOutput(void) {
     return (CRYPTO1_FILTER_OUTPUT_B0_24(State.Odd[0], State.Odd[1], State.Odd[2]));
 }
 
+/* The functions on the response path below keep the even and odd state  */
+/* in one 32 bit register each, which suits a 32 bit core much better    */
+/* than the 6 byte registers used above. The filter output comes from    */
+/* the byte tables, the feedback is folded to a byte and looked up in    */
+/* the parity table.                                                     */
+#define CRYPTO1_FILTER_OUTPUT_B0_WORD(__O) CRYPTO1_FILTER_OUTPUT_B0_24((__O) & 0xFF, ((__O) >> 8) & 0xFF, (__O) >> 16)
+
+static __inline__ void Crypto1LoadState(uint32_t *pEven, uint32_t *pOdd) __attribute__((always_inline));
+static void Crypto1LoadState(uint32_t *pEven, uint32_t *pOdd) {
+    *pEven = State.Even[0] | ((uint32_t)State.Even[1] << 8) | ((uint32_t)State.Even[2] << 16);
+    *pOdd  = State.Odd[0]  | ((uint32_t)State.Odd[1]  << 8) | ((uint32_t)State.Odd[2]  << 16);
+}
+
+static __inline__ void Crypto1StoreState(uint32_t Even, uint32_t Odd) __attribute__((always_inline));
+static void Crypto1StoreState(uint32_t Even, uint32_t Odd) {
+    State.Even[0] = (uint8_t)(Even >> 0);
+    State.Even[1] = (uint8_t)(Even >> 8);
+    State.Even[2] = (uint8_t)(Even >> 16);
+    State.Odd[0]  = (uint8_t)(Odd >> 0);
+    State.Odd[1]  = (uint8_t)(Odd >> 8);
+    State.Odd[2]  = (uint8_t)(Odd >> 16);
+}
+
+/* Feedback bit of the LFSR, Even is the half which takes the new bit */
+static __inline__ uint8_t Crypto1WordFeedback(uint32_t Even, uint32_t Odd) __attribute__((always_inline));
+static uint8_t Crypto1WordFeedback(uint32_t Even, uint32_t Odd) {
+    uint32_t Feedback;
+
+    Feedback  = (Even & LFSR_MASK_EVEN) ^ (Odd & LFSR_MASK_ODD);
+    Feedback ^= Feedback >> 16;
+    Feedback ^= Feedback >> 8;
+
+    return (evenparity8((uint8_t)Feedback));
+}
+
+/* Proceed LFSR by 2 * Pairs clock cycles and return the keystream.      */
+/* The bits of In are fed into the LFSR, XORed with the keystream if     */
+/* Decrypt is 1. *pOut holds the filter output of the current state and */
+/* is left with the one of the new state, which encrypts the parity bit  */
+/* and bit 0 of the next byte.                                           */
+static __inline__ uint8_t Crypto1WordClock(uint32_t *pEven, uint32_t *pOdd, uint8_t *pOut,
+                                           uint8_t In, uint8_t Decrypt, uint8_t Pairs) __attribute__((always_inline));
+static uint8_t Crypto1WordClock(uint32_t *pEven, uint32_t *pOdd, uint8_t *pOut,
+                                uint8_t In, uint8_t Decrypt, uint8_t Pairs) {
+    uint32_t Even = *pEven, Odd = *pOdd;
+    uint8_t Out = *pOut, KeyStream = 0x00, i;
+
+    for (i = 0; i < Pairs; i++) {
+        KeyStream = (KeyStream >> 1) | (Out << 7);
+        Even = (Even >> 1) | ((uint32_t)(Crypto1WordFeedback(Even, Odd) ^ (In & 1) ^ (Out & Decrypt)) << 23);
+        In >>= 1;
+
+        /* remember Odd/Even swap has been omitted! */
+        Out = CRYPTO1_FILTER_OUTPUT_B0_WORD(Even);
+        KeyStream = (KeyStream >> 1) | (Out << 7);
+        Odd = (Odd >> 1) | ((uint32_t)(Crypto1WordFeedback(Odd, Even) ^ (In & 1) ^ (Out & Decrypt)) << 23);
+        In >>= 1;
+
+        Out = CRYPTO1_FILTER_OUTPUT_B0_WORD(Odd);
+    }
+    *pEven = Even;
+    *pOdd = Odd;
+    *pOut = Out;
+
+    return (KeyStream >> (8 - 2 * Pairs));
+}
+
 /* Setup LFSR split into odd and even states, feed in uid ^nonce */
 /* Version for first (not nested) authentication.                 */
 void Crypto1Setup(uint8_t Key[6], uint8_t Uid[4], uint8_t CardNonce[4]) {
@@ -632,142 +663,29 @@ void Crypto1SetupNested(uint8_t Key[6], uint8_t Uid[4], uint8_t CardNonce[4], ui
 /* Crypto1Auth is similar to Crypto1Byte but */
 /* EncryptedReaderNonce is decrypted and fed back */
 void Crypto1Auth(uint8_t EncryptedReaderNonce[NONCE_SIZE]) {
-    /* registers to hold temporary LFSR state */
-    register uint8_t Even0, Even1, Even2;
-    register uint8_t Odd0, Odd1, Odd2;
-    uint8_t In, Feedback, i;
-
-    /* read state */
-    Even0 = State.Even[0];
-    Even1 = State.Even[1];
-    Even2 = State.Even[2];
-    Odd0 = State.Odd[0];
-    Odd1 = State.Odd[1];
-    Odd2 = State.Odd[2];
-
-    /* 4 Bytes */
-    for (i = 0; i < NONCE_SIZE; i++) {
-        In = EncryptedReaderNonce[i];
-
-        /* Bit 0 */
-        Feedback = CRYPTO1_FILTER_OUTPUT_B0_24(Odd0, Odd1, Odd2);
-        Feedback = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2)
-                   ^ Feedback
-                   ^ In;
-        In >>= 1;
-        SHIFT24(Even0, Even1, Even2, Feedback);
-
-        /* Bit 1 */
-        /* remember Odd/Even swap has been omitted! */
-        Feedback = CRYPTO1_FILTER_OUTPUT_B0_24(Even0, Even1, Even2);
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2)
-                   ^ Feedback
-                   ^ In;
-        In >>= 1;
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
+    uint32_t Even, Odd;
+    uint8_t Out, i;
 
-        /* Bit 2 */
-        Feedback = CRYPTO1_FILTER_OUTPUT_B0_24(Odd0, Odd1, Odd2);
-        Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2)
-                    ^ Feedback
-                    ^ In;
-        In >>= 1;
-        SHIFT24(Even0, Even1, Even2, Feedback);
+    Crypto1LoadState(&Even, &Odd);
+    Out = CRYPTO1_FILTER_OUTPUT_B0_WORD(Odd);
 
-        /* Bit 3 */
-        Feedback = CRYPTO1_FILTER_OUTPUT_B0_24(Even0, Even1, Even2);
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2)
-                   ^ Feedback
-                   ^ In;
-        In >>= 1;
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
-
-        /* Bit 4 */
-        Feedback = CRYPTO1_FILTER_OUTPUT_B0_24(Odd0, Odd1, Odd2);
-        Feedback = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2)
-                   ^ Feedback
-                   ^ In;
-        In >>= 1;
-        SHIFT24(Even0, Even1, Even2, Feedback);
-
-        /* Bit 5 */
-        Feedback = CRYPTO1_FILTER_OUTPUT_B0_24(Even0, Even1, Even2);
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2)
-                   ^ Feedback
-                   ^ In;
-        In >>= 1;
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
-
-        /* Bit 6 */
-        Feedback = CRYPTO1_FILTER_OUTPUT_B0_24(Odd0, Odd1, Odd2);
-        Feedback = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2)
-                   ^ Feedback
-                   ^ In;
-        In >>= 1;
-        SHIFT24(Even0, Even1, Even2, Feedback);
-
-        /* Bit 7 */
-        Feedback = CRYPTO1_FILTER_OUTPUT_B0_24(Even0, Even1, Even2);
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2)
-                   ^ Feedback
-                   ^ In;
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
+    /* 4 Bytes, the reader nonce is decrypted while it is fed in */
+    for (i = 0; i < NONCE_SIZE; i++) {
+        Crypto1WordClock(&Even, &Odd, &Out, EncryptedReaderNonce[i], 1, 4);
     }
-    // save state
-    State.Even[0] = Even0;
-    State.Even[1] = Even1;
-    State.Even[2] = Even2;
-    State.Odd[0]  = Odd0;
-    State.Odd[1]  = Odd1;
-    State.Odd[2]  = Odd2;
+    Crypto1StoreState(Even, Odd);
 }
 
 /* Crypto1Nibble generates keystream for a nibble (4 bit) */
 /* no input to the LFSR  */
 uint8_t Crypto1Nibble(void) {
-    /* state registers */
-    register uint8_t Even0, Even1, Even2;
-    register uint8_t Odd0,  Odd1,  Odd2;
-    uint8_t KeyStream, Feedback, Out;
-
-    /* read state */
-    Even0 = State.Even[0];
-    Even1 = State.Even[1];
-    Even2 = State.Even[2];
-    Odd0 = State.Odd[0];
-    Odd1 = State.Odd[1];
-    Odd2 = State.Odd[2];
-
-    /* Bit 0, initialise keystream */
-    KeyStream = CRYPTO1_FILTER_OUTPUT_B3_24(Odd0, Odd1, Odd2);
-    Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
-    SHIFT24(Even0, Even1, Even2, Feedback);
-
-    /* Bit 1 */
-    Out = CRYPTO1_FILTER_OUTPUT_B3_24(Even0, Even1, Even2);
-    KeyStream = (KeyStream >> 1) | Out;
-    Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
-    SHIFT24(Odd0, Odd1, Odd2, Feedback);
-
-    /* Bit 2 */
-    Out = CRYPTO1_FILTER_OUTPUT_B3_24(Odd0, Odd1, Odd2);
-    KeyStream = (KeyStream >> 1) | Out;
-    Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
-    SHIFT24(Even0, Even1, Even2, Feedback);
-
-    /* Bit 3 */
-    Out = CRYPTO1_FILTER_OUTPUT_B3_24(Even0, Even1, Even2);
-    KeyStream = (KeyStream >> 1) | Out;
-    Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
-    SHIFT24(Odd0, Odd1, Odd2, Feedback);
+    uint32_t Even, Odd;
+    uint8_t KeyStream, Out;
 
-    /* save state */
-    State.Even[0] = Even0;
-    State.Even[1] = Even1;
-    State.Even[2] = Even2;
-    State.Odd[0]  = Odd0;
-    State.Odd[1]  = Odd1;
-    State.Odd[2]  = Odd2;
+    Crypto1LoadState(&Even, &Odd);
+    Out = CRYPTO1_FILTER_OUTPUT_B0_WORD(Odd);
+    KeyStream = Crypto1WordClock(&Even, &Odd, &Out, 0, 0, 2);
+    Crypto1StoreState(Even, Odd);
 
     return (KeyStream);
 }
@@ -775,77 +693,13 @@ uint8_t Crypto1Nibble(void) {
 /* Crypto1Byte generates keystream for a byte (8 bit) */
 /* no input to the LFSR  */
 uint8_t Crypto1Byte(void) {
-    /* state registers */
-    register uint8_t Even0, Even1, Even2;
-    register uint8_t Odd0,  Odd1,  Odd2;
-    uint8_t KeyStream, Feedback, Out;
-
-    /* read state */
-    Even0 = State.Even[0];
-    Even1 = State.Even[1];
-    Even2 = State.Even[2];
-    Odd0 = State.Odd[0];
-    Odd1 = State.Odd[1];
-    Odd2 = State.Odd[2];
-
-    /* Bit 0, initialise keystream */
-    KeyStream = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
-    Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
-    SHIFT24(Even0, Even1, Even2, Feedback);
-
-    /* Bit 1 */
-    /* remember Odd/Even swap has been omitted! */
-    Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-    KeyStream = (KeyStream >> 1) | Out;
-    Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
-    SHIFT24(Odd0, Odd1, Odd2, Feedback);
-
-    /* Bit 2 */
-    Out = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
-    KeyStream = (KeyStream >> 1) | Out;
-    Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
-    SHIFT24(Even0, Even1, Even2, Feedback);
-
-    /* Bit 3 */
-    /* remember Odd/Even swap has been omitted! */
-    Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-    KeyStream = (KeyStream >> 1) | Out;
-    Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
-    SHIFT24(Odd0, Odd1, Odd2, Feedback);
-
-    /* Bit 4 */
-    Out = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
-    KeyStream = (KeyStream >> 1) | Out;
-    Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
-    SHIFT24(Even0, Even1, Even2, Feedback);
-
-    /* Bit 5 */
-    /* remember Odd/Even swap has been omitted! */
-    Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-    KeyStream = (KeyStream >> 1) | Out;
-    Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
-    SHIFT24(Odd0, Odd1, Odd2, Feedback);
-
-    /* Bit 6 */
-    Out = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
-    KeyStream = (KeyStream >> 1) | Out;
-    Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
-    SHIFT24(Even0, Even1, Even2, Feedback);
-
-    /* Bit 7 */
-    /* remember Odd/Even swap has been omitted! */
-    Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-    KeyStream = (KeyStream >> 1) | Out;
-    Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
-    SHIFT24(Odd0, Odd1, Odd2, Feedback);
+    uint32_t Even, Odd;
+    uint8_t KeyStream, Out;
 
-    /* save state */
-    State.Even[0] = Even0;
-    State.Even[1] = Even1;
-    State.Even[2] = Even2;
-    State.Odd[0]  = Odd0;
-    State.Odd[1]  = Odd1;
-    State.Odd[2]  = Odd2;
+    Crypto1LoadState(&Even, &Odd);
+    Out = CRYPTO1_FILTER_OUTPUT_B0_WORD(Odd);
+    KeyStream = Crypto1WordClock(&Even, &Odd, &Out, 0, 0, 4);
+    Crypto1StoreState(Even, Odd);
 
     return (KeyStream);
 }
@@ -855,82 +709,17 @@ uint8_t Crypto1Byte(void) {
 /* Avoids load/store of the LFSR-state for each byte!  */
 /* Enhancement for the original function Crypto1Byte() */
 void Crypto1ByteArray(uint8_t *Buffer, uint8_t Count) {
-    /* state registers */
-    register uint8_t Even0, Even1, Even2;
-    register uint8_t Odd0,  Odd1,  Odd2;
-    uint8_t KeyStream, Feedback, Out;
-
-    /* read state */
-    Even0 = State.Even[0];
-    Even1 = State.Even[1];
-    Even2 = State.Even[2];
-    Odd0 = State.Odd[0];
-    Odd1 = State.Odd[1];
-    Odd2 = State.Odd[2];
-
-    while (Count--) {
-        /* Bit 0, initialise keystream */
-        KeyStream = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
-        Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
-        SHIFT24(Even0, Even1, Even2, Feedback);
-
-        /* Bit 1 */
-        /* remember Odd/Even swap has been omitted! */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
-
-        /* Bit 2 */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
-        SHIFT24(Even0, Even1, Even2, Feedback);
-
-        /* Bit 3 */
-        /* remember Odd/Even swap has been omitted! */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
-
-        /* Bit 4 */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
-        SHIFT24(Even0, Even1, Even2, Feedback);
-
-        /* Bit 5 */
-        /* remember Odd/Even swap has been omitted! */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
-
-        /* Bit 6 */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
-        SHIFT24(Even0, Even1, Even2, Feedback);
+    uint32_t Even, Odd;
+    uint8_t Out;
 
-        /* Bit 7 */
-        /* remember Odd/Even swap has been omitted! */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
+    Crypto1LoadState(&Even, &Odd);
+    Out = CRYPTO1_FILTER_OUTPUT_B0_WORD(Odd);
 
+    while (Count--) {
         /* Transcript and increment buffer address */
-        *Buffer++ ^= KeyStream;
+        *Buffer++ ^= Crypto1WordClock(&Even, &Odd, &Out, 0, 0, 4);
     }
-
-    /* save state */
-    State.Even[0] = Even0;
-    State.Even[1] = Even1;
-    State.Even[2] = Even2;
-    State.Odd[0]  = Odd0;
-    State.Odd[1]  = Odd1;
-    State.Odd[2]  = Odd2;
+    Crypto1StoreState(Even, Odd);
 }
 
 /* Crypto1ByteArrayWithParity encrypts an array of bytes   */
@@ -940,191 +729,47 @@ void Crypto1ByteArray(uint8_t *Buffer, uint8_t Count) {
 /* The filter output used to encrypt the parity is         */
 /* reused to encrypt bit 0 in the next byte.               */
 void Crypto1ByteArrayWithParity(uint8_t *Buffer, uint8_t *Parity, uint8_t Count) {
-    /* state registers */
-    register uint8_t Even0, Even1, Even2;
-    register uint8_t Odd0,  Odd1,  Odd2;
-    // KeyStream is direct to use, must to init.
-    uint8_t KeyStream = 0x00, Feedback, Out;
-
-    /* read state */
-    Even0 = State.Even[0];
-    Even1 = State.Even[1];
-    Even2 = State.Even[2];
-    Odd0 = State.Odd[0];
-    Odd1 = State.Odd[1];
-    Odd2 = State.Odd[2];
-
-    /* First pass needs output, next pass uses parity bit! */
-    Out = CRYPTO1_FILTER_OUTPUT_B0_24(Odd0, Odd1, Odd2);
-
-    while (Count--) {
-        /* Bit 0, initialise keystream from parity */
-        SHIFT8(KeyStream, Out);
-        Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
-        SHIFT24(Even0, Even1, Even2, Feedback);
+    uint32_t Even, Odd;
+    uint8_t KeyStream, Out;
 
-        /* Bit 1 */
-        /* remember Odd/Even swap has been omitted! */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
+    Crypto1LoadState(&Even, &Odd);
+    Out = CRYPTO1_FILTER_OUTPUT_B0_WORD(Odd);
 
-        /* Bit 2 */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
-        SHIFT24(Even0, Even1, Even2, Feedback);
-
-        /* Bit 3 */
-        /* remember Odd/Even swap has been omitted! */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
-
-        /* Bit 4 */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
-        SHIFT24(Even0, Even1, Even2, Feedback);
-
-        /* Bit 5 */
-        /* remember Odd/Even swap has been omitted! */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
-
-        /* Bit 6 */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2);
-        SHIFT24(Even0, Even1, Even2, Feedback);
-
-        /* Bit 7 */
-        /* remember Odd/Even swap has been omitted! */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2);
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
+    while (Count--) {
+        KeyStream = Crypto1WordClock(&Even, &Odd, &Out, 0, 0, 4);
 
         /* Next bit encodes parity */
-        Out = CRYPTO1_FILTER_OUTPUT_B0_24(Odd0, Odd1, Odd2);
         *Parity++ = ODD_PARITY(*Buffer) ^ Out;
 
         /* encode Byte */
         *Buffer++ ^= KeyStream;
     }
-    /* save state */
-    State.Even[0] = Even0;
-    State.Even[1] = Even1;
-    State.Even[2] = Even2;
-    State.Odd[0]  = Odd0;
-    State.Odd[1]  = Odd1;
-    State.Odd[2]  = Odd2;
+    Crypto1StoreState(Even, Odd);
 }
 
 /* Crypto1ByteArrayWithParity encrypts an array of bytes   */
 /* and generates the parity bits                           */
-/* No input to the LFSR                                    */
+/* The plain bytes are fed into the LFSR                   */
 /* Avoids load/store of the LFSR-state for each byte!      */
 /* The filter output used to encrypt the parity is         */
 /* reused to encrypt bit 0 in the next byte.               */
 void Crypto1ByteArrayWithParityHasIn(uint8_t *Buffer, uint8_t *Parity, uint8_t Count) {
-    /* state registers */
-    register uint8_t Even0, Even1, Even2;
-    register uint8_t Odd0,  Odd1,  Odd2;
-    // KeyStream is direct to use, must to init.
-    uint8_t KeyStream = 0x00, Feedback, Out;
-
-    /* read state */
-    Even0 = State.Even[0];
-    Even1 = State.Even[1];
-    Even2 = State.Even[2];
-    Odd0 = State.Odd[0];
-    Odd1 = State.Odd[1];
-    Odd2 = State.Odd[2];
-
-    /* First pass needs output, next pass uses parity bit! */
-    Out = CRYPTO1_FILTER_OUTPUT_B0_24(Odd0, Odd1, Odd2);
-
-    while (Count--) {
-        uint8_t In = *Buffer;
-
-        /* Bit 0, initialise keystream from parity */
-        SHIFT8(KeyStream, Out);
-        Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2) ^ In;
-        In >>= 1;
-        SHIFT24(Even0, Even1, Even2, Feedback);
-
-        /* Bit 1 */
-        /* remember Odd/Even swap has been omitted! */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2) ^ In;
-        In >>= 1;
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
-
-        /* Bit 2 */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2) ^ In;
-        In >>= 1;
-        SHIFT24(Even0, Even1, Even2, Feedback);
-
-        /* Bit 3 */
-        /* remember Odd/Even swap has been omitted! */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2) ^ In;
-        In >>= 1;
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
-
-        /* Bit 4 */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2) ^ In;
-        In >>= 1;
-        SHIFT24(Even0, Even1, Even2, Feedback);
-
-        /* Bit 5 */
-        /* remember Odd/Even swap has been omitted! */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2) ^ In;
-        In >>= 1;
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
+    uint32_t Even, Odd;
+    uint8_t KeyStream, Out;
 
-        /* Bit 6 */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Odd0, Odd1, Odd2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback  = Crypto1LFSRbyteFeedback(Even0, Even1, Even2, Odd0, Odd1, Odd2) ^ In;
-        In >>= 1;
-        SHIFT24(Even0, Even1, Even2, Feedback);
+    Crypto1LoadState(&Even, &Odd);
+    Out = CRYPTO1_FILTER_OUTPUT_B0_WORD(Odd);
 
-        /* Bit 7 */
-        /* remember Odd/Even swap has been omitted! */
-        Out = CRYPTO1_FILTER_OUTPUT_B7_24(Even0, Even1, Even2);
-        KeyStream = (KeyStream >> 1) | Out;
-        Feedback = Crypto1LFSRbyteFeedback(Odd0, Odd1, Odd2, Even0, Even1, Even2) ^ In;
-        In >>= 1;
-        SHIFT24(Odd0, Odd1, Odd2, Feedback);
+    while (Count--) {
+        KeyStream = Crypto1WordClock(&Even, &Odd, &Out, *Buffer, 0, 4);
 
         /* Next bit encodes parity */
-        Out = CRYPTO1_FILTER_OUTPUT_B0_24(Odd0, Odd1, Odd2);
         *Parity++ = ODD_PARITY(*Buffer) ^ Out;
 
         /* encode Byte */
         *Buffer++ ^= KeyStream;
     }
-    /* save state */
-    State.Even[0] = Even0;
-    State.Even[1] = Even1;
-    State.Even[2] = Even2;
-    State.Odd[0]  = Odd0;
-    State.Odd[1]  = Odd1;
-    State.Odd[2]  = Odd2;
+    Crypto1StoreState(Even, Odd);
 }
 
 /* Function Crypto1PRNG                                           */
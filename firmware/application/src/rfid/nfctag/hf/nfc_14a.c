@@ -11,6 +11,7 @@ NRF_LOG_MODULE_REGISTER();
 #include "hex_utils.h"
 #include "crc_utils.h"
 #include "nfc_mf1.h"
+#include "nfc_14a_trace.h"
 
 #include "rfid_main.h"
 #include "syssleep.h"
@@ -96,6 +97,12 @@ static volatile  bool m_is_responded = false;
 // Receiving buffer
 static uint8_t m_nfc_rx_buffer[MAX_NFC_RX_BUFFER_SIZE] = { 0x00 };
 static uint8_t m_nfc_tx_buffer[MAX_NFC_TX_BUFFER_SIZE] = { 0x00 };
+// Frames of the trace without their parity bits, @see nfc_14a_trace_append
+static uint8_t m_trace_frame[MAX_NFC_TX_BUFFER_SIZE];
+static uint8_t m_trace_parity[MAX_NFC_RX_BUFFER_SIZE];
+// The frame received last as it came, traced once its answer was started, @see nfc_tag_14a_trace_rx
+static uint8_t m_trace_rx_frame[MAX_NFC_RX_BUFFER_SIZE];
+static uint16_t m_trace_rx_bits = 0;
 // The N -secondary connection needs to use SAK, when the "third 'bit' in SAK is 1 is 1, the logo UID is incomplete
 static uint8_t m_uid_incomplete_sak[]   = { 0x04, 0xda, 0x17 };
 
@@ -288,6 +295,25 @@ uint8_t nfc_tag_14a_unwrap_frame(const uint8_t *pbtFrame, const size_t szFrameBi
     } while(0);                                                                                                  \
 
 
+/**
+ * @brief Add the frame received last to the trace, it goes before the answer to it
+ */
+static void nfc_tag_14a_trace_rx(void) {
+    uint16_t bits = m_trace_rx_bits;
+    if (bits == 0) {
+        return;
+    }
+    m_trace_rx_bits = 0;
+#if !NFC_TAG_14A_RX_PARITY_AUTO_DEL_ENABLE
+    if (bits >= 9) {
+        bits = nfc_tag_14a_unwrap_frame(m_trace_rx_frame, bits, m_trace_rx_frame, m_trace_parity);
+        nfc_14a_trace_append(0, m_trace_rx_frame, bits, m_trace_parity);
+        return;
+    }
+#endif
+    nfc_14a_trace_append(0, m_trace_rx_frame, bits, NULL);
+}
+
 /**@brief The function of sending the byte flow, this implementation automatically sends SOF
  *
  * @param[in]   data       The byte flow data to be sent
@@ -297,6 +323,9 @@ uint8_t nfc_tag_14a_unwrap_frame(const uint8_t *pbtFrame, const size_t szFrameBi
 void nfc_tag_14a_tx_bytes(uint8_t *data, uint32_t bytes, bool appendCrc) {
     ASSERT(bytes <= MAX_NFC_TX_BUFFER_SIZE);
     NFC_14A_TX_BYTE_CORE(data, bytes, appendCrc, NRF_NFCT_FRAME_DELAY_MODE_WINDOWGRID);
+    nfc_tag_14a_trace_rx();
+    // the hardware adds the parity bits and the CRC
+    nfc_14a_trace_append(NFC_14A_TRACE_FROM_TAG | (appendCrc ? NFC_14A_TRACE_CRC : 0), m_nfc_tx_buffer, bytes * 8, NULL);
 }
 
 /**
@@ -325,6 +354,12 @@ void nfc_tag_14a_tx_bits(uint8_t *data, uint32_t bits) {
     m_is_responded = true;
     memcpy(m_nfc_tx_buffer, data, (bits / 8) + (bits % 8 > 0 ? 1 : 0));
     NFC_14A_TX_BITS_CORE(bits, NRF_NFCT_FRAME_DELAY_MODE_WINDOWGRID);
+    nfc_tag_14a_trace_rx();
+    // the frame is sent with its parity bits in it, the trace keeps them apart
+    if (nfc_14a_trace_is_enable()) {
+        uint16_t data_bits = nfc_tag_14a_unwrap_frame(m_nfc_tx_buffer, bits, m_trace_frame, m_trace_parity);
+        nfc_14a_trace_append(NFC_14A_TRACE_FROM_TAG, m_trace_frame, data_bits, bits >= 9 ? m_trace_parity : NULL);
+    }
 }
 
 /**@brief The function of sending n bits is implemented, and this implementation is automatically sent SOF
@@ -336,6 +371,8 @@ void nfc_tag_14a_tx_nbit(uint8_t data, uint32_t bits) {
     m_is_responded = true;
     m_nfc_tx_buffer[0] = data;
     NFC_14A_TX_BITS_CORE(bits, NRF_NFCT_FRAME_DELAY_MODE_WINDOWGRID);
+    nfc_tag_14a_trace_rx();
+    nfc_14a_trace_append(NFC_14A_TRACE_FROM_TAG, m_nfc_tx_buffer, bits, NULL);
 }
 
 /**
@@ -359,6 +396,11 @@ void nfc_tag_14a_data_process(uint8_t *p_data) {
         // Because of this error receiving event caused by this possible interference
         return;
     }
+    // The trace takes the frame with its parity bits as it came, it is added once the answer was started
+    if (nfc_14a_trace_is_enable()) {
+        memcpy(m_trace_rx_frame, p_data, (szDataBits + 7) / 8);
+        m_trace_rx_bits = szDataBits;
+    }
     // Manually draw frame, separate data and strange school inspection
 #if !NFC_TAG_14A_RX_PARITY_AUTO_DEL_ENABLE
     if (szDataBits >= 9) {
@@ -560,8 +602,8 @@ void nfc_tag_14a_data_process(uint8_t *p_data) {
 }
 
 static inline void nfc_fdt_reset(void) {
-    // STOP TX
-    *(volatile uint32_t *)0x40005010 = 0x01;
+    // STOP TX, the task at 0x010 is not in the datasheet
+    *(volatile uint32_t *)((uint8_t *)NRF_NFCT + 0x010) = 0x01;
     // Reset fdt max
     nrf_nfct_frame_delay_max_set(0x00001000UL);
 }
@@ -639,6 +681,8 @@ void nfc_tag_14a_event_callback(nrfx_nfct_evt_t const *p_event) {
                 nfc_fdt_reset();
                 NRFX_NFCT_RX_BYTES
             }
+            // a frame without answer is traced now
+            nfc_tag_14a_trace_rx();
             break;
         }
         case NRFX_NFCT_EVT_ERROR: {
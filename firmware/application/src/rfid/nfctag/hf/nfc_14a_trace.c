@@ -0,0 +1,149 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "nfc_14a_trace.h"
+#include "nfc_14a.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+
+
+#define NFC_14A_TRACE_MASK  (NFC_14A_TRACE_SIZE - 1)
+
+
+// The frames are added from the NFCT interrupt and taken from the main loop with it masked.
+// Positions run free, the ring index is the position masked.
+static uint8_t m_trace_ring[NFC_14A_TRACE_SIZE];
+static volatile uint32_t m_trace_head = 0;
+static volatile uint32_t m_trace_tail = 0;
+static volatile uint32_t m_trace_dropped = 0;
+static volatile bool m_trace_enable = false;
+
+
+static void nfc_14a_trace_put(uint32_t pos, const uint8_t *data, uint16_t length) {
+    uint16_t index = pos & NFC_14A_TRACE_MASK;
+    uint16_t first = MIN(length, NFC_14A_TRACE_SIZE - index);
+    memcpy(&m_trace_ring[index], data, first);
+    memcpy(m_trace_ring, data + first, length - first);
+}
+
+static void nfc_14a_trace_get(uint32_t pos, uint8_t *data, uint16_t length) {
+    uint16_t index = pos & NFC_14A_TRACE_MASK;
+    uint16_t first = MIN(length, NFC_14A_TRACE_SIZE - index);
+    memcpy(data, &m_trace_ring[index], first);
+    memcpy(data + first, m_trace_ring, length - first);
+}
+
+static uint16_t nfc_14a_trace_record_length(uint16_t bits) {
+    uint16_t bytes = ((bits & NFC_14A_TRACE_BITS_MASK) + 7) / 8;
+    uint16_t length = sizeof(nfc_14a_trace_header_t) + bytes;
+    if (bits & NFC_14A_TRACE_PARITY) {
+        length += (bytes + 7) / 8;
+    }
+    return length;
+}
+
+/**
+ * Length of the record at pos, the bits field is read back from the ring
+ */
+static uint16_t nfc_14a_trace_record_length_at(uint32_t pos) {
+    uint8_t bits[2];
+    nfc_14a_trace_get(pos + offsetof(nfc_14a_trace_header_t, bits), bits, sizeof(bits));
+    return nfc_14a_trace_record_length((bits[0] << 8) | bits[1]);
+}
+
+/**
+ * Enable or disable the trace, it starts empty
+ */
+void nfc_14a_trace_set_enable(bool enable) {
+    CRITICAL_REGION_ENTER();
+    m_trace_enable = enable;
+    m_trace_head = 0;
+    m_trace_tail = 0;
+    m_trace_dropped = 0;
+    CRITICAL_REGION_EXIT();
+}
+
+bool nfc_14a_trace_is_enable(void) {
+    return m_trace_enable;
+}
+
+/**
+ * Add a frame to the trace, overwriting the oldest frames if it is full.
+ * parity holds one bit per byte of data in the LSB of each byte, as nfc_tag_14a_unwrap_frame gives them, or NULL.
+ * Called from the NFCT interrupt, after the answer to the frame was started.
+ */
+void nfc_14a_trace_append(uint16_t flags, const uint8_t *data, uint16_t bits, const uint8_t *parity) {
+    if (!m_trace_enable) {
+        return;
+    }
+    uint16_t bytes = (bits + 7) / 8;
+    uint8_t parity_bits[(MAX_NFC_RX_BUFFER_SIZE + 7) / 8];
+    if (parity != NULL && bytes <= MAX_NFC_RX_BUFFER_SIZE) {
+        flags |= NFC_14A_TRACE_PARITY;
+        memset(parity_bits, 0, sizeof(parity_bits));
+        for (uint16_t i = 0; i < bytes; i++) {
+            parity_bits[i / 8] |= (parity[i] & 0x01) << (i % 8);
+        }
+    } else {
+        flags &= ~NFC_14A_TRACE_PARITY;
+    }
+    uint16_t value = flags | (bits & NFC_14A_TRACE_BITS_MASK);
+    uint16_t length = nfc_14a_trace_record_length(value);
+    nfc_14a_trace_header_t header = {
+        .timestamp = U32HTONL(app_timer_cnt_get()),
+        .bits = U16HTONS(value),
+    };
+    // the oldest records make room
+    while (NFC_14A_TRACE_SIZE - (m_trace_head - m_trace_tail) < length) {
+        m_trace_tail += nfc_14a_trace_record_length_at(m_trace_tail);
+        m_trace_dropped++;
+    }
+    uint32_t pos = m_trace_head;
+    nfc_14a_trace_put(pos, (uint8_t *)&header, sizeof(header));
+    pos += sizeof(header);
+    nfc_14a_trace_put(pos, data, bytes);
+    pos += bytes;
+    if (flags & NFC_14A_TRACE_PARITY) {
+        nfc_14a_trace_put(pos, parity_bits, (bytes + 7) / 8);
+    }
+    m_trace_head += length;
+}
+
+/**
+ * Take the oldest records of the trace, as many whole records as fit into max_length.
+ * Returns the length taken.
+ */
+uint16_t nfc_14a_trace_read(uint8_t *buffer, uint16_t max_length) {
+    uint16_t length = 0;
+    CRITICAL_REGION_ENTER();
+    while (m_trace_tail != m_trace_head) {
+        uint16_t record_length = nfc_14a_trace_record_length_at(m_trace_tail);
+        if (length + record_length > max_length) {
+            break;
+        }
+        nfc_14a_trace_get(m_trace_tail, buffer + length, record_length);
+        m_trace_tail += record_length;
+        length += record_length;
+    }
+    CRITICAL_REGION_EXIT();
+    return length;
+}
+
+/**
+ * Bytes of records in the trace
+ */
+uint16_t nfc_14a_trace_pending(void) {
+    return m_trace_head - m_trace_tail;
+}
+
+/**
+ * Number of records overwritten since the last call
+ */
+uint32_t nfc_14a_trace_take_dropped(void) {
+    uint32_t dropped;
+    CRITICAL_REGION_ENTER();
+    dropped = m_trace_dropped;
+    m_trace_dropped = 0;
+    CRITICAL_REGION_EXIT();
+    return dropped;
+}
@@ -0,0 +1,38 @@
+#ifndef NFC_14A_TRACE_H
+#define NFC_14A_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "utils.h"
+
+
+// Bytes kept for the trace, a power of 2, the oldest records are overwritten
+#ifndef NFC_14A_TRACE_SIZE
+#define NFC_14A_TRACE_SIZE          4096
+#endif
+
+// Flags in the bits field of a record
+#define NFC_14A_TRACE_FROM_TAG      0x8000  // sent by the emulated tag, else received from the reader
+#define NFC_14A_TRACE_PARITY        0x4000  // the data is followed by the parity bits, one per byte, LSB first
+#define NFC_14A_TRACE_CRC           0x2000  // the CRC was appended by the hardware and is not in the data
+#define NFC_14A_TRACE_BITS_MASK     0x1FFF
+
+
+/*
+ * A frame of the trace, in network byte order, followed by the data and the parity bits
+ */
+typedef struct {
+    uint32_t timestamp;     // RTC ticks, 32768 Hz, 24 bits that wrap
+    uint16_t bits;          // frame bits without parity, and the flags above
+} PACKED nfc_14a_trace_header_t;
+
+
+void nfc_14a_trace_set_enable(bool enable);
+bool nfc_14a_trace_is_enable(void);
+void nfc_14a_trace_append(uint16_t flags, const uint8_t *data, uint16_t bits, const uint8_t *parity);
+uint16_t nfc_14a_trace_read(uint8_t *buffer, uint16_t max_length);
+uint16_t nfc_14a_trace_pending(void);
+uint32_t nfc_14a_trace_take_dropped(void);
+
+#endif
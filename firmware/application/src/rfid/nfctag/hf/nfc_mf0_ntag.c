@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 
 #include "nfc_mf0_ntag.h"
 #include "nfc_14a.h"
@@ -808,6 +809,7 @@ static int handle_write_command(uint8_t block_num, uint8_t *p_data) {
     if (m_tag_information->config.mode_uid_magic) {
         // anything can be written in this mode
         memcpy(m_tag_information->memory[block_num], p_data, NFC_TAG_MF0_NTAG_DATA_SIZE);
+        tag_emulation_mark_dirty(m_tag_information->memory[block_num], NFC_TAG_MF0_NTAG_DATA_SIZE);
         return ACK_VALUE;
     }
 
@@ -837,6 +839,7 @@ static int handle_write_command(uint8_t block_num, uint8_t *p_data) {
             } else return NAK_INVALID_OPERATION_TBV;
             break;
     }
+    tag_emulation_mark_dirty(m_tag_information->memory[block_num], NFC_TAG_MF0_NTAG_DATA_SIZE);
 
     return ACK_VALUE;
 }
@@ -902,6 +905,7 @@ static void handle_incr_cnt_command(uint8_t block_num, uint8_t *p_data) {
         cnt_data[0] = (uint8_t)(cnt >> 16);
         cnt_data[1] = (uint8_t)(cnt >> 8);
         cnt_data[2] = (uint8_t)(cnt & 0xff);
+        tag_emulation_mark_dirty(cnt_data, NFC_TAG_MF0_NTAG_DATA_SIZE);
 
         nfc_tag_14a_tx_nbit(ACK_VALUE, 4);
     }
@@ -1242,11 +1246,9 @@ bool nfc_tag_mf0_ntag_data_factory(uint8_t slot, tag_specific_type_t tag_type) {
 
     // save data to flash
     tag_sense_type_t sense_type = get_sense_type_from_tag_type(tag_type);
-    fds_slot_record_map_t map_info;
-    get_fds_map_by_slot_sense_type_for_dump(slot, sense_type, &map_info);
     int info_size = get_information_size_by_tag_type(tag_type);
     NRF_LOG_INFO("MF0/NTAG info size: %d", info_size);
-    bool ret = fds_write_sync(map_info.id, map_info.key, info_size, p_ntag_information);
+    bool ret = tag_dump_write_sync(slot, sense_type, (uint8_t *)p_ntag_information, info_size, TAG_DUMP_CHUNK_MASK_ALL, NULL);
     if (ret) {
         NRF_LOG_INFO("Factory slot data success.");
     } else {
@@ -1,10 +1,14 @@
 #include <stdlib.h>
+#include <string.h>
 
 #include "nfc_mf1.h"
 #include "nfc_14a.h"
 #include "hex_utils.h"
 #include "fds_util.h"
+#include "nonce_pool.h"
 #include "tag_persistence.h"
+#include "mf1_crapto1.h"
+#include "app_util_platform.h"
 
 #ifdef NFC_MF1_FAST_SIM
 #include "mf1_crypto1.h"
@@ -200,12 +204,26 @@ static struct Crypto1State *pcs = &mpcs;
 
 // Define the buffer of the data that stored the detected data
 // Place this data in a dormant RAM to save time and space to write into Flash
-#define MF1_AUTH_LOG_MAX_SIZE   1000
+// The entries are packed as nfc_tag_mf1_auth_log_entry_t into a ring, the UIDs are kept once in a table.
+// Same RAM as the 1000 fixed 18 byte records it replaces.
+#define MF1_AUTH_LOG_MAGIC          0x4D466C33
+#define MF1_AUTH_LOG_ENTRY_COUNT    1271
 static __attribute__((section(".noinit"))) struct nfc_tag_mf1_auth_log_buffer {
-    uint32_t count;
-    nfc_tag_mf1_auth_log_t logs[MF1_AUTH_LOG_MAX_SIZE];
+    uint32_t magic;             // the log is cleared if this is not MF1_AUTH_LOG_MAGIC, e.g. at the first power up
+    uint32_t count;             // entries in the ring
+    uint32_t head;              // entry positions in the ring, they run free
+    uint32_t tail;
+    uint32_t dropped;           // entries overwritten in ring mode, or not logged once full
+    uint8_t mode;               // nfc_tag_mf1_auth_log_mode_t
+    uint8_t uid_count;
+    uint8_t uids[NFC_TAG_MF1_AUTH_LOG_UID_MAX][4];
+    nfc_tag_mf1_auth_log_entry_t ring[MF1_AUTH_LOG_ENTRY_COUNT];
 } m_auth_log;
 
+// The entry of the auth in progress, written to the log once the reader answered
+static nfc_tag_mf1_auth_log_entry_t m_auth_log_entry;
+static uint8_t m_auth_log_entry_step = 0;
+
 static uint8_t CardResponse[4];
 static uint8_t ReaderResponse[4];
 static uint8_t CurrentAddress;
@@ -310,17 +328,35 @@ void ValueToBlock(uint8_t *Block, uint32_t Value) {
  * @param nonce      Random number buffer
  */
 void nfc_tag_mf1_random_nonce(uint8_t nonce[4], bool isNested) {
-    // Use RAND to quickly generate random numbers, less performance loss
-    // isNested provides more randomness for hardnested attack
-    if (isNested) {
-        nonce[0] = rand() & 0xff;
-        nonce[1] = rand() & 0xff;
-        nonce[2] = rand() & 0xff;
-        nonce[3] = rand() & 0xff;
-    } else {
-        // fast for most readers
-        num_to_bytes(rand(), 4, nonce);
+    // The pool is refilled from the hardware RNG outside of the interrupt, taking a nonce is just a read.
+    // All 32 bits are random for the plain and the nested auth alike, with the detection log on or off,
+    // a hardnested analysis finds no bias.
+    num_to_bytes(nonce_pool_get(), 4, nonce);
+}
+
+static void mf1_auth_log_init(void) {
+    if (m_auth_log.magic != MF1_AUTH_LOG_MAGIC) {
+        memset(&m_auth_log, 0, offsetof(struct nfc_tag_mf1_auth_log_buffer, ring));
+        m_auth_log.magic = MF1_AUTH_LOG_MAGIC;
+        NRF_LOG_INFO("Mifare Classic auth log buffer ready");
+    }
+}
+
+
+/**
+ * Index of the UID in the table of the log, added if new. Returns -1 once the table is full.
+ */
+static int mf1_auth_log_uid_index(const uint8_t *uid) {
+    for (uint8_t i = 0; i < m_auth_log.uid_count; i++) {
+        if (memcmp(m_auth_log.uids[i], uid, 4) == 0) {
+            return i;
+        }
     }
+    if (m_auth_log.uid_count >= NFC_TAG_MF1_AUTH_LOG_UID_MAX) {
+        return -1;
+    }
+    memcpy(m_auth_log.uids[m_auth_log.uid_count], uid, 4);
+    return m_auth_log.uid_count++;
 }
 
 /**
@@ -331,26 +367,22 @@ void nfc_tag_mf1_random_nonce(uint8_t nonce[4], bool isNested) {
  * @param nonce: Brightly random number
  */
 void append_mf1_auth_log_step1(bool isKeyB, bool isNested, uint8_t block, uint8_t *nonce) {
-    // Power up for the first time, reset the buffer information
-    if (m_auth_log.count == 0xFFFFFFFF) {
-        m_auth_log.count = 0;
-        NRF_LOG_INFO("Mifare Classic auth log buffer ready");
-    }
-    // Non -first -time call, see if you record whether the detection log is over the upper limit of the size
-    if (m_auth_log.count > MF1_AUTH_LOG_MAX_SIZE) {
-        // Skill this operation directly over the upper limit.
-        NRF_LOG_INFO("Mifare Classic auth log buffer overflow");
+    m_auth_log_entry_step = 0;
+    // Determine whether this card slot enables the detection log record
+    if (!m_tag_information->config.detection_enable) {
         return;
     }
-    // Determine whether this card slot enables the detection log record
-    if (m_tag_information->config.detection_enable) {
-        m_auth_log.logs[m_auth_log.count].is_key_b = isKeyB;
-        m_auth_log.logs[m_auth_log.count].block = block;
-        m_auth_log.logs[m_auth_log.count].is_nested = isNested;
-        memcpy(m_auth_log.logs[m_auth_log.count].uid, UID_BY_CASCADE_LEVEL, 4);
-//        m_auth_log.logs[m_auth_log.count].nt = U32HTONL(*(uint32_t *)nonce);
-        memcpy(m_auth_log.logs[m_auth_log.count].nt, nonce, 4);
+    mf1_auth_log_init();
+    int uid_index = mf1_auth_log_uid_index(UID_BY_CASCADE_LEVEL);
+    if (uid_index < 0) {
+        NRF_LOG_INFO("Mifare Classic auth log uid table full");
+        m_auth_log.dropped++;
+        return;
     }
+    m_auth_log_entry.block = block;
+    m_auth_log_entry.flags = (isKeyB ? NFC_TAG_MF1_AUTH_LOG_KEY_B : 0) | (isNested ? NFC_TAG_MF1_AUTH_LOG_NESTED : 0) | (uid_index << NFC_TAG_MF1_AUTH_LOG_UID_SHIFT);
+    memcpy(m_auth_log_entry.nt, nonce, 4);
+    m_auth_log_entry_step = 1;
 }
 
 /** @brief MF1 additional verification log, step 2, store the encryption information of the read -ahead response
@@ -358,17 +390,12 @@ void append_mf1_auth_log_step1(bool isKeyB, bool isNested, uint8_t block, uint8_
  * @param ar: The random number of the label, the random number of the read -headed head is encrypted
  */
 void append_mf1_auth_log_step2(uint8_t *nr, uint8_t *ar) {
-    // Determine to the upper limit and skip this operation directly to avoid covering the previous records
-    if (m_auth_log.count > MF1_AUTH_LOG_MAX_SIZE) {
+    if (m_auth_log_entry_step != 1) {
         return;
     }
-    if (m_tag_information->config.detection_enable) {
-        // Cache encryption information
-//        m_auth_log.logs[m_auth_log.count].nr = U32HTONL(*(uint32_t *)nr);
-//        m_auth_log.logs[m_auth_log.count].ar = U32HTONL(*(uint32_t *)ar);
-        memcpy(m_auth_log.logs[m_auth_log.count].nr, nr, 4);
-        memcpy(m_auth_log.logs[m_auth_log.count].ar, ar, 4);
-    }
+    memcpy(m_auth_log_entry.nr, nr, 4);
+    memcpy(m_auth_log_entry.ar, ar, 4);
+    m_auth_log_entry_step = 2;
 }
 
 /** @brief MF1 additional verification log, step 3, store the last verification or failure log
@@ -376,26 +403,87 @@ void append_mf1_auth_log_step2(uint8_t *nr, uint8_t *ar) {
  * @param is_auth_success: Whether to verify success
  */
 void append_mf1_auth_log_step3(bool is_auth_success) {
-    // Determine to the upper limit and skip this operation directly to avoid covering the previous records
-    if (m_auth_log.count > MF1_AUTH_LOG_MAX_SIZE) {
+    uint8_t step = m_auth_log_entry_step;
+    m_auth_log_entry_step = 0;
+    if (step != 2) {
         return;
     }
-    if (m_tag_information->config.detection_enable) {
-        // Then you can end this record, the number of statistics increases
-        m_auth_log.count += 1;
-        // Print the number of logs in the current record
-        NRF_LOG_INFO("Auth log count: %d", m_auth_log.count);
+    if (m_auth_log.head - m_auth_log.tail >= MF1_AUTH_LOG_ENTRY_COUNT) {
+        // Skill this operation directly over the upper limit, unless the oldest entry can go
+        if (m_auth_log.mode != NFC_TAG_MF1_AUTH_LOG_MODE_RING) {
+            NRF_LOG_INFO("Mifare Classic auth log buffer overflow");
+            m_auth_log.dropped++;
+            return;
+        }
+        m_auth_log.tail++;
+        m_auth_log.count--;
+        m_auth_log.dropped++;
     }
+    m_auth_log.ring[m_auth_log.head % MF1_AUTH_LOG_ENTRY_COUNT] = m_auth_log_entry;
+    m_auth_log.head++;
+    // Then you can end this record, the number of statistics increases
+    m_auth_log.count += 1;
+    // Print the number of logs in the current record
+    NRF_LOG_INFO("Auth log count: %d", m_auth_log.count);
 }
 
 /** @brief MF1 obtain verification log
- * @param count: The statistics of the verification log
+ * @param index: first entry to copy
+ * @param buffer: the entries, packed or as nfc_tag_mf1_auth_log_t
+ * @param max_length: room in buffer, only whole entries are copied
+ * @param packed: copy the entries as they are in the log, the UIDs are then given by mf1_get_auth_log_uids
+ * @return length copied
+ */
+uint16_t mf1_get_auth_log(uint32_t index, uint8_t *buffer, uint16_t max_length, bool packed) {
+    uint16_t length;
+    uint32_t first, head, tail;
+    mf1_auth_log_init();
+    // The entries are copied outside of the critical region. The emulation may add entries meanwhile,
+    // in ring mode it then overwrites the oldest ones: copy again if the first one copied was overwritten.
+    do {
+        length = 0;
+        CRITICAL_REGION_ENTER();
+        first = m_auth_log.tail + index;
+        head = m_auth_log.head;
+        CRITICAL_REGION_EXIT();
+        for (uint32_t pos = first; (int32_t)(head - pos) > 0; pos++) {
+            nfc_tag_mf1_auth_log_entry_t *entry = &m_auth_log.ring[pos % MF1_AUTH_LOG_ENTRY_COUNT];
+            if (packed) {
+                if (length + sizeof(nfc_tag_mf1_auth_log_entry_t) > max_length) {
+                    break;
+                }
+                memcpy(buffer + length, entry, sizeof(nfc_tag_mf1_auth_log_entry_t));
+                length += sizeof(nfc_tag_mf1_auth_log_entry_t);
+            } else {
+                if (length + sizeof(nfc_tag_mf1_auth_log_t) > max_length) {
+                    break;
+                }
+                nfc_tag_mf1_auth_log_t *log = (nfc_tag_mf1_auth_log_t *)(buffer + length);
+                memset(log, 0, sizeof(nfc_tag_mf1_auth_log_t));
+                log->block = entry->block;
+                log->is_key_b = (entry->flags & NFC_TAG_MF1_AUTH_LOG_KEY_B) ? 1 : 0;
+                log->is_nested = (entry->flags & NFC_TAG_MF1_AUTH_LOG_NESTED) ? 1 : 0;
+                memcpy(log->uid, m_auth_log.uids[entry->flags >> NFC_TAG_MF1_AUTH_LOG_UID_SHIFT], 4);
+                memcpy(log->nt, entry->nt, 4);
+                memcpy(log->nr, entry->nr, 4);
+                memcpy(log->ar, entry->ar, 4);
+                length += sizeof(nfc_tag_mf1_auth_log_t);
+            }
+        }
+        CRITICAL_REGION_ENTER();
+        tail = m_auth_log.tail;
+        CRITICAL_REGION_EXIT();
+    } while ((int32_t)(tail - first) > 0);
+    return length;
+}
+
+/** @brief MF1 UIDs of the packed entries of the verification log
+ * @param count: number of UIDs
  */
-nfc_tag_mf1_auth_log_t *mf1_get_auth_log(uint32_t *count) {
-    // First pass the total number of logs verified by verified
-    *count = m_auth_log.count;
-    // Just return to the head pointer of the log number array
-    return m_auth_log.logs;
+uint8_t *mf1_get_auth_log_uids(uint8_t *count) {
+    mf1_auth_log_init();
+    *count = m_auth_log.uid_count;
+    return (uint8_t *)m_auth_log.uids;
 }
 
 static int get_block_max_by_tag_type(tag_specific_type_t tag_type) {
@@ -612,6 +700,7 @@ void nfc_tag_mf1_state_handler(uint8_t *p_data, uint16_t szDataBits) {
                     if (nfc_tag_14a_checks_crc(p_data, NFC_TAG_MF1_FRAME_SIZE)) {
                         // The data verification passes, we need to put the data sent in RAM
                         memcpy(m_tag_information->memory[CurrentAddress], p_data, NFC_TAG_MF1_DATA_SIZE);
+                        tag_emulation_mark_dirty(m_tag_information->memory[CurrentAddress], NFC_TAG_MF1_DATA_SIZE);
                         // Restore the Gen1A special state machine for waiting operation status
                         m_gen1a_state = GEN1A_STATE_UNLOCKED_RW_WAIT;
                         // Reply to read head ACK, complete the writing operation
@@ -780,6 +869,7 @@ void nfc_tag_mf1_state_handler(uint8_t *p_data, uint16_t szDataBits) {
                             } else {
                                 // Write the block address specified by the global buffer back in the instruction parameter
                                 memcpy(m_tag_information->memory[p_data[1]], m_data_block_buffer, MEM_BYTES_PER_BLOCK);
+                                tag_emulation_mark_dirty(m_tag_information->memory[p_data[1]], MEM_BYTES_PER_BLOCK);
                                 status = ACK_VALUE;
                             }
                             mf1_response_4bit_auto_encrypt(status);
@@ -937,6 +1027,7 @@ void nfc_tag_mf1_state_handler(uint8_t *p_data, uint16_t szDataBits) {
                     } else {
                         // Other remaining modes can be updated to the labeled RAM
                         memcpy(m_tag_information->memory[CurrentAddress], p_data, NFC_TAG_MF1_DATA_SIZE);
+                        tag_emulation_mark_dirty(m_tag_information->memory[CurrentAddress], NFC_TAG_MF1_DATA_SIZE);
                         status = ACK_VALUE;
                     }
                 } else {
@@ -1160,11 +1251,9 @@ bool nfc_tag_mf1_data_factory(uint8_t slot, tag_specific_type_t tag_type) {
 
     // save data to flash
     tag_sense_type_t sense_type = get_sense_type_from_tag_type(tag_type);
-    fds_slot_record_map_t map_info;
-    get_fds_map_by_slot_sense_type_for_dump(slot, sense_type, &map_info);
     int info_size = get_information_size_by_tag_type(tag_type);
     NRF_LOG_INFO("MF1 info size: %d", info_size);
-    bool ret = fds_write_sync(map_info.id, map_info.key, info_size, p_mf1_information);
+    bool ret = tag_dump_write_sync(slot, sense_type, (uint8_t *)p_mf1_information, info_size, TAG_DUMP_CHUNK_MASK_ALL, NULL);
     if (ret) {
         NRF_LOG_INFO("Factory slot data success.");
     } else {
@@ -1183,16 +1272,27 @@ bool nfc_tag_mf1_is_detection_enable(void) {
     return m_tag_information->config.detection_enable;
 }
 
-// Clear detection record
-void nfc_tag_mf1_detection_log_clear(void) {
-    m_auth_log.count = 0;
+// Clear detection record, mode tells what to do once it is full
+void nfc_tag_mf1_detection_log_clear(nfc_tag_mf1_auth_log_mode_t mode) {
+    CRITICAL_REGION_ENTER();
+    m_auth_log.magic = 0;
+    mf1_auth_log_init();
+    m_auth_log.mode = mode;
+    CRITICAL_REGION_EXIT();
 }
 
 // The number of statistics of detection records
 uint32_t nfc_tag_mf1_detection_log_count(void) {
+    mf1_auth_log_init();
     return m_auth_log.count;
 }
 
+// The number of entries lost since the detection record was cleared
+uint32_t nfc_tag_mf1_detection_log_dropped(void) {
+    mf1_auth_log_init();
+    return m_auth_log.dropped;
+}
+
 // Set gen1a magic mode
 void nfc_tag_mf1_set_gen1a_magic_mode(bool enable) {
     m_tag_information->config.mode_gen1a_magic = enable;
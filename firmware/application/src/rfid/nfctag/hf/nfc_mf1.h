@@ -6,7 +6,8 @@
 
 // Exchange space for time.
 // Fast simulate enable(Implement By ChameleonMini Repo)
-// #define NFC_MF1_FAST_SIM
+// NFC_MF1_FAST_SIM is defined by the Makefile, build with NFC_MF1_FAST_SIM=0 to use crapto1,
+// firmware/application/test/crypto1_test.c checks both engines give the same bits.
 
 #define NFC_TAG_MF1_DATA_SIZE   16
 #define NFC_TAG_MF1_FRAME_SIZE  (NFC_TAG_MF1_DATA_SIZE + NFC_TAG_14A_CRC_LENGTH)
@@ -138,15 +139,36 @@ typedef struct {
     // uint32_t ar;
 } PACKED nfc_tag_mf1_auth_log_t;
 
+// MF1 label verification history as packed in the log: the UID is an index in a table of the log
+typedef struct {
+    uint8_t block;
+    uint8_t flags;
+    uint8_t nt[4];
+    uint8_t nr[4];
+    uint8_t ar[4];
+} PACKED nfc_tag_mf1_auth_log_entry_t;
+
+#define NFC_TAG_MF1_AUTH_LOG_KEY_B              0x01
+#define NFC_TAG_MF1_AUTH_LOG_NESTED             0x02
+#define NFC_TAG_MF1_AUTH_LOG_UID_SHIFT          3
+#define NFC_TAG_MF1_AUTH_LOG_UID_MAX            32
+
+typedef enum {
+    NFC_TAG_MF1_AUTH_LOG_MODE_STOP,     // new entries are dropped once the log is full
+    NFC_TAG_MF1_AUTH_LOG_MODE_RING,     // the oldest entries are overwritten
+} nfc_tag_mf1_auth_log_mode_t;
+
 
-nfc_tag_mf1_auth_log_t *mf1_get_auth_log(uint32_t *count);
+uint16_t mf1_get_auth_log(uint32_t index, uint8_t *buffer, uint16_t max_length, bool packed);
+uint8_t *mf1_get_auth_log_uids(uint8_t *count);
 int nfc_tag_mf1_data_loadcb(tag_specific_type_t type, tag_data_buffer_t *buffer);
 int nfc_tag_mf1_data_savecb(tag_specific_type_t type, tag_data_buffer_t *buffer);
 bool nfc_tag_mf1_data_factory(uint8_t slot, tag_specific_type_t tag_type);
 void nfc_tag_mf1_set_detection_enable(bool enable);
 bool nfc_tag_mf1_is_detection_enable(void);
-void nfc_tag_mf1_detection_log_clear(void);
+void nfc_tag_mf1_detection_log_clear(nfc_tag_mf1_auth_log_mode_t mode);
 uint32_t nfc_tag_mf1_detection_log_count(void);
+uint32_t nfc_tag_mf1_detection_log_dropped(void);
 nfc_tag_14a_coll_res_reference_t *get_mifare_coll_res(void);
 nfc_tag_14a_coll_res_reference_t *get_saved_mifare_coll_res(void);
 void nfc_tag_mf1_set_gen1a_magic_mode(bool enable);
@@ -6,6 +6,7 @@
 #include "fds_util.h"
 #include "tag_persistence.h"
 #include "bsp_delay.h"
+#include "lf_tag_modulation.h"
 
 #include "nrf_gpio.h"
 #include "nrf_drv_timer.h"
@@ -28,17 +29,26 @@ NRF_LOG_MODULE_REGISTER();
 // Whether the USB light effect is allowed to enable
 extern bool g_usb_led_marquee_enable;
 
+// Each half bit is two PWM periods of 128us at 125kHz, the sequence can then start in the middle of a half bit
+#define LF_EM410X_PWM_PERIODS_PER_HALF  2
+#define LF_EM410X_PWM_TOP               (LF_125KHZ_EM410X_BIT_CLOCK / LF_EM410X_PWM_PERIODS_PER_HALF / 8)
+#define LF_EM410X_PWM_SEQ_LENGTH        (LF_125KHZ_EM410X_BIT_SIZE * 2 * LF_EM410X_PWM_PERIODS_PER_HALF)
+// The field is checked once for this many broadcasts of the ID, 32.768ms each
+#define LF_EM410X_FIELD_CHECK_US        (LF_125KHZ_EM410X_BIT_CLOCK * 2 * LF_125KHZ_EM410X_BIT_SIZE * LF_125KHZ_BROADCAST_MAX)
+
 // Bit data carrying 64 -bit ID number
 static uint64_t m_id_bit_data = 0;
-// The bit position of the card ID currently sent
-static uint8_t m_bit_send_position;
-// Whether to send the first edge
-static bool m_is_send_first_edge;
-// The current broadcast ID number is 33ms every few times, and can be broadcast about 30 times a second
-static uint8_t m_send_id_count;
+// Modulation of the whole ID played by the PWM, one value per PWM period
+static nrf_pwm_values_common_t m_id_pwm_values[LF_EM410X_PWM_SEQ_LENGTH];
+static nrf_pwm_sequence_t const m_id_pwm_seq = {
+    .values.p_common = m_id_pwm_values,
+    .length          = LF_EM410X_PWM_SEQ_LENGTH,
+    .repeats         = 0,
+    .end_delay       = 0
+};
 // Whether it is currently in the low -frequency card number of broadcasting
 static volatile bool m_is_lf_emulating = false;
-// The timer of the delivery card number, we use the timer 3
+// The timer of the field checks while broadcasting, we use the timer 3
 const nrfx_timer_t m_timer_send_id = NRFX_TIMER_INSTANCE(3);
 // Cache label type
 static tag_specific_type_t m_tag_type = TAG_TYPE_UNDEFINED;
@@ -206,76 +216,46 @@ bool lf_is_field_exists(void) {
     return nrf_lpcomp_result_get() == 1;                //Determine the sampling results of the LF field status
 }
 
+/**
+ * @brief Build the PWM sequence of the ID, Manchester coded: 1 is modulated then not, 0 the reverse.
+ *        The sequence is turned to start in the middle of the first half of the last bit, the stop bit 0,
+ *        which is not modulated: the LPCOMP samples the field there at each start of the sequence.
+ */
+static void em410x_pwm_sequence_build(void) {
+    const uint16_t start = (LF_125KHZ_EM410X_BIT_SIZE - 1) * 2 * LF_EM410X_PWM_PERIODS_PER_HALF + 1;
+    for (uint16_t i = 0; i < LF_EM410X_PWM_SEQ_LENGTH; i++) {
+        uint16_t period = (start + i) % LF_EM410X_PWM_SEQ_LENGTH;
+        uint8_t bit = period / (2 * LF_EM410X_PWM_PERIODS_PER_HALF);
+        bool first_half = (period / LF_EM410X_PWM_PERIODS_PER_HALF) % 2 == 0;
+        bool mod = GETBIT(m_id_bit_data, bit) ? first_half : !first_half;
+        m_id_pwm_values[i] = mod ? LF_MOD_PWM_ON(LF_EM410X_PWM_TOP) : LF_MOD_PWM_OFF;
+    }
+}
+
+/**
+ * @brief Field check while broadcasting, the only interrupt of the EM410X emulation
+ */
 void timer_ce_handler(nrf_timer_event_t event_type, void *p_context) {
-    bool mod;
-    switch (event_type) {
-        // Because we are configured using the CC channel 2, the event recovers
-        // Detect nrf_timer_event_compare0 event in the function
-        case NRF_TIMER_EVENT_COMPARE2: {
-            if (m_is_send_first_edge) {
-                if (GETBIT(m_id_bit_data, m_bit_send_position)) {
-                    // The first edge of the send 1
-                    ANT_TO_MOD();
-                    mod = true;
-                } else {
-                    // The first edge of the send 0
-                    ANT_NO_MOD();
-                    mod = false;
-                }
-                m_is_send_first_edge = false;   //The second edge is sent next time
-            } else {
-                if (GETBIT(m_id_bit_data, m_bit_send_position)) {
-                    // Send the second edge of 1
-                    ANT_NO_MOD();
-                    mod = false;
-                } else {
-                    //The second edge of the send 0
-                    ANT_TO_MOD();
-                    mod = true;
-                }
-                m_is_send_first_edge = true;    //The first edge of the next sends next time
-            }
-
-            // measure field only during no-mod half of last bit of last broadcast
-            if ((! mod) &&
-                    (m_bit_send_position + 1 >= LF_125KHZ_EM410X_BIT_SIZE) &&
-                    (m_send_id_count + 1 >= LF_125KHZ_BROADCAST_MAX)) {
-                nrfx_timer_disable(&m_timer_send_id);                       // Close the timer of the broadcast venue
-                // We don't need any events, but only need to detect the state of the field
-                NRF_LPCOMP->INTENCLR = LPCOMP_INTENCLR_CROSS_Msk | LPCOMP_INTENCLR_UP_Msk | LPCOMP_INTENCLR_DOWN_Msk | LPCOMP_INTENCLR_READY_Msk;
-                if (lf_is_field_exists()) {
-                    nrf_drv_lpcomp_disable();
-                    nrfx_timer_enable(&m_timer_send_id);                    // Open the timer of the broadcaster and continue to simulate
-                } else {
-                    // Open the incident interruption, so that the next event can be in and out normally
-                    g_is_tag_emulating = false;                             // Reset the flag in the simulation
-                    m_is_lf_emulating = false;
-                    TAG_FIELD_LED_OFF()                                     // Make sure the indicator light of the LF field status
-                    NRF_LPCOMP->INTENSET = LPCOMP_INTENCLR_CROSS_Msk | LPCOMP_INTENCLR_UP_Msk | LPCOMP_INTENCLR_DOWN_Msk | LPCOMP_INTENCLR_READY_Msk;
-                    // call sleep_timer_start *after* unsetting g_is_tag_emulating
-                    sleep_timer_start(SLEEP_DELAY_MS_FIELD_125KHZ_LOST);    // Start the timer to enter the sleep
-                    NRF_LOG_INFO("LF FIELD LOST");
-                }
-            }
-
-            if (m_is_send_first_edge == true) { // The first edge of the next sends next time
-                if (++m_bit_send_position >= LF_125KHZ_EM410X_BIT_SIZE) {
-                    m_bit_send_position = 0;    // The broadcast is successful once, and the BIT position is zero
-                    if(!lf_is_field_exists()){  // To avoid stopping sending when the reader field is present
-                        m_send_id_count++;
-                    }
-                    if (m_send_id_count >= LF_125KHZ_BROADCAST_MAX) {
-                        m_send_id_count = 0;                                        //The number of broadcasts reaches the upper limit, re -identifies the status of the field and re -statistically count the number of broadcast times
-                    }
-                }
-            }
-            break;
-        }
-        default: {
-            // Nothing to do.
-            break;
-        }
+    // Because we are configured using the CC channel 2, the event recovers
+    // Detect nrf_timer_event_compare2 event in the function
+    if (event_type != NRF_TIMER_EVENT_COMPARE2 || lf_tag_modulation_field_exists()) {
+        return;
     }
+    nrfx_timer_disable(&m_timer_send_id);                       // Close the timer of the broadcast venue
+    lf_tag_modulation_stop();
+    // Open the incident interruption, so that the next event can be in and out normally
+    g_is_tag_emulating = false;                                 // Reset the flag in the simulation
+    m_is_lf_emulating = false;
+    TAG_FIELD_LED_OFF()                                         // Make sure the indicator light of the LF field status
+    // The comparator kept running while broadcasting, drop its events so that the old ones don't fire at once
+    nrf_lpcomp_event_clear(NRF_LPCOMP_EVENT_READY);
+    nrf_lpcomp_event_clear(NRF_LPCOMP_EVENT_DOWN);
+    nrf_lpcomp_event_clear(NRF_LPCOMP_EVENT_UP);
+    nrf_lpcomp_event_clear(NRF_LPCOMP_EVENT_CROSS);
+    NRF_LPCOMP->INTENSET = LPCOMP_INTENCLR_CROSS_Msk | LPCOMP_INTENCLR_UP_Msk | LPCOMP_INTENCLR_DOWN_Msk | LPCOMP_INTENCLR_READY_Msk;
+    // call sleep_timer_start *after* unsetting g_is_tag_emulating
+    sleep_timer_start(SLEEP_DELAY_MS_FIELD_125KHZ_LOST);        // Start the timer to enter the sleep
+    NRF_LOG_INFO("LF FIELD LOST");
 }
 
 /**
@@ -291,8 +271,8 @@ static void lpcomp_event_handler(nrf_lpcomp_event_t event) {
     if (!m_is_lf_emulating && event == NRF_LPCOMP_EVENT_UP) {
         // Turn off dormant delay
         sleep_timer_stop();
-        // Close the comparator
-        nrf_drv_lpcomp_disable();
+        // The comparator keeps running for the samples of the field taken by the PWM, without any interrupt
+        NRF_LPCOMP->INTENCLR = LPCOMP_INTENCLR_CROSS_Msk | LPCOMP_INTENCLR_UP_Msk | LPCOMP_INTENCLR_DOWN_Msk | LPCOMP_INTENCLR_READY_Msk;
 
         // Set the simulation status logo bit
         m_is_lf_emulating = true;
@@ -305,12 +285,8 @@ static void lpcomp_event_handler(nrf_lpcomp_event_t event) {
         set_slot_light_color(RGB_BLUE);
         TAG_FIELD_LED_ON()
 
-        //In any case, every time the state finds changes, you need to reset the BIT location of the sending
-        m_send_id_count = 0;
-        m_bit_send_position = 0;
-        m_is_send_first_edge = true;
-
-        // openThePreciseHardwareTimerToTheBroadcastCardNumber
+        // The PWM broadcasts the card number from the sequence built at load, the CPU only wakes up for the field checks
+        lf_tag_modulation_start(NRF_PWM_CLK_125kHz, LF_EM410X_PWM_TOP, &m_id_pwm_seq, &m_id_pwm_seq, NRF_PWM_EVENT_SEQSTARTED0);
         nrfx_timer_enable(&m_timer_send_id);
 
         NRF_LOG_INFO("LF FIELD DETECTED");
@@ -329,11 +305,13 @@ static void lf_sense_enable(void) {
     err_code = nrf_drv_lpcomp_init(&config, lpcomp_event_handler);
     APP_ERROR_CHECK(err_code);
 
-    // TAG id broadcast
+    // Field checks while the TAG id is broadcast
     nrfx_timer_config_t timer_cfg = NRFX_TIMER_DEFAULT_CONFIG;
+    timer_cfg.frequency = NRF_TIMER_FREQ_31250Hz;
+    timer_cfg.bit_width = NRF_TIMER_BIT_WIDTH_32;
     err_code = nrfx_timer_init(&m_timer_send_id, &timer_cfg, timer_ce_handler);
     APP_ERROR_CHECK(err_code);
-    nrfx_timer_extended_compare(&m_timer_send_id, NRF_TIMER_CC_CHANNEL2, nrfx_timer_us_to_ticks(&m_timer_send_id, LF_125KHZ_EM410X_BIT_CLOCK), NRF_TIMER_SHORT_COMPARE2_CLEAR_MASK, true);
+    nrfx_timer_extended_compare(&m_timer_send_id, NRF_TIMER_CC_CHANNEL2, nrfx_timer_us_to_ticks(&m_timer_send_id, LF_EM410X_FIELD_CHECK_US), NRF_TIMER_SHORT_COMPARE2_CLEAR_MASK, true);
 
     if (lf_is_field_exists() && !m_is_lf_emulating) {
         lpcomp_event_handler(NRF_LPCOMP_EVENT_UP);
@@ -341,6 +319,7 @@ static void lf_sense_enable(void) {
 }
 
 static void lf_sense_disable(void) {
+    lf_tag_modulation_stop();               //stopTheBroadcastOfThePwm
     nrfx_timer_uninit(&m_timer_send_id);    //counterInitializationTimer
     nrfx_lpcomp_uninit();                   //antiInitializationComparator
     m_is_lf_emulating = false;              //setAsNonSimulatedState
@@ -385,6 +364,7 @@ int lf_tag_em410x_data_loadcb(tag_specific_type_t type, tag_data_buffer_t *buffe
         // The ID card number is directly converted here as the corresponding BIT data stream
         m_tag_type = type;
         m_id_bit_data = em410x_id_to_memory64(buffer->buffer);
+        em410x_pwm_sequence_build();
         NRF_LOG_INFO("LF Em410x data load finish.");
     } else {
         NRF_LOG_ERROR("LF_EM410X_TAG_ID_SIZE too big.");
@@ -417,10 +397,8 @@ bool lf_tag_em410x_data_factory(uint8_t slot, tag_specific_type_t tag_type) {
     uint8_t tag_id[5] = { 0xDE, 0xAD, 0xBE, 0xEF, 0x88 };
     // Write the data in Flash
     tag_sense_type_t sense_type = get_sense_type_from_tag_type(tag_type);
-    fds_slot_record_map_t map_info; // Get the special card slot FDS record information
-    get_fds_map_by_slot_sense_type_for_dump(slot, sense_type, &map_info);
     //Call the blocked FDS to write the function, and write the data of the specified field type of the card slot into the Flash
-    bool ret = fds_write_sync(map_info.id, map_info.key, sizeof(tag_id), (uint8_t *)tag_id);
+    bool ret = tag_dump_write_sync(slot, sense_type, tag_id, sizeof(tag_id), TAG_DUMP_CHUNK_MASK_ALL, NULL);
     if (ret) {
         NRF_LOG_INFO("Factory slot data success.");
     } else {
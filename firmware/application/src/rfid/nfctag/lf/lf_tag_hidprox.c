@@ -8,8 +8,8 @@
 #include "hw_connect.h"
 #include "syssleep.h"
 #include "lf_tag_em.h"
+#include "lf_tag_modulation.h"
 
-#include "nrf_drv_timer.h"
 #include "nrf_drv_lpcomp.h"
 #include "nrf_gpio.h"
 
@@ -19,11 +19,30 @@
 #include "nrf_log_default_backends.h"
 NRF_LOG_MODULE_REGISTER();
 
+// PWM periods of a half bit at 1MHz, the frame is followed by the first periods of the pause, where the field is sampled
+#define HID_PROX_PWM_TOP            HID_PROX_MANCHESTER_HALF_PERIOD_US
+#define HID_PROX_PWM_SETTLE         4
+#define HID_PROX_PWM_DATA_LENGTH    (HID_PROX_TOTAL_BITS * 2 + HID_PROX_PWM_SETTLE)
+#define HID_PROX_PWM_GAP_PERIODS    (HID_PROX_TRANSMISSION_INTERVAL_MS * 1000 / HID_PROX_MANCHESTER_HALF_PERIOD_US)
+
 // Static data for current HID Prox tag
 static lf_tag_hidprox_info_t m_tag_info = {0};
 
-// Timer for HID Prox transmission timing
-static const nrfx_timer_t m_timer_hidprox = NRFX_TIMER_INSTANCE(3);
+// Modulation played by the PWM: the frame, then the rest of the pause as one value repeated
+static nrf_pwm_values_common_t m_pwm_data_values[HID_PROX_PWM_DATA_LENGTH];
+static nrf_pwm_values_common_t m_pwm_gap_value = LF_MOD_PWM_OFF;
+static nrf_pwm_sequence_t const m_pwm_data_seq = {
+    .values.p_common = m_pwm_data_values,
+    .length          = HID_PROX_PWM_DATA_LENGTH,
+    .repeats         = 0,
+    .end_delay       = 0
+};
+static nrf_pwm_sequence_t const m_pwm_gap_seq = {
+    .values.p_common = &m_pwm_gap_value,
+    .length          = 1,
+    .repeats         = HID_PROX_PWM_GAP_PERIODS - HID_PROX_PWM_SETTLE - 1,
+    .end_delay       = 0
+};
 
 // Field detection state
 static volatile bool m_is_lf_emulating = false;
@@ -35,9 +54,7 @@ extern bool g_usb_led_marquee_enable;
 
 // Function prototypes
 static void hidprox_encode_manchester(void);
-static void hidprox_timer_handler(nrf_timer_event_t event_type, void* p_context);
 static void hidprox_field_handler(nrf_lpcomp_event_t event);
-static void hidprox_modulation_control(bool enable);
 
 /**
  * Load HID Prox tag data from buffer
@@ -112,22 +129,6 @@ void lf_tag_hidprox_simulation_init(void) {
     // Prepare Manchester encoded data for transmission
     hidprox_encode_manchester();
     
-    // Initialize timer for bit transmission
-    nrfx_timer_config_t timer_cfg = NRFX_TIMER_DEFAULT_CONFIG;
-    timer_cfg.frequency = NRF_TIMER_FREQ_16MHz;
-    timer_cfg.mode = NRF_TIMER_MODE_TIMER;
-    timer_cfg.bit_width = NRF_TIMER_BIT_WIDTH_32;
-    
-    err_code = nrfx_timer_init(&m_timer_hidprox, &timer_cfg, hidprox_timer_handler);
-    APP_ERROR_CHECK(err_code);
-    
-    // Set timer to trigger every half-bit period (32 microseconds)
-    nrfx_timer_extended_compare(&m_timer_hidprox, 
-                               NRF_TIMER_CC_CHANNEL2, 
-                               nrfx_timer_us_to_ticks(&m_timer_hidprox, HID_PROX_MANCHESTER_HALF_PERIOD_US),
-                               NRF_TIMER_SHORT_COMPARE2_CLEAR_MASK, 
-                               true);
-    
     // Configure field detection using LPCOMP
     nrf_drv_lpcomp_config_t lpcomp_config = NRF_DRV_LPCOMP_DEFAULT_CONFIG;
     lpcomp_config.hal.reference = NRF_LPCOMP_REF_SUPPLY_1_16;
@@ -137,11 +138,11 @@ void lf_tag_hidprox_simulation_init(void) {
     
     err_code = nrf_drv_lpcomp_init(&lpcomp_config, hidprox_field_handler);
     APP_ERROR_CHECK(err_code);
+    // Running from now on, for the field handler and then for the samples taken by the PWM
+    nrf_drv_lpcomp_enable();
     
     // Initialize state variables
     m_tag_info.emulation_enabled = true;
-    m_tag_info.transmission_bit_position = 0;
-    m_tag_info.transmission_phase = 0;
     m_tag_info.transmission_active = false;
     m_is_lf_emulating = false;
     m_field_detected = false;
@@ -153,8 +154,8 @@ void lf_tag_hidprox_simulation_init(void) {
  * Deinitialize HID Prox simulation
  */
 void lf_tag_hidprox_simulation_deinit(void) {
-    // Stop timer
-    nrfx_timer_uninit(&m_timer_hidprox);
+    // Stop the PWM
+    lf_tag_modulation_stop();
     
     // Deinitialize LPCOMP
     nrf_drv_lpcomp_uninit();
@@ -182,21 +183,24 @@ void lf_tag_hidprox_simulation_process(void) {
         return;
     }
     
-    // Check if field is still present
-    if (m_is_lf_emulating && !lf_is_field_exists()) {
+    // Check if field is still present, as last sampled during the pause
+    if (m_is_lf_emulating && !lf_tag_modulation_field_exists()) {
         // Field lost - stop emulation
         g_is_tag_emulating = false;
         m_is_lf_emulating = false;
         m_field_detected = false;
         m_tag_info.transmission_active = false;
         
-        nrfx_timer_disable(&m_timer_hidprox);
-        hidprox_modulation_control(false);
+        lf_tag_modulation_stop();
         
         TAG_FIELD_LED_OFF();
         
-        // Re-enable LPCOMP for field detection
-        nrf_drv_lpcomp_enable();
+        // Re-enable LPCOMP interrupts for field detection, without the events of the samples taken while emulating
+        nrf_lpcomp_event_clear(NRF_LPCOMP_EVENT_READY);
+        nrf_lpcomp_event_clear(NRF_LPCOMP_EVENT_DOWN);
+        nrf_lpcomp_event_clear(NRF_LPCOMP_EVENT_UP);
+        nrf_lpcomp_event_clear(NRF_LPCOMP_EVENT_CROSS);
+        NRF_LPCOMP->INTENSET = LPCOMP_INTENSET_UP_Msk;
         
         // Start sleep timer
         sleep_timer_start(SLEEP_DELAY_MS_FIELD_125KHZ_LOST);
@@ -251,68 +255,18 @@ static void hidprox_encode_manchester(void) {
         m_tag_info.transmission_buffer[bit_pos++] = (wiegand_data >> i) & 1;
     }
     
-    NRF_LOG_INFO("HID Prox Manchester encoded: %d bits, wiegand: 0x%08X", 
-                 bit_pos, wiegand_data);
-}
-
-/**
- * FSK modulation control for HID Prox transmission
- */
-static void hidprox_modulation_control(bool enable) {
-    if (enable) {
-        // Enable FSK modulation (pull LF_MOD high)
-        nrf_gpio_pin_set(LF_MOD);
-    } else {
-        // Disable FSK modulation (pull LF_MOD low)
-        nrf_gpio_pin_clear(LF_MOD);
+    // Manchester encoding: 1 = high-to-low, 0 = low-to-high, high being modulated
+    for (int i = 0; i < HID_PROX_TOTAL_BITS; i++) {
+        bool bit = m_tag_info.transmission_buffer[i];
+        m_pwm_data_values[i * 2] = bit ? LF_MOD_PWM_ON(HID_PROX_PWM_TOP) : LF_MOD_PWM_OFF;
+        m_pwm_data_values[i * 2 + 1] = bit ? LF_MOD_PWM_OFF : LF_MOD_PWM_ON(HID_PROX_PWM_TOP);
     }
-}
-
-/**
- * Timer handler for HID Prox bit transmission
- */
-static void hidprox_timer_handler(nrf_timer_event_t event_type, void* p_context) {
-    if (event_type == NRF_TIMER_EVENT_COMPARE2) {
-        if (!m_is_lf_emulating || !m_tag_info.transmission_active) {
-            return;
-        }
-        
-        // Get current bit to transmit
-        uint8_t current_bit = m_tag_info.transmission_buffer[m_tag_info.transmission_bit_position];
-        
-        // Manchester encoding: 1 = high-to-low, 0 = low-to-high
-        if (m_tag_info.transmission_phase == 0) {
-            // First half of bit period
-            if (current_bit == 1) {
-                hidprox_modulation_control(true);   // High for first half of '1'
-            } else {
-                hidprox_modulation_control(false);  // Low for first half of '0'
-            }
-            m_tag_info.transmission_phase = 1;
-        } else {
-            // Second half of bit period
-            if (current_bit == 1) {
-                hidprox_modulation_control(false);  // Low for second half of '1'
-            } else {
-                hidprox_modulation_control(true);   // High for second half of '0'
-            }
-            m_tag_info.transmission_phase = 0;
-            m_tag_info.transmission_bit_position++;
-            
-            // Check if we've transmitted all bits
-            if (m_tag_info.transmission_bit_position >= HID_PROX_TOTAL_BITS) {
-                m_tag_info.transmission_bit_position = 0;
-                m_tag_info.transmission_active = false;
-                hidprox_modulation_control(false);  // Turn off modulation
-                
-                // Schedule next transmission
-                bsp_delay_ms(HID_PROX_TRANSMISSION_INTERVAL_MS);
-                if (m_is_lf_emulating) {
-                    m_tag_info.transmission_active = true;
-                }
-            }
-        }
+    for (int i = HID_PROX_TOTAL_BITS * 2; i < HID_PROX_PWM_DATA_LENGTH; i++) {
+        m_pwm_data_values[i] = LF_MOD_PWM_OFF;
     }
+    
+    NRF_LOG_INFO("HID Prox Manchester encoded: %d bits, wiegand: 0x%08X", 
+                 bit_pos, wiegand_data);
 }
 
 /**
@@ -322,7 +276,8 @@ static void hidprox_field_handler(nrf_lpcomp_event_t event) {
     if (!m_is_lf_emulating && event == NRF_LPCOMP_EVENT_UP) {
         // Field detected - start emulation
         sleep_timer_stop();
-        nrf_drv_lpcomp_disable();
+        // LPCOMP keeps running without interrupts, the PWM has it sample the field
+        NRF_LPCOMP->INTENCLR = LPCOMP_INTENCLR_UP_Msk;
         
         m_is_lf_emulating = true;
         g_is_tag_emulating = true;
@@ -335,13 +290,9 @@ static void hidprox_field_handler(nrf_lpcomp_event_t event) {
         set_slot_light_color(RGB_CYAN);
         TAG_FIELD_LED_ON();
         
-        // Reset transmission state
-        m_tag_info.transmission_bit_position = 0;
-        m_tag_info.transmission_phase = 0;
+        // The PWM plays the frame and the pause in a loop from the sequence built by hidprox_encode_manchester
         m_tag_info.transmission_active = true;
-        
-        // Enable timer for transmission
-        nrfx_timer_enable(&m_timer_hidprox);
+        lf_tag_modulation_start(NRF_PWM_CLK_1MHz, HID_PROX_PWM_TOP, &m_pwm_data_seq, &m_pwm_gap_seq, NRF_PWM_EVENT_SEQSTARTED1);
         
         NRF_LOG_INFO("HID Prox field detected - starting emulation");
     }
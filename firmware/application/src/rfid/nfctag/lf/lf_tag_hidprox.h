@@ -23,9 +23,7 @@ typedef struct {
     hid_prox_card_data_t card_data;
     uint8_t emulation_enabled;
     uint8_t transmission_buffer[HID_PROX_TOTAL_BITS];  // Buffer for Manchester encoded transmission
-    uint8_t transmission_bit_position;                  // Current bit position in transmission
-    uint8_t transmission_phase;                         // Manchester phase (0 = first half, 1 = second half)
-    uint8_t transmission_active;                        // Whether transmission is currently active
+    uint8_t transmission_active;                        // Whether the PWM is playing the transmission
 } lf_tag_hidprox_info_t;
 
 // Function prototypes
@@ -0,0 +1,94 @@
+#include "lf_tag_modulation.h"
+#include "rfid_main.h"
+
+#include "nrf_gpio.h"
+#include "nrf_drv_pwm.h"
+#include "nrf_drv_ppi.h"
+#include "nrf_lpcomp.h"
+
+#define NRF_LOG_MODULE_NAME lf_tag_modulation
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+#include "nrf_log_default_backends.h"
+NRF_LOG_MODULE_REGISTER();
+
+
+// PWM0 drives the antenna of the LF reader and PWM1 the RGB, the emulated LF tag is played on PWM2
+static nrf_drv_pwm_t m_pwm_mod = NRF_DRV_PWM_INSTANCE(2);
+// Links the sample event of the sequences to the LPCOMP SAMPLE task
+static nrf_ppi_channel_t m_ppi_field_sample;
+static bool m_is_playing = false;
+
+
+/**
+ * @brief Play the modulation of a LF tag on LF_MOD until lf_tag_modulation_stop.
+ *        The PWM reads the sequences from RAM with its EasyDMA and loops on them with its shorts,
+ *        one value per PWM period, there is no interrupt while playing.
+ *        At sample_event the PPI makes the running LPCOMP sample the field, it has to be in a period
+ *        without modulation, the antenna is shorted otherwise.
+ * @param clock         PWM clock
+ * @param top           PWM period in ticks of the clock
+ * @param seq0          played first, the values have to stay in RAM while playing
+ * @param seq1          played after seq0, then seq0 again, can be seq0
+ * @param sample_event  PWM event at which the field is sampled
+ */
+void lf_tag_modulation_start(nrf_pwm_clk_t clock, uint16_t top,
+                             nrf_pwm_sequence_t const *seq0, nrf_pwm_sequence_t const *seq1,
+                             nrf_pwm_event_t sample_event) {
+    ret_code_t err_code;
+
+    if (m_is_playing) {
+        lf_tag_modulation_stop();
+    }
+
+    nrfx_pwm_config_t config = NRFX_PWM_DEFAULT_CONFIG;
+    config.output_pins[0] = LF_MOD;
+    for (uint8_t i = 1; i < NRF_PWM_CHANNEL_COUNT; i++) {
+        config.output_pins[i] = NRFX_PWM_PIN_NOT_USED;
+    }
+    config.base_clock = clock;
+    config.count_mode = NRF_PWM_MODE_UP;
+    config.top_value = top;
+    config.load_mode = NRF_PWM_LOAD_COMMON;
+    config.step_mode = NRF_PWM_STEP_AUTO;
+    // No handler, so the PWM interrupt stays disabled
+    err_code = nrfx_pwm_init(&m_pwm_mod, &config, NULL);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_field_sample);
+    APP_ERROR_CHECK(err_code);
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_field_sample,
+                                          nrfx_pwm_event_address_get(&m_pwm_mod, sample_event),
+                                          (uint32_t)nrf_lpcomp_task_address_get(NRF_LPCOMP_TASK_SAMPLE));
+    APP_ERROR_CHECK(err_code);
+    err_code = nrf_drv_ppi_channel_enable(m_ppi_field_sample);
+    APP_ERROR_CHECK(err_code);
+
+    // The antenna is not shorted yet, RESULT is valid before the first sample of the PPI
+    nrf_lpcomp_task_trigger(NRF_LPCOMP_TASK_SAMPLE);
+    nrfx_pwm_complex_playback(&m_pwm_mod, seq0, seq1, 1, NRFX_PWM_FLAG_LOOP);
+    m_is_playing = true;
+}
+
+/**
+ * @brief Stop the modulation, LF_MOD is left low so that the field can be sensed again
+ */
+void lf_tag_modulation_stop(void) {
+    if (!m_is_playing) {
+        return;
+    }
+    m_is_playing = false;
+    nrf_drv_ppi_channel_disable(m_ppi_field_sample);
+    nrf_drv_ppi_channel_free(m_ppi_field_sample);
+    // At most one period to wait
+    nrfx_pwm_stop(&m_pwm_mod, true);
+    nrfx_pwm_uninit(&m_pwm_mod);
+    nrf_gpio_pin_clear(LF_MOD);
+}
+
+/**
+ * @brief Field at the last sample taken by the PPI while playing, the LPCOMP has to be running
+ */
+bool lf_tag_modulation_field_exists(void) {
+    return nrf_lpcomp_result_get() == 1;
+}
@@ -0,0 +1,24 @@
+#ifndef __LF_TAG_MODULATION_H
+#define __LF_TAG_MODULATION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "nrf_pwm.h"
+
+
+/**
+ * Values of a PWM period that hold LF_MOD for the whole period.
+ * With bit 15 set the output starts the period high and falls at the compare value.
+ */
+#define LF_MOD_PWM_ON(top)  (0x8000 | (top))
+#define LF_MOD_PWM_OFF      (0x8000 | 0)
+
+
+void lf_tag_modulation_start(nrf_pwm_clk_t clock, uint16_t top,
+                             nrf_pwm_sequence_t const *seq0, nrf_pwm_sequence_t const *seq1,
+                             nrf_pwm_event_t sample_event);
+void lf_tag_modulation_stop(void);
+bool lf_tag_modulation_field_exists(void);
+
+#endif
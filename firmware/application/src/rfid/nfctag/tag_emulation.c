@@ -9,6 +9,7 @@
 #include "tag_emulation.h"
 #include "tag_persistence.h"
 #include "rgb_marquee.h"
+#include "app_util_platform.h"
 
 
 #define NRF_LOG_MODULE_NAME tag_emu
@@ -54,12 +55,42 @@ bool is_tag_specific_type_valid(tag_specific_type_t tag_type) {
  * The label data exists in the information in Flash, and the total length must be aligned by 4 bytes (whole words)!IntersectionIntersection
  */
 static uint8_t m_tag_data_buffer_lf[12];      // Low -frequency card data buffer
-static uint16_t m_tag_data_lf_crc;
-static tag_data_buffer_t m_tag_data_lf = { sizeof(m_tag_data_buffer_lf), m_tag_data_buffer_lf, &m_tag_data_lf_crc };
+static uint16_t m_tag_data_lf_crc[TAG_DUMP_CHUNK_COUNT(sizeof(m_tag_data_buffer_lf))];
+static tag_data_buffer_t m_tag_data_lf_buffer = { sizeof(m_tag_data_buffer_lf), m_tag_data_buffer_lf, m_tag_data_lf_crc, 0, 0, { 0, false } };
+static tag_data_buffer_t *m_tag_data_lf = &m_tag_data_lf_buffer;
 
-static uint8_t m_tag_data_buffer_hf[4500];    // High -frequency card data buffer
-static uint16_t m_tag_data_hf_crc;
-static tag_data_buffer_t m_tag_data_hf = { sizeof(m_tag_data_buffer_hf), m_tag_data_buffer_hf, &m_tag_data_hf_crc };
+/**
+ * High -frequency card data buffers, a cache of the data of the recently used slots.
+ * Switching to a cached slot only changes m_tag_data_hf, the data of the slot left stays in RAM
+ * and is written to flash when its entry is evicted or on tag_emulation_save.
+ */
+#ifndef TAG_SLOT_CACHE_SIZE
+#define TAG_SLOT_CACHE_SIZE     4
+#endif
+#define TAG_DATA_HF_SIZE        4500
+#define TAG_SLOT_CACHE_FREE     0xFF
+
+typedef struct {
+    tag_data_buffer_t data;
+    uint16_t crc[TAG_DUMP_CHUNK_COUNT(TAG_DATA_HF_SIZE)];
+    uint8_t slot;                   // TAG_SLOT_CACHE_FREE when the entry holds no data
+    tag_specific_type_t tag_type;
+    uint16_t parked_length;         // Data length given by the savecb when the slot was left, 0 while in use
+    uint32_t last_used;
+} tag_slot_cache_entry_t;
+
+static uint8_t m_tag_data_buffer_hf[TAG_SLOT_CACHE_SIZE][TAG_DATA_HF_SIZE];
+static tag_slot_cache_entry_t m_slot_cache[TAG_SLOT_CACHE_SIZE];
+static uint8_t m_slot_cache_active;    // Entry of m_tag_data_hf
+static uint32_t m_slot_cache_tick;
+static tag_data_buffer_t *m_tag_data_hf = &m_slot_cache[0].data;
+
+// The dirty mask of a buffer has one bit per chunk
+STATIC_ASSERT(TAG_DUMP_CHUNK_COUNT(TAG_DATA_HF_SIZE) <= 32);
+STATIC_ASSERT(TAG_SLOT_CACHE_SIZE >= 2);
+
+// Statistics of the card data saves
+static tag_save_stats_t m_tag_save_stats;
 
 /**
  * Eight card slots, each card slot has its own unique configuration
@@ -83,6 +114,9 @@ static tag_slot_config_t slotConfig ALIGN_U32 = {
 };
 // The card slot configuration unique CRC, once the slot configuration changes, can be checked by CRC
 static uint16_t m_slot_config_crc;
+// The copy of the card slot configuration the queued write reads from, slotConfig can change again meanwhile
+static tag_slot_config_t m_slot_config_queued ALIGN_U32;
+static volatile bool m_slot_config_write_queued;
 
 // ********************** Specific parameter ends **********************
 
@@ -117,6 +151,7 @@ static tag_base_handler_map_t tag_base_map[] = {
 
 static void tag_emulation_load_config(void);
 static void tag_emulation_save_config(void);
+static void save_buffer_by_sense_type(uint8_t slot, tag_sense_type_t sense_type, tag_data_buffer_t *buffer, int data_byte_length);
 
 /**
  * accordingToTheSpecifiedDetailedLabelType,ObtainTheImplementationFunctionOfTheDataThatProcessesTheLoadedLoaded
@@ -172,7 +207,7 @@ tag_sense_type_t get_sense_type_from_tag_type(tag_specific_type_t type) {
 tag_data_buffer_t *get_buffer_by_tag_type(tag_specific_type_t type) {
     for (int i = 0; i < ARRAY_SIZE(tag_base_map); i++) {
         if (tag_base_map[i].tag_type == type) {
-            return tag_base_map[i].data_buffer;
+            return *tag_base_map[i].data_buffer;
         }
     }
     return NULL;
@@ -192,13 +227,166 @@ bool tag_emulation_load_by_buffer(tag_specific_type_t tag_type, bool update_crc)
     tag_data_buffer_t *buffer = get_buffer_by_tag_type(tag_type);
     int length = fn_loadcb(tag_type, buffer);
     if (length > 0 && update_crc) {
-        // afterReadingIsCompleted,WeCanSaveACrcOfTheCurrentDataWhenItIsStoredLater,ItCanBeUsedAsAReferenceForChangesComparison
-        calc_14a_crc_lut(buffer->buffer, length, (uint8_t *)buffer->crc);
+        // afterReadingIsCompleted,WeCanSaveACrcOfEachChunkOfTheCurrentData,WhenItIsStoredLaterOnlyTheChunksThatChangedAreWritten
+        for (uint16_t chunk = 0; chunk < TAG_DUMP_CHUNK_COUNT(length); chunk++) {
+            uint16_t offset = chunk * TAG_DUMP_CHUNK_SIZE;
+            calc_14a_crc_lut(buffer->buffer + offset, MIN(length - offset, TAG_DUMP_CHUNK_SIZE), (uint8_t *)&buffer->crc[chunk]);
+        }
+        buffer->dirty = 0;
         return true;
     }
     return false;
 }
 
+/**
+ * Mark the chunks of the card data that contain data..data+length as modified.
+ * The emulators call this on every write of a block or page, so that the next save
+ * writes these chunks without comparing them.
+ */
+void tag_emulation_mark_dirty(const void *data, uint16_t length) {
+    tag_data_buffer_t *buffers[] = { m_tag_data_hf, m_tag_data_lf };
+    const uint8_t *p_data = data;
+    for (int i = 0; i < ARRAY_SIZE(buffers); i++) {
+        tag_data_buffer_t *buffer = buffers[i];
+        if (length == 0 || p_data < buffer->buffer || p_data + length > buffer->buffer + buffer->length) {
+            continue;
+        }
+        uint16_t offset = p_data - buffer->buffer;
+        for (uint16_t chunk = offset / TAG_DUMP_CHUNK_SIZE; chunk <= (offset + length - 1) / TAG_DUMP_CHUNK_SIZE; chunk++) {
+            buffer->dirty |= 1UL << chunk;
+        }
+        return;
+    }
+}
+
+/**
+ * Get the statistics of the card data saves since power on
+ */
+void tag_emulation_get_save_stats(tag_save_stats_t *stats) {
+    *stats = m_tag_save_stats;
+}
+
+/**
+ * Set up the entries of the slot cache, all of them free
+ */
+static void tag_slot_cache_init(void) {
+    for (int i = 0; i < TAG_SLOT_CACHE_SIZE; i++) {
+        tag_slot_cache_entry_t *entry = &m_slot_cache[i];
+        entry->data.length = TAG_DATA_HF_SIZE;
+        entry->data.buffer = m_tag_data_buffer_hf[i];
+        entry->data.crc = entry->crc;
+        entry->slot = TAG_SLOT_CACHE_FREE;
+        entry->parked_length = 0;
+    }
+    m_slot_cache_active = 0;
+    m_tag_data_hf = &m_slot_cache[0].data;
+}
+
+/**
+ * Leave the slot in use, its savecb is called as for a save so that the shadow modes work as before:
+ * the data is kept for a later write back, or dropped and read from flash next time.
+ */
+static void tag_slot_cache_park_active(void) {
+    tag_slot_cache_entry_t *entry = &m_slot_cache[m_slot_cache_active];
+    if (entry->slot == TAG_SLOT_CACHE_FREE || entry->parked_length != 0) {
+        return;
+    }
+    tag_datas_savecb_t fn_savecb = get_data_savecb_from_tag_type(entry->tag_type);
+    int length = (fn_savecb != NULL) ? fn_savecb(entry->tag_type, &entry->data) : 0;
+    if (length <= 0 || length > entry->data.length) {
+        NRF_LOG_INFO("Slot %d data not cached.", entry->slot);
+        entry->slot = TAG_SLOT_CACHE_FREE;
+        return;
+    }
+    entry->parked_length = length;
+}
+
+/**
+ * Write the changes of a parked entry to flash, the entry stays in the cache
+ */
+static void tag_slot_cache_write_back(tag_slot_cache_entry_t *entry) {
+    if (entry->slot != TAG_SLOT_CACHE_FREE && entry->parked_length != 0) {
+        save_buffer_by_sense_type(entry->slot, TAG_SENSE_HF, &entry->data, entry->parked_length);
+    }
+}
+
+/**
+ * Drop the cached data of a slot, for when its data in flash is replaced or deleted
+ */
+static void tag_slot_cache_invalidate(uint8_t slot) {
+    for (int i = 0; i < TAG_SLOT_CACHE_SIZE; i++) {
+        if (m_slot_cache[i].slot == slot) {
+            m_slot_cache[i].slot = TAG_SLOT_CACHE_FREE;
+            m_slot_cache[i].parked_length = 0;
+        }
+    }
+}
+
+/**
+ * Take a free entry, or else the least recently used one after writing it back
+ */
+static tag_slot_cache_entry_t *tag_slot_cache_evict(void) {
+    tag_slot_cache_entry_t *victim = &m_slot_cache[0];
+    for (int i = 1; i < TAG_SLOT_CACHE_SIZE && victim->slot != TAG_SLOT_CACHE_FREE; i++) {
+        tag_slot_cache_entry_t *candidate = &m_slot_cache[i];
+        if (candidate->slot == TAG_SLOT_CACHE_FREE || candidate->last_used < victim->last_used) {
+            victim = candidate;
+        }
+    }
+    if (victim->slot != TAG_SLOT_CACHE_FREE) {
+        NRF_LOG_INFO("Slot %d data evicted from cache.", victim->slot);
+        tag_slot_cache_write_back(victim);
+    }
+    return victim;
+}
+
+/**
+ * Point m_tag_data_hf at the cache entry of a slot. Returns true if the slot was cached,
+ * otherwise a free or the least recently used entry is taken, written back first, and has to be read from flash.
+ */
+static bool tag_slot_cache_acquire(uint8_t slot, tag_specific_type_t tag_type) {
+    tag_slot_cache_park_active();
+    tag_slot_cache_entry_t *entry = NULL;
+    for (int i = 0; i < TAG_SLOT_CACHE_SIZE; i++) {
+        if (m_slot_cache[i].slot == slot && m_slot_cache[i].tag_type == tag_type) {
+            entry = &m_slot_cache[i];
+            break;
+        }
+    }
+    bool hit = (entry != NULL);
+    if (!hit) {
+        entry = tag_slot_cache_evict();
+        entry->slot = slot;
+        entry->tag_type = tag_type;
+        entry->data.dirty = 0;
+        entry->data.flash_length = 0;
+    }
+    entry->parked_length = 0;
+    entry->last_used = ++m_slot_cache_tick;
+    m_slot_cache_active = entry - m_slot_cache;
+    m_tag_data_hf = &entry->data;
+    return hit;
+}
+
+/**
+ * Point m_tag_data_hf and the HF emulators at a free entry, for a slot without HF data or whose data could not be read.
+ * The host commands can still write the HF data, the writes must not reach the entry of a parked slot.
+ */
+static void tag_slot_cache_use_scratch(void) {
+    tag_slot_cache_park_active();
+    tag_slot_cache_entry_t *entry = tag_slot_cache_evict();
+    entry->slot = TAG_SLOT_CACHE_FREE;     // Never written back
+    entry->parked_length = 0;
+    entry->data.dirty = 0;
+    entry->data.flash_length = 0;
+    entry->data.flash_layout = (tag_dump_layout_t) { 0, false };
+    m_slot_cache_active = entry - m_slot_cache;
+    m_tag_data_hf = &entry->data;
+    // Both emulators keep a pointer to the data they loaded last, the largest types fit in the entry
+    nfc_tag_mf1_data_loadcb(TAG_TYPE_MIFARE_4096, m_tag_data_hf);
+    nfc_tag_mf0_ntag_data_loadcb(TAG_TYPE_NTAG_216, m_tag_data_hf);
+}
+
 /**
  * loadTheDataAccordingToTheType
  */
@@ -214,22 +402,49 @@ static void load_data_by_tag_type(uint8_t slot, tag_specific_type_t tag_type) {
         return;
     }
     tag_sense_type_t sense_type = get_sense_type_from_tag_type(tag_type);
-    // getTheSpecialCardSlotFdsRecordInformation
-    fds_slot_record_map_t map_info;
-    get_fds_map_by_slot_sense_type_for_dump(slot, sense_type, &map_info);
+    if (sense_type == TAG_SENSE_HF) {
+        // The data of a cached slot is newer than the flash, only the emulation has to be pointed at it
+        if (tag_slot_cache_acquire(slot, tag_type)) {
+            tag_emulation_load_by_buffer(tag_type, false);
+            NRF_LOG_INFO("Load tag slot %d, type %d data from cache.", slot, tag_type);
+            return;
+        }
+        buffer = m_tag_data_hf;
+    }
     // accordingToTheTypeOfTheCardSlotCurrentlyActivated,LoadTheDataOfTheDesignatedFieldToTheBuffer //Tip:IfTheLengthOfTheDataCannotMatchTheLengthOfTheBuffer,ItMayBeCausedByTheFirmwareUpdateAtThisTime,TheDataMustBeDeletedAndRebuilt
     uint16_t length = buffer->length;
-    bool ret = fds_read_sync(map_info.id, map_info.key, &length, buffer->buffer);
+    bool ret = tag_dump_read_sync(slot, sense_type, buffer->buffer, &length, &buffer->flash_layout);
     if (false == ret) {
+        buffer->flash_length = 0;
+        if (sense_type == TAG_SENSE_HF) {
+            // A save of the slot writes the scratch entry, it has to know what is in flash
+            tag_dump_layout_t layout = buffer->flash_layout;
+            m_slot_cache[m_slot_cache_active].slot = TAG_SLOT_CACHE_FREE;
+            tag_slot_cache_use_scratch();
+            m_tag_data_hf->flash_layout = layout;
+        }
         NRF_LOG_INFO("Tag slot data no exists.");
         return;
     }
+    buffer->flash_length = length;
     ret = tag_emulation_load_by_buffer(tag_type, true);
     if (ret) {
         NRF_LOG_INFO("Load tag slot %d, type %d data done.", slot, tag_type);
     }
 }
 
+/**
+ * A queued chunk write of the card data is done, a failed chunk is written again on the next save
+ */
+static void tag_data_chunk_write_done(uint16_t id, uint16_t key, bool success, void *ctx) {
+    if (!success) {
+        tag_data_buffer_t *buffer = ctx;
+        CRITICAL_REGION_ENTER();
+        buffer->dirty |= 1UL << FDS_SLOT_TAG_DUMP_CHUNK_INDEX(key);
+        CRITICAL_REGION_EXIT();
+    }
+}
+
 /**
  * Save data according to the type
  */
@@ -262,26 +477,61 @@ static void save_data_by_tag_type(uint8_t slot, tag_specific_type_t tag_type) {
         NRF_LOG_ERROR("Tag data save length overflow.", tag_type);
         return;
     }
-    uint16_t crc;
-    calc_14a_crc_lut(buffer->buffer, data_byte_length, (uint8_t *)&crc);
+    save_buffer_by_sense_type(slot, get_sense_type_from_tag_type(tag_type), buffer, data_byte_length);
+}
+
+/**
+ * Write the chunks of a data buffer that changed since it was loaded or saved
+ */
+static void save_buffer_by_sense_type(uint8_t slot, tag_sense_type_t sense_type, tag_data_buffer_t *buffer, int data_byte_length) {
+    // The chunks written by the emulation are saved as they are, the others are compared by CRC
+    // because the data can also be changed by commands of the host
+    uint32_t dirty;
+    CRITICAL_REGION_ENTER();
+    dirty = buffer->dirty;
+    buffer->dirty = 0;
+    CRITICAL_REGION_EXIT();
+    uint16_t chunk_count = TAG_DUMP_CHUNK_COUNT(data_byte_length);
+    uint16_t crc[32];
+    uint32_t chunk_mask = 0;
+    for (uint16_t chunk = 0; chunk < chunk_count; chunk++) {
+        uint16_t offset = chunk * TAG_DUMP_CHUNK_SIZE;
+        calc_14a_crc_lut(buffer->buffer + offset, MIN(data_byte_length - offset, TAG_DUMP_CHUNK_SIZE), (uint8_t *)&crc[chunk]);
+        if ((dirty & (1UL << chunk)) || crc[chunk] != buffer->crc[chunk]) {
+            chunk_mask |= 1UL << chunk;
+        }
+    }
+    // The data may be longer than in flash, e.g. after a change to a larger tag type
+    if (data_byte_length > buffer->flash_length) {
+        chunk_mask |= TAG_DUMP_CHUNK_MASK_ALL << (buffer->flash_length / TAG_DUMP_CHUNK_SIZE);
+        chunk_mask &= TAG_DUMP_CHUNK_MASK_ALL >> (32 - chunk_count);
+    } else if (data_byte_length < buffer->flash_length) {
+        // or shorter, the last chunk is written again and the chunks after it are deleted
+        chunk_mask |= 1UL << (chunk_count - 1);
+    }
+    m_tag_save_stats.chunk_count += chunk_count;
     // Determine whether the data has changed
-    if (crc == *buffer->crc) {
+    if (chunk_mask == 0) {
         NRF_LOG_INFO("Tag slot data no change, length = %d", data_byte_length);
         return;
     }
-    tag_sense_type_t sense_type = get_sense_type_from_tag_type(tag_type);
-    // Get the special card slot FDS record information
-    fds_slot_record_map_t map_info;
-    get_fds_map_by_slot_sense_type_for_dump(slot, sense_type, &map_info);
-    // Call the blocked FDS to write the function, and write the data of the specified field type of the card slot into the Flash
-    bool ret = fds_write_sync(map_info.id, map_info.key, data_byte_length, buffer->buffer);
+    // Queue the writes of the changed chunks of the card slot data, the main loop goes on while they are written into the Flash
+    uint16_t written = 0;
+    bool ret = tag_dump_write_async(slot, sense_type, buffer->buffer, data_byte_length, chunk_mask, &written, &buffer->flash_layout,
+                                    tag_data_chunk_write_done, buffer);
     if (ret) {
-        NRF_LOG_INFO("Save tag slot data success.");
+        NRF_LOG_INFO("Save tag slot data queued, %d bytes, %d of %d chunks changed.", written, __builtin_popcount(chunk_mask), chunk_count);
+        buffer->flash_length = data_byte_length;
     } else {
         NRF_LOG_ERROR("Save tag slot data error.");
+        // Write everything again on the next save
+        buffer->dirty |= chunk_mask;
     }
+    m_tag_save_stats.bytes_last += written;
+    m_tag_save_stats.bytes_total += written;
+    m_tag_save_stats.chunks_last += __builtin_popcount(chunk_mask);
     //After the preservation is completed, the CRC of the BUFFER in the corresponding memory
-    *buffer->crc = crc;
+    memcpy(buffer->crc, crc, chunk_count * sizeof(uint16_t));
 }
 
 /**
@@ -291,9 +541,7 @@ static void delete_data_by_tag_type(uint8_t slot, tag_sense_type_t sense_type) {
     if (sense_type == TAG_SENSE_NO) {
         return;
     }
-    fds_slot_record_map_t map_info;
-    get_fds_map_by_slot_sense_type_for_dump(slot, sense_type, &map_info);
-    int count = fds_delete_sync(map_info.id, map_info.key);
+    int count = tag_dump_delete_sync(slot, sense_type);
     NRF_LOG_INFO("Slot %d delete sense type %d data, record count: %d", slot, sense_type, count);
 }
 
@@ -303,6 +551,9 @@ static void delete_data_by_tag_type(uint8_t slot, tag_sense_type_t sense_type) {
  */
 void tag_emulation_load_data(void) {
     uint8_t slot = tag_emulation_get_slot();
+    if (slotConfig.slots[slot].tag_hf == TAG_TYPE_UNDEFINED) {
+        tag_slot_cache_use_scratch();
+    }
     load_data_by_tag_type(slot, slotConfig.slots[slot].tag_hf);
     load_data_by_tag_type(slot, slotConfig.slots[slot].tag_lf);
 }
@@ -312,8 +563,16 @@ void tag_emulation_load_data(void) {
  */
 void tag_emulation_save_data(void) {
     uint8_t slot = tag_emulation_get_slot();
+    m_tag_save_stats.saves++;
+    m_tag_save_stats.bytes_last = 0;
+    m_tag_save_stats.chunks_last = 0;
+    m_tag_save_stats.chunk_count = 0;
     save_data_by_tag_type(slot, slotConfig.slots[slot].tag_hf);
     save_data_by_tag_type(slot, slotConfig.slots[slot].tag_lf);
+    // The slots left since are still in the cache
+    for (int i = 0; i < TAG_SLOT_CACHE_SIZE; i++) {
+        tag_slot_cache_write_back(&m_slot_cache[i]);
+    }
 }
 
 /**
@@ -332,6 +591,9 @@ void tag_emulation_get_specific_types_by_slot(uint8_t slot, tag_slot_specific_ty
  */
 void tag_emulation_delete_data(uint8_t slot, tag_sense_type_t sense_type) {
     // delete data
+    if (sense_type == TAG_SENSE_HF) {
+        tag_slot_cache_invalidate(slot);
+    }
     delete_data_by_tag_type(slot, sense_type);
     //Close the corresponding card type of the corresponding card slot
     switch (sense_type) {
@@ -360,6 +622,10 @@ void tag_emulation_delete_data(uint8_t slot, tag_sense_type_t sense_type) {
 bool tag_emulation_factory_data(uint8_t slot, tag_specific_type_t tag_type) {
     tag_datas_factory_t factory = get_data_factory_from_tag_type(tag_type);
     if (factory != NULL) {
+        // The cached data of the slot would be written back over the new one
+        if (get_sense_type_from_tag_type(tag_type) == TAG_SENSE_HF) {
+            tag_slot_cache_invalidate(slot);
+        }
         // The process of implementing the data formatting data!
         if (factory(slot, tag_type)) {
             // If the current data card slot number currently set is the current activated card slot, then we need to update to the memory
@@ -503,6 +769,19 @@ static void tag_emulation_load_config(void) {
     }
 }
 
+/**
+ * The queued write of the card slot configuration is done, ctx is the CRC of the configuration written
+ */
+static void tag_emulation_save_config_done(uint16_t id, uint16_t key, bool success, void *ctx) {
+    m_slot_config_write_queued = false;
+    if (success) {
+        NRF_LOG_INFO("Save tag slot config success.");
+        m_slot_config_crc = (uint16_t)(uintptr_t)ctx;
+    } else {
+        NRF_LOG_ERROR("Save tag slot config error.");
+    }
+}
+
 /**
  *Save the emulated card configuration data
  */
@@ -512,13 +791,14 @@ static void tag_emulation_save_config(void) {
     calc_14a_crc_lut((uint8_t *)&slotConfig, sizeof(slotConfig), (uint8_t *)&new_calc_crc);
     if (new_calc_crc != m_slot_config_crc) {    // Before saving, make sure that the card slot configuration has changed
         NRF_LOG_INFO("Save tag slot config start.");
-        bool ret = fds_write_sync(FDS_EMULATION_CONFIG_FILE_ID, FDS_EMULATION_CONFIG_RECORD_KEY, sizeof(slotConfig), (uint8_t *)&slotConfig);
-        if (ret) {
-            NRF_LOG_INFO("Save tag slot config success.");
-            m_slot_config_crc = new_calc_crc;
-        } else {
-            NRF_LOG_ERROR("Save tag slot config error.");
+        // The copy must not change before the previous write of it is done
+        if (m_slot_config_write_queued) {
+            fds_flush_sync();
         }
+        memcpy(&m_slot_config_queued, &slotConfig, sizeof(slotConfig));
+        m_slot_config_write_queued = true;
+        fds_write_async(FDS_EMULATION_CONFIG_FILE_ID, FDS_EMULATION_CONFIG_RECORD_KEY, sizeof(m_slot_config_queued), (uint8_t *)&m_slot_config_queued,
+                        tag_emulation_save_config_done, (void *)(uintptr_t)new_calc_crc);
     } else {
         NRF_LOG_INFO("Tag slot config no change.");
     }
@@ -544,6 +824,7 @@ void tag_emulation_sense_end(void) {
  *Initialized label simulation
  */
 void tag_emulation_init(void) {
+    tag_slot_cache_init();          // All the HF buffers are free
     tag_emulation_load_config();    // Configuration of loading the card slot of the simulation card
     tag_emulation_load_data();      // Load the data of the emulated card
 }
@@ -579,7 +860,9 @@ void tag_emulation_change_slot(uint8_t index, bool sense_disable) {
         // Turn off the analog card to avoid triggering the simulation when switching the card slot
         tag_emulation_sense_end();
     }
-    tag_emulation_save_data();      // Save the data of the current card, if there is a change, if there is a change
+    uint8_t slot_now = tag_emulation_get_slot();
+    save_data_by_tag_type(slot_now, slotConfig.slots[slot_now].tag_lf);    // Save the LF data of the current card, if there is a change
+    tag_slot_cache_park_active();   // The HF data stays in the slot cache until it is evicted or saved
     g_is_tag_emulating = false;     // Reset the logo position
     tag_emulation_set_slot(index);  // Update the index of the activated card slot
     tag_emulation_load_data();      // Then reload the data of the card slot
@@ -673,14 +956,16 @@ void tag_emulation_change_type(uint8_t slot, tag_specific_type_t tag_type) {
         }
         case TAG_SENSE_HF: {
             slotConfig.slots[slot].tag_hf = tag_type;
+            // The data cached for the previous type is not written back
+            tag_slot_cache_invalidate(slot);
             break;
         }
         default:
             break; //Never happen
     }
     NRF_LOG_INFO("tag type = %d", tag_type);
-    //After the update is completed, we need to notify the relevant data in the update of the memory
-    if (sense_type != TAG_SENSE_NO) {
+    //After the update is completed, we need to notify the relevant data in the update of the memory, only the active slot is in use
+    if (sense_type != TAG_SENSE_NO && slot == tag_emulation_get_slot()) {
         load_data_by_tag_type(slot, tag_type);
         NRF_LOG_INFO("reload data success.");
     }
@@ -691,37 +976,31 @@ void tag_emulation_change_type(uint8_t slot, tag_specific_type_t tag_type) {
  * Some data that can be used to initialize the default factory factory
  */
 void tag_emulation_factory_init(void) {
-    fds_slot_record_map_t map_info;
-
     // Initialized a dual -frequency card in the card slot, if there is no historical record, it is a new state of factory.
     if (slotConfig.slots[0].enabled_hf && slotConfig.slots[0].tag_hf == TAG_TYPE_MIFARE_1024) {
         // Initialize a high -frequency M1 card in the card slot 1, if it does not exist.
-        get_fds_map_by_slot_sense_type_for_dump(0, TAG_SENSE_HF, &map_info);
-        if (!fds_is_exists(map_info.id, map_info.key)) {
+        if (!tag_dump_is_exists(0, TAG_SENSE_HF)) {
             tag_emulation_factory_data(0, slotConfig.slots[0].tag_hf);
         }
     }
 
     if (slotConfig.slots[0].enabled_lf && slotConfig.slots[0].tag_lf == TAG_TYPE_EM410X) {
         // Initialize a low -frequency EM410X card in slot 1, if it does not exist.
-        get_fds_map_by_slot_sense_type_for_dump(0, TAG_SENSE_LF, &map_info);
-        if (!fds_is_exists(map_info.id, map_info.key)) {
+        if (!tag_dump_is_exists(0, TAG_SENSE_LF)) {
             tag_emulation_factory_data(0, slotConfig.slots[0].tag_lf);
         }
     }
 
     if (slotConfig.slots[1].enabled_hf && slotConfig.slots[1].tag_hf == TAG_TYPE_MF0ICU1) {
         // Initialize a high -frequency M1 card in the card slot 2, if it does not exist.
-        get_fds_map_by_slot_sense_type_for_dump(1, TAG_SENSE_HF, &map_info);
-        if (!fds_is_exists(map_info.id, map_info.key)) {
+        if (!tag_dump_is_exists(1, TAG_SENSE_HF)) {
             tag_emulation_factory_data(1, slotConfig.slots[1].tag_hf);
         }
     }
 
     if (slotConfig.slots[2].enabled_lf && slotConfig.slots[2].tag_lf == TAG_TYPE_EM410X) {
         // Initialize a low -frequency EM410X card in slot 3, if it does not exist.
-        get_fds_map_by_slot_sense_type_for_dump(2, TAG_SENSE_LF, &map_info);
-        if (!fds_is_exists(map_info.id, map_info.key)) {
+        if (!tag_dump_is_exists(2, TAG_SENSE_LF)) {
             tag_emulation_factory_data(2, slotConfig.slots[2].tag_lf);
         }
     }
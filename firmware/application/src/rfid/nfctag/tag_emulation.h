@@ -7,6 +7,7 @@
 #include "app_util.h"
 #include "utils.h"
 #include "tag_base_type.h"
+#include "tag_persistence.h"
 
 //Up to eight card slots
 #define TAG_MAX_SLOT_NUM    8
@@ -17,9 +18,21 @@ extern bool g_is_tag_emulating;
 typedef struct {
     uint16_t length;
     uint8_t *buffer;
-    uint16_t *crc;
+    uint16_t *crc;              // CRC of each chunk of the buffer as it is in flash
+    volatile uint32_t dirty;    // Chunks written by the emulation since the last save, bit n for chunk n
+    uint16_t flash_length;      // Length of the data in flash, the chunks after it do not exist yet
+    tag_dump_layout_t flash_layout;     // How the data is stored, set when it is read and kept by the saves
 } tag_data_buffer_t;
 
+// Statistics of the card data saves since power on
+typedef struct {
+    uint32_t saves;         // Number of saves
+    uint32_t bytes_total;   // Bytes written to flash by all saves
+    uint16_t bytes_last;    // Bytes written to flash by the last save
+    uint8_t chunks_last;    // Chunks written by the last save
+    uint8_t chunk_count;    // Chunks of the data of the last save
+} tag_save_stats_t;
+
 //Farming impact enable and closed energy switching function
 typedef void (*tag_sense_switch_t)(bool enable);
 // Flash data is notified to the registrar after loading to RAM
@@ -36,7 +49,7 @@ typedef struct {
     tag_datas_loadcb_t   data_on_load;
     tag_datas_savecb_t   data_on_save;
     tag_datas_factory_t  data_factory;
-    tag_data_buffer_t    *data_buffer;
+    tag_data_buffer_t    **data_buffer;     // The HF buffer changes with the slot, see the slot cache
 } tag_base_handler_map_t;
 
 /**
@@ -92,6 +105,10 @@ bool tag_emulation_factory_data(uint8_t slot, tag_specific_type_t tag_type);
 void tag_emulation_change_type(uint8_t slot, tag_specific_type_t tag_type);
 //Load the data from the memory to the simulation card buffer
 bool tag_emulation_load_by_buffer(tag_specific_type_t tag_type, bool update_crc);
+// Mark the chunks of the card data covering data..data+length as modified, called by the emulation on writes
+void tag_emulation_mark_dirty(const void *data, uint16_t length);
+// Get the statistics of the card data saves
+void tag_emulation_get_save_stats(tag_save_stats_t *stats);
 
 tag_sense_type_t get_sense_type_from_tag_type(tag_specific_type_t type);
 tag_data_buffer_t *get_buffer_by_tag_type(tag_specific_type_t type);
@@ -1,5 +1,10 @@
+#include <string.h>
+
 #include "tag_persistence.h"
 #include "fds_ids.h"
+#include "fds_util.h"
+#include "pack_utils.h"
+#include "nrf.h"
 
 #define NRF_LOG_MODULE_NAME tag_persistence
 #include "nrf_log.h"
@@ -8,6 +13,38 @@
 NRF_LOG_MODULE_REGISTER();
 
 
+// Encoding of the data of a chunk record
+#define TAG_DUMP_CHUNK_RAW          0
+#define TAG_DUMP_CHUNK_PACKED       1
+// Packed chunk records of queued writes, a write waits for one of them to be in flash when all are queued
+#define TAG_DUMP_PACK_POOL_SIZE     8
+
+
+// Header of a chunk record, followed by the data of the chunk as given by encoding
+typedef struct {
+    uint8_t encoding;
+    uint8_t padding;    // bytes after the data up to the end of the last word of the record
+    uint16_t length;    // length of the chunk data once unpacked
+} tag_dump_chunk_header_t;
+
+// A chunk record as written to flash, FDS wants it word aligned
+typedef struct {
+    tag_dump_chunk_header_t header;
+    uint8_t data[TAG_DUMP_CHUNK_SIZE];
+} tag_dump_chunk_record_t;
+
+// A chunk record of a queued write and the done callback of its owner
+typedef struct {
+    tag_dump_chunk_record_t record;
+    fds_write_done_cb_t done;
+    void *ctx;
+    volatile bool busy;
+} tag_dump_pack_slot_t;
+
+
+static tag_dump_chunk_record_t m_chunk_record __ALIGN(4);
+static tag_dump_pack_slot_t m_pack_pool[TAG_DUMP_PACK_POOL_SIZE] __ALIGN(4);
+
 
 static void get_fds_map_by_slot_auto_inc_id(uint16_t id, uint8_t slot, tag_sense_type_t sense_type, fds_slot_record_map_t *map) {
     if ((sense_type == TAG_SENSE_NO) || (slot > 7)) {
@@ -30,3 +67,244 @@ void get_fds_map_by_slot_sense_type_for_dump(uint8_t slot, tag_sense_type_t sens
 void get_fds_map_by_slot_sense_type_for_nick(uint8_t slot, tag_sense_type_t sense_type, fds_slot_record_map_t *map) {
     get_fds_map_by_slot_auto_inc_id(FDS_SLOT_TAG_NICK_NAME_FILE_ID_BASE, slot, sense_type, map);
 }
+
+/**
+ * Pack a chunk of a card dump into a chunk record, it keeps the chunk as it is if packing does not make it smaller.
+ * Returns the length of the record.
+ */
+static uint16_t tag_dump_chunk_pack(const uint8_t *data, uint16_t length, tag_dump_chunk_record_t *record) {
+    uint16_t data_length = pack_encode(data, length, record->data, length - 1);
+    if (data_length > 0) {
+        record->header.encoding = TAG_DUMP_CHUNK_PACKED;
+    } else {
+        record->header.encoding = TAG_DUMP_CHUNK_RAW;
+        memcpy(record->data, data, length);
+        data_length = length;
+    }
+    record->header.padding = (4 - data_length % 4) % 4;
+    record->header.length = length;
+    return sizeof(tag_dump_chunk_header_t) + data_length;
+}
+
+/**
+ * Unpack a chunk record read from flash into data, record_length is the length in words read by FDS.
+ * Returns the length of the chunk or -1 if the record is not valid.
+ */
+static int tag_dump_chunk_unpack(const tag_dump_chunk_record_t *record, uint16_t record_length, uint8_t *data, uint16_t size) {
+    if (record_length < sizeof(tag_dump_chunk_header_t) + record->header.padding || record->header.length > size) {
+        return -1;
+    }
+    uint16_t data_length = record_length - sizeof(tag_dump_chunk_header_t) - record->header.padding;
+    switch (record->header.encoding) {
+        case TAG_DUMP_CHUNK_RAW:
+            if (record->header.length != data_length) {
+                return -1;
+            }
+            memcpy(data, record->data, data_length);
+            return data_length;
+        case TAG_DUMP_CHUNK_PACKED: {
+            int length = pack_decode(record->data, data_length, data, record->header.length);
+            return length == record->header.length ? length : -1;
+        }
+        default:
+            return -1;
+    }
+}
+
+/**
+ * Read the card dump of a card slot. The chunk records are read in order until one is missing or
+ * shorter than a chunk; a dump in the older single record layout is read as a whole.
+ * The record of the older layout left by a queued conversion to chunks is deleted here.
+ */
+bool tag_dump_read_sync(uint8_t slot, tag_sense_type_t sense_type, uint8_t *buffer, uint16_t *length, tag_dump_layout_t *layout) {
+    fds_slot_record_map_t map_info;
+    get_fds_map_by_slot_sense_type_for_dump(slot, sense_type, &map_info);
+    tag_dump_layout_t found = { 0, false };
+    uint16_t size = *length;
+    uint16_t offset = 0;
+    bool ret = true;
+    for (uint16_t chunk = 0; chunk < TAG_DUMP_CHUNK_MAX && offset < size; chunk++) {
+        uint16_t record_length = sizeof(m_chunk_record);
+        if (!fds_read_sync(map_info.id, FDS_SLOT_TAG_DUMP_CHUNK_KEY(sense_type, chunk), &record_length, (uint8_t *)&m_chunk_record)) {
+            break;
+        }
+        int chunk_length = tag_dump_chunk_unpack(&m_chunk_record, record_length, buffer + offset, size - offset);
+        if (chunk_length < 0) {
+            NRF_LOG_ERROR("Slot %d sense type %d chunk %d not valid.", slot, sense_type, chunk);
+            // The chunks after it may be there, the next write deletes all it can
+            found.chunk_count = TAG_DUMP_CHUNK_MAX;
+            ret = false;
+            break;
+        }
+        offset += chunk_length;
+        found.chunk_count = chunk + 1;
+        if (chunk_length < TAG_DUMP_CHUNK_SIZE) {
+            break;
+        }
+    }
+    if (ret && offset > 0) {
+        *length = offset;
+        if (fds_is_exists(map_info.id, map_info.key)) {
+            fds_delete_sync(map_info.id, map_info.key);
+        }
+    } else if (ret) {
+        // no chunk found, maybe the dump was saved by an older firmware
+        ret = fds_read_sync(map_info.id, map_info.key, length, buffer);
+        found.legacy = ret;
+    }
+    if (layout != NULL) {
+        *layout = found;
+    }
+    return ret;
+}
+
+/**
+ * Delete the chunk records of a card dump from first_chunk on, returns the number of records deleted
+ */
+static int tag_dump_delete_chunks(uint16_t id, tag_sense_type_t sense_type, uint16_t first_chunk) {
+    int count = 0;
+    for (uint16_t chunk = first_chunk; chunk <= UINT8_MAX; chunk++) {
+        int deleted = fds_delete_sync(id, FDS_SLOT_TAG_DUMP_CHUNK_KEY(sense_type, chunk));
+        if (deleted == 0) {
+            break;
+        }
+        count += deleted;
+    }
+    return count;
+}
+
+/**
+ * Write the chunks of a card dump selected in chunk_mask (bit n for chunk n).
+ * Chunks beyond the end of the dump are deleted, a dump in the older single record layout
+ * is written in full and its record is deleted afterwards.
+ */
+bool tag_dump_write_sync(uint8_t slot, tag_sense_type_t sense_type, uint8_t *buffer, uint16_t length, uint32_t chunk_mask, uint16_t *written) {
+    fds_slot_record_map_t map_info;
+    get_fds_map_by_slot_sense_type_for_dump(slot, sense_type, &map_info);
+    uint16_t chunk_count = TAG_DUMP_CHUNK_COUNT(length);
+    if (chunk_count > TAG_DUMP_CHUNK_MAX) {
+        NRF_LOG_ERROR("Tag dump too large for chunk mask, length = %d", length);
+        return false;
+    }
+    bool legacy = fds_is_exists(map_info.id, map_info.key);
+    if (legacy) {
+        chunk_mask = TAG_DUMP_CHUNK_MASK_ALL;
+    }
+    bool ret = true;
+    for (uint16_t chunk = 0; chunk < chunk_count; chunk++) {
+        if ((chunk_mask & (1UL << chunk)) == 0) {
+            continue;
+        }
+        uint16_t offset = chunk * TAG_DUMP_CHUNK_SIZE;
+        uint16_t chunk_length = MIN(length - offset, TAG_DUMP_CHUNK_SIZE);
+        uint16_t record_length = tag_dump_chunk_pack(buffer + offset, chunk_length, &m_chunk_record);
+        if (!fds_write_sync(map_info.id, FDS_SLOT_TAG_DUMP_CHUNK_KEY(sense_type, chunk), record_length, &m_chunk_record)) {
+            ret = false;
+            continue;
+        }
+        if (written != NULL) {
+            *written += record_length;
+        }
+    }
+    if (!ret) {
+        return false;
+    }
+    // the dump may have been longer before, e.g. when the tag type changed
+    tag_dump_delete_chunks(map_info.id, sense_type, chunk_count);
+    if (legacy) {
+        fds_delete_sync(map_info.id, map_info.key);
+        NRF_LOG_INFO("Slot %d sense type %d dump converted to %d chunks.", slot, sense_type, chunk_count);
+    }
+    return true;
+}
+
+/**
+ * Take a free chunk record for a queued write, the records are packed at once so the buffer
+ * of the card dump can be changed again while they wait.
+ */
+static tag_dump_pack_slot_t *tag_dump_pack_slot_get(void) {
+    while (true) {
+        for (uint8_t i = 0; i < TAG_DUMP_PACK_POOL_SIZE; i++) {
+            if (!m_pack_pool[i].busy) {
+                m_pack_pool[i].busy = true;
+                return &m_pack_pool[i];
+            }
+        }
+        // all of them are waiting in the FDS queue, the first is given back from the FDS event handler
+        __NOP();
+    }
+}
+
+/**
+ * A queued chunk record is in flash, give its record back and tell its owner
+ */
+static void tag_dump_pack_write_done(uint16_t id, uint16_t key, bool success, void *ctx) {
+    tag_dump_pack_slot_t *pack = ctx;
+    fds_write_done_cb_t done = pack->done;
+    void *done_ctx = pack->ctx;
+    pack->busy = false;
+    if (done != NULL) {
+        done(id, key, success, done_ctx);
+    }
+}
+
+/**
+ * Queue the writes of the chunks of a card dump selected in chunk_mask, done is called from the FDS
+ * event handler for each chunk. The chunks are packed before this returns, so the buffer can be changed at once.
+ * Nothing here waits for the flash: what is stored is known from layout, the chunks left after the last one
+ * are deleted by queued deletes. A dump of the older layout is written in full, its record is deleted by the next read.
+ */
+bool tag_dump_write_async(uint8_t slot, tag_sense_type_t sense_type, uint8_t *buffer, uint16_t length, uint32_t chunk_mask, uint16_t *written,
+                          tag_dump_layout_t *layout, fds_write_done_cb_t done, void *ctx) {
+    fds_slot_record_map_t map_info;
+    get_fds_map_by_slot_sense_type_for_dump(slot, sense_type, &map_info);
+    uint16_t chunk_count = TAG_DUMP_CHUNK_COUNT(length);
+    if (chunk_count > TAG_DUMP_CHUNK_MAX) {
+        NRF_LOG_ERROR("Tag dump too large for chunk mask, length = %d", length);
+        return false;
+    }
+    if (layout->legacy) {
+        chunk_mask = TAG_DUMP_CHUNK_MASK_ALL;
+    }
+    // stale chunks are not read back once the new last chunk is written, they can go first
+    for (uint16_t chunk = chunk_count; chunk < layout->chunk_count; chunk++) {
+        fds_delete_async(map_info.id, FDS_SLOT_TAG_DUMP_CHUNK_KEY(sense_type, chunk));
+    }
+    layout->chunk_count = chunk_count;
+    for (uint16_t chunk = 0; chunk < chunk_count; chunk++) {
+        if ((chunk_mask & (1UL << chunk)) == 0) {
+            continue;
+        }
+        uint16_t offset = chunk * TAG_DUMP_CHUNK_SIZE;
+        uint16_t chunk_length = MIN(length - offset, TAG_DUMP_CHUNK_SIZE);
+        tag_dump_pack_slot_t *pack = tag_dump_pack_slot_get();
+        uint16_t record_length = tag_dump_chunk_pack(buffer + offset, chunk_length, &pack->record);
+        pack->done = done;
+        pack->ctx = ctx;
+        if (!fds_write_async(map_info.id, FDS_SLOT_TAG_DUMP_CHUNK_KEY(sense_type, chunk), record_length, &pack->record, tag_dump_pack_write_done, pack)) {
+            pack->busy = false;
+            return false;
+        }
+        if (written != NULL) {
+            *written += record_length;
+        }
+    }
+    layout->legacy = false;
+    return true;
+}
+
+bool tag_dump_is_exists(uint8_t slot, tag_sense_type_t sense_type) {
+    fds_slot_record_map_t map_info;
+    get_fds_map_by_slot_sense_type_for_dump(slot, sense_type, &map_info);
+    return fds_is_exists(map_info.id, FDS_SLOT_TAG_DUMP_CHUNK_KEY(sense_type, 0)) || fds_is_exists(map_info.id, map_info.key);
+}
+
+/**
+ * Delete all the records of a card dump, returns the number of records deleted
+ */
+int tag_dump_delete_sync(uint8_t slot, tag_sense_type_t sense_type) {
+    fds_slot_record_map_t map_info;
+    get_fds_map_by_slot_sense_type_for_dump(slot, sense_type, &map_info);
+    int count = fds_delete_sync(map_info.id, map_info.key);
+    return count + tag_dump_delete_chunks(map_info.id, sense_type, 0);
+}
@@ -2,7 +2,23 @@
 #define TAG_PERSISTENCE_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "tag_base_type.h"
+#include "fds_util.h"
+
+
+// Size of one FDS record of a card dump, 16 MF1 blocks
+#define TAG_DUMP_CHUNK_SIZE             256
+#define TAG_DUMP_CHUNK_COUNT(length)    (((length) + TAG_DUMP_CHUNK_SIZE - 1) / TAG_DUMP_CHUNK_SIZE)
+#define TAG_DUMP_CHUNK_MASK_ALL         0xFFFFFFFF
+// Chunks of a dump written at most, one bit each in a chunk mask
+#define TAG_DUMP_CHUNK_MAX              32
+
+// How a card dump is stored in flash, as found by the last read and kept by the queued writes
+typedef struct {
+    uint8_t chunk_count;    // Chunk records
+    bool legacy;            // The dump is one record of the older layout
+} tag_dump_layout_t;
 
 
 typedef struct {
@@ -19,4 +35,22 @@ void get_fds_map_by_slot_sense_type_for_dump(uint8_t slot, tag_sense_type_t sens
  */
 void get_fds_map_by_slot_sense_type_for_nick(uint8_t slot, tag_sense_type_t sense_type, fds_slot_record_map_t *map);
 
+/**
+ * Read the chunked card dump of a card slot into buffer, length is the buffer size and is updated to the length read.
+ * layout, if not NULL, is set to how the dump is stored.
+ */
+bool tag_dump_read_sync(uint8_t slot, tag_sense_type_t sense_type, uint8_t *buffer, uint16_t *length, tag_dump_layout_t *layout);
+/**
+ * Write the chunks of the card dump selected in chunk_mask, written is incremented by the bytes written to flash
+ */
+bool tag_dump_write_sync(uint8_t slot, tag_sense_type_t sense_type, uint8_t *buffer, uint16_t length, uint32_t chunk_mask, uint16_t *written);
+/**
+ * Same as tag_dump_write_sync but the writes are queued, done is called once per chunk when it is in flash.
+ * layout is the one given by the read of the dump and is updated, the flash is not searched.
+ */
+bool tag_dump_write_async(uint8_t slot, tag_sense_type_t sense_type, uint8_t *buffer, uint16_t length, uint32_t chunk_mask, uint16_t *written,
+                          tag_dump_layout_t *layout, fds_write_done_cb_t done, void *ctx);
+bool tag_dump_is_exists(uint8_t slot, tag_sense_type_t sense_type);
+int tag_dump_delete_sync(uint8_t slot, tag_sense_type_t sense_type);
+
 #endif
@@ -0,0 +1,154 @@
+#include <string.h>
+
+#include "mf0_toolbox.h"
+#include "app_status.h"
+#include "nordic_common.h"
+
+#define NRF_LOG_MODULE_NAME mf0_toolbox
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+#include "nrf_log_default_backends.h"
+NRF_LOG_MODULE_REGISTER();
+
+
+// tag information used for this module.
+static picc_14a_tag_t m_tag_info;
+
+
+/**
+* @brief    : Send a command with CRC and check the CRC of the answer
+* @param    :cmd: command without CRC
+*            answer_len: expected length of the answer without CRC
+* @retval   : STATUS_HF_TAG_OK if the tag answered answer_len bytes, a NAK is an error
+*/
+static uint8_t mf0_transceive(uint8_t *cmd, uint8_t cmd_len, uint8_t *answer, uint8_t answer_len) {
+    uint8_t buffer[DEF_FIFO_LENGTH];
+    uint8_t crc[DEF_CRC_LENGTH];
+    uint16_t len = 0;
+    uint8_t status;
+
+    memcpy(buffer, cmd, cmd_len);
+    crc_14a_append(buffer, cmd_len);
+    status = pcd_14a_reader_bytes_transfer(PCD_TRANSCEIVE, buffer, cmd_len + DEF_CRC_LENGTH, buffer, &len, U8ARR_BIT_LEN(buffer));
+    if (status != STATUS_HF_TAG_OK) {
+        return status;
+    }
+    // A NAK is only 4 bits
+    if (len != (answer_len + DEF_CRC_LENGTH) * 8) {
+        return STATUS_HF_ERR_STAT;
+    }
+    crc_14a_calculate(buffer, answer_len, crc);
+    if (memcmp(crc, buffer + answer_len, DEF_CRC_LENGTH) != 0) {
+        return STATUS_HF_ERR_CRC;
+    }
+    memcpy(answer, buffer, answer_len);
+    return STATUS_HF_TAG_OK;
+}
+
+static uint8_t mf0_pwd_auth(uint8_t *pwd, uint8_t *pack) {
+    uint8_t cmd[5] = { MF0_CMD_PWD_AUTH };
+    memcpy(cmd + 1, pwd, 4);
+    if (mf0_transceive(cmd, sizeof(cmd), pack, 2) != STATUS_HF_TAG_OK) {
+        return STATUS_MF_ERR_AUTH;
+    }
+    return STATUS_HF_TAG_OK;
+}
+
+/**
+* @brief    : Wake up the tag again after it went idle on a NAK, the password is sent again if any
+*/
+static uint8_t mf0_reselect(uint8_t *pwd) {
+    uint8_t pack[2];
+    if (pcd_14a_reader_fast_select(&m_tag_info) != STATUS_HF_TAG_OK) {
+        return STATUS_HF_TAG_NO;
+    }
+    if (pwd != NULL) {
+        return mf0_pwd_auth(pwd, pack);
+    }
+    return STATUS_HF_TAG_OK;
+}
+
+/**
+* @brief    : Dump the pages of an Ultralight / NTAG after one select.
+*             GET_VERSION and READ_SIG are asked first, the tags answering GET_VERSION are read
+*             with FAST_READ, the others with READ. The dump stops at the first page the tag refuses,
+*             which is the end of the memory or a protected page.
+* @param    :pwd: password for PWD_AUTH, NULL to read without
+*            first_page: first page
+*            stop: page after the last page, up to 256
+*            info: version, signature and pack, filled before the first page is reported
+*            on_pages: called for every run of pages read
+* @retval   : STATUS_HF_TAG_OK if pages were read
+*/
+uint8_t mf0_toolbox_dump_pages(uint8_t *pwd, uint8_t first_page, uint16_t stop, mf0_toolbox_dump_info_t *info, mf0_toolbox_dump_pages_cb_t on_pages) {
+    uint8_t cmd[3];
+    uint8_t pages[MF0_FAST_READ_PAGES_MAX * 4];
+    uint16_t page = first_page;
+    uint16_t single_until = 0;
+    uint8_t count;
+    uint8_t status;
+    bool fast_read;
+    bool read_any = false;
+
+    memset(info, 0, sizeof(mf0_toolbox_dump_info_t));
+    status = pcd_14a_reader_scan_auto(&m_tag_info);
+    if (status != STATUS_HF_TAG_OK) {
+        return status;
+    }
+
+    // Ultralight and Ultralight C NAK GET_VERSION and go idle
+    cmd[0] = MF0_CMD_GET_VERSION;
+    if (mf0_transceive(cmd, 1, info->version, sizeof(info->version)) == STATUS_HF_TAG_OK) {
+        info->flags |= MF0_DUMP_FLAG_VERSION;
+        cmd[0] = MF0_CMD_READ_SIG;
+        cmd[1] = 0x00;
+        if (mf0_transceive(cmd, 2, info->signature, sizeof(info->signature)) == STATUS_HF_TAG_OK) {
+            info->flags |= MF0_DUMP_FLAG_SIGNATURE;
+        } else if (mf0_reselect(NULL) != STATUS_HF_TAG_OK) {
+            return STATUS_HF_TAG_NO;
+        }
+    } else if (mf0_reselect(NULL) != STATUS_HF_TAG_OK) {
+        return STATUS_HF_TAG_NO;
+    }
+    fast_read = (info->flags & MF0_DUMP_FLAG_VERSION) != 0;
+
+    if (pwd != NULL) {
+        status = mf0_pwd_auth(pwd, info->pack);
+        if (status != STATUS_HF_TAG_OK) {
+            return status;
+        }
+        info->flags |= MF0_DUMP_FLAG_PACK;
+    }
+
+    while (page < stop) {
+        if (fast_read) {
+            // After a refused range the pages are read one by one up to its end, so the dump stops exactly at the first refused page
+            count = MIN(stop - page, page < single_until ? 1 : MF0_FAST_READ_PAGES_MAX);
+            cmd[0] = MF0_CMD_FAST_READ;
+            cmd[1] = page;
+            cmd[2] = page + count - 1;
+            status = mf0_transceive(cmd, 3, pages, count * 4);
+        } else {
+            // READ always answers 4 pages, rolling over at the end of the memory
+            count = MIN(stop - page, 4);
+            cmd[0] = MF0_CMD_READ;
+            cmd[1] = page;
+            status = mf0_transceive(cmd, 2, pages, 16);
+        }
+        if (status != STATUS_HF_TAG_OK) {
+            NRF_LOG_INFO("Page %d refused: %d", page, status);
+            if (status == STATUS_HF_TAG_NO || mf0_reselect(pwd) != STATUS_HF_TAG_OK) {
+                break;
+            }
+            if (fast_read && count > 1) {
+                single_until = page + count;
+                continue;
+            }
+            break;
+        }
+        on_pages(page, pages, count);
+        read_any = true;
+        page += count;
+    }
+    return read_any ? STATUS_HF_TAG_OK : status;
+}
@@ -0,0 +1,49 @@
+#ifndef MF0_TOOLBOX
+#define MF0_TOOLBOX
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <rc522.h>
+#include "netdata.h"
+
+#define MF0_CMD_GET_VERSION     0x60
+#define MF0_CMD_READ            0x30
+#define MF0_CMD_FAST_READ       0x3A
+#define MF0_CMD_READ_SIG        0x3C
+#define MF0_CMD_PWD_AUTH        0x1B
+
+// The answer of FAST_READ has to fit the 522 FIFO together with its CRC
+#define MF0_FAST_READ_PAGES_MAX ((DEF_FIFO_LENGTH - DEF_CRC_LENGTH) / 4)
+
+#define MF0_DUMP_FLAG_VERSION   0x01    // GET_VERSION answered, the tag supports FAST_READ
+#define MF0_DUMP_FLAG_SIGNATURE 0x02    // READ_SIG answered
+#define MF0_DUMP_FLAG_PACK      0x04    // PWD_AUTH succeeded
+
+// this struct is also used in the fw/cli protocol, therefore PACKED
+typedef struct {
+    uint8_t flags;          // MF0_DUMP_FLAG_*
+    uint8_t version[8];
+    uint8_t signature[32];
+    uint8_t pack[2];
+} PACKED mf0_toolbox_dump_info_t;
+
+// page: first page, pages: count * 4 bytes
+typedef void (*mf0_toolbox_dump_pages_cb_t)(uint8_t page, uint8_t *pages, uint8_t count);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint8_t mf0_toolbox_dump_pages(
+    uint8_t *pwd,
+    uint8_t first_page,
+    uint16_t stop,
+    mf0_toolbox_dump_info_t *info,
+    mf0_toolbox_dump_pages_cb_t on_pages
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -558,6 +558,38 @@ uint8_t darkside_recover_key(uint8_t targetBlk, uint8_t targetTyp,
     return STATUS_HF_TAG_OK;
 }
 
+/**
+* @brief    : Collect several darkside parameter sets in one go, every set after the first one is taken
+*             with another reader nonce, as a retry of darkside_recover_key would.
+* @param    :count   : The number of sets to collect
+* @param    :on_core : Called for each set collected
+* @retval   : STATUS_HF_TAG_OK with the status of the darkside run which ended the batch,
+*             a card lost after the first set also ends the batch with the sets collected so far
+*
+*/
+uint8_t darkside_recover_key_batch(uint8_t targetBlk, uint8_t targetTyp,
+                                   uint8_t firstRecover, uint8_t ntSyncMax, uint8_t count,
+                                   mf1_darkside_core_cb_t on_core, mf1_darkside_status_t *darkside_status) {
+    DarksideCore_t dc;
+    uint8_t status;
+
+    for (uint8_t i = 0; i < count; i++) {
+        status = darkside_recover_key(targetBlk, targetTyp, i == 0 ? firstRecover : 0, ntSyncMax, &dc, darkside_status);
+        if (status != STATUS_HF_TAG_OK) {
+            if (i == 0) {
+                return status;
+            }
+            *darkside_status = DARKSIDE_OK;
+            break;
+        }
+        if (*darkside_status != DARKSIDE_OK) {
+            break;
+        }
+        on_core(&dc);
+    }
+    return STATUS_HF_TAG_OK;
+}
+
 /**
 * @brief    : Modify the middle delay of the antenna restart
 *               The longer the delay, the more you can restart certain non -standard cards, the more
@@ -899,6 +931,34 @@ uint8_t nested_recover_key(uint64_t keyKnown, uint8_t blkKnown, uint8_t typKnown
     return STATUS_HF_TAG_OK;
 }
 
+/**
+* @brief    : Collect a variable number of nested sets, each set is reported as soon as it is captured
+*             so that the host can recover the key while the acquisition still runs
+* @param    :sets        : Number of sets to collect, NESTED_SETS_MAX at most
+* @param    :on_set      : Called with every set captured
+* @retval   :STATUS_HF_TAG_OK if all sets were collected, else the error code of the set that failed
+*
+*/
+uint8_t nested_recover_key_stream(uint64_t keyKnown, uint8_t blkKnown, uint8_t typKnown, uint8_t targetBlock, uint8_t targetType,
+                                  uint8_t sets, mf1_nested_core_cb_t on_set) {
+    mf1_nested_core_t nc;
+    uint8_t m, res;
+    // all operations must be based on the card
+    res = pcd_14a_reader_scan_auto(p_tag_info);
+    if (res != STATUS_HF_TAG_OK) {
+        return res;
+    }
+    for (m = 0; m < sets; m++) {
+        bsp_wdt_feed();
+        res = nested_recover_core(&nc, keyKnown, blkKnown, typKnown, targetBlock, targetType);
+        if (res != STATUS_HF_TAG_OK) {
+            return res;
+        }
+        on_set(&nc);
+    }
+    return STATUS_HF_TAG_OK;
+}
+
 /**
 * @brief    : NestedFollow detection implementation
 * @param    :block   :The owner of the known secret key of the card
@@ -1025,25 +1085,40 @@ inline void mf1_toolbox_report_healthy () {
     while (NRF_LOG_PROCESS());
 }
 
+// Remove duplicated keys, keeping the order of the first occurrences
+static void mf1_toolbox_keys_unique(mf1_key_t *keys, uint8_t *keys_len) {
+    uint8_t table[256] = { 0 }; // index + 1 of a kept key, 0 is a free slot. 255 keys at most, a slot stays free
+    uint8_t i, n = 0, h;
+    for (i = 0; i < *keys_len; i++) {
+        h = keys[i].key[0] ^ (keys[i].key[1] * 3) ^ (keys[i].key[2] * 5) ^ (keys[i].key[3] * 7) ^ (keys[i].key[4] * 11) ^ (keys[i].key[5] * 13);
+        while (table[h] != 0 && memcmp(&keys[table[h] - 1], &keys[i], sizeof(mf1_key_t)) != 0) h++;
+        if (table[h] != 0) continue; // key duplicated
+
+        keys[n] = keys[i];
+        table[h] = ++n;
+    }
+    *keys_len = n;
+}
+
+// Move a found key to the front, the same keys tend to repeat over the sectors of a card
+static void mf1_toolbox_key_to_front(mf1_key_t *keys, uint8_t index) {
+    mf1_key_t key = keys[index];
+    memmove(&keys[1], &keys[0], index * sizeof(mf1_key_t));
+    keys[0] = key;
+}
+
 uint16_t mf1_toolbox_check_keys_of_sectors (
     mf1_toolbox_check_keys_of_sectors_in_t *in,
-    mf1_toolbox_check_keys_of_sectors_out_t *out
+    mf1_toolbox_check_keys_of_sectors_out_t *out,
+    mf1_toolbox_check_keys_of_sectors_stats_t *stats
 ) {
     memset(out, 0, sizeof(mf1_toolbox_check_keys_of_sectors_out_t));
+    memset(stats, 0, sizeof(mf1_toolbox_check_keys_of_sectors_stats_t));
     uint8_t trailer[18] = {}; // trailer 16 bytes + padding 2 bytes
 
-    // keys unique
+    // keys unique, the order is the priority given by the host
     uint8_t i, j, maskSector, maskShift, trailerNo;
-    for (i = 0; i < in->keys_len; i++) {
-        for (j = i + 1; j < in->keys_len; j++) {
-            if (memcmp(&in->keys[i], &in->keys[j], sizeof(mf1_key_t)) != 0) continue;
-
-            // key duplicated, replace with last key
-            if (j != in->keys_len - 1) in->keys[j] = in->keys[in->keys_len - 1];
-            in->keys_len--;
-            j--;
-        }
-    }
+    mf1_toolbox_keys_unique(in->keys, &in->keys_len);
 
     uint16_t status = STATUS_HF_TAG_OK;
     bool skipKeyB;
@@ -1053,10 +1128,12 @@ uint16_t mf1_toolbox_check_keys_of_sectors (
         trailerNo = i < 32 ? i * 4 + 3 : i * 16 - 369; // trailerNo of sector
         skipKeyB = (maskSector & 0b1) > 0;
         if ((maskSector & 0b10) == 0) {
+            stats->sector_keys++;
             for (j = 0; j < in->keys_len; j++) {
                 mf1_toolbox_report_healthy();
                 if (status != STATUS_HF_TAG_OK) mf1_toolbox_antenna_restart();
 
+                stats->auths++;
                 status = auth_key_use_522_hw(trailerNo, PICC_AUTHENT1A, in->keys[j].key);
                 if (status != STATUS_HF_TAG_OK) { // auth failed
                     if (status == STATUS_HF_TAG_NO) return STATUS_HF_TAG_NO;
@@ -1065,6 +1142,7 @@ uint16_t mf1_toolbox_check_keys_of_sectors (
                 // key A found
                 out->found.b[i / 4] |= 0b10 << maskShift;
                 out->keys[i][0] = in->keys[j];
+                mf1_toolbox_key_to_front(in->keys, j);
                 // try to read keyB from trailer of sector
                 status = pcd_14a_reader_mf1_read(trailerNo, trailer);
                 // key B not in trailer
@@ -1078,10 +1156,12 @@ uint16_t mf1_toolbox_check_keys_of_sectors (
         }
         if (skipKeyB) continue;
 
+        stats->sector_keys++;
         for (j = 0; j < in->keys_len; j++) {
             mf1_toolbox_report_healthy();
             if (status != STATUS_HF_TAG_OK) mf1_toolbox_antenna_restart();
 
+            stats->auths++;
             status = auth_key_use_522_hw(trailerNo, PICC_AUTHENT1B, in->keys[j].key);
             if (status != STATUS_HF_TAG_OK) { // auth failed
                 if (status == STATUS_HF_TAG_NO) return STATUS_HF_TAG_NO;
@@ -1090,6 +1170,7 @@ uint16_t mf1_toolbox_check_keys_of_sectors (
             // key B found
             out->found.b[i / 4] |= 0b1 << maskShift;
             out->keys[i][1] = in->keys[j];
+            mf1_toolbox_key_to_front(in->keys, j);
             break;
         }
     }
@@ -1097,6 +1178,221 @@ uint16_t mf1_toolbox_check_keys_of_sectors (
     return STATUS_HF_TAG_OK;
 }
 
+/**
+* @brief : Try a list of keys on one block, the card is only scanned again after a failed auth
+* @param :index : The index of the key which authenticated
+* @retval : STATUS_HF_TAG_OK if a key authenticated, STATUS_MF_ERR_AUTH if none did,
+*           STATUS_HF_TAG_NO if the card is lost
+*
+*/
+uint16_t mf1_toolbox_check_keys_on_block(uint8_t block, uint8_t type, mf1_key_t *keys, uint8_t keys_len, uint8_t *index) {
+    uint16_t status = STATUS_HF_TAG_OK;
+    for (uint8_t i = 0; i < keys_len; i++) {
+        mf1_toolbox_report_healthy();
+        if (status != STATUS_HF_TAG_OK) mf1_toolbox_antenna_restart();
+
+        status = auth_key_use_522_hw(block, type, keys[i].key);
+        if (status == STATUS_HF_TAG_OK) {
+            pcd_14a_reader_mf1_unauth();
+            *index = i;
+            return STATUS_HF_TAG_OK;
+        }
+        if (status == STATUS_HF_TAG_NO) return STATUS_HF_TAG_NO;
+    }
+    return STATUS_MF_ERR_AUTH;
+}
+
+/**
+* @brief : Reselect the card after a failed auth or read, the card falls back to IDLE in that case
+* @retval : STATUS_HF_TAG_OK if the card is selected again, STATUS_HF_TAG_NO if the card is lost
+*
+*/
+static uint16_t mf1_toolbox_reselect(void) {
+    pcd_14a_reader_mf1_unauth();
+    if (pcd_14a_reader_fast_select(p_tag_info) == STATUS_HF_TAG_OK) {
+        return STATUS_HF_TAG_OK;
+    }
+    mf1_toolbox_antenna_restart();
+    return pcd_14a_reader_scan_auto(p_tag_info);
+}
+
+/**
+* @brief : Read all sectors of the card with the keys found by mf1_toolbox_check_keys_of_sectors
+*           Every sector is authenticated once with key A, key B is only used for the blocks key A can not read.
+*           The card is selected once and only reselected after a failed auth or read.
+* @param :keys : The found mask and the keys of the sectors, sectors without a found key are skipped
+* @param :sectors : The number of sectors to dump, 40 at most
+* @param :on_sector : Called for each dumped sector, the known keys are already put into the trailer
+* @retval : STATUS_HF_TAG_OK if all sectors are processed, STATUS_HF_TAG_NO if the card is lost
+*
+*/
+uint16_t mf1_toolbox_dump_sectors(
+    mf1_toolbox_check_keys_of_sectors_out_t *keys,
+    uint8_t sectors,
+    mf1_toolbox_dump_sector_cb_t on_sector
+) {
+    static uint8_t blocks[16 * 16]; // 16 blocks of the largest sector
+    uint8_t block[18];              // a block and its 2 crc bytes
+    uint8_t i, j, t, maskSector, maskShift, firstBlock, blockCount, authed;
+    uint16_t readMask, fullMask;
+
+    if (sectors > 40) sectors = 40;
+    if (pcd_14a_reader_scan_auto(p_tag_info) != STATUS_HF_TAG_OK) {
+        return STATUS_HF_TAG_NO;
+    }
+
+    bool selected = true;
+    for (i = 0; i < sectors; i++) {
+        maskShift = 6 - i % 4 * 2;
+        maskSector = (keys->found.b[i / 4] >> maskShift) & 0b11;
+        if (maskSector == 0) continue;
+
+        firstBlock = i < 32 ? i * 4 : 128 + (i - 32) * 16;
+        blockCount = i < 32 ? 4 : 16;
+        fullMask = (uint16_t)((1u << blockCount) - 1);
+        readMask = 0;
+        authed = 0;
+        memset(blocks, 0, sizeof(blocks));
+
+        // t = 0 is key A, t = 1 is key B
+        for (t = 0; t < 2 && readMask != fullMask; t++) {
+            if ((maskSector & (0b10 >> t)) == 0) continue;
+            mf1_toolbox_report_healthy();
+            if (!selected) {
+                if (mf1_toolbox_reselect() != STATUS_HF_TAG_OK) return STATUS_HF_TAG_NO;
+                selected = true;
+            }
+
+            if (pcd_14a_reader_mf1_auth(p_tag_info, PICC_AUTHENT1A + t, firstBlock + blockCount - 1, keys->keys[i][t].key) != STATUS_HF_TAG_OK) {
+                selected = false;
+                continue;
+            }
+            authed |= 0b10 >> t;
+
+            for (j = 0; j < blockCount; j++) {
+                if (readMask & (1 << j)) continue;
+                // not in place, the 2 crc bytes would land in the next block, which is left zeroed if it can't be read
+                if (pcd_14a_reader_mf1_read(firstBlock + j, block) != STATUS_HF_TAG_OK) {
+                    // a denied read drops the card out of the session, try the other key
+                    selected = false;
+                    break;
+                }
+                memcpy(&blocks[j * 16], block, 16);
+                readMask |= 1 << j;
+            }
+        }
+
+        // the keys can't be read back from the trailer, fill in what we know
+        if (readMask & (1 << (blockCount - 1))) {
+            uint8_t *trailer = &blocks[(blockCount - 1) * 16];
+            if (maskSector & 0b10) memcpy(&trailer[0], keys->keys[i][0].key, sizeof(mf1_key_t));
+            if (maskSector & 0b01) memcpy(&trailer[10], keys->keys[i][1].key, sizeof(mf1_key_t));
+        }
+        on_sector(i, authed, readMask, blocks, blockCount);
+    }
+
+    return STATUS_HF_TAG_OK;
+}
+
+/**
+* @brief : Acquire one encrypted nonce of the target sector with a nested auth, the tag must be scanned before
+* @param :pcs : The crypto1 state used for the authentication
+* @param :cuid : The uid fixed when the tag was scanned
+* @param :answer : The buffer for the 4 bytes encrypted nonce
+* @param :par_enc : The 4 parity bits of the encrypted nonce, the parity of the first byte at bit 3
+* @retval : STATUS_HF_TAG_OK if the nonce is acquired, otherwise the error status of the failed step
+*
+*/
+static uint8_t hardnested_nonce_acquire_one(struct Crypto1State *pcs, uint32_t cuid, bool slow, uint8_t blkKnown, uint8_t typKnown,
+    uint64_t keyKnown, uint8_t targetBlk, uint8_t targetTyp, uint8_t *answer, uint8_t *par_enc) {
+    uint8_t nt_enc[] = { 0x00, 0x00, 0x00, 0x00 };
+    uint8_t parity[] = { 0x00, 0x00, 0x00, 0x00 };
+    uint8_t status   = STATUS_HF_TAG_NO;
+    uint16_t len     = 0;
+
+    if (pcd_14a_reader_fast_select(p_tag_info) != STATUS_HF_TAG_OK) {
+        NRF_LOG_INFO("AcquireEncryptedNonces: Tag lost\r\n");
+        return STATUS_HF_TAG_NO;
+    }
+    // Slow mode, delay some time?
+    if (slow) {
+        bsp_delay_us(400);
+    }
+    // First auth
+    if (authex(pcs, cuid, blkKnown, typKnown, keyKnown, AUTH_FIRST, NULL) != STATUS_HF_TAG_OK) {
+        NRF_LOG_INFO("AcquireEncryptedNonces: Auth1 error\r\n");
+        return STATUS_MF_ERR_AUTH;
+    }
+    // Nested auth
+    len = send_cmd(pcs, AUTH_NESTED, targetTyp, targetBlk, &status, nt_enc, parity, U8ARR_BIT_LEN(nt_enc));
+    if (len != 32) {
+        NRF_LOG_INFO("AcquireEncryptedNonces: Auth2 error len=%d\r\n", len);
+        return STATUS_HF_ERR_STAT;
+    }
+    memcpy(answer, nt_enc, sizeof(nt_enc));
+    // merge parity
+    *par_enc = (parity[0] << 3) | (parity[1] << 2) | (parity[2] << 1) | parity[3];
+    return STATUS_HF_TAG_OK;
+}
+
+/**
+* @brief : Collect nested encrypted nonces of every sector and key type, for checking a key dictionary offline.
+*           Each nonce costs one auth with the known key and one nested auth, the card is never re-scanned.
+* @param :keyKnown : The known secret key of the card
+* @param :blkKnown : The block of the known secret key
+* @param :typKnown : The type of the known secret key, 0x60 (A secret key) or 0x61 (B secret key)
+* @param :mask : Which sectorKeys to skip, in the format of mf1_toolbox_check_keys_of_sectors
+* @param :sectors : The number of sectors of the card, 40 at most
+* @param :count : The number of nonces per sectorKey, 8 at most
+* @param :uid : The uid used in the authentications
+* @param :on_nonces : Called with the nonces of each sectorKey, a sectorKey which gives no nested answer reports less nonces
+* @retval : STATUS_HF_TAG_OK if all sectorKeys are processed, otherwise the error status of the failed step
+*
+*/
+uint8_t mf1_toolbox_nested_nonces_of_sectors(uint8_t blkKnown, uint8_t typKnown, uint64_t keyKnown,
+    mf1_toolbox_check_keys_of_sectors_mask_t *mask, uint8_t sectors, uint8_t count, uint32_t *uid,
+    mf1_toolbox_nested_nonces_cb_t on_nonces) {
+    struct Crypto1State mpcs = { 0, 0 };
+    struct Crypto1State *pcs = &mpcs;
+    uint8_t nonces[8 * 5];  // nt_enc 4 bytes + parity 1 byte per nonce
+    uint8_t i, t, n, maskShift, trailerNo, err_count;
+    uint8_t status;
+
+    if (sectors > 40) sectors = 40;
+    if (count > 8) count = 8;
+    if (pcd_14a_reader_scan_auto(p_tag_info) != STATUS_HF_TAG_OK) {
+        return STATUS_HF_TAG_NO;
+    }
+    *uid = get_u32_tag_uid(p_tag_info);
+
+    for (i = 0; i < sectors; i++) {
+        maskShift = 6 - i % 4 * 2;
+        trailerNo = i < 32 ? i * 4 + 3 : i * 16 - 369; // trailerNo of sector
+        // t = 0 is key A, t = 1 is key B
+        for (t = 0; t < 2; t++) {
+            if ((mask->b[i / 4] >> maskShift) & (0b10 >> t)) continue;
+            for (n = 0, err_count = 0; n < count;) {
+                mf1_toolbox_report_healthy();
+                status = hardnested_nonce_acquire_one(pcs, *uid, false, blkKnown, typKnown, keyKnown,
+                    trailerNo, PICC_AUTHENT1A + t, &nonces[n * 5], &nonces[n * 5 + 4]);
+                if (status == STATUS_HF_TAG_OK) {
+                    n++;
+                    err_count = 0;
+                    continue;
+                }
+                if (++err_count < 3) continue;
+                // the nested auth of a sector may fail for good, the card and the known key may not
+                if (status != STATUS_HF_ERR_STAT) {
+                    return status;
+                }
+                break;
+            }
+            on_nonces(i, PICC_AUTHENT1A + t, nonces, n);
+        }
+    }
+    return STATUS_HF_TAG_OK;
+}
+
 /**
 * @brief : HardNested random number acquisition implementation
 * @param :slow : Is it a low-speed acquisition mode? Low-speed acquisition is suitable for some non-standard cards
@@ -1115,11 +1411,10 @@ uint8_t mf1_hardnested_nonces_acquire(bool slow, uint8_t blkKnown, uint8_t typKn
     struct Crypto1State mpcs = { 0, 0 };
     struct Crypto1State *pcs = &mpcs;
     uint8_t answer[] 	     = { 0x00, 0x00, 0x00, 0x00 };
-    uint8_t parity[] 	     = { 0x00, 0x00, 0x00, 0x00 };
+    uint8_t par_enc          = 0;
     uint8_t nt_par_enc       = 0;
     uint8_t status           = STATUS_HF_TAG_NO;
     uint32_t cuid            = 0;   // cuid can be fixed when selecting card
-    uint16_t len             = 0;
     *num_nonces              = 0;   // The number of random numbers currently counted must be reset
     bool tag_selected        = false;
     uint8_t err_count        = 0;
@@ -1128,49 +1423,22 @@ uint8_t mf1_hardnested_nonces_acquire(bool slow, uint8_t blkKnown, uint8_t typKn
         // NRF_LOG_INFO("AcquireEncryptedNonces: %d\r\n", i);
         if (tag_selected) {
             mf1_toolbox_report_healthy();
-            if (pcd_14a_reader_fast_select(p_tag_info) != STATUS_HF_TAG_OK) {
-                NRF_LOG_INFO("AcquireEncryptedNonces: Tag lost\r\n");
-                if (++err_count >= 15) {
-                    return STATUS_HF_TAG_NO;
-                }
-                continue;
-            }
-            // Slow mode, delay some time?
-            if (slow) {
-                bsp_delay_us(400);
-            }
-            // First auth
-            if (authex(pcs, cuid, blkKnown, typKnown, keyKnown, AUTH_FIRST, NULL) != STATUS_HF_TAG_OK) {
-                NRF_LOG_INFO("AcquireEncryptedNonces: Auth1 error\r\n");
-                if (++err_count >= 15) {
-                    return STATUS_MF_ERR_AUTH;
-                }
-                continue;
-            }
-            // Nested auth
-            len = send_cmd(pcs, AUTH_NESTED, targetTyp, targetBlk, &status, answer, parity, U8ARR_BIT_LEN(answer));
-            if (len != 32) {
-                NRF_LOG_INFO("AcquireEncryptedNonces: Auth2 error len=%d\r\n", len);
+            status = hardnested_nonce_acquire_one(pcs, cuid, slow, blkKnown, typKnown, keyKnown, targetBlk, targetTyp, answer, &par_enc);
+            if (status != STATUS_HF_TAG_OK) {
                 if (++err_count >= 15) {
-                    return STATUS_HF_ERR_STAT;
+                    return status;
                 }
                 continue;
             }
             // Reset err count
             err_count = 0;
-            // merge parity
-            uint8_t par_enc = 0;
-            par_enc |= parity[3] << 4;
-            par_enc |= parity[2] << 5;
-            par_enc |= parity[1] << 6;
-            par_enc |= parity[0] << 7;
             // copy to buffer
             *num_nonces = *num_nonces + 1;
             if (*num_nonces % 2) {
                 memcpy(nonces + i, answer, 4);
-                nt_par_enc = par_enc & 0xf0;
+                nt_par_enc = par_enc << 4;
             } else {
-                nt_par_enc |= par_enc >> 4;
+                nt_par_enc |= par_enc;
                 memcpy(nonces + i + 4, answer, 4);
                 memcpy(nonces + i + 8, &nt_par_enc, 1);
                 i += 9;
@@ -1189,3 +1457,78 @@ uint8_t mf1_hardnested_nonces_acquire(bool slow, uint8_t blkKnown, uint8_t typKn
     // OK!
     return STATUS_HF_TAG_OK;
 }
+
+/**
+* @brief : Long running HardNested acquisition, the nonce pairs are handed out chunk by chunk while they are acquired.
+*           The distinct first bytes of the encrypted nonces and their parity sum Sum(a0) are tracked on the way,
+*           the acquisition stops by itself once all 256 first bytes are seen and noncesTarget nonces are acquired.
+* @param :noncesTarget : The number of nonces to acquire at least
+* @param :noncesMax : The number of nonces to give up at, when the first bytes are still not all seen
+* @param :chunk : The buffer for the nonce pairs, 9 bytes per pair in the format of mf1_hardnested_nonces_acquire
+* @param :chunkMax : The size of the chunk buffer in bytes
+* @param :chunkLength : The length of the pairs left in the chunk buffer when returning
+* @param :on_chunk : Called with the chunk buffer every time it is full
+* @param :progress : The first byte tracking state and the number of nonces acquired
+* @retval : STATUS_HF_TAG_OK when the target is reached, otherwise the error status of the failed step
+*
+*/
+uint8_t mf1_hardnested_nonces_stream(bool slow, uint8_t blkKnown, uint8_t typKnown, uint64_t keyKnown,
+    uint8_t targetBlk, uint8_t targetTyp, uint32_t noncesTarget, uint32_t noncesMax,
+    uint8_t *chunk, uint16_t chunkMax, uint16_t *chunkLength,
+    mf1_hardnested_chunk_cb_t on_chunk, mf1_hardnested_progress_t *progress) {
+    struct Crypto1State mpcs = { 0, 0 };
+    struct Crypto1State *pcs = &mpcs;
+    uint8_t seen[256 / 8]    = { 0x00 };
+    uint8_t answer[]         = { 0x00, 0x00, 0x00, 0x00 };
+    uint8_t par_enc          = 0;
+    uint8_t status           = STATUS_HF_TAG_NO;
+    uint8_t err_count        = 0;
+    uint32_t cuid            = 0;
+
+    memset(progress, 0, sizeof(mf1_hardnested_progress_t));
+    *chunkLength = 0;
+    chunkMax -= chunkMax % 9;
+
+    if (pcd_14a_reader_scan_auto(p_tag_info) != STATUS_HF_TAG_OK) {
+        return STATUS_HF_TAG_NO;
+    }
+    cuid = get_u32_tag_uid(p_tag_info);
+
+    // only stop on a pair boundary, the pairs are what the host consumes
+    while (progress->msb_count < 256 || progress->nonces < noncesTarget || progress->nonces % 2) {
+        if (progress->nonces >= noncesMax && progress->nonces % 2 == 0) {
+            return STATUS_HF_ERR_STAT;
+        }
+        mf1_toolbox_report_healthy();
+        status = hardnested_nonce_acquire_one(pcs, cuid, slow, blkKnown, typKnown, keyKnown, targetBlk, targetTyp, answer, &par_enc);
+        if (status != STATUS_HF_TAG_OK) {
+            if (++err_count >= 15) {
+                return status;
+            }
+            continue;
+        }
+        err_count = 0;
+
+        // a0: parity of the encrypted first byte xor its encrypted parity bit, once per distinct first byte
+        if ((seen[answer[0] / 8] & (1 << (answer[0] % 8))) == 0) {
+            seen[answer[0] / 8] |= 1 << (answer[0] % 8);
+            progress->msb_count++;
+            progress->msb_sum += evenparity8(answer[0]) ^ ((par_enc >> 3) & 1);
+        }
+
+        if (progress->nonces++ % 2 == 0) {
+            memcpy(&chunk[*chunkLength], answer, 4);
+            chunk[*chunkLength + 8] = par_enc << 4;
+        } else {
+            memcpy(&chunk[*chunkLength + 4], answer, 4);
+            chunk[*chunkLength + 8] |= par_enc;
+            *chunkLength += 9;
+            if (*chunkLength == chunkMax) {
+                on_chunk(chunk, *chunkLength);
+                *chunkLength = 0;
+            }
+        }
+    }
+
+    return STATUS_HF_TAG_OK;
+}
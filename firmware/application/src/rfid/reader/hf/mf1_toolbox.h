@@ -11,6 +11,8 @@
 
 #define SETS_NR         2       // Using several sets of random number probes, at least two can ensure that there are two sets of random number combinations for intersection inquiries. The larger the value, the easier it is to succeed.
 #define DIST_NR         3       // The more distance the distance can accurately judge the communication stability of the current card
+#define NESTED_SETS_MAX     32  // Sets a streamed nested acquisition can be asked for, @see nested_recover_key_stream
+#define DARKSIDE_SETS_MAX   16  // Sets a darkside batch can be asked for, @see darkside_recover_key_batch
 
 // mifare authentication
 #define CRYPT_NONE      0
@@ -31,6 +33,8 @@ typedef struct {            //Answer the random number parameters required for N
     uint8_t par;            //The puppet test of the communication process of nested verification encryption, only the "low 3 digits', that is, the right 3
 } mf1_nested_core_t;
 
+typedef void (*mf1_nested_core_cb_t)(mf1_nested_core_t *nc);
+
 typedef struct {
     uint8_t uid[4];
     struct {
@@ -57,6 +61,8 @@ typedef struct {
     uint8_t ar[4];
 } PACKED DarksideCore_t;
 
+typedef void (*mf1_darkside_core_cb_t)(DarksideCore_t *dc);
+
 typedef struct {
     uint8_t key[6];
 } PACKED mf1_key_t;
@@ -76,6 +82,27 @@ typedef struct {
     mf1_key_t keys[40][2]; // 6 bytes * 2 keys * 40 sectors = 480 bytes
 } PACKED mf1_toolbox_check_keys_of_sectors_out_t;
 
+typedef struct {
+    uint16_t auths;       // auths tried
+    uint16_t sector_keys; // sectorKeys searched
+} mf1_toolbox_check_keys_of_sectors_stats_t;
+
+// sector: sector number, authed: 0b10 key A and/or 0b01 key B authenticated,
+// read_mask: bit n set if block n of the sector was read, blocks: block_count * 16 bytes
+typedef void (*mf1_toolbox_dump_sector_cb_t)(uint8_t sector, uint8_t authed, uint16_t read_mask, uint8_t *blocks, uint8_t block_count);
+
+// first byte tracking of the hardnested acquisition
+typedef struct {
+    uint16_t msb_count; // distinct first bytes of the encrypted nonces seen, 256 at most
+    uint16_t msb_sum;   // Sum(a0) over the distinct first bytes
+    uint32_t nonces;    // nonces acquired
+} mf1_hardnested_progress_t;
+
+typedef void (*mf1_hardnested_chunk_cb_t)(uint8_t *chunk, uint16_t length);
+
+// nonces: count * (nt_enc 4 bytes + parity 1 byte, the parity of the first byte at bit 3)
+typedef void (*mf1_toolbox_nested_nonces_cb_t)(uint8_t sector, uint8_t type, uint8_t *nonces, uint8_t count);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -90,6 +117,16 @@ uint8_t darkside_recover_key(
     mf1_darkside_status_t *darkside_status
 );
 
+uint8_t darkside_recover_key_batch(
+    uint8_t targetBlk,
+    uint8_t targetTyp,
+    uint8_t firstRecover,
+    uint8_t ntSyncMax,
+    uint8_t count,
+    mf1_darkside_core_cb_t on_core,
+    mf1_darkside_status_t *darkside_status
+);
+
 uint8_t nested_distance_detect(
     uint8_t block,
     uint8_t type,
@@ -107,6 +144,7 @@ uint8_t nested_distance_detect(
 
 uint8_t nested_recover_key(NESTED_CORE_PARAM_DEF, mf1_nested_core_t ncs[SETS_NR]);
 uint8_t static_nested_recover_key(NESTED_CORE_PARAM_DEF, mf1_static_nested_core_t *sncs);
+uint8_t nested_recover_key_stream(NESTED_CORE_PARAM_DEF, uint8_t sets, mf1_nested_core_cb_t on_set);
 
 uint8_t check_prng_type(mf1_prng_type_t *type);
 uint8_t check_std_mifare_nt_support();
@@ -115,11 +153,28 @@ uint16_t auth_key_use_522_hw(uint8_t block, uint8_t type, uint8_t *key);
 
 uint16_t mf1_toolbox_check_keys_of_sectors (
     mf1_toolbox_check_keys_of_sectors_in_t *in,
-    mf1_toolbox_check_keys_of_sectors_out_t *out
+    mf1_toolbox_check_keys_of_sectors_out_t *out,
+    mf1_toolbox_check_keys_of_sectors_stats_t *stats
 );
 
+uint16_t mf1_toolbox_check_keys_on_block(uint8_t block, uint8_t type, mf1_key_t *keys, uint8_t keys_len, uint8_t *index);
+
+uint16_t mf1_toolbox_dump_sectors(
+    mf1_toolbox_check_keys_of_sectors_out_t *keys,
+    uint8_t sectors,
+    mf1_toolbox_dump_sector_cb_t on_sector
+);
+
+uint8_t mf1_toolbox_nested_nonces_of_sectors(uint8_t blkKnown, uint8_t typKnown, uint64_t keyKnown,
+    mf1_toolbox_check_keys_of_sectors_mask_t *mask, uint8_t sectors, uint8_t count, uint32_t *uid,
+    mf1_toolbox_nested_nonces_cb_t on_nonces);
+
 uint8_t mf1_hardnested_nonces_acquire(bool slow, uint8_t blkKnown, uint8_t typKnown, uint64_t keyKnown, 
     uint8_t targetBlk, uint8_t targetTyp, uint8_t* nonces, uint16_t noncesMax, uint8_t* num_nonces);
+uint8_t mf1_hardnested_nonces_stream(bool slow, uint8_t blkKnown, uint8_t typKnown, uint64_t keyKnown,
+    uint8_t targetBlk, uint8_t targetTyp, uint32_t noncesTarget, uint32_t noncesMax,
+    uint8_t *chunk, uint16_t chunkMax, uint16_t *chunkLength,
+    mf1_hardnested_chunk_cb_t on_chunk, mf1_hardnested_progress_t *progress);
 
 #ifdef __cplusplus
 }
@@ -33,7 +33,26 @@ static bool m_reader_is_init = false;
 
 // Communication timeout
 static uint16_t g_com_timeout_ms = DEF_COM_TIMEOUT;
-static autotimer *g_timeout_auto_timer;
+
+// Cpu cycles per microsecond, the transfers are timed with the DWT cycle counter
+#define CYCLES_PER_US               (SystemCoreClock / 1000000)
+// Lower bound of the adaptive auth timeout, covers the slowest card answer we know of
+#define AUTH_TIMEOUT_MIN_US         1000
+// The auth timeout is this many times the slowest successful auth of the current card
+#define AUTH_TIMEOUT_FACTOR         3
+
+// Slowest successful auth of the current card, 0 if no auth was timed yet
+static uint32_t m_auth_cycles_max = 0;
+// The card the auth time was learned from
+static uint8_t m_auth_uid[10];
+static uint8_t m_auth_uid_len = 0;
+// Cycles from command start to completion of the last transfer
+static uint32_t m_last_transfer_cycles = 0;
+// Timing log, @see pcd_14a_reader_timing_get
+static pcd_14a_reader_timing_t m_timing;
+// The tag the reader commands select when several tags are in the field, @see pcd_14a_reader_target_set
+static uint8_t m_target_uid[10];
+static uint8_t m_target_uid_len = 0;
 
 // RC522 SPI
 #define SPI_INSTANCE  0 /**< SPI instance index. */
@@ -41,51 +60,68 @@ static const nrf_drv_spi_t s_spiHandle = NRF_DRV_SPI_INSTANCE(SPI_INSTANCE);
 
 #define ONCE_OPT __attribute__((optimize("O3")))
 
+// EasyDMA buffers, an address byte and up to a full FIFO
+static uint8_t m_spi_tx_buf[DEF_FIFO_LENGTH + 1];
+static uint8_t m_spi_rx_buf[DEF_FIFO_LENGTH + 1];
+
 /**
-* @brief  :Read register
-* @param  :Address:Register address
-* @retval :Value in the register
+* @brief  :Run one chip select transaction of len bytes from m_spi_tx_buf through EasyDMA,
+*          the answer is in m_spi_rx_buf
 */
-uint8_t read_register_single(uint8_t Address) {
+static void ONCE_OPT spi_transfer(uint8_t len) {
     RC522_DOSEL;
 
-    Address = (uint8_t)(((Address << 1) & 0x7E) | 0x80);
-
-    NRF_SPI0->TXD = Address;
-    while (NRF_SPI0->EVENTS_READY == 0);
-    NRF_SPI0->EVENTS_READY = 0;
-    (void)NRF_SPI0->RXD;
-
-    NRF_SPI0->TXD = Address;
-    while (NRF_SPI0->EVENTS_READY == 0);
-    NRF_SPI0->EVENTS_READY = 0;
-    Address = NRF_SPI0->RXD;
+    NRF_SPIM0->TXD.PTR = (uint32_t)m_spi_tx_buf;
+    NRF_SPIM0->TXD.MAXCNT = len;
+    NRF_SPIM0->RXD.PTR = (uint32_t)m_spi_rx_buf;
+    NRF_SPIM0->RXD.MAXCNT = len;
+    NRF_SPIM0->EVENTS_END = 0;
+    NRF_SPIM0->TASKS_START = 1;
+    while (NRF_SPIM0->EVENTS_END == 0);
+    NRF_SPIM0->EVENTS_END = 0;
 
     RC522_UNSEL;
+}
 
-    return Address;
+/**
+* @brief  :Read register
+* @param  :Address:Register address
+* @retval :Value in the register
+*/
+uint8_t ONCE_OPT read_register_single(uint8_t Address) {
+    m_spi_tx_buf[0] = (uint8_t)(((Address << 1) & 0x7E) | 0x80);
+    m_spi_tx_buf[1] = 0x00;
+    spi_transfer(2);
+    return m_spi_rx_buf[1];
 }
 
 void read_register_buffer(uint8_t Address, uint8_t *pInBuffer, uint8_t len) {
-    RC522_DOSEL;
-
-    Address = (((Address << 1) & 0x7E) | 0x80);
-
-    NRF_SPI0->TXD = Address;
-    while (NRF_SPI0->EVENTS_READY == 0);    // Waiting for transmission ends
-    NRF_SPI0->EVENTS_READY = 0;
-    (void)NRF_SPI0->RXD;    //Read once and give a level
-
-    uint8_t i = 0;
-    do {
-        //Then start receiving data
-        NRF_SPI0->TXD = Address;
-        while (NRF_SPI0->EVENTS_READY == 0);    //Waiting for transmission
-        NRF_SPI0->EVENTS_READY = 0;
-        pInBuffer[i] = NRF_SPI0->RXD;    // Read once and give a level
-    } while (++i < len);
+    if (len > DEF_FIFO_LENGTH) {
+        len = DEF_FIFO_LENGTH;
+    }
+    // The 522 reads the same address again for every address byte, the last one is terminated by 0
+    memset(m_spi_tx_buf, (((Address << 1) & 0x7E) | 0x80), len);
+    m_spi_tx_buf[len] = 0x00;
+    spi_transfer(len + 1);
+    memcpy(pInBuffer, m_spi_rx_buf + 1, len);
+}
 
-    RC522_UNSEL;
+/**
+* @brief  :Read several registers in one transaction
+* @param  :pAddress: Register addresses
+*          pValues: Values in the registers
+*          count: Number of registers
+*/
+void read_register_multi(const uint8_t *pAddress, uint8_t *pValues, uint8_t count) {
+    if (count > DEF_FIFO_LENGTH) {
+        count = DEF_FIFO_LENGTH;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        m_spi_tx_buf[i] = (uint8_t)(((pAddress[i] << 1) & 0x7E) | 0x80);
+    }
+    m_spi_tx_buf[count] = 0x00;
+    spi_transfer(count + 1);
+    memcpy(pValues, m_spi_rx_buf + 1, count);
 }
 
 /**
@@ -94,45 +130,18 @@ void read_register_buffer(uint8_t Address, uint8_t *pInBuffer, uint8_t len) {
 *           value: The value to be written
 */
 void ONCE_OPT write_register_single(uint8_t Address, uint8_t value) {
-    RC522_DOSEL;
-
-    Address = ((Address << 1) & 0x7E);
-
-    // First pass the address first pass the address
-    NRF_SPI0->TXD = Address;
-    while (NRF_SPI0->EVENTS_READY == 0);
-    NRF_SPI0->EVENTS_READY = 0;
-    (void)NRF_SPI0->RXD;
-
-    //  Passing address
-    NRF_SPI0->TXD = value;
-    while (NRF_SPI0->EVENTS_READY == 0);
-    NRF_SPI0->EVENTS_READY = 0;
-    (void)NRF_SPI0->RXD;
-
-    RC522_UNSEL;
+    m_spi_tx_buf[0] = ((Address << 1) & 0x7E);
+    m_spi_tx_buf[1] = value;
+    spi_transfer(2);
 }
 
 void write_register_buffer(uint8_t Address, uint8_t *values, uint8_t len) {
-    RC522_DOSEL;
-
-    Address = ((Address << 1) & 0x7E);
-
-    NRF_SPI0->TXD = Address;
-    while (NRF_SPI0->EVENTS_READY == 0);
-    NRF_SPI0->EVENTS_READY = 0;
-    (void)NRF_SPI0->RXD;
-
-    uint8_t i = 0;
-    do {
-        // Passing address
-        NRF_SPI0->TXD = values[i];
-        while (NRF_SPI0->EVENTS_READY == 0);
-        NRF_SPI0->EVENTS_READY = 0;
-        (void)NRF_SPI0->RXD;
-    } while (++i < len);
-
-    RC522_UNSEL;
+    if (len > DEF_FIFO_LENGTH) {
+        len = DEF_FIFO_LENGTH;
+    }
+    m_spi_tx_buf[0] = ((Address << 1) & 0x7E);
+    memcpy(m_spi_tx_buf + 1, values, len);
+    spi_transfer(len + 1);
 }
 
 /**
@@ -176,13 +185,13 @@ void pcd_14a_reader_init(void) {
         spiConfig.sck_pin = HF_SPI_SCK;
         spiConfig.mode = NRF_DRV_SPI_MODE_0;
         spiConfig.frequency = NRF_DRV_SPI_FREQ_8M;
-        // Configure to block operation
+        // Configure to block operation, the registers are driven directly through SPIM0 EasyDMA
         errCode = nrf_drv_spi_init(&s_spiHandle, &spiConfig, NULL, NULL);
         APP_ERROR_CHECK(errCode);
 
-        // Initialized timer
-        // This timer is not released after the initialization of the timer, and it always needs to take up
-        g_timeout_auto_timer = bsp_obtain_timer(0);
+        // Communication timeouts and the timing log use the cycle counter
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
     }
 }
 
@@ -223,7 +232,6 @@ void pcd_14a_reader_uninit(void) {
     // Make sure that the device has been initialized, and then the anti -initialization
     if (m_reader_is_init) {
         m_reader_is_init = false;
-        bsp_return_timer(g_timeout_auto_timer);
         nrf_drv_spi_uninit(&s_spiHandle);
     }
 }
@@ -247,6 +255,36 @@ uint16_t pcd_14a_reader_timeout_get() {
     return g_com_timeout_ms;
 }
 
+/**
+* @brief  : Read the answer of a transceive out of the FIFO
+* @retval : STATUS_HF_TAG_OK, or STATUS_HF_ERR_STAT if the answer is longer than maxOutLenBit
+*/
+static uint8_t pcd_14a_reader_fifo_read(uint8_t *pOut, uint16_t *pOutLenBit, uint16_t maxOutLenBit) {
+    static const uint8_t fifo_regs[] = { FIFOLevelReg, Control522Reg };
+    uint8_t regs[2];
+    uint8_t n, lastBits;
+
+    read_register_multi(fifo_regs, regs, sizeof(regs));
+    n = regs[0];                                                    // Read the number of bytes saved in FIFO
+    if (n == 0) { n = 1; }
+
+    lastBits = regs[1] & 0x07;                                      // Finally receive the validity of the byte
+
+    if (lastBits) { *pOutLenBit = (n - 1) * 8 + lastBits; }         // N -byte number minus 1 (last byte)+ the number of bits of the last bit The total number of data readings read
+    else { *pOutLenBit = n * 8; }                                   // Finally received the entire bytes received by the byte valid
+
+    if (*pOutLenBit > maxOutLenBit) {
+        NRF_LOG_INFO("pcd_14a_reader_bytes_transfer receive response overflow: %d, max = %d\n", *pOutLenBit, maxOutLenBit);
+        // We can't pass the problem with problems, which is meaningless for the time being
+        *pOutLenBit = 0;
+        // Since there is a problem with the data, let's notify the upper layer and inform me
+        return STATUS_HF_ERR_STAT;
+    }
+    // Read all the data in FIFO
+    read_register_buffer(FIFODataReg, pOut, n);
+    return STATUS_HF_TAG_OK;
+}
+
 /**
 * @brief  : Through RC522 and ISO14443 cartoon communication
 * @param  : Command: RC522 command word
@@ -257,127 +295,7 @@ uint16_t pcd_14a_reader_timeout_get() {
 * @retval : Status value mi_ok, successful
 */
 uint8_t pcd_14a_reader_bytes_transfer(uint8_t Command, uint8_t *pIn, uint8_t InLenByte, uint8_t *pOut, uint16_t *pOutLenBit, uint16_t maxOutLenBit) {
-    uint8_t status      = STATUS_HF_ERR_STAT;
-    uint8_t waitFor     = 0x00;
-    uint8_t lastBits    = 0;
-    uint8_t n           = 0;
-    uint8_t pcd_err_val = 0;
-    uint8_t not_timeout = 0;
-
-    switch (Command) {
-        case PCD_AUTHENT:                       //  MiFare certification
-            waitFor = 0x10;                     //  Query the free interrupt logo when the certification card is waiting
-            break;
-
-        case PCD_TRANSCEIVE:
-            waitFor = 0x30;                     //  Inquiry the receiving interrupt logo position and Leisure interrupt logo
-            break;
-    }
-
-    write_register_single(CommandReg,       PCD_IDLE);      //  Flushbuffer clearing the internal FIFO read and writing pointer and ErRreg's Bufferovfl logo position is cleared
-    clear_register_mask(ComIrqReg,      0x80);          //  When Set1 is cleared, the shielding position of commonricqreg is clear zero
-    set_register_mask(FIFOLevelReg,     0x80);          //  Write an empty order
-
-    write_register_buffer(FIFODataReg, pIn, InLenByte); // Write data into FIFODATA
-    write_register_single(CommandReg, Command);             // Write command
-
-    if (Command == PCD_TRANSCEIVE) {
-        set_register_mask(BitFramingReg, 0x80);     // StartSend places to start the data to send this bit and send and receive commands when it is valid
-    }
-
-    if (pOut == NULL) {
-        // If the developer does not need to receive data, then return directly after the sending!
-        while ((read_register_single(Status2Reg) & 0x07) == 0x03);
-        return STATUS_HF_TAG_OK;
-    }
-    // Reset the length of the received data
-    *pOutLenBit         = 0;
-
-    bsp_set_timer(g_timeout_auto_timer, 0);         // Before starting the operation, return to zero over time counting
-
-    do {
-        n = read_register_single(ComIrqReg);                // Read the communication interrupt register to determine whether the current IO task is completed!
-        not_timeout = NO_TIMEOUT_1MS(g_timeout_auto_timer, g_com_timeout_ms);
-    } while (not_timeout && (!(n & waitFor)));  // Exit conditions: timeout interruption, interrupt with empty command commands
-    // NRF_LOG_INFO("N = %02x\n", n);
-
-    if (Command == PCD_TRANSCEIVE) {
-        clear_register_mask(BitFramingReg, 0x80);       // Clean up allows the startsend bit and the bit length position
-    }
-
-    // Whether to receive timeout
-    if (not_timeout) {
-        // First determine whether there is a place where there is an error register
-        if (n & 0x02) {
-            // Error occur
-            // Read an error logo register BufferOfI CollErr ParityErr ProtocolErr
-            pcd_err_val = read_register_single(ErrorReg);
-            // Detect whether there are abnormalities
-            if (pcd_err_val & 0x01) {               // ProtocolErr Error only appears in the following two cases:
-                if (Command == PCD_AUTHENT) {       // During the execution of the MFAUTHENT command, if the number of bytes received by a data stream, the position of the place
-                    // Therefore, we need to deal with it well, assuming that there are problems during the verification process, then we need to think that this is normal
-                    status = STATUS_MF_ERR_AUTH;
-                } else {                            // If the SOF is wrong, the position is set up and the receiver is automatically cleared during the start -up stage, which is effective at the rate of 106kbd
-                    NRF_LOG_INFO("Protocol error\n");
-                    status = STATUS_HF_ERR_STAT;
-                }
-            } else if (pcd_err_val & 0x02) {
-                // Detecting whether there are even strange errors
-                NRF_LOG_INFO("Parity error\n");
-                status = STATUS_HF_ERR_PARITY;
-            } else if (pcd_err_val & 0x04) {        // Detect whether there are CRC errors
-                NRF_LOG_INFO("CRC error\n");
-                status = STATUS_HF_ERR_CRC;
-            } else if (pcd_err_val & 0x08) {        // There is a conflict to detect the label
-                NRF_LOG_INFO("Collision tag\n");
-                status = STATUS_HF_COLLISION;
-            } else {                                // There are other unrepaired abnormalities
-                NRF_LOG_INFO("HF error: 0x%0x2\n", pcd_err_val);
-                status = STATUS_HF_ERR_STAT;
-            }
-        } else {
-            // Occasionally occur
-            // NRF_LOG_INFO("COM OK\n");
-            if (Command == PCD_TRANSCEIVE) {
-                n = read_register_single(FIFOLevelReg);                             // Read the number of bytes saved in FIFO
-                if (n == 0) { n = 1; }
-
-                lastBits = read_register_single(Control522Reg) & 0x07;          // Finally receive the validity of the byte
-
-                if (lastBits) { *pOutLenBit = (n - 1) * 8 + lastBits; } // N -byte number minus 1 (last byte)+ the number of bits of the last bit The total number of data readings read
-                else { *pOutLenBit = n * 8; }                           // Finally received the entire bytes received by the byte valid
-
-                if (*pOutLenBit <= maxOutLenBit) {
-                    // Read all the data in FIFO
-                    read_register_buffer(FIFODataReg, pOut, n);
-                    // Transmission instructions can be considered success when reading normal data!
-                    status = STATUS_HF_TAG_OK;
-                } else {
-                    NRF_LOG_INFO("pcd_14a_reader_bytes_transfer receive response overflow: %d, max = %d\n", *pOutLenBit, maxOutLenBit);
-                    // We can't pass the problem with problems, which is meaningless for the time being
-                    *pOutLenBit = 0;
-                    // Since there is a problem with the data, let's notify the upper layer and inform me
-                    status = STATUS_HF_ERR_STAT;
-                }
-            } else {
-                // Non -transmitted instructions, the execution is completed without errors and considered success!
-                status = STATUS_HF_TAG_OK;
-            }
-        }
-    } else {
-        status = STATUS_HF_TAG_NO;
-        // NRF_LOG_INFO("Tag lost(timeout).\n");
-    }
-
-    if (status != STATUS_HF_TAG_OK) {
-        // If there are certain operations,
-        // We may need to remove MFCrypto1On This register logo,
-        // Because it may be because of the error encryption communication caused by verification
-        clear_register_mask(Status2Reg, 0x08);
-    }
-
-    // NRF_LOG_INFO("Com status: %d\n", status);
-    return status;
+    return pcd_14a_reader_bytes_transfer_flags(Command, pIn, InLenByte, pOut, pOutLenBit, maxOutLenBit, 0);
 }
 
 /**
@@ -491,15 +409,20 @@ uint8_t pcd_14a_reader_bits_transfer(uint8_t *pTx, uint16_t  szTxBits, uint8_t *
 *          POUTLENBIT: Bit the length of the data
 *          FLAGS:
 *            - PCD_TRANSMIT_FLAG_NO_RESET_MF_CRYPTO1_ON: Do not reset MFCrypto1On
+*            - PCD_TRANSMIT_FLAG_KEEP_COLLISION_DATA: Read the bits received before a collision
 * @retval : Status value mi_ok, successful
 */
 uint8_t pcd_14a_reader_bytes_transfer_flags(uint8_t Command, uint8_t *pIn, uint8_t InLenByte, uint8_t *pOut, uint16_t *pOutLenBit, uint16_t maxOutLenBit, uint32_t flags) {
     uint8_t status      = STATUS_HF_ERR_STAT;
     uint8_t waitFor     = 0x00;
-    uint8_t lastBits    = 0;
     uint8_t n           = 0;
     uint8_t pcd_err_val = 0;
     uint8_t not_timeout = 0;
+    uint8_t irq[2];
+    uint32_t start_cycles = DWT->CYCCNT;
+    uint32_t timeout_cycles = g_com_timeout_ms * 1000 * CYCLES_PER_US;
+    // ComIrqReg and ErrorReg are polled together
+    static const uint8_t irq_regs[] = { ComIrqReg, ErrorReg };
 
     switch (Command) {
         case PCD_AUTHENT:                       //  MiFare certification
@@ -512,8 +435,8 @@ uint8_t pcd_14a_reader_bytes_transfer_flags(uint8_t Command, uint8_t *pIn, uint8
     }
 
     write_register_single(CommandReg,       PCD_IDLE);      //  Flushbuffer clearing the internal FIFO read and writing pointer and ErRreg's Bufferovfl logo position is cleared
-    clear_register_mask(ComIrqReg,      0x80);          //  When Set1 is cleared, the shielding position of commonricqreg is clear zero
-    set_register_mask(FIFOLevelReg,     0x80);          //  Write an empty order
+    write_register_single(ComIrqReg,    0x7F);          //  Set1 is cleared, so every irq bit written with 1 is cleared
+    write_register_single(FIFOLevelReg, 0x80);          //  FlushBuffer, the other bits of the register are read only
 
     write_register_buffer(FIFODataReg, pIn, InLenByte); // Write data into FIFODATA
     write_register_single(CommandReg, Command);             // Write command
@@ -530,11 +453,20 @@ uint8_t pcd_14a_reader_bytes_transfer_flags(uint8_t Command, uint8_t *pIn, uint8
     // Reset the length of the received data
     *pOutLenBit         = 0;
 
-    bsp_set_timer(g_timeout_auto_timer, 0);         // Before starting the operation, return to zero over time counting
+    // A failed auth never completes, so once a successful one was timed the wait for this card is cut short
+    if (Command == PCD_AUTHENT && m_auth_cycles_max != 0) {
+        uint32_t auth_cycles = MAX(m_auth_cycles_max * AUTH_TIMEOUT_FACTOR, AUTH_TIMEOUT_MIN_US * CYCLES_PER_US);
+        timeout_cycles = MIN(timeout_cycles, auth_cycles);
+    }
 
+    // No irq line of the 522 is wired to the MCU, so the completion is polled.
+    // Each poll is a single 3 byte DMA transaction which also fetches the error flags.
+    uint32_t command_cycles = DWT->CYCCNT;
     do {
-        n = read_register_single(ComIrqReg);                // Read the communication interrupt register to determine whether the current IO task is completed!
-        not_timeout = NO_TIMEOUT_1MS(g_timeout_auto_timer, g_com_timeout_ms);
+        read_register_multi(irq_regs, irq, sizeof(irq));
+        n = irq[0];
+        m_last_transfer_cycles = DWT->CYCCNT - command_cycles;
+        not_timeout = m_last_transfer_cycles <= timeout_cycles || (n & waitFor);
     } while (not_timeout && (!(n & waitFor)));  // Exit conditions: timeout interruption, interrupt with empty command commands
     // NRF_LOG_INFO("N = %02x\n", n);
 
@@ -548,7 +480,7 @@ uint8_t pcd_14a_reader_bytes_transfer_flags(uint8_t Command, uint8_t *pIn, uint8
         if (n & 0x02) {
             // Error occur
             // Read an error logo register BufferOfI CollErr ParityErr ProtocolErr
-            pcd_err_val = read_register_single(ErrorReg);
+            pcd_err_val = irq[1];
             // Detect whether there are abnormalities
             if (pcd_err_val & 0x01) {               // ProtocolErr Error only appears in the following two cases:
                 if (Command == PCD_AUTHENT) {       // During the execution of the MFAUTHENT command, if the number of bytes received by a data stream, the position of the place
@@ -568,6 +500,11 @@ uint8_t pcd_14a_reader_bytes_transfer_flags(uint8_t Command, uint8_t *pIn, uint8
             } else if (pcd_err_val & 0x08) {        // There is a conflict to detect the label
                 NRF_LOG_INFO("Collision tag\n");
                 status = STATUS_HF_COLLISION;
+                // The bits before the collision are valid, the bitwise anticollision goes on from them
+                if ((flags & PCD_TRANSMIT_FLAG_KEEP_COLLISION_DATA) && Command == PCD_TRANSCEIVE &&
+                        pcd_14a_reader_fifo_read(pOut, pOutLenBit, maxOutLenBit) != STATUS_HF_TAG_OK) {
+                    status = STATUS_HF_ERR_STAT;
+                }
             } else {                                // There are other unrepaired abnormalities
                 NRF_LOG_INFO("HF error: 0x%0x2\n", pcd_err_val);
                 status = STATUS_HF_ERR_STAT;
@@ -576,26 +513,8 @@ uint8_t pcd_14a_reader_bytes_transfer_flags(uint8_t Command, uint8_t *pIn, uint8
             // Occasionally occur
             // NRF_LOG_INFO("COM OK\n");
             if (Command == PCD_TRANSCEIVE) {
-                n = read_register_single(FIFOLevelReg);                             // Read the number of bytes saved in FIFO
-                if (n == 0) { n = 1; }
-
-                lastBits = read_register_single(Control522Reg) & 0x07;          // Finally receive the validity of the byte
-
-                if (lastBits) { *pOutLenBit = (n - 1) * 8 + lastBits; } // N -byte number minus 1 (last byte)+ the number of bits of the last bit The total number of data readings read
-                else { *pOutLenBit = n * 8; }                           // Finally received the entire bytes received by the byte valid
-
-                if (*pOutLenBit <= maxOutLenBit) {
-                    // Read all the data in FIFO
-                    read_register_buffer(FIFODataReg, pOut, n);
-                    // Transmission instructions can be considered success when reading normal data!
-                    status = STATUS_HF_TAG_OK;
-                } else {
-                    NRF_LOG_INFO("pcd_14a_reader_bytes_transfer receive response overflow: %d, max = %d\n", *pOutLenBit, maxOutLenBit);
-                    // We can't pass the problem with problems, which is meaningless for the time being
-                    *pOutLenBit = 0;
-                    // Since there is a problem with the data, let's notify the upper layer and inform me
-                    status = STATUS_HF_ERR_STAT;
-                }
+                // Transmission instructions can be considered success when reading normal data!
+                status = pcd_14a_reader_fifo_read(pOut, pOutLenBit, maxOutLenBit);
             } else {
                 // Non -transmitted instructions, the execution is completed without errors and considered success!
                 status = STATUS_HF_TAG_OK;
@@ -603,6 +522,7 @@ uint8_t pcd_14a_reader_bytes_transfer_flags(uint8_t Command, uint8_t *pIn, uint8
         }
     } else {
         status = STATUS_HF_TAG_NO;
+        m_timing.timeouts++;
         // NRF_LOG_INFO("Tag lost(timeout).\n");
     }
 
@@ -613,10 +533,31 @@ uint8_t pcd_14a_reader_bytes_transfer_flags(uint8_t Command, uint8_t *pIn, uint8
         clear_register_mask(Status2Reg, 0x08);
     }
 
+    m_timing.transfers++;
+    m_timing.transfer_cycles += DWT->CYCCNT - start_cycles;
+
     // NRF_LOG_INFO("Com status: %d\n", status);
     return status;
 }
 
+/**
+* @brief  : Get the timing log of the card communication
+* @param  : timing: Buffer for the counters
+*           reset: Clear the counters after reading them
+*/
+void pcd_14a_reader_timing_get(pcd_14a_reader_timing_t *timing, bool reset) {
+    *timing = m_timing;
+    timing->auth_timeout_us = 0;
+    if (m_auth_cycles_max != 0) {
+        uint32_t auth_timeout_us = MAX(m_auth_cycles_max * AUTH_TIMEOUT_FACTOR / CYCLES_PER_US, AUTH_TIMEOUT_MIN_US);
+        timing->auth_timeout_us = MIN(auth_timeout_us, g_com_timeout_ms * 1000);
+    }
+    timing->cycles_per_us = CYCLES_PER_US;
+    if (reset) {
+        memset(&m_timing, 0, sizeof(m_timing));
+    }
+}
+
 /**
 * @brief  : ISO14443-A Fast Select
 * @param  :tag: tag info buffer
@@ -663,55 +604,118 @@ uint8_t pcd_14a_reader_fast_select(picc_14a_tag_t *tag) {
 }
 
 /**
-* @brief  : ISO14443-A Find a card, only execute once!
-* @param  : tag: Buffer that stores card information
-* @retval : Status value hf_tag_ok, success
+* @brief  : Bit oriented anticollision of one cascade level. On a collision the bits received before it are kept,
+*           the colliding bit is taken as 1 and the level is asked again with the known bits, until a single tag answers.
+* @param  : sel: SELECT command of the level
+*           uid_resp: 4 bytes of the level and the BCC
+*           resolve: resolve collisions, else a collision is returned
+* @retval : STATUS_HF_TAG_OK if the level is complete
 */
-uint8_t pcd_14a_reader_scan_once(picc_14a_tag_t *tag) {
-    // The key parameters of initialization
-    if (tag) {
-        tag->uid_len = 0;
-        memset(tag->uid, 0, 10);
-        tag->ats_len = 0;
-    } else {
-        return STATUS_PAR_ERR;  // Finding cards are not allowed to be transmitted to the label information structure
-    }
+static uint8_t pcd_14a_reader_anticoll(uint8_t sel, uint8_t *uid_resp, bool resolve) {
+    uint8_t buffer[7] = { sel };    // SEL, NVB, 4 bytes of the level and BCC
+    uint8_t resp[5];
+    uint8_t known_bits = 0;
+    uint8_t tx_bytes, tx_last_bits, rx_bytes, coll_pos, i;
+    uint16_t len;
+    uint8_t status;
 
-    // wake
-    if (pcd_14a_reader_atqa_request(tag->atqa, NULL, U8ARR_BIT_LEN(tag->atqa)) != STATUS_HF_TAG_OK) {
-        // NRF_LOG_INFO("pcd_14a_reader_atqa_request STATUS_HF_TAG_NO\r\n");
-        return STATUS_HF_TAG_NO;
-    }
+    while (true) {
+        tx_bytes = 2 + known_bits / 8;
+        tx_last_bits = known_bits % 8;
+        buffer[1] = (tx_bytes << 4) | tx_last_bits;     // NVB
+        // RxAlign stores the first bit received right after the last bit sent
+        set_register_mask(BitFramingReg, (tx_last_bits << 4) | tx_last_bits);
+        len = 0;
+        status = pcd_14a_reader_bytes_transfer_flags(PCD_TRANSCEIVE, buffer, tx_bytes + (tx_last_bits > 0), resp, &len,
+                                                     U8ARR_BIT_LEN(resp), PCD_TRANSMIT_FLAG_KEEP_COLLISION_DATA);
+        clear_register_mask(BitFramingReg, (tx_last_bits << 4) | tx_last_bits);
+        if (status != STATUS_HF_TAG_OK && status != STATUS_HF_COLLISION) {
+            return status;
+        }
 
-    uint8_t resp[DEF_FIFO_LENGTH] = {0}; // theoretically. A usual RATS will be much smaller
-    // uint8_t resp_par[MAX_PARITY_SIZE] = {0};
+        // merge the bits received behind the known bits
+        rx_bytes = MIN((len + 7) / 8, sizeof(buffer) - tx_bytes);
+        if (rx_bytes > 0) {
+            buffer[tx_bytes] = (buffer[tx_bytes] & ((1 << tx_last_bits) - 1)) | (resp[0] & (0xFF << tx_last_bits));
+            for (i = 1; i < rx_bytes; i++) {
+                buffer[tx_bytes + i] = resp[i];
+            }
+        }
+        if (status == STATUS_HF_TAG_OK) {
+            memcpy(uid_resp, buffer + 2, 5);
+            return STATUS_HF_TAG_OK;
+        }
+        if (!resolve) {
+            NRF_LOG_INFO("Err at tag collision.\n");
+            return STATUS_HF_COLLISION;
+        }
 
-    uint16_t len;
-    uint8_t status;
+        // CollPos counts from the first bit of the first byte received, 0 means the 32nd bit
+        coll_pos = read_register_single(CollReg);
+        if (coll_pos & 0x20) {
+            // CollPosNotValid, the collision is out of the range CollPos can tell
+            return STATUS_HF_COLLISION;
+        }
+        coll_pos = coll_pos & 0x1F;
+        if (coll_pos == 0) {
+            coll_pos = 32;
+        }
+        coll_pos += (tx_bytes - 2) * 8;
+        if (coll_pos <= known_bits || coll_pos > 32) {
+            // no progress, the tags did not follow the known bits
+            return STATUS_HF_ERR_STAT;
+        }
+        // take the tag which has the colliding bit set
+        known_bits = coll_pos;
+        buffer[2 + (known_bits - 1) / 8] |= 1 << ((known_bits - 1) % 8);
+        NRF_LOG_INFO("Collision at bit %d of level 0x%02x", known_bits, sel);
+    }
+}
+
+/**
+* @brief  : Select a tag through all its cascade levels, after a REQA or WUPA.
+* @param  : tag: Buffer of the tag, filled with the uid, cascade and sak
+*           uid_known: The uid of tag is already known, it is selected without anticollision
+*           resolve: Resolve collisions, @see pcd_14a_reader_anticoll
+* @retval : Status value hf_tag_ok, success
+*/
+static uint8_t pcd_14a_reader_select(picc_14a_tag_t *tag, bool uid_known, bool resolve) {
+    uint8_t resp[DEF_FIFO_LENGTH] = {0};
+    uint8_t cascade_max = uid_known ? (tag->uid_len == 4 ? 1 : tag->uid_len == 7 ? 2 : 3) : 3;
     uint8_t do_cascade = 1;
     uint8_t cascade_level = 0;
+    uint16_t len;
+    uint8_t status;
+
+    if (!uid_known) {
+        tag->uid_len = 0;
+        memset(tag->uid, 0, sizeof(tag->uid));
+    }
 
     // OK we will select at least at cascade 1, lets see if first byte of UID was 0x88 in
     // which case we need to make a cascade 2 request and select - this is a long UID
     // While the UID is not complete, the 3nd bit (from the right) is set in the SAK.
-    for (; do_cascade; cascade_level++) {
+    for (; do_cascade && cascade_level < cascade_max; cascade_level++) {
         // SELECT_* (L1: 0x93, L2: 0x95, L3: 0x97)
-        uint8_t sel_all[]    = { PICC_ANTICOLL1, 0x20 };
         uint8_t sel_uid[]    = { PICC_ANTICOLL1, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
         uint8_t uid_resp[5] = {0}; // UID + original BCC
-        sel_uid[0] = sel_all[0] = PICC_ANTICOLL1 + cascade_level * 2;
+        sel_uid[0] = PICC_ANTICOLL1 + cascade_level * 2;
 
-        // Send anti -collision instruction
-        status = pcd_14a_reader_bytes_transfer(PCD_TRANSCEIVE, sel_all, sizeof(sel_all), resp, &len, U8ARR_BIT_LEN(resp));
-
-        // There is a label collision, we need to solve the collision
-        if (status != STATUS_HF_TAG_OK) {
-            // The collision still has to be collided. Do n't have this during the decryption process.
-            // So do not solve the collision for the time being, but directly inform the user that the user guarantees that there is only one card in the field
-            NRF_LOG_INFO("Err at tag collision.\n");
-            return status;
-        } else {  // no collision, use the response to SELECT_ALL as current uid
-            memcpy(uid_resp, resp, 5); // UID + original BCC
+        if (uid_known) {
+            // The level is known, the tag is selected directly. The other tags do not match and stay out.
+            if (cascade_level < cascade_max - 1) {
+                uid_resp[0] = 0x88;
+                memcpy(uid_resp + 1, tag->uid + cascade_level * 3, 3);
+            } else {
+                memcpy(uid_resp, tag->uid + cascade_level * 3, 4);
+            }
+            uid_resp[4] = uid_resp[0] ^ uid_resp[1] ^ uid_resp[2] ^ uid_resp[3];
+        } else {
+            // Send anti -collision instruction
+            status = pcd_14a_reader_anticoll(sel_uid[0], uid_resp, resolve);
+            if (status != STATUS_HF_TAG_OK) {
+                return status;
+            }
         }
 
         uint8_t uid_resp_len = 4;
@@ -736,7 +740,8 @@ uint8_t pcd_14a_reader_scan_once(picc_14a_tag_t *tag) {
         status = pcd_14a_reader_bytes_transfer(PCD_TRANSCEIVE, sel_uid, sizeof(sel_uid), resp, &len, U8ARR_BIT_LEN(resp));
         if (status != STATUS_HF_TAG_OK) {
             NRF_LOG_INFO("Err at sak receive.\n");
-            return STATUS_HF_ERR_STAT;
+            // no tag has the uid asked for
+            return uid_known ? STATUS_HF_TAG_NO : STATUS_HF_ERR_STAT;
         }
 
         // Sak received by buffer
@@ -745,6 +750,9 @@ uint8_t pcd_14a_reader_scan_once(picc_14a_tag_t *tag) {
         // If UID is 0X88 The beginning of the form shows that the UID is not complete
         // In the next cycle, we need to make an increased level, return to the end of the anti -rushing collision, and complete the level
         do_cascade = (((tag->sak & 0x04) /* && uid_resp[0] == 0x88 */) > 0);
+        if (uid_known) {
+            continue;
+        }
         if (do_cascade) {
             // Remove first byte, 0x88 is not an UID byte, it CT, see page 3 of:
             // http://www.nxp.com/documents/application_note/AN10927.pdf
@@ -757,9 +765,56 @@ uint8_t pcd_14a_reader_scan_once(picc_14a_tag_t *tag) {
         // Copy the UID information of the card to the transmitted structure
         memcpy(tag->uid + (cascade_level * 3), uid_resp, uid_resp_len);
         tag->uid_len += uid_resp_len;
-        // Only 1 2 3 Three types, corresponding 4 7 10 Byte card number
-        // Therefore + 1
-        tag->cascade = cascade_level + 1;
+    }
+    // Only 1 2 3 Three types, corresponding 4 7 10 Byte card number
+    tag->cascade = cascade_level;
+    if (do_cascade) {
+        // the tag asks for more levels than its uid has
+        return STATUS_HF_ERR_STAT;
+    }
+    return STATUS_HF_TAG_OK;
+}
+
+/**
+* @brief  : ISO14443-A Find a card, only execute once!
+*           If a target uid is set, only this tag is selected, even if other tags are in the field.
+* @param  : tag: Buffer that stores card information
+* @retval : Status value hf_tag_ok, success
+*/
+uint8_t pcd_14a_reader_scan_once(picc_14a_tag_t *tag) {
+    // The key parameters of initialization
+    if (tag) {
+        tag->uid_len = 0;
+        memset(tag->uid, 0, 10);
+        tag->ats_len = 0;
+    } else {
+        return STATUS_PAR_ERR;  // Finding cards are not allowed to be transmitted to the label information structure
+    }
+
+    // wake
+    if (pcd_14a_reader_atqa_request(tag->atqa, NULL, U8ARR_BIT_LEN(tag->atqa)) != STATUS_HF_TAG_OK) {
+        // NRF_LOG_INFO("pcd_14a_reader_atqa_request STATUS_HF_TAG_NO\r\n");
+        return STATUS_HF_TAG_NO;
+    }
+
+    uint8_t status;
+    if (m_target_uid_len != 0) {
+        memcpy(tag->uid, m_target_uid, m_target_uid_len);
+        tag->uid_len = m_target_uid_len;
+        status = pcd_14a_reader_select(tag, true, false);
+    } else {
+        // The collision still has to be collided. Do n't have this during the decryption process.
+        // So do not solve the collision for the time being, but directly inform the user that the user guarantees that there is only one card in the field
+        status = pcd_14a_reader_select(tag, false, false);
+    }
+    if (status != STATUS_HF_TAG_OK) {
+        return status;
+    }
+    // Another card may answer slower, it has to earn a shorter auth timeout again
+    if (tag->uid_len != m_auth_uid_len || memcmp(tag->uid, m_auth_uid, tag->uid_len) != 0) {
+        memcpy(m_auth_uid, tag->uid, tag->uid_len);
+        m_auth_uid_len = tag->uid_len;
+        m_auth_cycles_max = 0;
     }
     if (tag->sak & 0x20) {
         // Tag supports 14443-4, sending RATS
@@ -843,22 +898,22 @@ uint8_t pcd_14a_reader_ats_request(uint8_t *pAts, uint16_t *szAts, uint16_t szAt
 }
 
 /**
-* @brief  : Get answering request, type A
-* @param  : PSNR: Card serial number, n -bytes
-* @retval : Status value hf_tag_ok, success
+* @brief  : Send a REQA or WUPA, type A
+* @param  : req: PICC_REQIDL for the idle tags only, PICC_REQALL for the halted tags too
+*           resp: ATQA, zeroed if the ATQA of several tags collided
+* @retval : Status value hf_tag_ok if at least one tag answered
 */
-uint8_t pcd_14a_reader_atqa_request(uint8_t *resp, uint8_t *resp_par, uint16_t resp_max_bit) {
+static uint8_t pcd_14a_reader_request(uint8_t req, uint8_t *resp, uint8_t *resp_par, uint16_t resp_max_bit) {
     uint16_t len = 0;
     uint8_t retry = 0;
     uint8_t status = STATUS_HF_TAG_OK;
-    uint8_t wupa[] = { PICC_REQALL };  // 0x26 - REQA  0x52 - WAKE-UP
 
     // we may need several tries if we did send an unknown command or a wrong authentication before...
     do {
-        // Broadcast for a card, WUPA (0x52) will force response from all cards in the field and Receive the ATQA
-        status = pcd_14a_reader_bits_transfer(wupa, 7, NULL, resp, resp_par, &len, resp_max_bit);
+        // Broadcast for a card and Receive the ATQA
+        status = pcd_14a_reader_bits_transfer(&req, 7, NULL, resp, resp_par, &len, resp_max_bit);
         // NRF_LOG_INFO("pcd_14a_reader_atqa_request len: %d\n", len);
-    } while (len != 16 && (retry++ < 10));
+    } while (len != 16 && status != STATUS_HF_COLLISION && (retry++ < 10));
 
     // normal ATQA It is 2 bytes, that is, 16bit,
     // We need to judge whether the data received is correct
@@ -866,11 +921,67 @@ uint8_t pcd_14a_reader_atqa_request(uint8_t *resp, uint8_t *resp_par, uint16_t r
         // You can confirm that at least one 14A card exists in the current field
         return STATUS_HF_TAG_OK;
     }
+    // Tags with different ATQA answered together, the anticollision tells them apart
+    if (status == STATUS_HF_COLLISION) {
+        memset(resp, 0, resp_max_bit / 8);
+        return STATUS_HF_TAG_OK;
+    }
 
     // No card
     return STATUS_HF_TAG_NO;
 }
 
+/**
+* @brief  : Get answering request, type A
+* @param  : PSNR: Card serial number, n -bytes
+* @retval : Status value hf_tag_ok, success
+*/
+uint8_t pcd_14a_reader_atqa_request(uint8_t *resp, uint8_t *resp_par, uint16_t resp_max_bit) {
+    // WUPA (0x52) will force response from all cards in the field
+    return pcd_14a_reader_request(PICC_REQALL, resp, resp_par, resp_max_bit);
+}
+
+/**
+* @brief  : ISO14443-A Enumerate the tags in the field. Each tag is selected with the bitwise anticollision and halted,
+*           the next REQA is only answered by the tags left. No RATS is sent and the ATQA is zero
+*           if the ATQA of several tags collided.
+* @param  : tag: Buffer for the tag, handed to on_tag
+*           max: Tags to enumerate at most
+*           on_tag: Called for each tag
+*           count: Tags enumerated
+* @retval : Status value hf_tag_ok if at least one tag was enumerated
+*/
+uint8_t pcd_14a_reader_scan_all(picc_14a_tag_t *tag, uint8_t max, pcd_14a_reader_tag_cb_t on_tag, uint8_t *count) {
+    uint8_t status = STATUS_HF_TAG_NO;
+
+    *count = 0;
+    while (*count < max) {
+        tag->ats_len = 0;
+        // the first round also wakes the tags halted before
+        status = pcd_14a_reader_request(*count == 0 ? PICC_REQALL : PICC_REQIDL, tag->atqa, NULL, U8ARR_BIT_LEN(tag->atqa));
+        if (status != STATUS_HF_TAG_OK) {
+            break;
+        }
+        status = pcd_14a_reader_select(tag, false, true);
+        if (status != STATUS_HF_TAG_OK) {
+            break;
+        }
+        pcd_14a_reader_halt_tag();
+        (*count)++;
+        on_tag(tag);
+    }
+    return *count > 0 ? STATUS_HF_TAG_OK : status;
+}
+
+/**
+* @brief  : Set the tag the reader selects, pcd_14a_reader_scan_once then selects it directly by its uid.
+* @param  : uid: 4, 7 or 10 bytes, uid_len 0 selects whichever tag answers again
+*/
+void pcd_14a_reader_target_set(uint8_t *uid, uint8_t uid_len) {
+    memcpy(m_target_uid, uid, uid_len);
+    m_target_uid_len = uid_len;
+}
+
 /**
 * @brief   : Unlock the Gen1a back door card for non -standard M1 operation steps
 *               Note that do not have a card after unlocking.
@@ -962,18 +1073,26 @@ uint16_t pcd_14a_reader_mf1_auth(picc_14a_tag_t *tag, uint8_t type, uint8_t addr
     uint8_t dat_buff[12] = { type, addr };
     uint16_t data_len = 0;
 
+    uint32_t start_cycles = DWT->CYCCNT;
+
     memcpy(&dat_buff[2], pKey, 6);
     get_4byte_tag_uid(tag, &dat_buff[8]);
 
     pcd_14a_reader_bytes_transfer(PCD_AUTHENT, dat_buff, 12, dat_buff, &data_len, U8ARR_BIT_LEN(dat_buff));
 
+    m_timing.auths++;
     // In order to improve compatibility, we directly judge the implementation of the execution PCD_AUTHENT
     // After the instruction, whether the communication plus position in Status2reg is placed.
     if (read_register_single(Status2Reg) & 0x08) {
+        // Learn how long this card takes to answer, @see pcd_14a_reader_bytes_transfer_flags
+        m_auth_cycles_max = MAX(m_auth_cycles_max, m_last_transfer_cycles);
+        m_timing.auths_ok++;
+        m_timing.auth_cycles += DWT->CYCCNT - start_cycles;
         return STATUS_HF_TAG_OK;
     }
 
     // Other situations are considered failure!
+    m_timing.auth_cycles += DWT->CYCCNT - start_cycles;
     return STATUS_MF_ERR_AUTH;
 }
 
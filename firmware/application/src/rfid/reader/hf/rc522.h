@@ -23,6 +23,7 @@
 * flags for pcd_14a_reader_bytes_transfer_flags
 */
 #define PCD_TRANSMIT_FLAG_NO_RESET_MF_CRYPTO1_ON 0x01 // do not clear MFCrypto1On when status != STATUS_HF_TAG_OK
+#define PCD_TRANSMIT_FLAG_KEEP_COLLISION_DATA    0x02 // read the bits received before a collision into pOut
 
 /*
 * isO14443ACommandWord
@@ -168,6 +169,21 @@ typedef struct {
     uint8_t ats_len;  // 14443-4 answer to select size
 } PACKED picc_14a_tag_t;
 
+// Timing log of the card communication, cycles are cpu cycles
+typedef struct {
+    uint64_t transfer_cycles;   // spent in transfers, including the SPI traffic
+    uint64_t auth_cycles;       // spent in auths, successful or not
+    uint32_t transfers;
+    uint32_t auths;
+    uint32_t auths_ok;
+    uint32_t timeouts;          // transfers without an answer of the card
+    uint32_t auth_timeout_us;   // adaptive auth timeout of the current card, 0 if not learned yet
+    uint32_t cycles_per_us;
+} pcd_14a_reader_timing_t;
+
+// called for each tag enumerated by pcd_14a_reader_scan_all, the tag is already halted
+typedef void (*pcd_14a_reader_tag_cb_t)(picc_14a_tag_t *tag);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -180,6 +196,7 @@ void pcd_14a_reader_antenna_off(void);
 
 // Device register
 uint8_t read_register_single(uint8_t Address);
+void read_register_multi(const uint8_t *pAddress, uint8_t *pValues, uint8_t count);
 void write_register_single(uint8_t Address, uint8_t value);
 void clear_register_mask(uint8_t reg, uint8_t mask);
 void set_register_mask(uint8_t reg, uint8_t mask);
@@ -187,6 +204,7 @@ void set_register_mask(uint8_t reg, uint8_t mask);
 // Device communication control
 uint16_t pcd_14a_reader_timeout_get(void);
 void pcd_14a_reader_timeout_set(uint16_t timeout_ms);
+void pcd_14a_reader_timing_get(pcd_14a_reader_timing_t *timing, bool reset);
 
 // Device communication interface
 uint8_t pcd_14a_reader_bytes_transfer(uint8_t Command,
@@ -216,6 +234,8 @@ void pcd_14a_reader_parity_off(void);
 
 // 14443-A tag operation
 uint8_t pcd_14a_reader_scan_auto(picc_14a_tag_t *tag);
+uint8_t pcd_14a_reader_scan_all(picc_14a_tag_t *tag, uint8_t max, pcd_14a_reader_tag_cb_t on_tag, uint8_t *count);
+void pcd_14a_reader_target_set(uint8_t *uid, uint8_t uid_len);
 uint8_t pcd_14a_reader_fast_select(picc_14a_tag_t *tag);
 uint8_t pcd_14a_reader_ats_request(uint8_t *pAts, uint16_t *szAts, uint16_t szAtsBitMax);
 uint8_t pcd_14a_reader_atqa_request(uint8_t *resp, uint8_t *resp_par, uint16_t resp_max_bit);
@@ -15,6 +15,7 @@
 
 #if defined(PROJECT_CHAMELEON_ULTRA)
 #include "rc522.h"
+#include "mf0_toolbox.h"
 #include "mf1_toolbox.h"
 #include "lf_em410x_data.h"
 #include "lf_125khz_radio.h"
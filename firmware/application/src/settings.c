@@ -1,4 +1,5 @@
 #include <stdbool.h>
+#include <string.h>
 #include "crc_utils.h"
 #include "app_status.h"
 #include "settings.h"
@@ -14,6 +15,11 @@ NRF_LOG_MODULE_REGISTER();
 
 static settings_data_t config;
 static uint16_t m_config_crc;
+// The copy of the configuration the queued write reads from, config can change again meanwhile
+static settings_data_t m_config_queued __ALIGN(4);
+static volatile bool m_config_write_queued;
+// A queued write failed, reported by the next save
+static volatile bool m_config_write_failed;
 static bool m_ble_pairing_enable_first_load_value;
 
 static void update_config_crc(void) {
@@ -121,22 +127,49 @@ void settings_load_config(void) {
     m_ble_pairing_enable_first_load_value = config.ble_pairing_enable;
 }
 
+// The queued write of the configuration is done, ctx is the CRC of the configuration written
+static void settings_save_config_done(uint16_t id, uint16_t key, bool success, void *ctx) {
+    m_config_write_queued = false;
+    if (success) {
+        NRF_LOG_INFO("Save config success.");
+        m_config_crc = (uint16_t)(uintptr_t)ctx;
+    } else {
+        // The CRC stays the one of the flash, the next save writes the configuration again
+        NRF_LOG_ERROR("Save config error.");
+        m_config_write_failed = true;
+    }
+}
+
+/**
+ * Queue the write of the configuration if it changed. A queued write that failed since is reported by the next save.
+ */
 uint8_t settings_save_config(void) {
     // We are saving the configuration, we need to calculate the crc code of the current configuration to judge whether the following data is updated
     if (config_did_change()) {    // Before saving, make sure that the configuration has changed
         NRF_LOG_INFO("Save config start.");
-        bool ret = fds_write_sync(FDS_SETTINGS_FILE_ID, FDS_SETTINGS_RECORD_KEY, sizeof(config), (uint8_t *)&config);
-        if (ret) {
-            NRF_LOG_INFO("Save config success.");
-            update_config_crc();
-        } else {
+        // The copy must not change before the previous write of it is done
+        if (m_config_write_queued) {
+            fds_flush_sync();
+        }
+        memcpy(&m_config_queued, &config, sizeof(config));
+        uint16_t crc;
+        calc_14a_crc_lut((uint8_t *)&m_config_queued, sizeof(m_config_queued), (uint8_t *)&crc);
+        m_config_write_queued = true;
+        bool ret = fds_write_async(FDS_SETTINGS_FILE_ID, FDS_SETTINGS_RECORD_KEY, sizeof(m_config_queued), (uint8_t *)&m_config_queued,
+                                   settings_save_config_done, (void *)(uintptr_t)crc);
+        if (!ret) {
             NRF_LOG_ERROR("Save config error.");
+            m_config_write_queued = false;
             return STATUS_FLASH_WRITE_FAIL;
         }
     } else {
         NRF_LOG_INFO("Config did not change.");
     }
 
+    if (m_config_write_failed) {
+        m_config_write_failed = false;
+        return STATUS_FLASH_WRITE_FAIL;
+    }
     return STATUS_SUCCESS;
 }
 
@@ -1,6 +1,7 @@
 #include "usb_main.h"
 #include "syssleep.h"
 #include "dataframe.h"
+#include "netdata.h"
 
 #include "app_usbd.h"
 #include "app_usbd_cdc_acm.h"
@@ -34,6 +35,18 @@ APP_USBD_CDC_ACM_GLOBAL_DEF(m_app_cdc_acm,
                             CDC_ACM_DATA_EPOUT,
                             APP_USBD_CDC_COMM_PROTOCOL_AT_V250);
 
+// Frames waiting for the CDC IN endpoint, the head one is owned by the USB stack until TX_DONE.
+#define USB_CDC_TX_QUEUE_SIZE 2
+
+typedef struct {
+    uint16_t length;
+    uint8_t buffer[NETDATA_FRAME_OVERHEAD + NETDATA_MAX_DATA_LENGTH];
+} usb_cdc_tx_frame_t;
+
+static usb_cdc_tx_frame_t m_tx_queue[USB_CDC_TX_QUEUE_SIZE];
+static volatile uint8_t m_tx_queue_head = 0;
+static volatile uint8_t m_tx_queue_count = 0;
+
 // USB DEFINES END
 
 // USB CODE START
@@ -41,6 +54,26 @@ volatile bool g_usb_connected = false;
 volatile bool g_usb_port_opened = false;
 volatile bool g_usb_led_marquee_enable = true;
 
+/** @brief Drop all the frames waiting to be sent */
+static void usb_cdc_tx_queue_reset(void) {
+    m_tx_queue_head = 0;
+    m_tx_queue_count = 0;
+}
+
+/** @brief Hand the frame at the head of the queue to the CDC class, if any */
+static void usb_cdc_tx_queue_start(void) {
+    if (m_tx_queue_count == 0) {
+        return;
+    }
+    usb_cdc_tx_frame_t *frame = &m_tx_queue[m_tx_queue_head];
+    ret_code_t err_code = app_usbd_cdc_acm_write(&m_app_cdc_acm, frame->buffer, frame->length);
+    if (err_code != NRF_SUCCESS) {
+        // Port closed or endpoint gone, nobody will read the queued frames.
+        NRF_LOG_ERROR("CDC ACM write failed: %d, %d frame(s) dropped", err_code, m_tx_queue_count);
+        usb_cdc_tx_queue_reset();
+    }
+}
+
 /** @brief User event handler @ref app_usbd_cdc_acm_user_ev_handler_t */
 static void cdc_acm_user_ev_handler(app_usbd_class_inst_t const *p_inst, app_usbd_cdc_acm_user_event_t event) {
     static uint8_t cdc_data_buffer[1];
@@ -62,9 +95,17 @@ static void cdc_acm_user_ev_handler(app_usbd_class_inst_t const *p_inst, app_usb
             NRF_LOG_INFO("CDC ACM port closed");
             g_usb_port_opened = false;
             g_usb_led_marquee_enable = true;
+            usb_cdc_tx_queue_reset();
+            // the next client has to negotiate the frame size again
+            data_frame_set_max_length(NETDATA_DEFAULT_DATA_LENGTH);
             break;
 
         case APP_USBD_CDC_ACM_USER_EVT_TX_DONE:
+            if (m_tx_queue_count > 0) {
+                m_tx_queue_head = (m_tx_queue_head + 1) % USB_CDC_TX_QUEUE_SIZE;
+                m_tx_queue_count--;
+                usb_cdc_tx_queue_start();
+            }
             break;
 
         case APP_USBD_CDC_ACM_USER_EVT_RX_DONE: {
@@ -151,9 +192,31 @@ void usb_cdc_init(void) {
     APP_ERROR_CHECK(ret);
 }
 
+/**
+ * @brief Queue a frame for the CDC IN endpoint and return as soon as it is copied,
+ *        the caller can build the next frame while this one is being sent.
+ *        Only waits when all the queue slots are in use, in which case the usbd event queue is pumped
+ *        so that the TX_DONE event of the frame in flight can free its slot.
+ */
 void usb_cdc_write(const void *p_buf, uint16_t length) {
-    ret_code_t err_code = app_usbd_cdc_acm_write(&m_app_cdc_acm, p_buf, length);
-    APP_ERROR_CHECK(err_code);
+    if (length > sizeof(m_tx_queue[0].buffer)) {
+        NRF_LOG_ERROR("CDC ACM frame too long: %d", length);
+        return;
+    }
+    while (m_tx_queue_count == USB_CDC_TX_QUEUE_SIZE && g_usb_port_opened) {
+        app_usbd_event_queue_process();
+    }
+    if (!g_usb_port_opened) {
+        return;
+    }
+    usb_cdc_tx_frame_t *frame = &m_tx_queue[(m_tx_queue_head + m_tx_queue_count) % USB_CDC_TX_QUEUE_SIZE];
+    memcpy(frame->buffer, p_buf, length);
+    frame->length = length;
+    m_tx_queue_count++;
+    if (m_tx_queue_count == 1) {
+        // endpoint idle, otherwise the TX_DONE of the previous frame will start this one
+        usb_cdc_tx_queue_start();
+    }
 }
 
 // override fputc to printf to cdc serial
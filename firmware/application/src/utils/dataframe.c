@@ -1,5 +1,6 @@
 #include "dataframe.h"
 #include "netdata.h"
+#include "crc_utils.h"
 
 #define NRF_LOG_MODULE_NAME data_frame
 #include "nrf_log.h"
@@ -19,13 +20,33 @@ static uint16_t m_data_len;
 static uint8_t *m_data_buffer;
 static volatile bool m_data_completed = false;
 static data_frame_cbk_t m_frame_process_cbk = NULL;
+static uint16_t m_data_max_length = NETDATA_DEFAULT_DATA_LENGTH;
 
-static uint8_t compute_lrc(uint8_t *buf, uint16_t bufsize) {
-    uint8_t lrc = 0x00;
-    for (uint16_t i = 0; i < bufsize; i++) {
-        lrc += buf[i];
-    }
-    return 0x100 - lrc;
+/**
+ * @brief: build the frame head and lrc around the data already placed in frame->data
+ * @param frame: frame buffer, owned by the caller
+ * @param cmd: instructionResponse
+ * @param status:responseStatus
+ * @param data_length: length of the data in frame->data
+ * @return: total length of the frame
+ */
+uint16_t data_frame_wrap(netdata_frame_raw_t *frame, uint16_t cmd, uint16_t status, uint16_t data_length) {
+    netdata_frame_postamble_t *tx_post = (netdata_frame_postamble_t *)((uint8_t *)frame + sizeof(netdata_frame_preamble_t) + data_length);
+    // sof
+    frame->pre.sof = NETDATA_FRAME_SOF;
+    // sof lrc
+    frame->pre.lrc1 = calc_lrc((uint8_t *)&frame->pre, offsetof(netdata_frame_preamble_t, lrc1));
+    // cmd
+    frame->pre.cmd = U16HTONS(cmd);
+    // status
+    frame->pre.status = U16HTONS(status);
+    // data_length
+    frame->pre.len = U16HTONS(data_length);
+    // head lrc
+    frame->pre.lrc2 = calc_lrc((uint8_t *)&frame->pre, offsetof(netdata_frame_preamble_t, lrc2));
+    // data all lrc
+    tx_post->lrc3 = calc_lrc((uint8_t *)&frame->data, data_length);
+    return sizeof(netdata_frame_preamble_t) + data_length + sizeof(netdata_frame_postamble_t);
 }
 
 /**
@@ -40,7 +61,7 @@ data_frame_tx_t *data_frame_make(uint16_t cmd, uint16_t status, uint16_t data_le
         NRF_LOG_ERROR("data_frame_make error, null pointer.");
         return NULL;
     }
-    if (data_length > 512) {
+    if (data_length > NETDATA_MAX_DATA_LENGTH) {
         NRF_LOG_ERROR("data_frame_make error, too much data.");
         return NULL;
     }
@@ -49,27 +70,12 @@ data_frame_tx_t *data_frame_make(uint16_t cmd, uint16_t status, uint16_t data_le
         NRF_LOG_HEXDUMP_INFO(data, data_length);
     }
 
-    netdata_frame_postamble_t *tx_post = (netdata_frame_postamble_t *)((uint8_t *)&m_netdata_frame_tx_buf + sizeof(netdata_frame_preamble_t) + data_length);
-    // sof
-    m_netdata_frame_tx_buf.pre.sof = NETDATA_FRAME_SOF;
-    // sof lrc
-    m_netdata_frame_tx_buf.pre.lrc1 = compute_lrc((uint8_t *)&m_netdata_frame_tx_buf.pre, offsetof(netdata_frame_preamble_t, lrc1));
-    // cmd
-    m_netdata_frame_tx_buf.pre.cmd = U16HTONS(cmd);
-    // status
-    m_netdata_frame_tx_buf.pre.status = U16HTONS(status);
-    // data_length
-    m_netdata_frame_tx_buf.pre.len = U16HTONS(data_length);
-    // head lrc
-    m_netdata_frame_tx_buf.pre.lrc2 = compute_lrc((uint8_t *)&m_netdata_frame_tx_buf.pre, offsetof(netdata_frame_preamble_t, lrc2));
     // data
     if (data_length > 0) {
         memcpy(&m_netdata_frame_tx_buf.data, data, data_length);
     }
     // length out.
-    m_frame_tx_buf_info.length = (sizeof(netdata_frame_preamble_t) + data_length + sizeof(netdata_frame_postamble_t));
-    // data all lrc
-    tx_post->lrc3 = compute_lrc((uint8_t *)&m_netdata_frame_tx_buf.data, data_length);
+    m_frame_tx_buf_info.length = data_frame_wrap(&m_netdata_frame_tx_buf, cmd, status, data_length);
     return (&m_frame_tx_buf_info);
 }
 
@@ -109,14 +115,14 @@ void data_frame_receive(uint8_t *data, uint16_t length) {
                 return;
             }
         } else if (m_data_rx_position == offsetof(netdata_frame_preamble_t, lrc1)) {
-            if (m_netdata_frame_rx_buf.pre.lrc1 != compute_lrc((uint8_t *)&m_netdata_frame_rx_buf.pre, offsetof(netdata_frame_preamble_t, lrc1))) {
+            if (m_netdata_frame_rx_buf.pre.lrc1 != calc_lrc((uint8_t *)&m_netdata_frame_rx_buf.pre, offsetof(netdata_frame_preamble_t, lrc1))) {
                 // not sof lrc byte
                 NRF_LOG_ERROR("Data frame sof lrc error.");
                 data_frame_reset();
                 return;
             }
         } else if (m_data_rx_position == offsetof(netdata_frame_preamble_t, lrc2)) {  // frame head lrc
-            if (m_netdata_frame_rx_buf.pre.lrc2 != compute_lrc((uint8_t *)&m_netdata_frame_rx_buf.pre, offsetof(netdata_frame_preamble_t, lrc2))) {
+            if (m_netdata_frame_rx_buf.pre.lrc2 != calc_lrc((uint8_t *)&m_netdata_frame_rx_buf.pre, offsetof(netdata_frame_preamble_t, lrc2))) {
                 // frame head lrc error
                 NRF_LOG_ERROR("Data frame head lrc error.");
                 data_frame_reset();
@@ -137,7 +143,7 @@ void data_frame_receive(uint8_t *data, uint16_t length) {
             // check all data ready.
             if (m_data_rx_position == (sizeof(netdata_frame_preamble_t) + m_data_len)) {
                 netdata_frame_postamble_t *rx_post = (netdata_frame_postamble_t *)((uint8_t *)&m_netdata_frame_rx_buf + sizeof(netdata_frame_preamble_t) + m_data_len);
-                if (rx_post->lrc3 == compute_lrc((uint8_t *)&m_netdata_frame_rx_buf.data, m_data_len)) {
+                if (rx_post->lrc3 == calc_lrc((uint8_t *)&m_netdata_frame_rx_buf.data, m_data_len)) {
                     // ok, lrc for data is check success.
                     // and we are receive completed
                     m_data_buffer = m_data_len > 0 ? (uint8_t *)&m_netdata_frame_rx_buf.data : NULL;
@@ -183,3 +189,25 @@ void data_frame_process(void) {
 void on_data_frame_complete(data_frame_cbk_t callback) {
     m_frame_process_cbk = callback;
 }
+
+/**
+ * @brief Get the negotiated max length of the data in a response frame
+ */
+uint16_t data_frame_get_max_length(void) {
+    return m_data_max_length;
+}
+
+/**
+ * @brief Set the negotiated max length of the data in a response frame, clamped to the buffer size
+ * @param max_length: max data length accepted by the client and the transport
+ */
+void data_frame_set_max_length(uint16_t max_length) {
+    if (max_length > NETDATA_MAX_DATA_LENGTH) {
+        max_length = NETDATA_MAX_DATA_LENGTH;
+    }
+    if (max_length < NETDATA_DEFAULT_DATA_LENGTH) {
+        max_length = NETDATA_DEFAULT_DATA_LENGTH;
+    }
+    m_data_max_length = max_length;
+    NRF_LOG_INFO("Data frame max length set to %d", max_length);
+}
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "netdata.h"
 
 // Data frame process callback
 typedef void (*data_frame_cbk_t)(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data);
@@ -14,8 +15,12 @@ typedef struct {
 } data_frame_tx_t;
 
 void data_frame_receive(uint8_t *data, uint16_t length);
+void data_frame_reset(void);
 void data_frame_process(void);
 void on_data_frame_complete(data_frame_cbk_t callback);
+uint16_t data_frame_wrap(netdata_frame_raw_t *frame, uint16_t cmd, uint16_t status, uint16_t data_length);
+uint16_t data_frame_get_max_length(void);
+void data_frame_set_max_length(uint16_t max_length);
 
 data_frame_tx_t *data_frame_make(
     uint16_t cmd,
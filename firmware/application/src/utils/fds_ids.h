@@ -25,6 +25,14 @@
  */
 #define FDS_SLOT_TAG_DUMP_FILE_ID_BASE      0x1100
 
+/*
+ * The dump is stored in chunks of TAG_DUMP_CHUNK_SIZE bytes, one record per chunk, so that a save
+ * only rewrites the chunks that changed. Chunk records use key (sense_type << 8) | chunk_index.
+ * A single record under the plain sense_type key is the older layout, still read and converted on the next save.
+ */
+#define FDS_SLOT_TAG_DUMP_CHUNK_KEY(sense_type, chunk)  ((uint16_t)(((sense_type) << 8) | (chunk)))
+#define FDS_SLOT_TAG_DUMP_CHUNK_INDEX(key)              ((key) & 0xFF)
+
 /*
  * Each card slot has two types of data, high and low frequency, so it can get two names
  * FDS file ID follows the card slot, starting from 0x1200 to 0x1207
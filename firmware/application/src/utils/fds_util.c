@@ -1,5 +1,6 @@
 #include "fds_util.h"
 #include "bsp_wdt.h"
+#include "app_util_platform.h"
 
 #define NRF_LOG_MODULE_NAME fds_sync
 #include "nrf_log.h"
@@ -18,6 +19,31 @@ static struct {
     bool ignore_pm;     // ignore peer manager records, defaults to true, set to false by fds_wipe
 } fds_operation_info;
 
+// Writes queued by fds_write_async, all of them fit in one save of the slot config, settings and an HF dump
+#define FDS_ASYNC_QUEUE_SIZE        24
+// Garbage collection is started when idle once this many words can be freed, one virtual page
+#define FDS_IDLE_GC_FREEABLE_WORDS  FDS_VIRTUAL_PAGE_SIZE
+
+typedef struct {
+    uint16_t id;
+    uint16_t key;
+    uint16_t length_words;
+    void *buffer;           // NULL to delete the record
+    fds_write_done_cb_t done;
+    void *ctx;
+} fds_async_write_t;
+
+// queued write info, the head write is the one given to FDS
+static struct {
+    fds_async_write_t queue[FDS_ASYNC_QUEUE_SIZE];
+    volatile uint8_t head;
+    volatile uint8_t count;         // queued writes, including the running one
+    volatile bool writing;          // head write is running
+    volatile bool gc_running;       // gc started by the queue or when idle
+    volatile bool gc_done;          // gc already ran for the head write
+    volatile bool stat_changed;     // records changed since the last idle gc check
+} fds_async_info;
+
 
 /**
  *The query record exists, and get the handle of the record
@@ -41,6 +67,7 @@ static bool fds_find_record(uint16_t id, uint16_t key, fds_record_desc_t *desc)
  */
 bool fds_is_exists(uint16_t id, uint16_t key) {
     fds_record_desc_t record_desc;
+    fds_flush_sync();
     if (fds_find_record(id, key, &record_desc)) {
         return true;
     }
@@ -57,6 +84,7 @@ bool fds_read_sync(uint16_t id, uint16_t key, uint16_t *length, uint8_t *buffer)
     ret_code_t          err_code;       //The results of the operation
     fds_flash_record_t  flash_record;   // Pointing to the actual information in Flash
     fds_record_desc_t   record_desc;    // Recorded handle
+    fds_flush_sync();                   // The queued writes may update this record
     if (fds_find_record(id, key, &record_desc)) {
         err_code = fds_record_open(&record_desc, &flash_record);            //Open the record so that it is marked as the open state
         APP_ERROR_CHECK(err_code);
@@ -109,6 +137,8 @@ static ret_code_t fds_write_record_nogc(uint16_t id, uint16_t key, uint16_t data
  * Write record
  */
 bool fds_write_sync(uint16_t id, uint16_t key, uint16_t length, void *buffer) {
+    // The queued writes go first
+    fds_flush_sync();
     // Make only one task running
     APP_ERROR_CHECK_BOOL(!fds_operation_info.waiting);
     // write result
@@ -168,6 +198,7 @@ int fds_delete_sync(uint16_t id, uint16_t key) {
     int                 delete_count = 0;
     fds_record_desc_t   record_desc;
     ret_code_t          err_code;
+    fds_flush_sync();
     while (fds_find_record(id, key, &record_desc)) {
         fds_operation_info.success = false;
         fds_record_id_from_desc(&record_desc, &fds_operation_info.record_id);
@@ -188,6 +219,56 @@ static bool is_peer_manager_record(uint16_t id_or_key) {
     return false;
 }
 
+/**
+ * Finish the head write of the queue and notify its owner
+ */
+static void fds_async_done(bool success) {
+    fds_async_write_t op = fds_async_info.queue[fds_async_info.head];
+    fds_async_info.head = (fds_async_info.head + 1) % FDS_ASYNC_QUEUE_SIZE;
+    fds_async_info.count--;
+    fds_async_info.writing = false;
+    fds_async_info.gc_done = false;
+    if (op.done != NULL) {
+        op.done(op.id, op.key, success, op.ctx);
+    }
+}
+
+/**
+ * Give the head write of the queue to FDS, if no write or gc is running.
+ * Called with the FDS event handler masked or from it.
+ */
+static void fds_async_start(void) {
+    while (fds_async_info.count > 0 && !fds_async_info.writing && !fds_async_info.gc_running) {
+        fds_async_write_t *op = &fds_async_info.queue[fds_async_info.head];
+        ret_code_t err_code;
+        if (op->buffer == NULL) {
+            fds_record_desc_t record_desc;
+            if (!fds_find_record(op->id, op->key, &record_desc)) {
+                // nothing to delete
+                fds_async_done(true);
+                continue;
+            }
+            err_code = fds_record_delete(&record_desc);
+        } else {
+            err_code = fds_write_record_nogc(op->id, op->key, op->length_words, op->buffer);
+        }
+        if (err_code == NRF_SUCCESS) {
+            fds_async_info.writing = true;
+        } else if (err_code == FDS_ERR_NO_SPACE_IN_QUEUES || err_code == FDS_ERR_BUSY) {
+            // Peer manager operations fill the queue of FDS, retried on the next event or flush
+            break;
+        } else if (err_code == FDS_ERR_NO_SPACE_IN_FLASH && !fds_async_info.gc_done && fds_gc() == NRF_SUCCESS) {
+            // Same as fds_write_sync, gc once and try again when it is done
+            NRF_LOG_INFO("FDS no space, gc auto start.");
+            fds_async_info.gc_done = true;
+            fds_async_info.gc_running = true;
+        } else {
+            NRF_LOG_ERROR("FDS queued write error: %d", err_code);
+            fds_async_done(false);
+        }
+    }
+}
+
 /**
  *FDS event callback
  */
@@ -208,6 +289,7 @@ static void fds_evt_handler(fds_evt_t const *p_evt) {
         case FDS_EVT_INIT: {
             if (p_evt->result == NRF_SUCCESS) {
                 NRF_LOG_INFO("NRF52 FDS libraries init success.");
+                fds_async_info.stat_changed = true;
             } else {
                 NRF_LOG_INFO("NRF52 FDS libraries init failed");
                 APP_ERROR_CHECK(p_evt->result);
@@ -216,6 +298,18 @@ static void fds_evt_handler(fds_evt_t const *p_evt) {
         break;
         case FDS_EVT_WRITE:
         case FDS_EVT_UPDATE: {
+            fds_async_info.stat_changed = true;
+            if (fds_async_info.writing) {
+                fds_async_write_t *op = &fds_async_info.queue[fds_async_info.head];
+                if (p_evt->write.file_id == op->id && p_evt->write.record_key == op->key) {
+                    if (p_evt->result != NRF_SUCCESS) {
+                        NRF_LOG_ERROR("Queued record change failed: FileID 0x%04x, RecordKey 0x%04x", op->id, op->key);
+                    }
+                    fds_async_done(p_evt->result == NRF_SUCCESS);
+                    fds_async_start();
+                    break;
+                }
+            }
             if (p_evt->result == NRF_SUCCESS) {
                 NRF_LOG_INFO("Record change: FileID 0x%04x, RecordKey 0x%04x", p_evt->write.file_id, p_evt->write.record_key);
                 if (p_evt->write.file_id == fds_operation_info.id && p_evt->write.record_key == fds_operation_info.key) {
@@ -230,6 +324,18 @@ static void fds_evt_handler(fds_evt_t const *p_evt) {
         }
         break;
         case FDS_EVT_DEL_RECORD: {
+            fds_async_info.stat_changed = true;
+            if (fds_async_info.writing) {
+                fds_async_write_t *op = &fds_async_info.queue[fds_async_info.head];
+                if (op->buffer == NULL && p_evt->del.file_id == op->id && p_evt->del.record_key == op->key) {
+                    if (p_evt->result != NRF_SUCCESS) {
+                        NRF_LOG_ERROR("Queued record delete failed: FileID 0x%04x, RecordKey 0x%04x", op->id, op->key);
+                    }
+                    fds_async_done(p_evt->result == NRF_SUCCESS);
+                    fds_async_start();
+                    break;
+                }
+            }
             if (p_evt->result == NRF_SUCCESS) {
                 NRF_LOG_INFO(
                     "Record remove: FileID: 0x%04x, RecordKey: 0x%04x, RecordID: %08x",
@@ -255,6 +361,11 @@ static void fds_evt_handler(fds_evt_t const *p_evt) {
                 NRF_LOG_INFO("FDS gc failed");
                 APP_ERROR_CHECK(p_evt->result);
             }
+            if (fds_async_info.gc_running) {
+                // the queue waited for the gc
+                fds_async_info.gc_running = false;
+                fds_async_start();
+            }
         }
         break;
         default: {
@@ -279,6 +390,7 @@ void fds_util_init() {
 }
 
 void fds_gc_sync(void) {
+    fds_flush_sync();
     fds_operation_info.success = false;
     ret_code_t err_code = fds_gc();
     APP_ERROR_CHECK(err_code);
@@ -287,6 +399,83 @@ void fds_gc_sync(void) {
     };
 }
 
+/**
+ * Add a write or a delete to the queue, waiting for room first
+ */
+static void fds_async_queue(uint16_t id, uint16_t key, uint16_t length_words, void *buffer, fds_write_done_cb_t done, void *ctx) {
+    // wait for room, the writes complete in the FDS event handler
+    while (fds_async_info.count >= FDS_ASYNC_QUEUE_SIZE) {
+        __NOP();
+    }
+    CRITICAL_REGION_ENTER();
+    fds_async_write_t *op = &fds_async_info.queue[(fds_async_info.head + fds_async_info.count) % FDS_ASYNC_QUEUE_SIZE];
+    op->id = id;
+    op->key = key;
+    op->length_words = length_words;
+    op->buffer = buffer;
+    op->done = done;
+    op->ctx = ctx;
+    fds_async_info.count++;
+    fds_async_start();
+    CRITICAL_REGION_EXIT();
+}
+
+/**
+ * Queue a record write and return at once, done is called from the FDS event handler when the record is in flash.
+ * The buffer is not copied and must stay valid until then. The sync functions first wait for the queue,
+ * so a record is never read before its queued write.
+ */
+bool fds_write_async(uint16_t id, uint16_t key, uint16_t length, void *buffer, fds_write_done_cb_t done, void *ctx) {
+    if (length == 0 || buffer == NULL) {
+        return false;
+    }
+    fds_async_queue(id, key, ((length - 1) / 4) + 1, buffer, done, ctx);
+    return true;
+}
+
+/**
+ * Queue the delete of a record after the queued writes and return at once, a record that does not exist is skipped
+ */
+void fds_delete_async(uint16_t id, uint16_t key) {
+    fds_async_queue(id, key, 0, NULL, NULL, NULL);
+}
+
+/**
+ * Wait until the queued writes and a running gc are done
+ */
+void fds_flush_sync(void) {
+    while (fds_async_info.count > 0 || fds_async_info.gc_running) {
+        if (!fds_async_info.writing && !fds_async_info.gc_running) {
+            // the last start found the FDS queue full
+            CRITICAL_REGION_ENTER();
+            fds_async_start();
+            CRITICAL_REGION_EXIT();
+        }
+        __NOP();
+    }
+}
+
+/**
+ * Called from the main loop when idle: start a gc once enough flash can be freed, so that
+ * writes do not have to wait for one. Erasing stalls the CPU, don't call it while emulating.
+ */
+void fds_gc_idle_process(void) {
+    if (!fds_async_info.stat_changed || fds_async_info.count > 0 || fds_async_info.gc_running) {
+        return;
+    }
+    fds_async_info.stat_changed = false;
+    fds_stat_t stat;
+    if (fds_stat(&stat) != NRF_SUCCESS || stat.freeable_words < FDS_IDLE_GC_FREEABLE_WORDS) {
+        return;
+    }
+    NRF_LOG_INFO("FDS idle gc start, %d words freeable.", stat.freeable_words);
+    CRITICAL_REGION_ENTER();
+    if (fds_gc() == NRF_SUCCESS) {
+        fds_async_info.gc_running = true;
+    }
+    CRITICAL_REGION_EXIT();
+}
+
 static bool fds_next_record_delete_sync() {
     fds_find_token_t  tok   = {0};
     fds_record_desc_t desc  = {0};
@@ -315,6 +504,7 @@ static bool fds_next_record_delete_sync() {
 
 bool fds_wipe(void) {
     NRF_LOG_INFO("Full fds wipe requested");
+    fds_flush_sync();
     fds_operation_info.ignore_pm = false;  // wipe should also delete peer manager files.
     while (fds_next_record_delete_sync()) {
         bsp_wdt_feed();
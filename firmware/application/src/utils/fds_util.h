@@ -4,6 +4,9 @@
 #include "fds.h"
 
 
+// Called from the FDS event handler when a queued write is done
+typedef void (*fds_write_done_cb_t)(uint16_t id, uint16_t key, bool success, void *ctx);
+
 bool fds_read_sync(uint16_t id, uint16_t key, uint16_t *length, uint8_t *buffer);
 bool fds_write_sync(uint16_t id, uint16_t key, uint16_t length, void *buffer);
 int fds_delete_sync(uint16_t id, uint16_t key);
@@ -11,5 +14,9 @@ bool fds_is_exists(uint16_t id, uint16_t key);
 void fds_util_init(void);
 void fds_gc_sync(void);
 bool fds_wipe(void);
+bool fds_write_async(uint16_t id, uint16_t key, uint16_t length, void *buffer, fds_write_done_cb_t done, void *ctx);
+void fds_delete_async(uint16_t id, uint16_t key);
+void fds_flush_sync(void);
+void fds_gc_idle_process(void);
 
 #endif
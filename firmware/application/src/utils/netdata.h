@@ -5,7 +5,10 @@
 #include <stdbool.h>
 #include "utils.h"
 
-#define NETDATA_MAX_DATA_LENGTH   512
+// Size of the frame buffers, the largest payload that can ever be negotiated.
+#define NETDATA_MAX_DATA_LENGTH       4096
+// Payload limit used until the client negotiates a larger one, compatible with older clients.
+#define NETDATA_DEFAULT_DATA_LENGTH   512
 
 /*
  * *********************************************************************************************************************************
@@ -17,8 +20,9 @@
  *  SOF(1byte)  LRC(1byte)  CMD(2byte)  Status(2byte)  Data Length(2byte)  Frame Head LRC(1byte)  Data(length)  Frame All LRC(1byte)
  *     0x11       0xEF        cmd(u16)    status(u16)      length(u16)              lrc(u8)          data(u8*)       lrc(u8)
  *
- *  The data length max is 512, frame length is 1 + 1 + 2 + 2 + 2 + 1 + n + 1 = (10 + n)
- *  So, one frame will be between 10 and 522 bytes.
+ *  The data length max is 512 by default and can be negotiated up to NETDATA_MAX_DATA_LENGTH,
+ *  frame length is 1 + 1 + 2 + 2 + 2 + 1 + n + 1 = (10 + n)
+ *  So, one frame will be between 10 and 522 bytes (4106 bytes after negotiation).
  * *********************************************************************************************************************************
  */
 
@@ -39,6 +43,8 @@ typedef struct {
     uint8_t lrc3;
 } PACKED netdata_frame_postamble_t;
 
+#define NETDATA_FRAME_OVERHEAD (sizeof(netdata_frame_preamble_t) + sizeof(netdata_frame_postamble_t))
+
 // For reception and CRC check
 typedef struct {
     netdata_frame_preamble_t pre;
@@ -0,0 +1,53 @@
+#include <stdlib.h>
+
+#include "nrf_drv_rng.h"
+#include "app_util_platform.h"
+
+#include "nonce_pool.h"
+
+
+// Single producer, single consumer ring: the main loop refills it, the NFCT interrupt takes from it.
+// Each side only writes its own index, so no lock is needed.
+static uint32_t m_pool[NONCE_POOL_SIZE];
+static volatile uint16_t m_head = 0;    // written by nonce_pool_refill only
+static volatile uint16_t m_tail = 0;    // written by nonce_pool_get only
+
+
+/**
+ * @brief Top up the pool from the hardware RNG, called from the main loop.
+ *        The RNG belongs to the SoftDevice, which fills its own pool with bias corrected bytes in the background,
+ *        so this only moves the bytes already available and never waits for the RNG.
+ */
+void nonce_pool_refill(void) {
+    uint8_t available;
+    uint32_t nonce;
+
+    while ((uint16_t)(m_head - m_tail) < NONCE_POOL_SIZE) {
+        nrf_drv_rng_bytes_available(&available);
+        if (available < sizeof(nonce) || nrf_drv_rng_rand((uint8_t *)&nonce, sizeof(nonce)) != NRF_SUCCESS) {
+            return;
+        }
+        m_pool[m_head % NONCE_POOL_SIZE] = nonce;
+        // the nonce has to be in the pool before the consumer can see it
+        __DMB();
+        m_head++;
+    }
+}
+
+/**
+ * @brief Take a nonce, cheap enough for the frame delay time of an auth.
+ *        If the readers drain the pool faster than the RNG refills it, rand() is used until it is refilled.
+ */
+uint32_t nonce_pool_get(void) {
+    uint16_t tail = m_tail;
+    uint32_t nonce;
+
+    if (tail == m_head) {
+        return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+    }
+    nonce = m_pool[tail % NONCE_POOL_SIZE];
+    // the nonce has to be read before the producer can overwrite it
+    __DMB();
+    m_tail = tail + 1;
+    return nonce;
+}
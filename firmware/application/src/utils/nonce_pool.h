@@ -0,0 +1,13 @@
+#ifndef NONCE_POOL_H__
+#define NONCE_POOL_H__
+
+#include <stdint.h>
+
+// Nonces kept ready for the emulated tags, a power of 2
+#define NONCE_POOL_SIZE     64
+
+
+void nonce_pool_refill(void);
+uint32_t nonce_pool_get(void);
+
+#endif
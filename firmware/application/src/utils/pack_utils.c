@@ -0,0 +1,120 @@
+#include <string.h>
+
+#include "pack_utils.h"
+
+
+// Copy distances tried by the encoder, short patterns and whole blocks.
+// Only these are searched so packing a dump stays cheap, see pack_encode.
+static const uint16_t m_pack_distances[] = {
+    1, 2, 3, 4,
+    16, 32, 48, 64, 80, 96, 112, 128, 144, 160, 176, 192, 208, 224, 240, 256,
+};
+
+
+/**
+ * Write the pending literals as tokens, returns the new output position or 0 if dst is full
+ */
+static uint16_t pack_flush_literals(const uint8_t *literal, uint16_t count, uint8_t *dst, uint16_t pos, uint16_t dst_size) {
+    while (count > 0) {
+        uint16_t run = count > PACK_LITERAL_MAX ? PACK_LITERAL_MAX : count;
+        if (pos + 1 + run > dst_size) {
+            return 0;
+        }
+        dst[pos++] = run - 1;
+        memcpy(dst + pos, literal, run);
+        pos += run;
+        literal += run;
+        count -= run;
+    }
+    return pos;
+}
+
+/**
+ * Pack src with greedy matching against the distances of m_pack_distances.
+ * A copy may overlap its own output, a run of one byte is a copy from distance 1.
+ */
+uint16_t pack_encode(const uint8_t *src, uint16_t length, uint8_t *dst, uint16_t dst_size) {
+    uint16_t pos = 0;
+    uint16_t literal = 0;
+    uint16_t i = 0;
+    while (i < length) {
+        uint16_t max = length - i;
+        if (max > PACK_COPY_MAX) {
+            max = PACK_COPY_MAX;
+        }
+        uint16_t best_length = 0;
+        uint16_t best_distance = 0;
+        for (uint8_t d = 0; d < sizeof(m_pack_distances) / sizeof(m_pack_distances[0]); d++) {
+            uint16_t distance = m_pack_distances[d];
+            if (distance > i) {
+                break;
+            }
+            const uint8_t *ref = src + i - distance;
+            uint16_t n = 0;
+            while (n < max && ref[n] == src[i + n]) {
+                n++;
+            }
+            if (n > best_length) {
+                best_length = n;
+                best_distance = distance;
+                if (n == max) {
+                    break;
+                }
+            }
+        }
+        if (best_length < PACK_COPY_MIN) {
+            i++;
+            continue;
+        }
+        if (i > literal) {
+            pos = pack_flush_literals(src + literal, i - literal, dst, pos, dst_size);
+            if (pos == 0) {
+                return 0;
+            }
+        }
+        if (pos + 2 > dst_size) {
+            return 0;
+        }
+        dst[pos++] = 0x80 | (best_length - PACK_COPY_MIN);
+        dst[pos++] = best_distance - 1;
+        i += best_length;
+        literal = i;
+    }
+    if (length > literal) {
+        pos = pack_flush_literals(src + literal, length - literal, dst, pos, dst_size);
+    }
+    return pos;
+}
+
+int pack_decode(const uint8_t *src, uint16_t length, uint8_t *dst, uint16_t dst_size) {
+    uint16_t pos = 0;
+    uint16_t i = 0;
+    while (i < length) {
+        uint8_t token = src[i++];
+        if (token < 0x80) {
+            uint16_t run = token + 1;
+            if (i + run > length || pos + run > dst_size) {
+                return -1;
+            }
+            memcpy(dst + pos, src + i, run);
+            i += run;
+            pos += run;
+        } else {
+            if (i >= length) {
+                return -1;
+            }
+            uint16_t run = (token & 0x7F) + PACK_COPY_MIN;
+            uint16_t distance = src[i++] + 1;
+            if (distance > pos || pos + run > dst_size) {
+                return -1;
+            }
+            // byte by byte, the copy may overlap
+            const uint8_t *ref = dst + pos - distance;
+            for (uint16_t n = 0; n < run; n++) {
+                dst[pos + n] = ref[n];
+            }
+            pos += run;
+        }
+    }
+    return pos;
+}
@@ -0,0 +1,32 @@
+#ifndef PACK_UTILS_H__
+#define PACK_UTILS_H__
+
+#include <stdint.h>
+
+/*
+ * Packing of card dumps for flash, a byte oriented LZ77 made for the content of dumps:
+ * runs of the same byte or of short patterns (empty blocks, access conditions) and
+ * whole 16 byte blocks repeated in the dump (sector trailers, empty sectors).
+ *
+ * Tokens:
+ *   0x00 - 0x7F    literal, the next token + 1 bytes are copied as they are
+ *   0x80 - 0xFF    copy of (token & 0x7F) + 3 bytes from the output, the next byte + 1 bytes back
+ */
+
+// Shortest copy, a shorter one does not pay for its two bytes
+#define PACK_COPY_MIN       3
+#define PACK_COPY_MAX       (0x7F + PACK_COPY_MIN)
+#define PACK_LITERAL_MAX    0x80
+#define PACK_DISTANCE_MAX   256
+
+
+/**
+ * Pack length bytes of src into dst, returns the packed length or 0 if it does not fit into dst_size
+ */
+uint16_t pack_encode(const uint8_t *src, uint16_t length, uint8_t *dst, uint16_t dst_size);
+/**
+ * Unpack length bytes of src into dst, returns the unpacked length or -1 if src is not valid or dst is too small
+ */
+int pack_decode(const uint8_t *src, uint16_t length, uint8_t *dst, uint16_t dst_size);
+
+#endif
@@ -0,0 +1,203 @@
+/*
+ * Host test of the LRC of the data frames and of the ISO14443-A CRC (crc_utils.c).
+ *
+ * Built once for each CRC_14A_SLICE_BY, every build has to give the results of the shared vectors file, which the
+ * Python client checks too. Random buffers at every alignment are then compared with a bit by bit reference, and
+ * the cost per byte is measured on the sizes the firmware has: data frames for the LRC, slot buffers for the CRC.
+ *
+ *   crc_test [--no-bench] [vectors/checksums.txt]
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "crc_utils.h"
+
+#define TEST_RAND_SEED      0x20240601
+#include "test_util.h"
+
+
+#define VECTOR_DATA_MAX     8192
+#define VECTOR_LINE_MAX     512
+
+#define FUZZ_BUFFERS        20000
+#define FUZZ_LENGTH_MAX     600
+#define BENCH_BYTES         (64 * 1024 * 1024)
+
+
+
+static uint16_t crc_a_reference(const uint8_t *data, size_t length) {
+    uint16_t crc = 0x6363;
+    while (length--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+static uint8_t lrc_reference(const uint8_t *data, size_t length) {
+    uint8_t sum = 0;
+    while (length--) {
+        sum += *data++;
+    }
+    return 0x100 - sum;
+}
+
+static int parse_hex(const char *text, uint8_t *out, size_t max) {
+    size_t length = strlen(text);
+    if (length % 2 || length / 2 > max) {
+        return -1;
+    }
+    for (size_t i = 0; i < length / 2; i++) {
+        unsigned int value;
+        if (sscanf(&text[i * 2], "%2x", &value) != 1) {
+            return -1;
+        }
+        out[i] = value;
+    }
+    return length / 2;
+}
+
+/**
+ * @brief Data of a vector: hex, '-' for none, or @<length> for the bytes (i * 31 + 7) & 0xFF
+ */
+static int vector_data(const char *text, uint8_t *out, size_t max) {
+    if (strcmp(text, "-") == 0) {
+        return 0;
+    }
+    if (text[0] == '@') {
+        int length = atoi(&text[1]);
+        if (length < 0 || length > max) {
+            return -1;
+        }
+        for (int i = 0; i < length; i++) {
+            out[i] = (i * 31 + 7) & 0xFF;
+        }
+        return length;
+    }
+    return parse_hex(text, out, max);
+}
+
+static bool test_vectors(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        printf("%s: cannot open\r\n", path);
+        return false;
+    }
+    // one byte more, the data is also checked away from the word alignment
+    static uint8_t data[VECTOR_DATA_MAX + 1];
+    char line[VECTOR_LINE_MAX];
+    int number = 0, count = 0, failed = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        number++;
+        char kind[16], text[VECTOR_LINE_MAX], result[16];
+        if (line[0] == '#' || sscanf(line, "%15s %511s %15s", kind, text, result) != 3) {
+            continue;
+        }
+        uint8_t expected[2];
+        int expected_length = parse_hex(result, expected, sizeof(expected));
+        for (int shift = 0; shift < 2; shift++) {
+            int length = vector_data(text, &data[shift], VECTOR_DATA_MAX);
+            bool ok;
+            if (length < 0 || expected_length < 1) {
+                ok = false;
+            } else if (strcmp(kind, "lrc") == 0) {
+                ok = expected_length == 1 && calc_lrc(&data[shift], length) == expected[0];
+            } else if (strcmp(kind, "crc_a") == 0) {
+                uint8_t crc[2];
+                calc_14a_crc_lut(&data[shift], length, crc);
+                ok = expected_length == 2 && memcmp(crc, expected, 2) == 0;
+            } else {
+                ok = false;
+            }
+            if (!ok) {
+                printf("%s:%d: %s %s is not %s\r\n", path, number, kind, text, result);
+                failed++;
+                break;
+            }
+        }
+        count++;
+    }
+    fclose(file);
+    printf("%d vectors, %d failed\r\n", count, failed);
+    return failed == 0 && count > 0;
+}
+
+static bool test_random(void) {
+    static uint8_t buffer[FUZZ_LENGTH_MAX + 8];
+    int failed = 0;
+    for (int i = 0; i < FUZZ_BUFFERS; i++) {
+        int offset = test_rand() % 8;
+        int length = test_rand() % (FUZZ_LENGTH_MAX + 1);
+        for (int j = 0; j < length; j++) {
+            // runs of 0xFF as well, the LRC lanes then take the most they can
+            buffer[offset + j] = (i & 1) ? 0xFF : test_rand();
+        }
+        uint8_t crc[2];
+        calc_14a_crc_lut(&buffer[offset], length, crc);
+        uint16_t expected = crc_a_reference(&buffer[offset], length);
+        if (crc[0] != (expected & 0xFF) || crc[1] != (expected >> 8) ||
+                calc_lrc(&buffer[offset], length) != lrc_reference(&buffer[offset], length)) {
+            failed++;
+        }
+    }
+    printf("%d random buffers, %d failed\r\n", FUZZ_BUFFERS, failed);
+    return failed == 0;
+}
+
+static void bench(void) {
+    // a data frame of the default size and one of the largest, a slot buffer of a MF1 4K
+    static const int sizes[] = { 512, 4096, 4500 };
+    static uint8_t buffer[4500 + 1];
+    for (int i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = test_rand();
+    }
+    // the data of a frame is at an odd address
+    uint8_t *data = &buffer[1];
+    volatile uint32_t sink = 0;
+    for (int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        int loops = BENCH_BYTES / sizes[i];
+        double ns = now_ns();
+        for (int loop = 0; loop < loops; loop++) {
+            sink += lrc_reference(data, sizes[i] - (loop & 1));
+        }
+        double lrc_byte_ns = now_ns() - ns;
+        ns = now_ns();
+        for (int loop = 0; loop < loops; loop++) {
+            sink += calc_lrc(data, sizes[i] - (loop & 1));
+        }
+        double lrc_ns = now_ns() - ns;
+        ns = now_ns();
+        for (int loop = 0; loop < loops; loop++) {
+            uint8_t crc[2];
+            calc_14a_crc_lut(data, sizes[i] - (loop & 1), crc);
+            sink += crc[0];
+        }
+        double crc_ns = now_ns() - ns;
+        printf("%5d bytes  lrc by byte %6.3f  lrc %6.3f  crc_a by %d %6.3f ns/byte\r\n", sizes[i],
+               lrc_byte_ns / BENCH_BYTES, lrc_ns / BENCH_BYTES, CRC_14A_SLICE_BY, crc_ns / BENCH_BYTES);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    bool run_bench = true;
+    const char *path = "vectors/checksums.txt";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--no-bench") == 0) {
+            run_bench = false;
+        } else {
+            path = argv[i];
+        }
+    }
+    printf("crc_a slice by %d\r\n", CRC_14A_SLICE_BY);
+    bool ok = test_vectors(path);
+    ok = test_random() && ok;
+    if (ok && run_bench) {
+        bench();
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,216 @@
+/*
+ * Host test of the two crypto1 engines of the MF1 emulation.
+ *
+ * The emulation uses either the crapto1 engine (mf1_crapto1.c + crypto1_helper.c) or, built with
+ * NFC_MF1_FAST_SIM, the table driven engine of mf1_crypto1.c. Both are run here through the same
+ * authentications and frames of random test vectors, every keystream, encrypted byte and parity bit
+ * has to be the same. The cost per byte of both engines is measured afterwards.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mf1_crypto1.h"
+#include "crypto1_helper.h"
+
+#define TEST_RAND_SEED      0x20231031
+#include "test_util.h"
+
+
+#define TEST_VECTORS    20000
+#define BENCH_FRAMES    200000
+#define FRAME_SIZE      18
+
+
+typedef struct {
+    uint8_t key[6];
+    uint8_t uid[4];
+    uint8_t nt[4];
+    uint8_t nr_enc[4];
+    uint8_t ar_enc[4];
+    uint8_t at[4];
+    uint8_t cmd[4];
+    uint8_t frame[FRAME_SIZE];
+    uint8_t nibble;
+} test_vector_t;
+
+// everything one engine gives back for a test vector
+typedef struct {
+    uint8_t rr[4];
+    uint8_t tr[4];
+    uint8_t nt_enc[4];
+    uint8_t nt_par[4];
+    uint8_t ar[4];
+    uint8_t at[4];
+    uint8_t at_par[4];
+    uint8_t cmd[4];
+    uint8_t frame[FRAME_SIZE];
+    uint8_t frame_par[FRAME_SIZE];
+    uint8_t frame_in[FRAME_SIZE];
+    uint8_t frame_in_par[FRAME_SIZE];
+    uint8_t nibble;
+} test_result_t;
+
+
+
+static uint32_t be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint64_t be48(const uint8_t *p) {
+    return ((uint64_t)be32(p) << 16) | ((uint64_t)p[4] << 8) | p[5];
+}
+
+static void put_be32(uint32_t v, uint8_t *p) {
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+// Same steps as nfc_mf1.c with NFC_MF1_FAST_SIM
+static void run_fast(const test_vector_t *tv, test_result_t *r) {
+    uint8_t key[6], uid[4], nr_enc[4];
+
+    // answers expected from the reader and given by the tag
+    memcpy(r->rr, tv->nt, 4);
+    Crypto1PRNG(r->rr, 64);
+    memcpy(r->tr, r->rr, 4);
+    Crypto1PRNG(r->tr, 32);
+
+    memcpy(key, tv->key, sizeof(key));
+    memcpy(uid, tv->uid, sizeof(uid));
+    // nested authentication, the nonce is sent encrypted
+    memcpy(r->nt_enc, tv->nt, 4);
+    Crypto1SetupNested(key, uid, r->nt_enc, r->nt_par, false);
+
+    // first authentication, the rest of the session continues from it
+    memcpy(key, tv->key, sizeof(key));
+    memcpy(uid, tv->uid, sizeof(uid));
+    uint8_t nt[4];
+    memcpy(nt, tv->nt, sizeof(nt));
+    Crypto1Setup(key, uid, nt);
+    memcpy(nr_enc, tv->nr_enc, sizeof(nr_enc));
+    Crypto1Auth(nr_enc);
+    memcpy(r->ar, tv->ar_enc, 4);
+    Crypto1ByteArray(r->ar, 4);
+    memcpy(r->at, tv->at, 4);
+    Crypto1ByteArrayWithParity(r->at, r->at_par, 4);
+    memcpy(r->cmd, tv->cmd, 4);
+    Crypto1ByteArray(r->cmd, 4);
+    memcpy(r->frame, tv->frame, FRAME_SIZE);
+    Crypto1ByteArrayWithParity(r->frame, r->frame_par, FRAME_SIZE);
+    memcpy(r->frame_in, tv->frame, FRAME_SIZE);
+    Crypto1ByteArrayWithParityHasIn(r->frame_in, r->frame_in_par, FRAME_SIZE);
+    r->nibble = tv->nibble ^ Crypto1Nibble();
+}
+
+// Same steps as nfc_mf1.c without NFC_MF1_FAST_SIM
+static void run_crapto1(const test_vector_t *tv, test_result_t *r) {
+    struct Crypto1State s;
+    uint8_t ks[4], nt[4];
+
+    put_be32(prng_successor(be32(tv->nt), 64), r->rr);
+    put_be32(prng_successor(be32(r->rr), 32), r->tr);
+
+    crypto1_init(&s, be48(tv->key));
+    put_be32(be32(tv->uid) ^ be32(tv->nt), ks);
+    memcpy(nt, tv->nt, sizeof(nt));
+    mf_crypto1_encryptEx(&s, nt, ks, r->nt_enc, 4, r->nt_par);
+
+    crypto1_init(&s, be48(tv->key));
+    crypto1_word(&s, be32(tv->uid) ^ be32(tv->nt), 0);
+    crypto1_word(&s, be32(tv->nr_enc), 1);
+    put_be32(be32(tv->ar_enc) ^ crypto1_word(&s, 0, 0), r->ar);
+    memcpy(r->at, tv->at, 4);
+    mf_crypto1_encrypt(&s, r->at, 4, r->at_par);
+    memcpy(r->cmd, tv->cmd, 4);
+    mf_crypto1_decryptEx(&s, r->cmd, 4, r->cmd);
+    memcpy(r->frame, tv->frame, FRAME_SIZE);
+    mf_crypto1_encrypt(&s, r->frame, FRAME_SIZE, r->frame_par);
+    uint8_t plain[FRAME_SIZE];
+    memcpy(plain, tv->frame, FRAME_SIZE);
+    mf_crypto1_encryptEx(&s, plain, plain, r->frame_in, FRAME_SIZE, r->frame_in_par);
+    r->nibble = mf_crypto1_encrypt4bit(&s, tv->nibble);
+}
+
+static int check_vectors(void) {
+    test_vector_t tv;
+    test_result_t fast, ref;
+    int failed = 0;
+
+    for (int i = 0; i < TEST_VECTORS; i++) {
+        test_rand_bytes((uint8_t *)&tv, sizeof(tv));
+        tv.nibble &= 0x0F;
+        memset(&fast, 0, sizeof(fast));
+        memset(&ref, 0, sizeof(ref));
+        run_fast(&tv, &fast);
+        run_crapto1(&tv, &ref);
+        // the parity arrays hold one bit per byte
+        for (int j = 0; j < FRAME_SIZE; j++) {
+            if (j < 4) {
+                fast.nt_par[j] &= 1;
+                ref.nt_par[j] &= 1;
+                fast.at_par[j] &= 1;
+                ref.at_par[j] &= 1;
+            }
+            fast.frame_par[j] &= 1;
+            ref.frame_par[j] &= 1;
+            fast.frame_in_par[j] &= 1;
+            ref.frame_in_par[j] &= 1;
+        }
+        fast.nibble &= 0x0F;
+        if (memcmp(&fast, &ref, sizeof(fast)) != 0) {
+            if (failed++ < 10) {
+                printf("Vector %d differs, key %012llx\r\n", i, (unsigned long long)be48(tv.key));
+            }
+        }
+    }
+    printf("%d vectors, %d failed\r\n", TEST_VECTORS, failed);
+    return failed;
+}
+
+static void bench_report(const char *name, double ns, uint64_t cycles) {
+    double bytes = (double)BENCH_FRAMES * FRAME_SIZE;
+    if (cycles != 0) {
+        printf("%-8s %6.2f ns/byte %7.1f cycles/byte\r\n", name, ns / bytes, cycles / bytes);
+    } else {
+        printf("%-8s %6.2f ns/byte\r\n", name, ns / bytes);
+    }
+}
+
+// One encrypted READ answer with parity per frame, the hot path of the emulation
+static void bench(void) {
+    uint8_t key[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    uint8_t uid[4] = { 0xDE, 0xAD, 0xBE, 0xEF };
+    uint8_t nt[4] = { 0x01, 0x02, 0x03, 0x04 };
+    uint8_t frame[FRAME_SIZE] = { 0 }, par[FRAME_SIZE];
+    struct Crypto1State s;
+    uint64_t cycles;
+    double ns;
+
+    Crypto1Setup(key, uid, nt);
+    ns = now_ns();
+    cycles = now_cycles();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        Crypto1ByteArrayWithParity(frame, par, FRAME_SIZE);
+    }
+    bench_report("crypto1", now_ns() - ns, now_cycles() - cycles);
+
+    crypto1_init(&s, 0xFFFFFFFFFFFFULL);
+    ns = now_ns();
+    cycles = now_cycles();
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        mf_crypto1_encrypt(&s, frame, FRAME_SIZE, par);
+    }
+    bench_report("crapto1", now_ns() - ns, now_cycles() - cycles);
+}
+
+int main(int argc, char *argv[]) {
+    int failed = check_vectors();
+    if (argc < 2 || strcmp(argv[1], "--no-bench") != 0) {
+        bench();
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,837 @@
+/*
+ * Host simulation of the ISO14443-A tag emulation.
+ *
+ * nfc_14a.c, nfc_mf1.c and nfc_mf0_ntag.c are built against the headers of ./stub, the NFCT registers are a plain
+ * struct. A scripted reader raises the NFCT events of nfc_tag_14a_event_callback frame by frame, checks every answer
+ * of the tag and measures how long the emulation takes to prepare it. On the device this time has to fit in the
+ * frame delay time, about 86 us after the end of the reader frame. The figures here are host cycles, they compare
+ * two builds of the emulation but are not nRF52840 cycles.
+ *
+ *   emu_test [--repeat N] script.txt ...
+ *
+ * Script lines, '#' starts a comment:
+ *   tag <type>                     factory data of mf1_mini, mf1_1k, mf1_2k, mf1_4k, ntag210, ntag212, ntag213,
+ *                                  ntag215, ntag216, ul, ul_c, ul_ev1_11 or ul_ev1_21
+ *   uid <hex>                      UID of 4, 7 or 10 bytes
+ *   block <n> <hex>                content of a block (MF1) or of a page (MF0/NTAG)
+ *   field on|off
+ *   trace on|off                   14a trace of the frames, every send then checks the reader frame is traced
+ *                                  before the answer of the tag
+ *   send <hex>[/bits] [crc]        plain frame of the reader, crc appends the CRC_A
+ *   expect <hex>[/bits] [crc]      answer of the tag to the last send, or 'expect none'
+ *   select | wupa                  REQA or WUPA, then anticollision and select of every cascade level
+ *   halt
+ *   auth a|b <block> <key> [fail]  first or nested authentication, fail if the key is wrong
+ *   read <block> <hex>             encrypted read
+ *   write <block> <hex>
+ *   inc|dec|restore <block> <value>
+ *   transfer <block>
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// The statics of the 14a layer are the NFCT buffers, the simulation fills and reads them like the EasyDMA does
+#include "nfc_14a.c"
+
+#include "mf1_crapto1.h"
+#include "crypto1_helper.h"
+#include "parity.h"
+#include "tag_persistence.h"
+
+#define TEST_RAND_SEED      0x20231107
+#include "test_util.h"
+
+
+#define EMU_FRAME_MAX       64
+#define EMU_LINE_MAX        512
+#define EMU_STATS_MAX       64
+#define EMU_TAG_BUFFER_SIZE 8192
+
+typedef struct {
+    uint8_t data[EMU_FRAME_MAX];
+    uint8_t parity[EMU_FRAME_MAX];
+    uint16_t bits;          // without the parity bits
+} emu_frame_t;
+
+// time the emulation took to answer one kind of frame
+typedef struct {
+    char label[24];
+    uint32_t count;
+    uint64_t cycles_min;
+    uint64_t cycles_sum;
+    double ns_min;
+    double ns_sum;
+    uint64_t insns_min;
+} emu_stat_t;
+
+
+NRF_NFCT_Type g_nfct_mock;
+bool g_is_tag_emulating = false;
+bool g_usb_led_marquee_enable = false;
+
+static uint8_t m_tag_buffer[EMU_TAG_BUFFER_SIZE] __attribute__((aligned(4)));
+static tag_data_buffer_t m_tag_data = { .length = sizeof(m_tag_buffer), .buffer = m_tag_buffer };
+static tag_specific_type_t m_tag_type = TAG_TYPE_UNDEFINED;
+
+// the reader side
+static emu_frame_t m_rx;
+static bool m_rx_valid = false;
+static struct Crypto1State m_reader;
+static bool m_reader_crypto = false;
+static uint32_t m_reader_uid = 0;
+
+static emu_stat_t m_stats[EMU_STATS_MAX];
+static int m_stats_count = 0;
+static int m_perf_fd = -1;
+
+static const char *m_script = "";
+static int m_line = 0;
+
+
+/*
+ * Firmware services the emulation calls
+ */
+uint32_t nonce_pool_get(void) {
+    return test_rand();
+}
+
+uint32_t app_timer_cnt_get(void) {
+    return 0;
+}
+
+void sleep_timer_start(uint32_t time_ms) {
+    (void)time_ms;
+}
+
+void sleep_timer_stop(void) {
+}
+
+void set_slot_light_color(chameleon_rgb_type_t color) {
+    (void)color;
+}
+
+void tag_emulation_mark_dirty(const void *data, uint16_t length) {
+    (void)data;
+    (void)length;
+}
+
+tag_sense_type_t get_sense_type_from_tag_type(tag_specific_type_t type) {
+    (void)type;
+    return TAG_SENSE_HF;
+}
+
+// The factory data is written here instead of flash
+bool tag_dump_write_sync(uint8_t slot, tag_sense_type_t sense_type, uint8_t *buffer, uint16_t length, uint32_t chunk_mask, uint16_t *written) {
+    (void)slot;
+    (void)sense_type;
+    (void)chunk_mask;
+    if (length > sizeof(m_tag_buffer)) {
+        return false;
+    }
+    memcpy(m_tag_buffer, buffer, length);
+    if (written != NULL) {
+        *written = length;
+    }
+    return true;
+}
+
+/*
+ * Measures
+ */
+// Instructions retired in user mode, when the kernel lets us count them
+static void perf_open(void) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    m_perf_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+}
+
+static void perf_start(void) {
+#ifdef __linux__
+    if (m_perf_fd >= 0) {
+        ioctl(m_perf_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(m_perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+static uint64_t perf_stop(void) {
+    uint64_t count = 0;
+#ifdef __linux__
+    if (m_perf_fd >= 0) {
+        ioctl(m_perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(m_perf_fd, &count, sizeof(count)) != sizeof(count)) {
+            count = 0;
+        }
+    }
+#endif
+    return count;
+}
+
+static void stat_add(const char *label, uint64_t cycles, double ns, uint64_t insns) {
+    emu_stat_t *stat = NULL;
+    for (int i = 0; i < m_stats_count; i++) {
+        if (strcmp(m_stats[i].label, label) == 0) {
+            stat = &m_stats[i];
+            break;
+        }
+    }
+    if (stat == NULL) {
+        if (m_stats_count == EMU_STATS_MAX) {
+            return;
+        }
+        stat = &m_stats[m_stats_count++];
+        snprintf(stat->label, sizeof(stat->label), "%s", label);
+        stat->cycles_min = UINT64_MAX;
+        stat->ns_min = 1e30;
+        stat->insns_min = UINT64_MAX;
+    }
+    stat->count++;
+    stat->cycles_sum += cycles;
+    stat->ns_sum += ns;
+    stat->cycles_min = MIN(stat->cycles_min, cycles);
+    stat->ns_min = MIN(stat->ns_min, ns);
+    stat->insns_min = MIN(stat->insns_min, insns);
+}
+
+static void stat_report(void) {
+    printf("%-20s %8s %9s %9s %11s %11s", "frame", "count", "min ns", "avg ns", "min cycles", "avg cycles");
+    printf(m_perf_fd >= 0 ? " %10s\r\n" : "\r\n", "min insns");
+    for (int i = 0; i < m_stats_count; i++) {
+        emu_stat_t *stat = &m_stats[i];
+        printf("%-20s %8u %9.0f %9.0f %11llu %11.0f", stat->label, stat->count, stat->ns_min, stat->ns_sum / stat->count,
+               (unsigned long long)stat->cycles_min, (double)stat->cycles_sum / stat->count);
+        if (m_perf_fd >= 0) {
+            printf(" %10llu", (unsigned long long)stat->insns_min);
+        }
+        printf("\r\n");
+    }
+}
+
+/*
+ * NFCT events
+ */
+static void emu_event(nrfx_nfct_evt_id_t evt_id) {
+    nrfx_nfct_evt_t evt = { .evt_id = evt_id };
+    nfc_tag_14a_event_callback(&evt);
+}
+
+static bool emu_fail(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+static bool emu_fail(const char *format, ...) {
+    va_list args;
+    printf("%s:%d: ", m_script, m_line);
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\r\n");
+    return false;
+}
+
+/**
+ * One frame of the reader, the answer of the tag is in m_rx if m_rx_valid
+ * @param label: the time taken is counted under this name
+ */
+static void emu_transceive(const char *label, const emu_frame_t *tx) {
+    uint16_t bits = tx->bits;
+    if (bits < 9) {
+        m_nfc_rx_buffer[0] = tx->data[0];
+    } else {
+        nfc_tag_14a_wrap_frame(tx->data, bits, tx->parity, m_nfc_rx_buffer);
+        bits += bits / 8;
+    }
+    NRF_NFCT->RXD.AMOUNT = bits;
+    memset((void *)&NRF_NFCT->TXD, 0, sizeof(NRF_NFCT->TXD));
+
+    perf_start();
+    double ns = now_ns();
+    uint64_t cycles = now_cycles();
+    emu_event(NRFX_NFCT_EVT_RX_FRAMEEND);
+    cycles = now_cycles() - cycles;
+    ns = now_ns() - ns;
+    stat_add(label, cycles, ns, perf_stop());
+
+    m_rx_valid = m_is_responded;
+    if (!m_rx_valid) {
+        return;
+    }
+    memset(&m_rx, 0, sizeof(m_rx));
+    bits = NRF_NFCT->TXD.AMOUNT;
+    if (NRF_NFCT->TXD.FRAMECONFIG & NFCT_TXD_FRAMECONFIG_PARITY_Msk) {
+        // the peripheral adds the parity bits and the CRC
+        uint16_t length = bits / 8;
+        memcpy(m_rx.data, m_nfc_tx_buffer, length);
+        if (NRF_NFCT->TXD.FRAMECONFIG & NFCT_TXD_FRAMECONFIG_CRCMODETX_Msk) {
+            calc_14a_crc_lut(m_rx.data, length, &m_rx.data[length]);
+            length += 2;
+        }
+        for (uint16_t i = 0; i < length; i++) {
+            m_rx.parity[i] = oddparity8(m_rx.data[i]);
+        }
+        m_rx.bits = length * 8;
+    } else if (bits < 9) {
+        m_rx.data[0] = m_nfc_tx_buffer[0];
+        m_rx.bits = bits;
+    } else {
+        m_rx.bits = nfc_tag_14a_unwrap_frame(m_nfc_tx_buffer, bits, m_rx.data, m_rx.parity);
+    }
+    emu_event(NRFX_NFCT_EVT_TX_FRAMEEND);
+}
+
+static void frame_plain(emu_frame_t *frame, const uint8_t *data, uint16_t length, bool crc) {
+    memcpy(frame->data, data, length);
+    if (crc) {
+        calc_14a_crc_lut(frame->data, length, &frame->data[length]);
+        length += 2;
+    }
+    for (uint16_t i = 0; i < length; i++) {
+        frame->parity[i] = oddparity8(frame->data[i]);
+    }
+    frame->bits = length * 8;
+}
+
+static void frame_encrypt(emu_frame_t *frame, const uint8_t *data, uint16_t length) {
+    memcpy(frame->data, data, length);
+    calc_14a_crc_lut(frame->data, length, &frame->data[length]);
+    length += 2;
+    mf_crypto1_encrypt(&m_reader, frame->data, length, frame->parity);
+    frame->bits = length * 8;
+}
+
+// Decrypt m_rx in place, the parity bits are checked as well
+static bool rx_decrypt(void) {
+    if (m_rx.bits == 4) {
+        m_rx.data[0] = mf_crypto1_encrypt4bit(&m_reader, m_rx.data[0]);
+        return true;
+    }
+    if (m_rx.bits % 8 != 0) {
+        return emu_fail("encrypted answer of %u bits", m_rx.bits);
+    }
+    for (uint16_t i = 0; i < m_rx.bits / 8; i++) {
+        m_rx.data[i] ^= crypto1_byte(&m_reader, 0x00, 0);
+        if ((filter(m_reader.odd) ^ oddparity8(m_rx.data[i])) != (m_rx.parity[i] & 1)) {
+            return emu_fail("wrong parity bit of the encrypted byte %u", i);
+        }
+    }
+    return true;
+}
+
+static void print_frame(const char *name, const uint8_t *data, uint16_t bits) {
+    printf("  %s", name);
+    for (uint16_t i = 0; i < (bits + 7) / 8; i++) {
+        printf(" %02x", data[i]);
+    }
+    printf(" (%u bits)\r\n", bits);
+}
+
+static bool rx_check(const uint8_t *data, uint16_t bits) {
+    if (!m_rx_valid) {
+        print_frame("expected", data, bits);
+        return emu_fail("no answer");
+    }
+    if (m_rx.bits != bits || memcmp(m_rx.data, data, (bits + 7) / 8) != 0) {
+        print_frame("expected", data, bits);
+        print_frame("got", m_rx.data, m_rx.bits);
+        return emu_fail("wrong answer");
+    }
+    return true;
+}
+
+static bool rx_check_none(void) {
+    if (m_rx_valid) {
+        print_frame("got", m_rx.data, m_rx.bits);
+        return emu_fail("unexpected answer");
+    }
+    return true;
+}
+
+static bool rx_check_ack(void) {
+    uint8_t ack = ACK_VALUE;
+    if (!m_rx_valid || !rx_decrypt()) {
+        return emu_fail("no ACK");
+    }
+    return rx_check(&ack, 4);
+}
+
+// The last send is in the trace as it was sent, then the answer of the tag if there was one
+static bool trace_check(const emu_frame_t *tx) {
+    uint8_t records[2 * (sizeof(nfc_14a_trace_header_t) + MAX_NFC_RX_BUFFER_SIZE)];
+    uint16_t length = nfc_14a_trace_read(records, sizeof(records));
+    nfc_14a_trace_header_t *header = (nfc_14a_trace_header_t *)records;
+    uint16_t bits = U16NTOHS(header->bits);
+    uint16_t bytes = (tx->bits + 7) / 8;
+    if (length < sizeof(*header) + bytes || (bits & NFC_14A_TRACE_FROM_TAG) || (bits & NFC_14A_TRACE_BITS_MASK) != tx->bits ||
+            memcmp(&records[sizeof(*header)], tx->data, bytes) != 0) {
+        return emu_fail("frame of the reader not traced first");
+    }
+    uint16_t next = sizeof(*header) + bytes + ((bits & NFC_14A_TRACE_PARITY) ? (bytes + 7) / 8 : 0);
+    header = (nfc_14a_trace_header_t *)&records[next];
+    if (m_rx_valid ? length <= next || !(U16NTOHS(header->bits) & NFC_14A_TRACE_FROM_TAG) : length != next) {
+        return emu_fail("answer of the tag not traced after the frame of the reader");
+    }
+    return true;
+}
+
+/*
+ * Reader commands
+ */
+static bool emu_select(uint8_t request) {
+    nfc_tag_14a_coll_res_reference_t *coll = m_tag_handler.get_coll_res();
+    uint8_t levels = *coll->size == NFC_TAG_14A_UID_SINGLE_SIZE ? 1 : (*coll->size == NFC_TAG_14A_UID_DOUBLE_SIZE ? 2 : 3);
+    emu_frame_t tx = { .data = { request }, .bits = 7 };
+    m_reader_crypto = false;
+    emu_transceive(request == NFC_TAG_14A_CMD_REQA ? "reqa" : "wupa", &tx);
+    if (!rx_check(coll->atqa, 16)) {
+        return false;
+    }
+    for (uint8_t level = 0; level < levels; level++) {
+        uint8_t cmd[7] = { NFC_TAG_14A_CMD_ANTICOLL_OR_SELECT_1 + level * 2, 0x20 };
+        uint8_t *uid = &cmd[2];
+        if (level + 1 < levels) {
+            uid[0] = NFC_TAG_14A_CASCADE_CT;
+            memcpy(&uid[1], &coll->uid[level * 3], 3);
+        } else {
+            memcpy(uid, &coll->uid[level * 3], 4);
+        }
+        nfc_tag_14a_create_bcc(uid, 4, &uid[4]);
+        frame_plain(&tx, cmd, 2, false);
+        emu_transceive("anticoll", &tx);
+        if (!rx_check(uid, 40)) {
+            return false;
+        }
+        cmd[1] = 0x70;
+        frame_plain(&tx, cmd, 7, true);
+        emu_transceive("select", &tx);
+        if (level + 1 < levels) {
+            if (!rx_check(m_uid_incomplete_sak, 24)) {
+                return false;
+            }
+        } else {
+            uint8_t sak[3] = { coll->sak[0] };
+            calc_14a_crc_lut(sak, 1, &sak[1]);
+            if (!rx_check(sak, 24)) {
+                return false;
+            }
+            m_reader_uid = bytes_to_num(uid, 4);
+        }
+    }
+    return true;
+}
+
+static bool emu_auth(uint8_t key_type, uint8_t block, uint64_t key, bool fail) {
+    uint8_t cmd[2] = { key_type, block };
+    emu_frame_t tx;
+    uint32_t nt;
+
+    if (m_reader_crypto) {
+        // nested, the nonce comes encrypted with the new key
+        frame_encrypt(&tx, cmd, 2);
+        emu_transceive("auth nested", &tx);
+        if (!m_rx_valid || m_rx.bits != 32) {
+            return emu_fail("no nonce");
+        }
+        uint32_t nt_enc = bytes_to_num(m_rx.data, 4);
+        crypto1_init(&m_reader, key);
+        nt = crypto1_word(&m_reader, m_reader_uid ^ nt_enc, 1) ^ nt_enc;
+    } else {
+        frame_plain(&tx, cmd, 2, true);
+        emu_transceive("auth", &tx);
+        if (!m_rx_valid || m_rx.bits != 32) {
+            return emu_fail("no nonce");
+        }
+        nt = bytes_to_num(m_rx.data, 4);
+        crypto1_init(&m_reader, key);
+        crypto1_word(&m_reader, m_reader_uid ^ nt, 0);
+    }
+    m_reader_crypto = false;
+
+    uint8_t nr[4], ar[4];
+    num_to_bytes(test_rand(), 4, nr);
+    num_to_bytes(prng_successor(nt, 64), 4, ar);
+    for (int i = 0; i < 4; i++) {
+        tx.data[i] = crypto1_byte(&m_reader, nr[i], 0) ^ nr[i];
+        tx.parity[i] = filter(m_reader.odd) ^ oddparity8(nr[i]);
+    }
+    for (int i = 0; i < 4; i++) {
+        tx.data[4 + i] = crypto1_byte(&m_reader, 0x00, 0) ^ ar[i];
+        tx.parity[4 + i] = filter(m_reader.odd) ^ oddparity8(ar[i]);
+    }
+    tx.bits = 64;
+    emu_transceive("auth nr ar", &tx);
+    if (fail) {
+        return rx_check_none();
+    }
+    if (!m_rx_valid) {
+        return emu_fail("authentication failed");
+    }
+    uint8_t at[4];
+    num_to_bytes(prng_successor(nt, 96), 4, at);
+    if (!rx_decrypt() || !rx_check(at, 32)) {
+        return false;
+    }
+    m_reader_crypto = true;
+    return true;
+}
+
+static bool emu_read(uint8_t block, const uint8_t *data) {
+    uint8_t cmd[2] = { 0x30, block }, expected[18];
+    emu_frame_t tx;
+    frame_encrypt(&tx, cmd, 2);
+    emu_transceive("read", &tx);
+    if (!m_rx_valid) {
+        return emu_fail("no answer");
+    }
+    memcpy(expected, data, 16);
+    calc_14a_crc_lut(expected, 16, &expected[16]);
+    return rx_decrypt() && rx_check(expected, 144);
+}
+
+static bool emu_write(uint8_t block, const uint8_t *data) {
+    uint8_t cmd[2] = { 0xA0, block };
+    emu_frame_t tx;
+    frame_encrypt(&tx, cmd, 2);
+    emu_transceive("write", &tx);
+    if (!rx_check_ack()) {
+        return false;
+    }
+    frame_encrypt(&tx, data, 16);
+    emu_transceive("write data", &tx);
+    return rx_check_ack();
+}
+
+static bool emu_value(uint8_t op, uint8_t block, int32_t value) {
+    uint8_t cmd[4] = { op, block };
+    emu_frame_t tx;
+    frame_encrypt(&tx, cmd, 2);
+    emu_transceive("value", &tx);
+    if (!rx_check_ack()) {
+        return false;
+    }
+    // little endian, as in the value block
+    for (int i = 0; i < 4; i++) {
+        cmd[i] = (uint32_t)value >> (8 * i);
+    }
+    frame_encrypt(&tx, cmd, 4);
+    emu_transceive("value data", &tx);
+    return rx_check_none();
+}
+
+static bool emu_transfer(uint8_t block) {
+    uint8_t cmd[2] = { 0xB0, block };
+    emu_frame_t tx;
+    frame_encrypt(&tx, cmd, 2);
+    emu_transceive("transfer", &tx);
+    return rx_check_ack();
+}
+
+static bool emu_halt(void) {
+    uint8_t cmd[2] = { NFC_TAG_14A_CMD_HALT, 0x00 };
+    emu_frame_t tx;
+    if (m_reader_crypto) {
+        frame_encrypt(&tx, cmd, 2);
+    } else {
+        frame_plain(&tx, cmd, 2, true);
+    }
+    m_reader_crypto = false;
+    emu_transceive("halt", &tx);
+    return rx_check_none();
+}
+
+/*
+ * Tag set up
+ */
+static const struct {
+    const char *name;
+    tag_specific_type_t type;
+} m_tag_types[] = {
+    { "mf1_mini", TAG_TYPE_MIFARE_Mini },
+    { "mf1_1k", TAG_TYPE_MIFARE_1024 },
+    { "mf1_2k", TAG_TYPE_MIFARE_2048 },
+    { "mf1_4k", TAG_TYPE_MIFARE_4096 },
+    { "ntag210", TAG_TYPE_NTAG_210 },
+    { "ntag212", TAG_TYPE_NTAG_212 },
+    { "ntag213", TAG_TYPE_NTAG_213 },
+    { "ntag215", TAG_TYPE_NTAG_215 },
+    { "ntag216", TAG_TYPE_NTAG_216 },
+    { "ul", TAG_TYPE_MF0ICU1 },
+    { "ul_c", TAG_TYPE_MF0ICU2 },
+    { "ul_ev1_11", TAG_TYPE_MF0UL11 },
+    { "ul_ev1_21", TAG_TYPE_MF0UL21 },
+};
+
+static bool is_mf1(void) {
+    return m_tag_type >= TAG_TYPE_MIFARE_Mini && m_tag_type <= TAG_TYPE_MIFARE_4096;
+}
+
+static bool emu_tag(const char *name) {
+    for (size_t i = 0; i < ARRAYLEN(m_tag_types); i++) {
+        if (strcmp(name, m_tag_types[i].name) != 0) {
+            continue;
+        }
+        m_tag_type = m_tag_types[i].type;
+        memset(m_tag_buffer, 0, sizeof(m_tag_buffer));
+        // the factory of the MF0/NTAG data looks at the type loaded
+        if (is_mf1()) {
+            nfc_tag_mf1_data_loadcb(m_tag_type, &m_tag_data);
+            nfc_tag_mf1_data_factory(0, m_tag_type);
+            nfc_tag_mf1_data_loadcb(m_tag_type, &m_tag_data);
+        } else {
+            nfc_tag_mf0_ntag_data_loadcb(m_tag_type, &m_tag_data);
+            nfc_tag_mf0_ntag_data_factory(0, m_tag_type);
+            nfc_tag_mf0_ntag_data_loadcb(m_tag_type, &m_tag_data);
+        }
+        m_reader_crypto = false;
+        return true;
+    }
+    return emu_fail("unknown tag type %s", name);
+}
+
+// res_coll is the first member of the information of both kinds of tags
+static nfc_tag_14a_coll_res_entity_t *emu_coll_res(void) {
+    return &((nfc_tag_mf1_information_t *)m_tag_buffer)->res_coll;
+}
+
+static uint8_t *emu_block(int block) {
+    if (is_mf1()) {
+        return ((nfc_tag_mf1_information_t *)m_tag_buffer)->memory[block];
+    }
+    return ((nfc_tag_mf0_ntag_information_t *)m_tag_buffer)->memory[block];
+}
+
+/*
+ * Scripts
+ */
+// Hex bytes of s, spaces allowed, "/bits" after them gives the bits of the last byte
+static int parse_hex(const char *s, uint8_t *data, int max, uint16_t *bits) {
+    int length = 0;
+    *bits = 0;
+    while (*s) {
+        if (isspace((unsigned char)*s)) {
+            s++;
+        } else if (*s == '/') {
+            *bits = atoi(s + 1);
+            break;
+        } else if (isxdigit((unsigned char)s[0]) && isxdigit((unsigned char)s[1]) && length < max) {
+            char byte[3] = { s[0], s[1], 0 };
+            data[length++] = strtoul(byte, NULL, 16);
+            s += 2;
+        } else {
+            return -1;
+        }
+    }
+    if (*bits == 0) {
+        *bits = length * 8;
+    }
+    return length;
+}
+
+// Split the words of line, the hex data is the words between the command and the options
+static int split(char *line, char **words, int max) {
+    int count = 0;
+    for (char *word = strtok(line, " \t\r\n"); word != NULL && count < max; word = strtok(NULL, " \t\r\n")) {
+        words[count++] = word;
+    }
+    return count;
+}
+
+// Hex data spread over words[from..to), joined back
+static int parse_words(char **words, int from, int to, uint8_t *data, int max, uint16_t *bits) {
+    char joined[EMU_LINE_MAX] = { 0 };
+    for (int i = from; i < to; i++) {
+        strncat(joined, words[i], sizeof(joined) - strlen(joined) - 1);
+    }
+    return parse_hex(joined, data, max, bits);
+}
+
+static bool run_line(char *line) {
+    char *words[40];
+    uint8_t data[EMU_FRAME_MAX];
+    uint16_t bits;
+    char *comment = strchr(line, '#');
+    if (comment != NULL) {
+        *comment = '\0';
+    }
+    int count = split(line, words, ARRAYLEN(words));
+    if (count == 0) {
+        return true;
+    }
+    const char *cmd = words[0];
+    bool crc = count > 1 && strcmp(words[count - 1], "crc") == 0;
+
+    if (strcmp(cmd, "tag") == 0 && count == 2) {
+        return emu_tag(words[1]);
+    }
+    if (m_tag_type == TAG_TYPE_UNDEFINED) {
+        return emu_fail("no tag yet");
+    }
+    if (strcmp(cmd, "uid") == 0 && count >= 2) {
+        int length = parse_words(words, 1, count, data, sizeof(data), &bits);
+        if (!is_valid_uid_size(length)) {
+            return emu_fail("wrong uid");
+        }
+        memcpy(emu_coll_res()->uid, data, length);
+        emu_coll_res()->size = length;
+        return true;
+    }
+    if (strcmp(cmd, "block") == 0 && count >= 3) {
+        int length = parse_words(words, 2, count, data, sizeof(data), &bits);
+        if (length != (is_mf1() ? NFC_TAG_MF1_DATA_SIZE : NFC_TAG_MF0_NTAG_DATA_SIZE)) {
+            return emu_fail("wrong block size");
+        }
+        memcpy(emu_block(atoi(words[1])), data, length);
+        return true;
+    }
+    if (strcmp(cmd, "field") == 0 && count == 2) {
+        m_reader_crypto = false;
+        emu_event(strcmp(words[1], "on") == 0 ? NRFX_NFCT_EVT_FIELD_DETECTED : NRFX_NFCT_EVT_FIELD_LOST);
+        return true;
+    }
+    if (strcmp(cmd, "send") == 0 && count >= 2) {
+        emu_frame_t tx;
+        char label[24];
+        int length = parse_words(words, 1, crc ? count - 1 : count, data, sizeof(data) - 2, &bits);
+        if (length <= 0) {
+            return emu_fail("wrong frame");
+        }
+        frame_plain(&tx, data, length, crc);
+        if (bits < 8 * length) {
+            tx.bits = bits;
+        }
+        snprintf(label, sizeof(label), "send %02x", data[0]);
+        emu_transceive(label, &tx);
+        return !nfc_14a_trace_is_enable() || trace_check(&tx);
+    }
+    if (strcmp(cmd, "trace") == 0 && count == 2) {
+        nfc_14a_trace_set_enable(strcmp(words[1], "on") == 0);
+        return true;
+    }
+    if (strcmp(cmd, "expect") == 0 && count >= 2) {
+        if (strcmp(words[1], "none") == 0) {
+            return rx_check_none();
+        }
+        int length = parse_words(words, 1, crc ? count - 1 : count, data, sizeof(data) - 2, &bits);
+        if (length <= 0) {
+            return emu_fail("wrong frame");
+        }
+        if (crc) {
+            calc_14a_crc_lut(data, length, &data[length]);
+            bits += 16;
+        }
+        if (!rx_check(data, bits)) {
+            return false;
+        }
+        // the plain answers sent with their parity bits need the odd parity
+        for (uint16_t i = 0; bits >= 9 && i < bits / 8; i++) {
+            if ((m_rx.parity[i] & 1) != oddparity8(m_rx.data[i])) {
+                return emu_fail("wrong parity bit of the byte %u", i);
+            }
+        }
+        return true;
+    }
+    if ((strcmp(cmd, "select") == 0 || strcmp(cmd, "wupa") == 0) && count == 1) {
+        return emu_select(cmd[0] == 's' ? NFC_TAG_14A_CMD_REQA : NFC_TAG_14A_CMD_WUPA);
+    }
+    if (strcmp(cmd, "halt") == 0 && count == 1) {
+        return emu_halt();
+    }
+    if (!is_mf1()) {
+        return emu_fail("unknown command %s", cmd);
+    }
+    if (strcmp(cmd, "auth") == 0 && (count == 4 || count == 5)) {
+        uint8_t key[6];
+        if (parse_hex(words[3], key, sizeof(key), &bits) != sizeof(key)) {
+            return emu_fail("wrong key");
+        }
+        uint8_t key_type = tolower((unsigned char)words[1][0]) == 'b' ? 0x61 : 0x60;
+        return emu_auth(key_type, atoi(words[2]), bytes_to_num(key, 6), count == 5 && strcmp(words[4], "fail") == 0);
+    }
+    if (!m_reader_crypto) {
+        return emu_fail("%s needs an authentication", cmd);
+    }
+    if ((strcmp(cmd, "read") == 0 || strcmp(cmd, "write") == 0) && count >= 3) {
+        if (parse_words(words, 2, count, data, sizeof(data), &bits) != NFC_TAG_MF1_DATA_SIZE) {
+            return emu_fail("wrong block size");
+        }
+        return cmd[0] == 'r' ? emu_read(atoi(words[1]), data) : emu_write(atoi(words[1]), data);
+    }
+    if (strcmp(cmd, "inc") == 0 && count == 3) {
+        return emu_value(0xC1, atoi(words[1]), atoi(words[2]));
+    }
+    if (strcmp(cmd, "dec") == 0 && count == 3) {
+        return emu_value(0xC0, atoi(words[1]), atoi(words[2]));
+    }
+    if (strcmp(cmd, "restore") == 0 && count == 2) {
+        return emu_value(0xC2, atoi(words[1]), 0);
+    }
+    if (strcmp(cmd, "transfer") == 0 && count == 2) {
+        return emu_transfer(atoi(words[1]));
+    }
+    return emu_fail("unknown command %s", cmd);
+}
+
+// Run a script, the first failure stops it
+static bool run_script(const char *path) {
+    char line[EMU_LINE_MAX];
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        printf("%s: cannot open\r\n", path);
+        return false;
+    }
+    m_script = path;
+    m_line = 0;
+    m_tag_type = TAG_TYPE_UNDEFINED;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f) != NULL) {
+        m_line++;
+        ok = run_line(line);
+    }
+    fclose(f);
+    // the next script starts out of the field, without trace
+    emu_event(NRFX_NFCT_EVT_FIELD_LOST);
+    nfc_14a_trace_set_enable(false);
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    int repeat = 100;
+    int first = 1;
+    int failed = 0;
+    if (argc > 2 && strcmp(argv[1], "--repeat") == 0) {
+        repeat = atoi(argv[2]);
+        first = 3;
+    }
+    if (first >= argc || repeat <= 0) {
+        printf("usage: %s [--repeat N] script.txt ...\r\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    perf_open();
+    for (int i = first; i < argc; i++) {
+        bool ok = true;
+        for (int n = 0; ok && n < repeat; n++) {
+            ok = run_script(argv[i]);
+        }
+        printf("%-40s %s\r\n", argv[i], ok ? "ok" : "FAILED");
+        failed += !ok;
+    }
+    printf("\r\n");
+    stat_report();
+    printf("%d scripts, %d failed\r\n", argc - first, failed);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,402 @@
+/*
+ * Host test of the data frame parser (dataframe.c) and of the command dispatch (app_cmd.c).
+ *
+ * app_cmd.c is built against the stand-ins of ./stub/app_cmd_stub.c, every command of the map runs down to its
+ * response, the reader finds no card. Frames go through data_frame_receive and data_frame_process as in the main
+ * loop, the responses come back through usb_cdc_write.
+ *
+ * Without arguments the parser is checked on known frames, then random frames (valid ones for every command of
+ * the map, then mutated ones) are fed and every response has to be a well formed frame of the command sent,
+ * then the frames per second of the parser and of the dispatch are measured for 10 and 512 byte frames, fed a
+ * byte at a time as by the USB CDC and in 244 byte packets as by the BLE NUS.
+ *
+ *   frame_test [--no-bench] [--runs N] [--seed S]
+ *   frame_test input ...           replay inputs, a crash of AFL (afl-fuzz -i seeds -o out build/frame_test @@)
+ *   frame_test --seeds DIR         write a valid frame of every command as seed inputs
+ *
+ * Built with -DFRAME_TEST_LIBFUZZER and -fsanitize=fuzzer (clang), LLVMFuzzerTestOneInput is the libFuzzer target.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// The statics of app_cmd.c are reset between inputs, the device would have rebooted
+#include "app_cmd.c"
+
+#include "app_cmd_stub.h"
+
+#define TEST_RAND_SEED      0x20240518
+#include "test_util.h"
+
+
+#define FRAME_RUNS          20000
+#define BENCH_FRAMES        200000
+#define BLE_PACKET_SIZE     244
+#define SEED_DATA_MAX       64
+
+// requests seen by the dispatch and checks of their responses failed
+static uint32_t m_requests;
+static uint32_t m_failures;
+
+
+static uint8_t lrc(const uint8_t *buf, size_t len) {
+    uint8_t sum = 0;
+    while (len--) {
+        sum += *buf++;
+    }
+    return -sum;
+}
+
+/**
+ * @brief Build a frame the way the client does, independently of data_frame_wrap
+ */
+static size_t frame_build(uint8_t *frame, uint16_t cmd, uint16_t status, uint16_t length, const uint8_t *data) {
+    frame[0] = NETDATA_FRAME_SOF;
+    frame[1] = lrc(frame, 1);
+    frame[2] = cmd >> 8;
+    frame[3] = cmd;
+    frame[4] = status >> 8;
+    frame[5] = status;
+    frame[6] = length >> 8;
+    frame[7] = length;
+    frame[8] = lrc(frame, 8);
+    if (length > 0) {
+        memcpy(&frame[9], data, length);
+    }
+    frame[9 + length] = lrc(&frame[9], length);
+    return NETDATA_FRAME_OVERHEAD + length;
+}
+
+/**
+ * @brief Check a frame sent to the host: head, length and both lrc, for the command being run
+ */
+static bool frame_check_response(const uint8_t *frame, size_t length, uint16_t cmd) {
+    if (length < NETDATA_FRAME_OVERHEAD || frame[0] != NETDATA_FRAME_SOF || frame[1] != lrc(frame, 1) || frame[8] != lrc(frame, 8)) {
+        return false;
+    }
+    uint16_t data_length = (frame[6] << 8) | frame[7];
+    if (data_length > NETDATA_MAX_DATA_LENGTH || length != NETDATA_FRAME_OVERHEAD + data_length) {
+        return false;
+    }
+    return frame[9 + data_length] == lrc(&frame[9], data_length) && ((frame[2] << 8) | frame[3]) == cmd;
+}
+
+static void on_frame(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    m_requests++;
+    uint32_t frames = g_stub_cdc_tx_frames;
+    on_data_frame_received(cmd, status, length, data);
+    // only the last frame of a stream is kept, it carries the final status
+    if (g_stub_cdc_tx_frames == frames || !frame_check_response(g_stub_cdc_tx, g_stub_cdc_tx_length, cmd)) {
+        printf("cmd %u length %u: no or bad response\r\n", cmd, length);
+        m_failures++;
+    }
+}
+
+/**
+ * @brief Power on: flash erased, default settings, parser and dispatch idle
+ */
+static void device_reset(void) {
+    app_cmd_stub_reset();
+    settings_init_config();
+    data_frame_set_max_length(NETDATA_DEFAULT_DATA_LENGTH);
+    // drop a frame left complete by a shutdown without running it
+    on_data_frame_complete(NULL);
+    data_frame_process();
+    data_frame_reset();
+    m_is_streaming = false;
+    m_is_batch_running = false;
+    m_batch_length = 0;
+    m_hf14a_trace_live = false;
+    on_data_frame_complete(on_frame);
+}
+
+/**
+ * @brief Feed bytes as the link receives them, the main loop processes a complete frame after each packet
+ */
+static void feed(const uint8_t *data, size_t length, size_t packet) {
+    if (setjmp(g_stub_shutdown) != 0) {
+        // entered the bootloader
+        device_reset();
+        return;
+    }
+    for (size_t offset = 0; offset < length; offset += packet) {
+        data_frame_receive((uint8_t *)&data[offset], MIN(packet, length - offset));
+        data_frame_process();
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    device_reset();
+    // the first byte picks the packets of the link, USB bytes or BLE packets
+    if (size > 0) {
+        size_t packet = data[0] & 0x80 ? BLE_PACKET_SIZE : 1 + (data[0] & 0x3F);
+        feed(data + 1, size - 1, packet);
+    }
+    if (m_failures > 0) {
+        abort();
+    }
+    return 0;
+}
+
+#ifndef FRAME_TEST_LIBFUZZER
+
+static bool check(bool ok, const char *what) {
+    if (!ok) {
+        printf("FAILED: %s\r\n", what);
+        m_failures++;
+    }
+    return ok;
+}
+
+static uint16_t response_status(void) {
+    return (g_stub_cdc_tx[4] << 8) | g_stub_cdc_tx[5];
+}
+
+static void test_parser(void) {
+    // GET_APP_VERSION as sent by the client
+    static const uint8_t get_version[] = { 0x11, 0xEF, 0x03, 0xE8, 0x00, 0x00, 0x00, 0x00, 0x15, 0x00 };
+    uint8_t frame[sizeof(netdata_frame_raw_t)];
+    uint8_t nick[] = { 0, TAG_SENSE_HF, 'h', 'o', 's', 't' };
+
+    device_reset();
+    feed(get_version, sizeof(get_version), 1);
+    check(m_requests == 1 && g_stub_cdc_tx_frames == 1 && response_status() == STATUS_SUCCESS, "get version, byte by byte");
+    check(g_stub_cdc_tx_length == 12 && g_stub_cdc_tx[9] == APP_FW_VER_MAJOR && g_stub_cdc_tx[10] == APP_FW_VER_MINOR, "version in the response");
+    feed(get_version, sizeof(get_version), sizeof(get_version));
+    check(m_requests == 2 && g_stub_cdc_tx_frames == 2, "get version, whole frame");
+
+    // each lrc wrong, then a good frame is still taken
+    static const int lrc_offsets[] = { 1, 8, 9 };
+    for (int i = 0; i < ARRAY_SIZE(lrc_offsets); i++) {
+        memcpy(frame, get_version, sizeof(get_version));
+        frame[lrc_offsets[i]] ^= 0x01;
+        feed(frame, sizeof(get_version), 1);
+        feed(get_version, sizeof(get_version), 1);
+    }
+    check(m_requests == 5 && g_stub_cdc_tx_frames == 5, "frames with a bad lrc dropped");
+    frame[0] = 0x00;
+    feed(frame, 1, 1);
+    feed(get_version, sizeof(get_version), 1);
+    check(m_requests == 6, "byte before the sof skipped");
+
+    size_t length = frame_build(frame, 0xFFFF, 0, 0, NULL);
+    feed(frame, length, 1);
+    check(response_status() == STATUS_INVALID_CMD, "unknown command");
+    frame_build(frame, DATA_CMD_GET_APP_VERSION, 0, 0, NULL);
+    frame[6] = (NETDATA_MAX_DATA_LENGTH + 1) >> 8;
+    frame[7] = (NETDATA_MAX_DATA_LENGTH + 1) & 0xFF;
+    frame[8] = lrc(frame, 8);
+    feed(frame, 9, 1);
+    feed(get_version, sizeof(get_version), 1);
+    check(m_requests == 8, "data length over the buffer refused");
+
+    length = frame_build(frame, DATA_CMD_SET_SLOT_TAG_NICK, 0, sizeof(nick), nick);
+    feed(frame, length, BLE_PACKET_SIZE);
+    length = frame_build(frame, DATA_CMD_GET_SLOT_TAG_NICK, 0, 2, nick);
+    feed(frame, length, BLE_PACKET_SIZE);
+    check(g_stub_cdc_tx_length == NETDATA_FRAME_OVERHEAD + 4 && memcmp(&g_stub_cdc_tx[9], "host", 4) == 0, "nick saved then read");
+
+    length = frame_build(frame, DATA_CMD_GET_DEVICE_CAPABILITIES, 0, 0, NULL);
+    feed(frame, length, 1);
+    check(g_stub_cdc_tx_length == NETDATA_FRAME_OVERHEAD + ARRAY_SIZE(m_data_cmd_map) * 2, "capabilities list the command map");
+
+    // over BLE the frames are a whole number of notifications, unless that is below the default length: not aligned then
+    static const uint16_t max_lengths[][2] = {
+        { NETDATA_MAX_DATA_LENGTH, 16 * BLE_PACKET_SIZE - NETDATA_FRAME_OVERHEAD },
+        { 1000, 4 * BLE_PACKET_SIZE - NETDATA_FRAME_OVERHEAD },
+        { 700, 700 },
+        { NETDATA_DEFAULT_DATA_LENGTH, NETDATA_DEFAULT_DATA_LENGTH },
+    };
+    g_stub_ble_link = true;
+    for (int i = 0; i < ARRAY_SIZE(max_lengths); i++) {
+        uint8_t request[] = { max_lengths[i][0] >> 8, max_lengths[i][0] & 0xFF };
+        length = frame_build(frame, DATA_CMD_SET_MAX_DATA_LENGTH, 0, sizeof(request), request);
+        feed(frame, length, BLE_PACKET_SIZE);
+        check(data_frame_get_max_length() == max_lengths[i][1] &&
+              ((g_stub_cdc_tx[9] << 8) | g_stub_cdc_tx[10]) == max_lengths[i][1], "max data length aligned over BLE");
+    }
+    g_stub_ble_link = false;
+    data_frame_set_max_length(NETDATA_DEFAULT_DATA_LENGTH);
+
+    // 490 bytes of check keys of sectors as before, the stats follow only when the flags byte asks for them
+    uint8_t check_keys[10 + 6 + 1] = { 0 };
+    reader_mode_enter();
+    length = frame_build(frame, DATA_CMD_MF1_CHECK_KEYS_OF_SECTORS, 0, sizeof(check_keys) - 1, check_keys);
+    feed(frame, length, BLE_PACKET_SIZE);
+    check(g_stub_cdc_tx_length == NETDATA_FRAME_OVERHEAD + 490, "check keys of sectors without stats");
+    check_keys[sizeof(check_keys) - 1] = 0x01;
+    length = frame_build(frame, DATA_CMD_MF1_CHECK_KEYS_OF_SECTORS, 0, sizeof(check_keys), check_keys);
+    feed(frame, length, BLE_PACKET_SIZE);
+    check(g_stub_cdc_tx_length == NETDATA_FRAME_OVERHEAD + 494, "check keys of sectors with stats");
+
+    // the records of a dump are streamed in frames of the max data length, 40 sectors of 68 bytes
+    uint8_t dump[1 + sizeof(mf1_toolbox_check_keys_of_sectors_out_t)] = { 40 };
+    length = frame_build(frame, DATA_CMD_MF1_DUMP, 0, sizeof(dump), dump);
+    uint32_t frames = g_stub_cdc_tx_frames;
+    feed(frame, length, BLE_PACKET_SIZE);
+    check(g_stub_cdc_tx_frames - frames == 6 && g_stub_cdc_tx_length == NETDATA_FRAME_OVERHEAD + 5 * 68, "dump streamed in default frames");
+    uint8_t max_length[] = { NETDATA_MAX_DATA_LENGTH >> 8, NETDATA_MAX_DATA_LENGTH & 0xFF };
+    length = frame_build(frame, DATA_CMD_SET_MAX_DATA_LENGTH, 0, sizeof(max_length), max_length);
+    feed(frame, length, BLE_PACKET_SIZE);
+    length = frame_build(frame, DATA_CMD_MF1_DUMP, 0, sizeof(dump), dump);
+    frames = g_stub_cdc_tx_frames;
+    feed(frame, length, BLE_PACKET_SIZE);
+    check(g_stub_cdc_tx_frames - frames == 1 && g_stub_cdc_tx_length == NETDATA_FRAME_OVERHEAD + 40 * 68, "dump in a single frame of the max length");
+    data_frame_set_max_length(NETDATA_DEFAULT_DATA_LENGTH);
+    tag_mode_enter();
+
+    length = frame_build(frame, DATA_CMD_ENTER_BOOTLOADER, 0, 0, NULL);
+    feed(frame, length, 1);
+    feed(get_version, sizeof(get_version), 1);
+    check(response_status() == STATUS_SUCCESS, "parser idle after the bootloader reset");
+    printf("%-40s %s\r\n", "parser", m_failures ? "FAILED" : "ok");
+}
+
+/**
+ * @brief Random frames: valid ones for the commands of the map, then with bytes changed or cut
+ */
+static void test_random(int runs) {
+    uint8_t data[NETDATA_MAX_DATA_LENGTH];
+    uint8_t input[1 + sizeof(netdata_frame_raw_t)];
+    uint32_t failures = m_failures;
+
+    for (int n = 0; n < runs; n++) {
+        uint16_t cmd = (test_rand() & 7) ? m_data_cmd_map[test_rand() % ARRAY_SIZE(m_data_cmd_map)].cmd : test_rand();
+        // mostly short requests, the processors check the length first
+        uint16_t length = test_rand() & 1 ? test_rand() % 8 : test_rand() % (NETDATA_DEFAULT_DATA_LENGTH + 1);
+        for (int i = 0; i < length; i++) {
+            data[i] = test_rand() & 1 ? test_rand() : test_rand() & 0x0F;
+        }
+        input[0] = test_rand();
+        size_t size = 1 + frame_build(&input[1], cmd, 0, length, data);
+        if (n >= runs / 2) {
+            int changes = 1 + test_rand() % 4;
+            while (changes--) {
+                input[1 + test_rand() % (size - 1)] ^= 1 << (test_rand() & 7);
+            }
+            if (test_rand() & 1) {
+                size = 1 + test_rand() % size;
+            }
+        }
+        m_failures = 0;
+        LLVMFuzzerTestOneInput(input, size);
+        failures += m_failures;
+    }
+    m_failures = failures;
+    printf("%-40s %s\r\n", "random frames", m_failures ? "FAILED" : "ok");
+}
+
+static void on_frame_count(uint16_t cmd, uint16_t status, uint16_t length, uint8_t *data) {
+    m_requests++;
+}
+
+/**
+ * @brief Frames per second of the parser alone or with the dispatch of GET_APP_VERSION
+ */
+static void bench(uint16_t data_length, size_t packet, bool dispatch) {
+    static uint8_t frames[8][sizeof(netdata_frame_raw_t)];
+    uint8_t data[NETDATA_DEFAULT_DATA_LENGTH];
+    size_t length = 0;
+
+    for (int i = 0; i < data_length; i++) {
+        data[i] = test_rand();
+    }
+    for (int i = 0; i < 8; i++) {
+        data[0] = i;
+        length = frame_build(frames[i], DATA_CMD_GET_APP_VERSION, 0, data_length, data);
+    }
+    device_reset();
+    on_data_frame_complete(dispatch ? on_data_frame_received : on_frame_count);
+    m_requests = 0;
+    uint32_t tx_frames = g_stub_cdc_tx_frames;
+    double start = now_ns();
+    for (int n = 0; n < BENCH_FRAMES; n++) {
+        uint8_t *frame = frames[n & 7];
+        for (size_t offset = 0; offset < length; offset += packet) {
+            data_frame_receive(&frame[offset], MIN(packet, length - offset));
+            data_frame_process();
+        }
+    }
+    double elapsed = (now_ns() - start) / 1e9;
+    uint32_t done = dispatch ? g_stub_cdc_tx_frames - tx_frames : m_requests;
+    printf("%5u %6s %-10s %12.0f %10.1f %9.1f\r\n", (unsigned)length, packet == 1 ? "usb" : "ble", dispatch ? "dispatch" : "parser",
+           done / elapsed, length * (double)done / elapsed / 1e6, elapsed * 1e9 / done);
+    check(done == BENCH_FRAMES, "all frames of the benchmark taken");
+}
+
+static int write_seeds(const char *dir) {
+    uint8_t input[1 + sizeof(netdata_frame_raw_t)];
+    uint8_t data[SEED_DATA_MAX] = { 0 };
+    char path[512];
+
+    for (int i = 0; i < ARRAY_SIZE(m_data_cmd_map); i++) {
+        uint16_t cmd = m_data_cmd_map[i].cmd;
+        for (int length = 0; length <= SEED_DATA_MAX; length = length ? length * 4 : 1) {
+            input[0] = 0;
+            size_t size = 1 + frame_build(&input[1], cmd, 0, length, data);
+            snprintf(path, sizeof(path), "%s/%u_%d", dir, cmd, length);
+            FILE *f = fopen(path, "wb");
+            if (f == NULL || fwrite(input, 1, size, f) != size) {
+                perror(path);
+                return EXIT_FAILURE;
+            }
+            fclose(f);
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+static int replay(int argc, char *argv[]) {
+    static uint8_t input[1 << 20];
+    for (int i = 1; i < argc; i++) {
+        FILE *f = fopen(argv[i], "rb");
+        if (f == NULL) {
+            perror(argv[i]);
+            return EXIT_FAILURE;
+        }
+        size_t size = fread(input, 1, sizeof(input), f);
+        fclose(f);
+        LLVMFuzzerTestOneInput(input, size);
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+    bool do_bench = true;
+    int runs = FRAME_RUNS;
+
+    if (argc == 3 && strcmp(argv[1], "--seeds") == 0) {
+        return write_seeds(argv[2]);
+    }
+    if (argc > 1 && strncmp(argv[1], "--", 2) != 0) {
+        return replay(argc, argv);
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--no-bench") == 0) {
+            do_bench = false;
+        } else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            m_seed = strtoul(argv[++i], NULL, 0);
+        } else {
+            printf("usage: %s [--no-bench] [--runs N] [--seed S] | input ... | --seeds DIR\r\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    test_parser();
+    test_random(runs);
+    if (do_bench) {
+        printf("\r\nframe  link  run             frames/s       MB/s  ns/frame\r\n");
+        for (int dispatch = 0; dispatch < 2; dispatch++) {
+            bench(0, 1, dispatch);
+            bench(0, BLE_PACKET_SIZE, dispatch);
+            bench(NETDATA_DEFAULT_DATA_LENGTH - NETDATA_FRAME_OVERHEAD, 1, dispatch);
+            bench(NETDATA_DEFAULT_DATA_LENGTH - NETDATA_FRAME_OVERHEAD, BLE_PACKET_SIZE, dispatch);
+        }
+    }
+    return m_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#endif
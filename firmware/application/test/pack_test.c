@@ -0,0 +1,240 @@
+/*
+ * Host test of the packing of card dumps in flash (pack_utils.c) and report of the ratios it gets.
+ *
+ * Without arguments synthetic dumps (empty MF1 1K and 4K, a used MF1 1K, an NTAG215 and random data)
+ * are packed in chunk records the same way as tag_persistence.c, every chunk has to unpack to the
+ * same data. Random records are unpacked to check the bounds, and the cost of unpacking is measured
+ * since the dump of a slot is unpacked when the slot is loaded.
+ *
+ *   pack_test [--no-bench]
+ *   pack_test dump.bin ...     report the flash used by the chunk records of each dump
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pack_utils.h"
+
+#define TEST_RAND_SEED      0x20231107
+#include "test_util.h"
+
+
+// Same as tag_persistence.h / tag_persistence.c
+#define CHUNK_SIZE          256
+#define CHUNK_HEADER_SIZE   4
+#define DUMP_SIZE_MAX       (32 * CHUNK_SIZE)
+
+#define FUZZ_RECORDS        200000
+#define BENCH_LOOPS         2000
+
+
+typedef struct {
+    size_t raw;         // dump length
+    size_t stored;      // chunk records in flash, words and headers included
+    size_t packed;      // chunks kept packed
+    size_t chunks;
+} pack_report_t;
+
+
+
+/**
+ * Pack a dump in chunks as tag_persistence.c does and unpack every chunk again, returns the number of failed chunks
+ */
+static int pack_dump(const uint8_t *dump, size_t length, pack_report_t *report) {
+    uint8_t record[CHUNK_SIZE], unpacked[CHUNK_SIZE];
+    int failed = 0;
+    memset(report, 0, sizeof(*report));
+    report->raw = length;
+    for (size_t offset = 0; offset < length; offset += CHUNK_SIZE) {
+        uint16_t chunk_length = length - offset < CHUNK_SIZE ? length - offset : CHUNK_SIZE;
+        uint16_t data_length = pack_encode(dump + offset, chunk_length, record, chunk_length - 1);
+        if (data_length > 0) {
+            int n = pack_decode(record, data_length, unpacked, chunk_length);
+            if (n != chunk_length || memcmp(unpacked, dump + offset, chunk_length) != 0) {
+                failed++;
+            }
+            report->packed++;
+        } else {
+            data_length = chunk_length;
+        }
+        report->stored += (CHUNK_HEADER_SIZE + data_length + 3) / 4 * 4;
+        report->chunks++;
+    }
+    return failed;
+}
+
+static void print_report(const char *name, const pack_report_t *report) {
+    printf("%-24s %6zu bytes %6zu in flash %5.1f%%  %zu of %zu chunks packed\r\n", name, report->raw, report->stored,
+           100.0 * report->stored / report->raw, report->packed, report->chunks);
+}
+
+// Sector trailer with the default keys and access conditions
+static void mf1_trailer(uint8_t *block) {
+    static const uint8_t trailer[16] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x07, 0x80, 0x69, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    };
+    memcpy(block, trailer, sizeof(trailer));
+}
+
+static size_t make_mf1(uint8_t *dump, int sectors, bool used) {
+    size_t length = 0;
+    for (int sector = 0; sector < sectors; sector++) {
+        int blocks = sector < 32 ? 4 : 16;
+        memset(dump + length, 0, blocks * 16);
+        if (used) {
+            // random keys and some data blocks, as in a dump of a card in use
+            test_rand_bytes(dump + length, (blocks - 1) * 16 * (test_rand() % 2));
+        }
+        mf1_trailer(dump + length + (blocks - 1) * 16);
+        if (used) {
+            test_rand_bytes(dump + length + (blocks - 1) * 16, 6);
+            test_rand_bytes(dump + length + (blocks - 1) * 16 + 10, 6);
+        }
+        length += blocks * 16;
+    }
+    // manufacturer block
+    test_rand_bytes(dump, 16);
+    return length;
+}
+
+static size_t make_ntag215(uint8_t *dump) {
+    size_t length = 135 * 4;
+    memset(dump, 0, length);
+    test_rand_bytes(dump, 9);
+    // capability container and an empty NDEF TLV
+    dump[12] = 0xE1;
+    dump[13] = 0x10;
+    dump[14] = 0x3E;
+    dump[16] = 0x03;
+    dump[18] = 0xFE;
+    dump[130 * 4 + 2] = 0xBD;
+    dump[131 * 4 + 3] = 0xFF;
+    return length;
+}
+
+static int check_dumps(void) {
+    static uint8_t dump[DUMP_SIZE_MAX];
+    pack_report_t report;
+    int failed = 0;
+
+    failed += pack_dump(dump, make_mf1(dump, 16, false), &report);
+    print_report("MF1 1K empty", &report);
+    failed += pack_dump(dump, make_mf1(dump, 16, true), &report);
+    print_report("MF1 1K used", &report);
+    failed += pack_dump(dump, make_mf1(dump, 40, false), &report);
+    print_report("MF1 4K empty", &report);
+    failed += pack_dump(dump, make_ntag215(dump), &report);
+    print_report("NTAG215", &report);
+    test_rand_bytes(dump, 4096);
+    failed += pack_dump(dump, 4096, &report);
+    print_report("random", &report);
+    if (report.packed != 0 || report.stored != 16 * (CHUNK_HEADER_SIZE + CHUNK_SIZE)) {
+        printf("Random data not kept raw\r\n");
+        failed++;
+    }
+    // every chunk length, patterns that pack at each distance
+    for (uint16_t length = 1; length <= CHUNK_SIZE; length++) {
+        for (int pattern = 0; pattern < 8; pattern++) {
+            uint8_t record[CHUNK_SIZE], unpacked[CHUNK_SIZE];
+            for (uint16_t i = 0; i < length; i++) {
+                dump[i] = (test_rand() % 4 == 0) ? (uint8_t)test_rand() : dump[i >= (1U << pattern) ? i - (1U << pattern) : 0];
+            }
+            uint16_t packed = pack_encode(dump, length, record, sizeof(record));
+            int n = pack_decode(record, packed, unpacked, sizeof(unpacked));
+            if (packed == 0 || n != length || memcmp(unpacked, dump, length) != 0) {
+                if (failed++ < 10) {
+                    printf("Length %d pattern %d differs\r\n", length, pattern);
+                }
+            }
+        }
+    }
+    printf("%d chunks failed\r\n", failed);
+    return failed;
+}
+
+// Records read from a damaged flash must not unpack beyond the chunk
+static int check_fuzz(void) {
+    uint8_t record[CHUNK_SIZE + 16], unpacked[CHUNK_SIZE + 16];
+    int failed = 0;
+    for (int i = 0; i < FUZZ_RECORDS; i++) {
+        uint16_t length = test_rand() % sizeof(record);
+        uint16_t size = test_rand() % CHUNK_SIZE;
+        test_rand_bytes(record, length);
+        memset(unpacked, 0xA5, sizeof(unpacked));
+        int n = pack_decode(record, length, unpacked, size);
+        if (n > size || unpacked[size] != 0xA5) {
+            failed++;
+        }
+    }
+    printf("%d random records, %d failed\r\n", FUZZ_RECORDS, failed);
+    return failed;
+}
+
+// Pack and unpack a used MF1 4K, the largest HF dump
+static void bench(void) {
+    static uint8_t dump[DUMP_SIZE_MAX], records[DUMP_SIZE_MAX], unpacked[CHUNK_SIZE];
+    uint16_t lengths[32];
+    size_t length = make_mf1(dump, 40, true);
+    size_t chunks = (length + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    double ns = now_ns();
+    for (int loop = 0; loop < BENCH_LOOPS; loop++) {
+        for (size_t c = 0; c < chunks; c++) {
+            lengths[c] = pack_encode(dump + c * CHUNK_SIZE, CHUNK_SIZE, records + c * CHUNK_SIZE, CHUNK_SIZE - 1);
+        }
+    }
+    double pack_ns = now_ns() - ns;
+    ns = now_ns();
+    for (int loop = 0; loop < BENCH_LOOPS; loop++) {
+        for (size_t c = 0; c < chunks; c++) {
+            if (lengths[c] > 0) {
+                pack_decode(records + c * CHUNK_SIZE, lengths[c], unpacked, CHUNK_SIZE);
+            }
+        }
+    }
+    double unpack_ns = now_ns() - ns;
+    printf("pack     %6.2f ns/byte\r\n", pack_ns / BENCH_LOOPS / length);
+    printf("unpack   %6.2f ns/byte\r\n", unpack_ns / BENCH_LOOPS / length);
+}
+
+static int report_files(int argc, char *argv[]) {
+    static uint8_t dump[DUMP_SIZE_MAX];
+    pack_report_t report, total = { 0 };
+    int failed = 0;
+    for (int i = 1; i < argc; i++) {
+        FILE *f = fopen(argv[i], "rb");
+        if (f == NULL) {
+            printf("%s: cannot open\r\n", argv[i]);
+            failed++;
+            continue;
+        }
+        size_t length = fread(dump, 1, sizeof(dump), f);
+        fclose(f);
+        if (length == 0) {
+            printf("%s: empty\r\n", argv[i]);
+            continue;
+        }
+        failed += pack_dump(dump, length, &report);
+        print_report(argv[i], &report);
+        total.raw += report.raw;
+        total.stored += report.stored;
+        total.packed += report.packed;
+        total.chunks += report.chunks;
+    }
+    if (argc > 2 && total.raw > 0) {
+        print_report("total", &total);
+    }
+    return failed;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--no-bench") != 0) {
+        return report_files(argc, argv) ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    int failed = check_dumps() + check_fuzz();
+    if (argc < 2) {
+        bench();
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,237 @@
+/*
+ * Host test of the card slots of tag_emulation.c and of the cache of their HF data.
+ *
+ * tag_emulation.c, the MF1/NTAG emulators and tag_persistence.c are built against the flash of ./stub/fds_stub.c,
+ * the LF emulators are stand-ins without data. Slots are switched and their data is changed by the emulators and
+ * as by the commands of the host, then the flash of every slot is checked after tag_emulation_save.
+ *
+ *   slot_test
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tag_emulation.h"
+#include "tag_persistence.h"
+#include "nfc_14a.h"
+#include "nfc_mf1.h"
+#include "lf_tag_em.h"
+#include "lf_tag_hidprox.h"
+#include "hal/nrf_nfct.h"
+#include "fds_ids.h"
+#include "fds_util.h"
+#include "fds_stub.h"
+
+
+#define SLOT_MF1            0       // MF1 1K and EM410X of the factory
+#define SLOT_LF             2       // EM410X only
+#define SLOT_NO_DATA        3       // MF1 1K without data in flash
+#define SLOT_DATA_MAX       4500
+
+static uint32_t m_failures;
+
+
+NRF_NFCT_Type g_nfct_mock;
+bool g_usb_led_marquee_enable = false;
+
+/*
+ * Firmware services of the emulation, the LF emulators have no data
+ */
+uint32_t nonce_pool_get(void) {
+    return 0x01020304;
+}
+
+uint32_t app_timer_cnt_get(void) {
+    return 0;
+}
+
+void sleep_timer_start(uint32_t time_ms) {
+    (void)time_ms;
+}
+
+void sleep_timer_stop(void) {
+}
+
+void set_slot_light_color(chameleon_rgb_type_t color) {
+    (void)color;
+}
+
+void rgb_marquee_reset(void) {
+}
+
+void lf_tag_125khz_sense_switch(bool enable) {
+    (void)enable;
+}
+
+int lf_tag_em410x_data_loadcb(tag_specific_type_t type, tag_data_buffer_t *buffer) {
+    (void)type;
+    (void)buffer;
+    return 0;
+}
+
+int lf_tag_em410x_data_savecb(tag_specific_type_t type, tag_data_buffer_t *buffer) {
+    (void)type;
+    (void)buffer;
+    return 0;
+}
+
+bool lf_tag_em410x_data_factory(uint8_t slot, tag_specific_type_t tag_type) {
+    (void)slot;
+    (void)tag_type;
+    return true;
+}
+
+int lf_tag_hidprox_data_loadcb(tag_specific_type_t type, tag_data_buffer_t *buffer) {
+    return lf_tag_em410x_data_loadcb(type, buffer);
+}
+
+int lf_tag_hidprox_data_savecb(tag_specific_type_t type, tag_data_buffer_t *buffer) {
+    return lf_tag_em410x_data_savecb(type, buffer);
+}
+
+bool lf_tag_hidprox_data_factory(uint8_t slot, tag_specific_type_t tag_type) {
+    return lf_tag_em410x_data_factory(slot, tag_type);
+}
+
+/*
+ * Checks
+ */
+static bool check(bool ok, const char *what) {
+    if (!ok) {
+        printf("FAILED: %s\r\n", what);
+        m_failures++;
+    }
+    return ok;
+}
+
+// The HF data of a slot in flash, its length or 0 if there is none
+static uint16_t slot_flash(uint8_t slot, uint8_t *data) {
+    uint16_t length = SLOT_DATA_MAX;
+    return tag_dump_read_sync(slot, TAG_SENSE_HF, data, &length, NULL) ? length : 0;
+}
+
+// The HF dump of a slot is stored as the chunks of its length, no more
+static bool slot_chunks_exact(uint8_t slot) {
+    static uint8_t data[SLOT_DATA_MAX];
+    uint16_t length = SLOT_DATA_MAX;
+    tag_dump_layout_t layout;
+    fds_slot_record_map_t map;
+    get_fds_map_by_slot_sense_type_for_dump(slot, TAG_SENSE_HF, &map);
+    return tag_dump_read_sync(slot, TAG_SENSE_HF, data, &length, &layout) && !layout.legacy &&
+           layout.chunk_count == TAG_DUMP_CHUNK_COUNT(length) &&
+           !fds_is_exists(map.id, FDS_SLOT_TAG_DUMP_CHUNK_KEY(TAG_SENSE_HF, layout.chunk_count)) &&
+           !fds_is_exists(map.id, map.key);
+}
+
+// A block written as by cmd_processor_mf1_write_emu_block_data
+static void host_write_block(uint8_t block, uint8_t value) {
+    nfc_tag_mf1_information_t *info = (nfc_tag_mf1_information_t *)get_buffer_by_tag_type(TAG_TYPE_MIFARE_4096)->buffer;
+    memset(info->memory[block], value, NFC_TAG_MF1_DATA_SIZE);
+    tag_emulation_mark_dirty(info->memory[block], NFC_TAG_MF1_DATA_SIZE);
+}
+
+static void device_init(void) {
+    fds_stub_reset();
+    tag_emulation_set_slot(SLOT_MF1);
+    tag_emulation_init();
+    tag_emulation_factory_init();
+    tag_emulation_change_type(SLOT_NO_DATA, TAG_TYPE_MIFARE_1024);
+    tag_emulation_save();
+}
+
+// A slot without HF data must not pass the writes of the host or of the emulator on to the slot left
+static void test_slot_without_hf(uint8_t slot, const char *what) {
+    static uint8_t before[SLOT_DATA_MAX], after[SLOT_DATA_MAX];
+    char label[96];
+
+    device_init();
+    uint16_t length = slot_flash(SLOT_MF1, before);
+    snprintf(label, sizeof(label), "%s: factory data of the MF1 slot", what);
+    check(length > 0, label);
+
+    tag_emulation_change_slot(slot, false);
+    host_write_block(1, 0xA5);
+    nfc_tag_mf1_set_gen1a_magic_mode(true);
+    tag_emulation_save();
+
+    snprintf(label, sizeof(label), "%s: MF1 slot unchanged in flash", what);
+    check(slot_flash(SLOT_MF1, after) == length && memcmp(before, after, length) == 0, label);
+
+    // Its cached data is unchanged as well
+    tag_emulation_change_slot(SLOT_MF1, false);
+    snprintf(label, sizeof(label), "%s: MF1 slot unchanged in RAM", what);
+    check(memcmp(get_buffer_by_tag_type(TAG_TYPE_MIFARE_1024)->buffer, before, length) == 0 && !nfc_tag_mf1_is_gen1a_magic_mode(), label);
+    // The slot of a HF type saves what was written while it was in use, as before the cache
+    if (slot == SLOT_LF) {
+        snprintf(label, sizeof(label), "%s: no HF data in flash", what);
+        check(slot_flash(slot, after) == 0, label);
+    }
+}
+
+// The changes of the slot in use and of the slots left are all saved
+static void test_slot_write_back(void) {
+    static uint8_t data[SLOT_DATA_MAX];
+
+    device_init();
+    host_write_block(2, 0x5A);
+    tag_emulation_change_slot(SLOT_LF, false);
+    tag_emulation_change_slot(SLOT_NO_DATA, false);
+    tag_emulation_save();
+    nfc_tag_mf1_information_t *info = (nfc_tag_mf1_information_t *)data;
+    check(slot_flash(SLOT_MF1, data) > 0 && info->memory[2][0] == 0x5A && info->memory[2][15] == 0x5A, "parked slot written back");
+}
+
+// The saves only queue writes and deletes, also when the dump shrinks
+static void test_save_queued(void) {
+    static uint8_t data[SLOT_DATA_MAX];
+
+    device_init();
+    host_write_block(1, 0x11);
+    uint32_t flushes = g_stub_fds_flushes;
+    tag_emulation_save();
+    check(g_stub_fds_flushes == flushes, "save of a changed block waits for no flash operation");
+
+    uint16_t length_1k = slot_flash(SLOT_MF1, data);
+    tag_emulation_change_type(SLOT_MF1, TAG_TYPE_MIFARE_4096);
+    flushes = g_stub_fds_flushes;
+    tag_emulation_save();
+    check(g_stub_fds_flushes == flushes && slot_flash(SLOT_MF1, data) > length_1k, "dump grown by the queued writes");
+    tag_emulation_change_type(SLOT_MF1, TAG_TYPE_MIFARE_1024);
+    flushes = g_stub_fds_flushes;
+    tag_emulation_save();
+    check(g_stub_fds_flushes == flushes && slot_flash(SLOT_MF1, data) == length_1k, "dump shrunk by the queued deletes");
+    check(slot_chunks_exact(SLOT_MF1), "no chunk left after the shrunk dump");
+}
+
+// A dump of the single record layout of the older firmware is converted on its first save with a change
+static void test_save_legacy(void) {
+    static uint8_t before[SLOT_DATA_MAX], after[SLOT_DATA_MAX];
+    fds_slot_record_map_t map;
+
+    device_init();
+    uint16_t length = slot_flash(SLOT_MF1, before);
+    tag_dump_delete_sync(SLOT_MF1, TAG_SENSE_HF);
+    get_fds_map_by_slot_sense_type_for_dump(SLOT_MF1, TAG_SENSE_HF, &map);
+    fds_write_sync(map.id, map.key, length, before);
+    tag_emulation_init();
+    // the record is whole words
+    check(slot_flash(SLOT_MF1, after) == (length + 3) / 4 * 4 && memcmp(before, after, length) == 0, "dump of the older layout read");
+
+    host_write_block(1, 0x22);
+    uint32_t flushes = g_stub_fds_flushes;
+    tag_emulation_save();
+    check(g_stub_fds_flushes == flushes, "conversion of the older layout queued");
+    nfc_tag_mf1_information_t *info = (nfc_tag_mf1_information_t *)after;
+    check(slot_flash(SLOT_MF1, after) == length && info->memory[1][0] == 0x22 && memcmp(before, after, 16) == 0, "dump converted to chunks");
+    check(slot_chunks_exact(SLOT_MF1), "record of the older layout deleted by the next read");
+}
+
+int main(void) {
+    test_slot_without_hf(SLOT_LF, "LF only slot");
+    test_slot_without_hf(SLOT_NO_DATA, "slot without data");
+    test_slot_write_back();
+    test_save_queued();
+    test_save_legacy();
+    printf("%s\r\n", m_failures ? "FAILED" : "slots ok");
+    return m_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
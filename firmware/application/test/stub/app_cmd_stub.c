@@ -0,0 +1,403 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "app_cmd_stub.h"
+#include "fds_stub.h"
+#include "fds_util.h"
+#include "rfid_main.h"
+#include "ble_main.h"
+#include "usb_main.h"
+#include "delayed_reset.h"
+#include "nrf_pwr_mgmt.h"
+#include "app_status.h"
+#include "lf_hidprox_data.h"
+#include "lf_tag_hidprox.h"
+
+
+/*
+ * Host stand-ins of the device modules called by app_cmd.c.
+ * The flash is the one of fds_stub.c, the slots only keep their types and the card data of the active one,
+ * the reader finds no card. Enough for the dispatch of every command to run to its response.
+ */
+
+uint8_t g_stub_cdc_tx[sizeof(netdata_frame_raw_t)];
+uint16_t g_stub_cdc_tx_length;
+uint32_t g_stub_cdc_tx_frames;
+jmp_buf g_stub_shutdown;
+bool g_stub_ble_link;
+
+bool g_is_tag_emulating = false;
+uint16_t batt_lvl_in_milli_volts = 3700;
+uint8_t percentage_batt_lvl = 80;
+
+// the buffers are allocated to their exact size so that the sanitizers see overruns
+#define STUB_TAG_DATA_HF_SIZE   4500
+#define STUB_TAG_DATA_LF_SIZE   12
+
+static tag_data_buffer_t m_tag_data_hf;
+static tag_data_buffer_t m_tag_data_lf;
+static tag_slot_specific_type_t m_slot_types[TAG_MAX_SLOT_NUM];
+static bool m_slot_enabled[TAG_MAX_SLOT_NUM][2];
+static uint8_t m_active_slot;
+static device_mode_t m_device_mode;
+static tag_save_stats_t m_save_stats;
+
+static nfc_tag_14a_uid_size m_coll_size;
+static uint8_t m_coll_atqa[2];
+static uint8_t m_coll_sak[1];
+static uint8_t m_coll_uid[10];
+static nfc_14a_ats_t m_coll_ats;
+static nfc_tag_14a_coll_res_reference_t m_coll_res = {
+    .size = &m_coll_size, .atqa = m_coll_atqa, .sak = m_coll_sak, .uid = m_coll_uid, .ats = &m_coll_ats,
+};
+
+static bool m_mf1_detection_enable;
+static bool m_mf1_gen1a;
+static bool m_mf1_gen2;
+static bool m_mf1_coll_res;
+static nfc_tag_mf1_write_mode_t m_mf1_write_mode;
+static bool m_mf0_uid_mode;
+static nfc_tag_mf0_ntag_write_mode_t m_mf0_write_mode;
+static uint8_t m_mf0_version[NFC_TAG_MF0_NTAG_VER_SIZE];
+static uint8_t m_mf0_signature[NFC_TAG_MF0_NTAG_SIG_SIZE];
+static uint8_t m_mf0_counters[3][NFC_TAG_MF0_NTAG_DATA_SIZE];
+
+
+void app_cmd_stub_reset(void) {
+    fds_stub_reset();
+    free(m_tag_data_hf.buffer);
+    free(m_tag_data_lf.buffer);
+    m_tag_data_hf = (tag_data_buffer_t) { .length = STUB_TAG_DATA_HF_SIZE, .buffer = calloc(1, STUB_TAG_DATA_HF_SIZE) };
+    m_tag_data_lf = (tag_data_buffer_t) { .length = STUB_TAG_DATA_LF_SIZE, .buffer = calloc(1, STUB_TAG_DATA_LF_SIZE) };
+    for (int i = 0; i < TAG_MAX_SLOT_NUM; i++) {
+        m_slot_types[i].tag_hf = i == 0 ? TAG_TYPE_MIFARE_1024 : TAG_TYPE_UNDEFINED;
+        m_slot_types[i].tag_lf = i == 0 ? TAG_TYPE_EM410X : TAG_TYPE_UNDEFINED;
+        m_slot_enabled[i][0] = m_slot_enabled[i][1] = i == 0;
+    }
+    m_active_slot = 0;
+    m_device_mode = DEVICE_MODE_TAG;
+    memset(&m_save_stats, 0, sizeof(m_save_stats));
+    m_coll_size = NFC_TAG_14A_UID_SINGLE_SIZE;
+    m_mf1_detection_enable = m_mf1_gen1a = m_mf1_gen2 = m_mf1_coll_res = false;
+    m_mf1_write_mode = NFC_TAG_MF1_WRITE_NORMAL;
+    m_mf0_uid_mode = false;
+    m_mf0_write_mode = NFC_TAG_MF0_NTAG_WRITE_NORMAL;
+    g_stub_cdc_tx_length = 0;
+    g_stub_cdc_tx_frames = 0;
+    g_stub_ble_link = false;
+}
+
+// ---------------------------------------------------------------- board and links
+
+chameleon_device_type_t hw_get_device_type(void) {
+    return CHAMELEON_ULTRA;
+}
+
+uint32_t app_timer_cnt_get(void) {
+    static uint32_t ticks;
+    return ticks++ & 0x00FFFFFF;
+}
+
+void set_slot_light_color(chameleon_rgb_type_t color) {}
+void apply_slot_change(uint8_t slot_now, uint8_t slot_new) {}
+void bsp_delay_ms(uint16_t nms) {}
+void delayed_reset(uint32_t delay) {}
+uint32_t sd_power_gpregret_clr(uint32_t gpregret_id, uint32_t gpregret_msk) { return NRF_SUCCESS; }
+uint32_t sd_power_gpregret_set(uint32_t gpregret_id, uint32_t gpregret_msk) { return NRF_SUCCESS; }
+
+void nrf_pwr_mgmt_shutdown(nrf_pwr_mgmt_shutdown_t shutdown_type) {
+    longjmp(g_stub_shutdown, 1);
+}
+
+device_mode_t get_device_mode(void) {
+    return m_device_mode;
+}
+
+void reader_mode_enter(void) {
+    m_device_mode = DEVICE_MODE_READER;
+}
+
+void tag_mode_enter(void) {
+    m_device_mode = DEVICE_MODE_TAG;
+}
+
+bool is_usb_working(void) {
+    return !g_stub_ble_link;
+}
+
+void usb_cdc_write(const void *p_buf, uint16_t length) {
+    memcpy(g_stub_cdc_tx, p_buf, length);
+    g_stub_cdc_tx_length = length;
+    g_stub_cdc_tx_frames++;
+}
+
+bool is_nus_working(void) { return g_stub_ble_link; }
+void nus_data_response(uint8_t *p_data, uint16_t length) {
+    usb_cdc_write(p_data, length);
+}
+uint16_t nus_get_max_data_len(void) { return 244; }
+void ble_bulk_transfer_begin(void) {}
+void ble_bulk_transfer_end(void) {}
+void advertising_stop(void) {}
+void delete_bonds_all(void) {}
+
+// ---------------------------------------------------------------- slots
+
+tag_data_buffer_t *get_buffer_by_tag_type(tag_specific_type_t type) {
+    return (type == TAG_TYPE_EM410X || type == TAG_TYPE_HID_PROX) ? &m_tag_data_lf : &m_tag_data_hf;
+}
+
+bool is_tag_specific_type_valid(tag_specific_type_t tag_type) {
+    static const tag_specific_type_t types[] = { TAG_SPECIFIC_TYPE_LF_VALUES, TAG_SPECIFIC_TYPE_HF_VALUES };
+    for (int i = 0; i < ARRAY_SIZE(types); i++) {
+        if (types[i] == tag_type) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_lf_type(tag_specific_type_t tag_type) {
+    static const tag_specific_type_t types[] = { TAG_SPECIFIC_TYPE_LF_VALUES };
+    for (int i = 0; i < ARRAY_SIZE(types); i++) {
+        if (types[i] == tag_type) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t tag_emulation_get_slot(void) {
+    return m_active_slot;
+}
+
+void tag_emulation_change_slot(uint8_t index, bool sense_disable) {
+    m_active_slot = index;
+}
+
+void tag_emulation_get_specific_types_by_slot(uint8_t slot, tag_slot_specific_type_t *tag_types) {
+    *tag_types = m_slot_types[slot];
+}
+
+void tag_emulation_change_type(uint8_t slot, tag_specific_type_t tag_type) {
+    if (is_lf_type(tag_type)) {
+        m_slot_types[slot].tag_lf = tag_type;
+    } else {
+        m_slot_types[slot].tag_hf = tag_type;
+    }
+}
+
+bool tag_emulation_factory_data(uint8_t slot, tag_specific_type_t tag_type) {
+    tag_data_buffer_t *buffer = get_buffer_by_tag_type(tag_type);
+    memset(buffer->buffer, 0, buffer->length);
+    return true;
+}
+
+void tag_emulation_delete_data(uint8_t slot, tag_sense_type_t sense_type) {
+    if (sense_type == TAG_SENSE_LF) {
+        m_slot_types[slot].tag_lf = TAG_TYPE_UNDEFINED;
+    } else {
+        m_slot_types[slot].tag_hf = TAG_TYPE_UNDEFINED;
+    }
+}
+
+bool tag_emulation_load_by_buffer(tag_specific_type_t tag_type, bool update_crc) {
+    return true;
+}
+
+void tag_emulation_save(void) {
+    m_save_stats.saves++;
+}
+
+void tag_emulation_get_save_stats(tag_save_stats_t *stats) {
+    *stats = m_save_stats;
+}
+
+bool tag_emulation_slot_is_enabled(uint8_t slot, tag_sense_type_t sense_type) {
+    return m_slot_enabled[slot][sense_type == TAG_SENSE_LF];
+}
+
+void tag_emulation_slot_set_enable(uint8_t slot, tag_sense_type_t sense_type, bool enable) {
+    m_slot_enabled[slot][sense_type == TAG_SENSE_LF] = enable;
+}
+
+uint8_t tag_emulation_slot_find_next(uint8_t slot_now) {
+    for (int i = 1; i < TAG_MAX_SLOT_NUM; i++) {
+        uint8_t slot = (slot_now + i) % TAG_MAX_SLOT_NUM;
+        if (m_slot_enabled[slot][0] || m_slot_enabled[slot][1]) {
+            return slot;
+        }
+    }
+    return slot_now;
+}
+
+// ---------------------------------------------------------------- emulation
+
+bool is_valid_uid_size(uint8_t uid_length) {
+    return uid_length == NFC_TAG_14A_UID_SINGLE_SIZE ||
+           uid_length == NFC_TAG_14A_UID_DOUBLE_SIZE ||
+           uid_length == NFC_TAG_14A_UID_TRIPLE_SIZE;
+}
+
+nfc_tag_14a_coll_res_reference_t *get_mifare_coll_res(void) { return &m_coll_res; }
+nfc_tag_14a_coll_res_reference_t *get_saved_mifare_coll_res(void) { return &m_coll_res; }
+nfc_tag_14a_coll_res_reference_t *nfc_tag_mf0_ntag_get_coll_res(void) { return &m_coll_res; }
+
+void nfc_tag_mf1_set_detection_enable(bool enable) { m_mf1_detection_enable = enable; }
+bool nfc_tag_mf1_is_detection_enable(void) { return m_mf1_detection_enable; }
+void nfc_tag_mf1_detection_log_clear(nfc_tag_mf1_auth_log_mode_t mode) {}
+uint32_t nfc_tag_mf1_detection_log_count(void) { return 0; }
+uint32_t nfc_tag_mf1_detection_log_dropped(void) { return 0; }
+uint16_t mf1_get_auth_log(uint32_t index, uint8_t *buffer, uint16_t max_length, bool packed) { return 0; }
+
+uint8_t *mf1_get_auth_log_uids(uint8_t *count) {
+    *count = 0;
+    return m_coll_uid;
+}
+
+void nfc_tag_mf1_set_gen1a_magic_mode(bool enable) { m_mf1_gen1a = enable; }
+bool nfc_tag_mf1_is_gen1a_magic_mode(void) { return m_mf1_gen1a; }
+void nfc_tag_mf1_set_gen2_magic_mode(bool enable) { m_mf1_gen2 = enable; }
+bool nfc_tag_mf1_is_gen2_magic_mode(void) { return m_mf1_gen2; }
+void nfc_tag_mf1_set_use_mf1_coll_res(bool enable) { m_mf1_coll_res = enable; }
+bool nfc_tag_mf1_is_use_mf1_coll_res(void) { return m_mf1_coll_res; }
+void nfc_tag_mf1_set_write_mode(nfc_tag_mf1_write_mode_t write_mode) { m_mf1_write_mode = write_mode; }
+nfc_tag_mf1_write_mode_t nfc_tag_mf1_get_write_mode(void) { return m_mf1_write_mode; }
+
+int nfc_tag_mf0_ntag_get_nr_pages_by_tag_type(tag_specific_type_t tag_type) {
+    switch (tag_type) {
+        case TAG_TYPE_MF0ICU1: return MF0ICU1_PAGES;
+        case TAG_TYPE_MF0ICU2: return MF0ICU2_PAGES;
+        case TAG_TYPE_MF0UL11: return MF0UL11_PAGES;
+        case TAG_TYPE_MF0UL21: return MF0UL21_PAGES;
+        case TAG_TYPE_NTAG_210: return NTAG210_PAGES;
+        case TAG_TYPE_NTAG_212: return NTAG212_PAGES;
+        case TAG_TYPE_NTAG_213: return NTAG213_PAGES;
+        case TAG_TYPE_NTAG_215: return NTAG215_PAGES;
+        case TAG_TYPE_NTAG_216: return NTAG216_PAGES;
+        default: return -1;
+    }
+}
+
+static bool is_mf0_slot(void) {
+    return nfc_tag_mf0_ntag_get_nr_pages_by_tag_type(m_slot_types[m_active_slot].tag_hf) > 0;
+}
+
+uint8_t *nfc_tag_mf0_ntag_get_version_data(void) { return is_mf0_slot() ? m_mf0_version : NULL; }
+uint8_t *nfc_tag_mf0_ntag_get_signature_data(void) { return is_mf0_slot() ? m_mf0_signature : NULL; }
+
+uint8_t *nfc_tag_mf0_ntag_get_counter_data_by_index(uint8_t index) {
+    return (is_mf0_slot() && index < ARRAY_SIZE(m_mf0_counters)) ? m_mf0_counters[index] : NULL;
+}
+
+int nfc_tag_mf0_ntag_get_uid_mode(void) { return is_mf0_slot() ? m_mf0_uid_mode : -1; }
+
+bool nfc_tag_mf0_ntag_set_uid_mode(bool enabled) {
+    m_mf0_uid_mode = enabled;
+    return is_mf0_slot();
+}
+
+nfc_tag_mf0_ntag_write_mode_t nfc_tag_mf0_ntag_get_write_mode(void) { return m_mf0_write_mode; }
+void nfc_tag_mf0_ntag_set_write_mode(nfc_tag_mf0_ntag_write_mode_t write_mode) { m_mf0_write_mode = write_mode; }
+
+// ---------------------------------------------------------------- reader, no card in the field
+
+void pcd_14a_reader_reset(void) {}
+void pcd_14a_reader_antenna_on(void) {}
+void pcd_14a_reader_antenna_off(void) {}
+void pcd_14a_reader_mf1_unauth(void) {}
+void pcd_14a_reader_target_set(uint8_t *uid, uint8_t uid_len) {}
+
+void pcd_14a_reader_timing_get(pcd_14a_reader_timing_t *timing, bool reset) {
+    memset(timing, 0, sizeof(*timing));
+    timing->cycles_per_us = 64;
+}
+
+uint8_t pcd_14a_reader_scan_auto(picc_14a_tag_t *tag) { return STATUS_HF_TAG_NO; }
+
+uint8_t pcd_14a_reader_scan_all(picc_14a_tag_t *tag, uint8_t max, pcd_14a_reader_tag_cb_t on_tag, uint8_t *count) {
+    *count = 0;
+    return STATUS_HF_TAG_NO;
+}
+
+uint16_t pcd_14a_reader_mf1_auth(picc_14a_tag_t *tag, uint8_t type, uint8_t addr, uint8_t *pKey) { return STATUS_HF_TAG_NO; }
+uint16_t pcd_14a_reader_mf1_read(uint8_t addr, uint8_t *pData) { return STATUS_HF_TAG_NO; }
+uint8_t pcd_14a_reader_mf1_write(uint8_t addr, uint8_t *pData) { return STATUS_HF_TAG_NO; }
+uint8_t pcd_14a_reader_mf1_manipulate_value_block(uint8_t operator, uint8_t addr, int32_t operand) { return STATUS_HF_TAG_NO; }
+uint8_t pcd_14a_reader_mf1_transfer_value_block(uint8_t addr) { return STATUS_HF_TAG_NO; }
+
+uint8_t pcd_14a_reader_raw_cmd(bool openRFField, bool waitResp, bool appendCrc, bool autoSelect, bool keepField, bool checkCrc, uint16_t waitRespTimeout,
+                               uint16_t szDataSendBits, uint8_t *pDataSend, uint8_t *pDataRecv, uint16_t *pszDataRecv, uint16_t szDataRecvBitMax) {
+    *pszDataRecv = 0;
+    return STATUS_HF_TAG_NO;
+}
+
+uint8_t darkside_recover_key(uint8_t targetBlk, uint8_t targetTyp, uint8_t firstRecover, uint8_t ntSyncMax,
+                             DarksideCore_t *dc, mf1_darkside_status_t *darkside_status) {
+    return STATUS_HF_TAG_NO;
+}
+
+uint8_t darkside_recover_key_batch(uint8_t targetBlk, uint8_t targetTyp, uint8_t firstRecover, uint8_t ntSyncMax, uint8_t count,
+                                   mf1_darkside_core_cb_t on_core, mf1_darkside_status_t *darkside_status) {
+    return STATUS_HF_TAG_NO;
+}
+
+uint8_t nested_distance_detect(uint8_t block, uint8_t type, uint8_t *key, uint8_t *uid, uint32_t *distance) {
+    return STATUS_HF_TAG_NO;
+}
+
+uint8_t nested_recover_key(NESTED_CORE_PARAM_DEF, mf1_nested_core_t ncs[SETS_NR]) { return STATUS_HF_TAG_NO; }
+uint8_t static_nested_recover_key(NESTED_CORE_PARAM_DEF, mf1_static_nested_core_t *sncs) { return STATUS_HF_TAG_NO; }
+uint8_t nested_recover_key_stream(NESTED_CORE_PARAM_DEF, uint8_t sets, mf1_nested_core_cb_t on_set) { return STATUS_HF_TAG_NO; }
+uint8_t check_prng_type(mf1_prng_type_t *type) { return STATUS_HF_TAG_NO; }
+uint8_t check_std_mifare_nt_support() { return STATUS_HF_TAG_NO; }
+uint16_t auth_key_use_522_hw(uint8_t block, uint8_t type, uint8_t *key) { return STATUS_HF_TAG_NO; }
+
+uint16_t mf1_toolbox_check_keys_of_sectors(mf1_toolbox_check_keys_of_sectors_in_t *in,
+                                           mf1_toolbox_check_keys_of_sectors_out_t *out,
+                                           mf1_toolbox_check_keys_of_sectors_stats_t *stats) {
+    memset(out, 0, sizeof(*out));
+    memset(stats, 0, sizeof(*stats));
+    return STATUS_HF_TAG_NO;
+}
+
+uint16_t mf1_toolbox_check_keys_on_block(uint8_t block, uint8_t type, mf1_key_t *keys, uint8_t keys_len, uint8_t *index) {
+    return STATUS_HF_TAG_NO;
+}
+
+// every sector is read with its 4 blocks of zeros
+uint16_t mf1_toolbox_dump_sectors(mf1_toolbox_check_keys_of_sectors_out_t *keys, uint8_t sectors, mf1_toolbox_dump_sector_cb_t on_sector) {
+    uint8_t blocks[4 * 16] = { 0 };
+    for (uint8_t sector = 0; sector < sectors; sector++) {
+        on_sector(sector, 0x03, 0x000F, blocks, 4);
+    }
+    return STATUS_HF_TAG_OK;
+}
+
+uint8_t mf1_toolbox_nested_nonces_of_sectors(uint8_t blkKnown, uint8_t typKnown, uint64_t keyKnown,
+                                             mf1_toolbox_check_keys_of_sectors_mask_t *mask, uint8_t sectors, uint8_t count, uint32_t *uid,
+                                             mf1_toolbox_nested_nonces_cb_t on_nonces) {
+    return STATUS_HF_TAG_NO;
+}
+
+uint8_t mf1_hardnested_nonces_acquire(bool slow, uint8_t blkKnown, uint8_t typKnown, uint64_t keyKnown,
+                                      uint8_t targetBlk, uint8_t targetTyp, uint8_t *nonces, uint16_t noncesMax, uint8_t *num_nonces) {
+    *num_nonces = 0;
+    return STATUS_HF_TAG_NO;
+}
+
+uint8_t mf1_hardnested_nonces_stream(bool slow, uint8_t blkKnown, uint8_t typKnown, uint64_t keyKnown,
+                                     uint8_t targetBlk, uint8_t targetTyp, uint32_t noncesTarget, uint32_t noncesMax,
+                                     uint8_t *chunk, uint16_t chunkMax, uint16_t *chunkLength,
+                                     mf1_hardnested_chunk_cb_t on_chunk, mf1_hardnested_progress_t *progress) {
+    *chunkLength = 0;
+    return STATUS_HF_TAG_NO;
+}
+
+uint8_t mf0_toolbox_dump_pages(uint8_t *pwd, uint8_t first_page, uint16_t stop, mf0_toolbox_dump_info_t *info, mf0_toolbox_dump_pages_cb_t on_pages) {
+    return STATUS_HF_TAG_NO;
+}
+
+uint8_t PcdScanEM410X(uint8_t *uid) { return STATUS_EM410X_TAG_NO_FOUND; }
+uint8_t PcdScanHIDProx(hid_prox_card_data_t *card_data) { return STATUS_EM410X_TAG_NO_FOUND; }
+uint8_t PcdWriteT55XX(uint8_t *uid, uint8_t *newkey, uint8_t *old_keys, uint8_t old_key_count) { return STATUS_EM410X_TAG_NO_FOUND; }
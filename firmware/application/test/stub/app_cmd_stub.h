@@ -0,0 +1,25 @@
+#ifndef TEST_STUB_APP_CMD_STUB_H
+#define TEST_STUB_APP_CMD_STUB_H
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "netdata.h"
+
+// Host stand-ins of the device modules called by app_cmd.c, see app_cmd_stub.c
+
+// Frames written to the USB CDC, the last one is kept
+extern uint8_t g_stub_cdc_tx[sizeof(netdata_frame_raw_t)];
+extern uint16_t g_stub_cdc_tx_length;
+extern uint32_t g_stub_cdc_tx_frames;
+
+// The host is connected over BLE instead of USB, the responses still land in g_stub_cdc_tx
+extern bool g_stub_ble_link;
+
+// nrf_pwr_mgmt_shutdown jumps here, the device would be reset
+extern jmp_buf g_stub_shutdown;
+
+// Back to the state of a device just powered on
+void app_cmd_stub_reset(void);
+
+#endif
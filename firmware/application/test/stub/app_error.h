@@ -0,0 +1,11 @@
+#ifndef TEST_STUB_APP_ERROR_H
+#define TEST_STUB_APP_ERROR_H
+
+#include <assert.h>
+
+#define NRF_SUCCESS                 0
+#define NRF_ERROR_INVALID_PARAM     7
+#define APP_ERROR_CHECK(err)        assert((err) == NRF_SUCCESS)
+#define APP_ERROR_CHECK_BOOL(cond)  assert(cond)
+
+#endif
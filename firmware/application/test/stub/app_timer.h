@@ -0,0 +1,15 @@
+#ifndef TEST_STUB_APP_TIMER_H
+#define TEST_STUB_APP_TIMER_H
+
+#include <stdint.h>
+
+// 24 bit counter at 32768 Hz like the RTC1 of the firmware
+#define APP_TIMER_TICKS(ms)     ((uint32_t)(((uint64_t)(ms) * 32768 + 500) / 1000))
+
+uint32_t app_timer_cnt_get(void);
+
+static inline uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from) {
+    return (ticks_to - ticks_from) & 0x00FFFFFF;
+}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef TEST_STUB_APP_UTIL_H
+#define TEST_STUB_APP_UTIL_H
+
+#include <assert.h>
+
+#define STATIC_ASSERT(expr)     _Static_assert(expr, #expr)
+#define UNUSED_PARAMETER(x)     ((void)(x))
+#ifndef MIN
+#define MIN(a, b)               ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b)               ((a) > (b) ? (a) : (b))
+#endif
+#define ASSERT(expr)            assert(expr)
+#define __ALIGN(n)              __attribute__((aligned(n)))
+#define ARRAY_SIZE(arr)         (sizeof(arr) / sizeof((arr)[0]))
+
+#endif
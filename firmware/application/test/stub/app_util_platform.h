@@ -0,0 +1,11 @@
+#ifndef TEST_STUB_APP_UTIL_PLATFORM_H
+#define TEST_STUB_APP_UTIL_PLATFORM_H
+
+#include "app_util.h"
+#include "app_error.h"
+
+// The simulation has no interrupts
+#define CRITICAL_REGION_ENTER() {
+#define CRITICAL_REGION_EXIT()  }
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef TEST_STUB_BLE_GATTS_H
+#define TEST_STUB_BLE_GATTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nrf_soc.h"
+
+#endif
@@ -0,0 +1,4 @@
+#ifndef TEST_STUB_BLE_NUS_H
+#define TEST_STUB_BLE_NUS_H
+
+#endif
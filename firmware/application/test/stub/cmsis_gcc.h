@@ -0,0 +1,7 @@
+#ifndef TEST_STUB_CMSIS_GCC_H
+#define TEST_STUB_CMSIS_GCC_H
+
+// Host stand-in for the CMSIS intrinsics used by the modules under test
+#define __REV(x)    __builtin_bswap32(x)
+
+#endif
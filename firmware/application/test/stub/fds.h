@@ -0,0 +1,8 @@
+#ifndef TEST_STUB_FDS_H
+#define TEST_STUB_FDS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "app_util_platform.h"
+
+#endif
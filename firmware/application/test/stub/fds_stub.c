@@ -0,0 +1,127 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "fds_stub.h"
+#include "fds_util.h"
+
+
+/*
+ * Host stand-in of fds_util.c: the flash is a list of records in RAM.
+ * The queued writes are done at once, their callback is called before fds_write_async returns.
+ * The functions which wait for the FDS queue on the device count in g_stub_fds_flushes.
+ */
+
+#define STUB_FDS_RECORD_MAX     64
+
+typedef struct {
+    uint16_t id;
+    uint16_t key;
+    uint16_t length;
+    uint8_t *data;
+} stub_fds_record_t;
+
+static stub_fds_record_t m_fds_records[STUB_FDS_RECORD_MAX];
+static uint8_t m_fds_count;
+
+uint32_t g_stub_fds_flushes;
+
+
+void fds_stub_reset(void) {
+    for (int i = 0; i < m_fds_count; i++) {
+        free(m_fds_records[i].data);
+    }
+    m_fds_count = 0;
+    g_stub_fds_flushes = 0;
+}
+
+static stub_fds_record_t *fds_find(uint16_t id, uint16_t key) {
+    for (int i = 0; i < m_fds_count; i++) {
+        if (m_fds_records[i].id == id && m_fds_records[i].key == key) {
+            return &m_fds_records[i];
+        }
+    }
+    return NULL;
+}
+
+bool fds_read_sync(uint16_t id, uint16_t key, uint16_t *length, uint8_t *buffer) {
+    g_stub_fds_flushes++;
+    stub_fds_record_t *record = fds_find(id, key);
+    if (record == NULL || record->length > *length) {
+        *length = 0;
+        return false;
+    }
+    memcpy(buffer, record->data, record->length);
+    *length = record->length;
+    return true;
+}
+
+static bool fds_stub_write(uint16_t id, uint16_t key, uint16_t length, void *buffer) {
+    // records are whole words as in flash
+    uint16_t length_words = (length + 3) / 4;
+    stub_fds_record_t *record = fds_find(id, key);
+    if (record == NULL) {
+        if (m_fds_count == STUB_FDS_RECORD_MAX) {
+            return false;
+        }
+        record = &m_fds_records[m_fds_count++];
+        record->id = id;
+        record->key = key;
+        record->data = NULL;
+    }
+    free(record->data);
+    record->length = length_words * 4;
+    record->data = calloc(1, record->length);
+    memcpy(record->data, buffer, length);
+    return true;
+}
+
+bool fds_write_sync(uint16_t id, uint16_t key, uint16_t length, void *buffer) {
+    g_stub_fds_flushes++;
+    return fds_stub_write(id, key, length, buffer);
+}
+
+bool fds_write_async(uint16_t id, uint16_t key, uint16_t length, void *buffer, fds_write_done_cb_t done, void *ctx) {
+    if (length == 0) {
+        return false;
+    }
+    bool success = fds_stub_write(id, key, length, buffer);
+    if (done != NULL) {
+        done(id, key, success, ctx);
+    }
+    return true;
+}
+
+static int fds_stub_delete(uint16_t id, uint16_t key) {
+    stub_fds_record_t *record = fds_find(id, key);
+    if (record == NULL) {
+        return 0;
+    }
+    free(record->data);
+    *record = m_fds_records[--m_fds_count];
+    return 1;
+}
+
+int fds_delete_sync(uint16_t id, uint16_t key) {
+    g_stub_fds_flushes++;
+    return fds_stub_delete(id, key);
+}
+
+void fds_delete_async(uint16_t id, uint16_t key) {
+    fds_stub_delete(id, key);
+}
+
+bool fds_is_exists(uint16_t id, uint16_t key) {
+    g_stub_fds_flushes++;
+    return fds_find(id, key) != NULL;
+}
+
+bool fds_wipe(void) {
+    while (m_fds_count > 0) {
+        free(m_fds_records[--m_fds_count].data);
+    }
+    return true;
+}
+
+void fds_flush_sync(void) {
+    g_stub_fds_flushes++;
+}
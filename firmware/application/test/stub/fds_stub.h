@@ -0,0 +1,14 @@
+#ifndef TEST_STUB_FDS_STUB_H
+#define TEST_STUB_FDS_STUB_H
+
+#include <stdint.h>
+
+// Host stand-in of the flash records of fds_util.c, see fds_stub.c
+
+// Calls that wait for the FDS queue on the device
+extern uint32_t g_stub_fds_flushes;
+
+// No record left, as after a wipe of the flash
+void fds_stub_reset(void);
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef TEST_STUB_NRF_NFCT_H
+#define TEST_STUB_NRF_NFCT_H
+
+#include <stdint.h>
+
+// Host stand-in for the NFCT registers, the emulation writes them like the peripheral and the simulation reads them back
+typedef struct {
+    volatile uint32_t TASKS_ACTIVATE;
+    volatile uint32_t TASKS_DISABLE;
+    volatile uint32_t TASKS_SENSE;
+    volatile uint32_t TASKS_STARTTX;
+    volatile uint32_t TASKS_STOPTX;         // 0x010, not in the datasheet
+    volatile uint32_t RESERVED0[2];
+    volatile uint32_t TASKS_ENABLERXDATA;   // 0x01C
+    volatile uint32_t INTENSET;
+    volatile uint32_t FRAMEDELAYMODE;
+    volatile uint32_t FRAMEDELAYMAX;
+    volatile uint32_t PACKETPTR;
+    volatile uint32_t MAXLEN;
+    struct {
+        volatile uint32_t FRAMECONFIG;
+        volatile uint32_t AMOUNT;
+    } TXD;
+    struct {
+        volatile uint32_t FRAMECONFIG;
+        volatile uint32_t AMOUNT;
+    } RXD;
+} NRF_NFCT_Type;
+
+extern NRF_NFCT_Type g_nfct_mock;
+#define NRF_NFCT    (&g_nfct_mock)
+
+#define NFCT_MAXLEN_MAXLEN_Pos                  (0UL)
+#define NFCT_MAXLEN_MAXLEN_Msk                  (0x1FFUL << NFCT_MAXLEN_MAXLEN_Pos)
+#define NFCT_TXD_AMOUNT_TXDATABITS_Msk          (0x7UL)
+#define NFCT_TXD_AMOUNT_TXDATABYTES_Pos         (3UL)
+#define NFCT_TXD_AMOUNT_TXDATABYTES_Msk         (0x1FFUL << NFCT_TXD_AMOUNT_TXDATABYTES_Pos)
+#define NFCT_RXD_AMOUNT_RXDATABITS_Msk          (0x7UL)
+#define NFCT_RXD_AMOUNT_RXDATABYTES_Pos         (3UL)
+#define NFCT_RXD_AMOUNT_RXDATABYTES_Msk         (0x1FFUL << NFCT_RXD_AMOUNT_RXDATABYTES_Pos)
+#define NFCT_TXD_FRAMECONFIG_PARITY_Msk         (0x1UL)
+#define NFCT_TXD_FRAMECONFIG_DISCARDMODE_Msk    (0x2UL)
+#define NFCT_TXD_FRAMECONFIG_SOF_Msk            (0x4UL)
+#define NFCT_TXD_FRAMECONFIG_CRCMODETX_Msk      (0x10UL)
+
+#define NRF_NFCT_INT_TXFRAMESTART_MASK          (0x1UL << 3)
+#define NRF_NFCT_INT_TXFRAMEEND_MASK            (0x1UL << 4)
+#define NRF_NFCT_INT_RXFRAMESTART_MASK          (0x1UL << 5)
+#define NRF_NFCT_INT_RXFRAMEEND_MASK            (0x1UL << 6)
+#define NRF_NFCT_INT_RXERROR_MASK               (0x1UL << 10)
+
+#define NRF_NFCT_FRAME_DELAY_MODE_WINDOWGRID    (3UL)
+
+static inline void nrf_nfct_frame_delay_max_set(uint32_t frame_delay_max) {
+    NRF_NFCT->FRAMEDELAYMAX = frame_delay_max;
+}
+
+#endif
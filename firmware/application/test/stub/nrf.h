@@ -0,0 +1,20 @@
+#ifndef TEST_STUB_NRF_H
+#define TEST_STUB_NRF_H
+
+#include <stdint.h>
+
+// Host stand-in for the identifiers of the chip
+typedef struct {
+    uint32_t DEVICEID[2];
+    uint32_t DEVICEADDR[2];
+} NRF_FICR_Type;
+
+static const NRF_FICR_Type g_ficr_mock = {
+    .DEVICEID = { 0x01234567, 0x89ABCDEF },
+    .DEVICEADDR = { 0xC0FFEE00, 0x0000BEEF },
+};
+#define NRF_FICR    (&g_ficr_mock)
+
+#define __NOP()     __asm__ volatile ("nop")
+
+#endif
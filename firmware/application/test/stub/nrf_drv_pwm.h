@@ -0,0 +1,6 @@
+#ifndef TEST_STUB_NRF_DRV_PWM_H
+#define TEST_STUB_NRF_DRV_PWM_H
+
+#include <stdbool.h>
+
+#endif
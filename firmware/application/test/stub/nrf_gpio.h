@@ -0,0 +1,13 @@
+#ifndef TEST_STUB_NRF_GPIO_H
+#define TEST_STUB_NRF_GPIO_H
+
+#include <stdint.h>
+#include "nrf.h"
+
+// Host stand-in for the GPIO, the pins of the LEDs are written and never read
+#define NRF_GPIO_PIN_PULLDOWN   1
+
+static inline void nrf_gpio_pin_set(uint32_t pin_number) { (void)pin_number; }
+static inline void nrf_gpio_pin_clear(uint32_t pin_number) { (void)pin_number; }
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef TEST_STUB_NRF_LOG_H
+#define TEST_STUB_NRF_LOG_H
+
+#include <stddef.h>
+#include <string.h>
+
+// Host stand-in for the logger, the simulation is quiet
+#define NRF_LOG_MODULE_REGISTER()
+#define NRF_LOG_INFO(...)       do {} while (0)
+#define NRF_LOG_DEBUG(...)      do {} while (0)
+#define NRF_LOG_WARNING(...)    do {} while (0)
+#define NRF_LOG_ERROR(...)      do {} while (0)
+#define NRF_LOG_HEXDUMP_INFO(p_data, len)   do {} while (0)
+#define NRF_LOG_HEXDUMP_DEBUG(p_data, len)  do {} while (0)
+
+#endif
@@ -0,0 +1,4 @@
+#ifndef TEST_STUB_NRF_LOG_CTRL_H
+#define TEST_STUB_NRF_LOG_CTRL_H
+
+#endif
@@ -0,0 +1,4 @@
+#ifndef TEST_STUB_NRF_LOG_DEFAULT_BACKENDS_H
+#define TEST_STUB_NRF_LOG_DEFAULT_BACKENDS_H
+
+#endif
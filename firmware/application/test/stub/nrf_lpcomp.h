@@ -0,0 +1,8 @@
+#ifndef TEST_STUB_NRF_LPCOMP_H
+#define TEST_STUB_NRF_LPCOMP_H
+
+typedef enum {
+    NRF_LPCOMP_INPUT_0,
+} nrf_lpcomp_input_t;
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef TEST_STUB_NRF_PWR_MGMT_H
+#define TEST_STUB_NRF_PWR_MGMT_H
+
+typedef enum {
+    NRF_PWR_MGMT_SHUTDOWN_GOTO_SYSOFF,
+    NRF_PWR_MGMT_SHUTDOWN_STAY_IN_SYSOFF,
+    NRF_PWR_MGMT_SHUTDOWN_GOTO_DFU,
+    NRF_PWR_MGMT_SHUTDOWN_RESET,
+    NRF_PWR_MGMT_SHUTDOWN_CONTINUE,
+} nrf_pwr_mgmt_shutdown_t;
+
+void nrf_pwr_mgmt_shutdown(nrf_pwr_mgmt_shutdown_t shutdown_type);
+
+#endif
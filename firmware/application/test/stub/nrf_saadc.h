@@ -0,0 +1,8 @@
+#ifndef TEST_STUB_NRF_SAADC_H
+#define TEST_STUB_NRF_SAADC_H
+
+typedef enum {
+    NRF_SAADC_INPUT_DISABLED,
+} nrf_saadc_input_t;
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef TEST_STUB_NRF_SOC_H
+#define TEST_STUB_NRF_SOC_H
+
+#include <stdint.h>
+
+uint32_t sd_power_gpregret_clr(uint32_t gpregret_id, uint32_t gpregret_msk);
+uint32_t sd_power_gpregret_set(uint32_t gpregret_id, uint32_t gpregret_msk);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef TEST_STUB_NRFX_NFCT_H
+#define TEST_STUB_NRFX_NFCT_H
+
+#include <stdint.h>
+#include "hal/nrf_nfct.h"
+
+// Host stand-in for the NFCT driver, the simulation raises the events itself
+#define NRFX_SUCCESS    0
+
+typedef enum {
+    NRFX_NFCT_EVT_FIELD_DETECTED,
+    NRFX_NFCT_EVT_RX_FRAMESTART,
+    NRFX_NFCT_EVT_RX_FRAMEEND,
+    NRFX_NFCT_EVT_TX_FRAMESTART,
+    NRFX_NFCT_EVT_TX_FRAMEEND,
+    NRFX_NFCT_EVT_FIELD_LOST,
+    NRFX_NFCT_EVT_ERROR,
+} nrfx_nfct_evt_id_t;
+
+typedef enum {
+    NRFX_NFCT_ERROR_FRAMEDELAYTIMEOUT,
+    NRFX_NFCT_ERROR_NUM,
+} nrfx_nfct_error_t;
+
+typedef enum {
+    NRFX_NFCT_STATE_DISABLED,
+    NRFX_NFCT_STATE_SENSING,
+    NRFX_NFCT_STATE_ACTIVATED,
+} nrfx_nfct_state_t;
+
+typedef struct {
+    nrfx_nfct_evt_id_t evt_id;
+    union {
+        struct {
+            nrfx_nfct_error_t reason;
+        } error;
+    } params;
+} nrfx_nfct_evt_t;
+
+typedef void (*nrfx_nfct_handler_t)(nrfx_nfct_evt_t const *p_nfct_evt);
+
+typedef struct {
+    uint32_t rxtx_int_mask;
+    nrfx_nfct_handler_t cb;
+} nrfx_nfct_config_t;
+
+static inline int nrfx_nfct_init(nrfx_nfct_config_t const *p_config) {
+    (void)p_config;
+    return NRFX_SUCCESS;
+}
+
+static inline void nrfx_nfct_uninit(void) {}
+static inline void nrfx_nfct_enable(void) {}
+static inline void nrfx_nfct_autocolres_disable(void) {}
+static inline void nrfx_nfct_state_force(nrfx_nfct_state_t state) {
+    (void)state;
+}
+
+#endif
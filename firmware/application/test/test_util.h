@@ -0,0 +1,51 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+/*
+ * Helpers shared by the host tests: the random data and the clocks of the benches.
+ *
+ * A test defines TEST_RAND_SEED before including this file, its random data is then the same on every run.
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifndef TEST_RAND_SEED
+#define TEST_RAND_SEED      0x20231107
+#endif
+
+static uint32_t m_seed = TEST_RAND_SEED;
+
+// xorshift32
+static inline uint32_t test_rand(void) {
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    return m_seed;
+}
+
+static inline void test_rand_bytes(uint8_t *buffer, size_t len) {
+    while (len--) {
+        *buffer++ = (uint8_t)test_rand();
+    }
+}
+
+static inline double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// 0 where there is no time stamp counter
+static inline uint64_t now_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+#endif
@@ -17,6 +17,7 @@ from pathlib import Path
 from platform import uname
 from datetime import datetime
 import hardnested_utils
+import trace_utils
 
 import chameleon_com
 import chameleon_cmd
@@ -58,7 +59,7 @@ def load_dic_file(import_dic, keys):
     return keys
     
 def check_tools():
-    tools = ['staticnested', 'nested', 'darkside', 'mfkey32v2']
+    tools = ['staticnested', 'nested', 'darkside', 'mfkey32v2', 'nesteddict']
     if sys.platform == "win32":
         tools = [x+'.exe' for x in tools]
     missing_tools = [tool for tool in tools if not (default_cwd / tool).exists()]
@@ -560,6 +561,8 @@ class HWConnect(BaseCLIUnit):
                     return
             self.device_com.open(args.port)
             self.device_com.commands = self.cmd.get_device_capabilities()
+            if Command.SET_MAX_DATA_LENGTH in self.device_com.commands:
+                self.device_com.data_max_length = self.cmd.set_max_data_length(self.device_com.data_max_length_limit)
             major, minor = self.cmd.get_app_version()
             model = ['Ultra', 'Lite'][self.cmd.get_device_model()]
             print(f" {{ Chameleon {model} connected: v{major}.{minor} }}")
@@ -677,6 +680,9 @@ class HF14AScan(ReaderRequiredUnit):
                         # TODO: check for ATS support on 14A3 tags
                     else:
                         print("Multiple tags detected, skipping deep tests...")
+            if len(resp) > 1:
+                print(f"{len(resp)} tags found, the reader commands can select one of them "
+                      f"with 'hf 14a target -u <uid>'")
         else:
             print("ISO14443-A Tag no found")
 
@@ -697,6 +703,166 @@ class HF14AInfo(ReaderRequiredUnit):
         scan.scan(deep=True)
 
 
+@hf_14a.command('target')
+class HF14ATarget(DeviceRequiredUnit):
+    def args_parser(self) -> ArgumentParserNoExit:
+        parser = ArgumentParserNoExit()
+        parser.description = 'Select the tag the reader commands use when several tags are in the field'
+        target_group = parser.add_mutually_exclusive_group(required=True)
+        target_group.add_argument('-u', '--uid', type=str, metavar="<hex>", help="UID of the tag, 4, 7 or 10 bytes")
+        target_group.add_argument('--clear', action='store_true', help="Use whichever tag answers again")
+        return parser
+
+    def on_exec(self, args: argparse.Namespace):
+        if args.clear:
+            self.cmd.hf14a_set_reader_target(b'')
+            print(" - Reader target cleared")
+            return
+        if not re.match(r"^([a-fA-F0-9]{8}|[a-fA-F0-9]{14}|[a-fA-F0-9]{20})$", args.uid):
+            raise ArgsParserError("UID must be 4, 7 or 10 bytes in hex")
+        self.cmd.hf14a_set_reader_target(bytes.fromhex(args.uid))
+        print(f" - Reader target set to {args.uid.upper()}")
+
+
+@hf_14a.command('timing')
+class HF14ATiming(DeviceRequiredUnit):
+    def args_parser(self) -> ArgumentParserNoExit:
+        parser = ArgumentParserNoExit()
+        parser.description = 'Show the timing log of the 14a reader communication'
+        parser.add_argument('-r', '--reset', action='store_true', help="Clear the counters after showing them")
+        return parser
+
+    def on_exec(self, args: argparse.Namespace):
+        timing = self.cmd.hf14a_reader_timing(args.reset)
+        print(f" - Transfers: {timing['transfers']}, {timing['timeouts']} timed out")
+        if timing['transfers'] > 0:
+            print(f"   Average transfer: {timing['transfer_us'] / timing['transfers']:.0f} us")
+        print(f" - Auths: {timing['auths']}, {timing['auths_ok']} successful")
+        if timing['auths'] > 0:
+            print(f"   Average auth: {timing['auth_us'] / timing['auths']:.0f} us, "
+                  f"{CG}{timing['auths'] * 1000000 / max(timing['auth_us'], 1):.1f}{C0} auths/s")
+        if timing['auth_timeout_us'] > 0:
+            print(f" - Adaptive auth timeout: {timing['auth_timeout_us']} us")
+        else:
+            print(" - Adaptive auth timeout: not learned yet")
+
+
+@hf_14a.command('trace')
+class HF14ATrace(DeviceRequiredUnit):
+    def args_parser(self) -> ArgumentParserNoExit:
+        parser = ArgumentParserNoExit()
+        parser.description = 'Trace of the frames exchanged while emulating a 14a tag'
+        action_group = parser.add_mutually_exclusive_group()
+        action_group.add_argument('--start', action='store_true', help="Start a new trace on the device")
+        action_group.add_argument('--stop', action='store_true', help="Stop tracing")
+        action_group.add_argument('-f', '--file', type=str, metavar="<file>", help="Show a trace file instead")
+        parser.add_argument('--live', action='store_true',
+                            help="With --start, show the frames while emulating until Ctrl-C")
+        parser.add_argument('-o', '--output', type=str, metavar="<file>", help="Record the trace to a binary file")
+        parser.add_argument('-q', '--quiet', action='store_true', help="Don't show the frames")
+        parser.add_argument('--decrypt', action='store_true',
+                            help="Recover keys with mfkey32 from the MF1 authentications of the trace")
+        return parser
+
+    def before_exec(self, args: argparse.Namespace):
+        if args.file is not None:
+            return True
+        return super().before_exec(args)
+
+    def show(self, records: list):
+        for record in records:
+            if 'dropped' in record:
+                print(f" {CR}... {record['dropped']} frames overwritten on the device{C0}")
+                self.last_timestamp = None
+                continue
+            # a timestamp relative to the previous frame is easier to read, the ticks wrap at 24 bits
+            delta = 0
+            if self.last_timestamp is not None:
+                delta = (record['timestamp'] - self.last_timestamp) & trace_utils.TRACE_TICKS_MASK
+            self.last_timestamp = record['timestamp']
+            direction = f"{CY}Tag{C0}" if record['from_tag'] else f"{CC}Rdr{C0}"
+            data = record['data']
+            if record['crc']:
+                data += trace_utils.crc_a(data)
+            text = data.hex(' ').upper()
+            if record['bits'] % 8:
+                text += f" ({record['bits']} bits)"
+            if record['parity'] is not None:
+                errors = [i for i, b in enumerate(record['data'])
+                          if record['parity'][i] != (bin(b).count('1') + 1) & 1]
+                if errors:
+                    # expected while encrypted, parity is encrypted too
+                    text += f" {CR}!par {','.join(str(i) for i in errors)}{C0}"
+            print(f" {delta * 1000000 // trace_utils.TRACE_TICKS_PER_SECOND:>9} us {direction} {text}")
+
+    def on_live_frame(self, data: bytes):
+        frame = chameleon_cmd.ChameleonCMD.parse_emu_trace(data)
+        self.record(frame)
+
+    def record(self, frame: dict):
+        if self.writer is not None:
+            self.writer.write(frame['records'], frame['dropped'])
+        records = trace_utils.parse_records(frame['records'])
+        if frame['dropped'] > 0:
+            records.insert(0, {'dropped': frame['dropped']})
+        self.records.extend(records)
+        if not self.quiet:
+            self.show(records)
+
+    def on_exec(self, args: argparse.Namespace):
+        self.writer = None
+        self.records = []
+        self.quiet = args.quiet
+        self.last_timestamp = None
+        if args.live and not args.start:
+            raise ArgsParserError("--live needs --start")
+        if args.stop:
+            self.cmd.hf14a_set_emu_trace(False)
+            print(" - Trace stopped")
+            return
+        if args.file is not None:
+            records = trace_utils.parse_records(trace_utils.read_file(args.file))
+            self.records.extend(records)
+            if not self.quiet:
+                self.show(records)
+        else:
+            if args.start:
+                self.cmd.hf14a_set_emu_trace(True, args.live)
+                if not args.live:
+                    print(" - Trace started")
+                    return
+                print(" - Trace started, present the device to the reader, Ctrl-C to stop")
+            if args.output is not None:
+                self.writer = trace_utils.TraceWriter(args.output)
+            try:
+                if args.live:
+                    self.device_com.set_listener(Command.HF14A_EMU_TRACE_LIVE, self.on_live_frame)
+                    try:
+                        while self.device_com.isOpen():
+                            time.sleep(0.1)
+                    except KeyboardInterrupt:
+                        pass
+                    finally:
+                        self.device_com.set_listener(Command.HF14A_EMU_TRACE_LIVE)
+                # the frames not pushed yet
+                while True:
+                    frame = self.cmd.hf14a_get_emu_trace()
+                    self.record(frame)
+                    if frame['pending'] == 0:
+                        break
+            finally:
+                if self.writer is not None:
+                    self.writer.close()
+                    print(f" - {self.writer.count} frames recorded to {args.output}")
+        frames = [record for record in self.records if 'dropped' not in record]
+        print(f" - {len(frames)} frames")
+        if args.decrypt:
+            auths = trace_utils.mf1_auths(self.records)
+            print(f" - {len(auths)} MF1 authentications in plain")
+            if len(auths) > 0:
+                HFMFELog().decrypt_records(auths)
+
+
 @hf_mf.command('nested')
 class HFMFNested(ReaderRequiredUnit):
     def args_parser(self) -> ArgumentParserNoExit:
@@ -714,6 +880,9 @@ class HFMFNested(ReaderRequiredUnit):
         dsttype_group = parser.add_mutually_exclusive_group()
         dsttype_group.add_argument('--ta', '--tA', action='store_true', help="Target A key (default)")
         dsttype_group.add_argument('--tb', '--tB', action='store_true', help="Target B key")
+        parser.add_argument('--sets', type=int, default=8, metavar="<dec>",
+                            help="Nested sets to acquire at most, 2 to 32 (default 8), "
+                                 "the sets after the first unique key are not used")
         return parser
 
     def from_nt_level_code_to_str(self, nt_level):
@@ -724,7 +893,57 @@ class HFMFNested(ReaderRequiredUnit):
         if nt_level == 2:
             return 'HardNested'
 
-    def recover_a_key(self, block_known, type_known, key_known, block_target, type_target) -> Union[str, None]:
+    def recover_nested_stream(self, dist_obj, block_known, type_known, key_known, block_target, type_target, sets):
+        """
+            Feed the sets to the nested tool while they are acquired, the tool answers every set
+            and prints the key as soon as a single key is found in the most sets.
+
+        :return: candidate keys, the unique key first
+        """
+        if sys.platform == "win32":
+            cmd_recover = f"nested.exe {dist_obj['uid']} {dist_obj['dist']}"
+        else:
+            cmd_recover = f"./nested {dist_obj['uid']} {dist_obj['dist']}"
+        print(f"   Executing {cmd_recover} < sets")
+        process = subprocess.Popen(cmd_recover, cwd=default_cwd, shell=True, stdin=subprocess.PIPE,
+                                   stdout=subprocess.PIPE, text=True)
+        key_list = []
+
+        def read_output():
+            for line in process.stdout:
+                sea_obj = re.search(r"([a-fA-F0-9]{12})", line)
+                if sea_obj is not None:
+                    key_list.append(sea_obj[1])
+                elif line.strip():
+                    print(f"   {line.strip()}")
+        reader = threading.Thread(target=read_output, daemon=True)
+        reader.start()
+
+        def on_set(nt_item):
+            # once the tool has a key the sets left over are not needed anymore
+            if process.poll() is not None or len(key_list) > 0:
+                return
+            try:
+                process.stdin.write(f"{nt_item['nt']} {nt_item['nt_enc']} {nt_item['par']}\n")
+                process.stdin.flush()
+            except OSError:
+                pass
+
+        try:
+            nt_sets = self.cmd.mf1_nested_acquire_stream(block_known, type_known, key_known, block_target,
+                                                         type_target, sets, on_set)
+            print(f"   {len(nt_sets)} set(s) acquired")
+        finally:
+            try:
+                process.stdin.close()
+            except OSError:
+                pass
+            process.wait()
+            reader.join()
+        return key_list
+
+    def recover_a_key(self, block_known, type_known, key_known, block_target, type_target,
+                      sets=8) -> Union[str, None]:
         """
             recover a key from key known.
 
@@ -750,6 +969,15 @@ class HFMFNested(ReaderRequiredUnit):
             for nt_item in nt_uid_obj['nts']:
                 cmd_param += f" {nt_item['nt']} {nt_item['nt_enc']}"
             tool_name = "staticnested"
+        elif Command.MF1_NESTED_ACQUIRE_STREAM in self.device_com.commands:
+            dist_obj = self.cmd.mf1_detect_nt_dist(block_known, type_known, key_known)
+            key_list = self.recover_nested_stream(dist_obj, block_known, type_known, key_known, block_target,
+                                                  type_target, sets)
+            print(f" - [{len(key_list)} candidate key(s) found ]")
+            for key in key_list:
+                if self.cmd.mf1_auth_one_key_block(block_target, type_target, bytearray.fromhex(key)):
+                    return key
+            return None
         else:
             dist_obj = self.cmd.mf1_detect_nt_dist(block_known, type_known, key_known)
             nt_obj = self.cmd.mf1_nested_acquire(block_known, type_known, key_known, block_target, type_target)
@@ -811,7 +1039,10 @@ class HFMFNested(ReaderRequiredUnit):
             print(f"{CR}Target key already known{C0}")
             return
         print(f" - {C0}Nested recover one key running...{C0}")
-        key = self.recover_a_key(block_known, type_known, key_known_bytes, block_target, type_target)
+        if not 2 <= args.sets <= 32:
+            print("sets must be between 2 and 32")
+            return
+        key = self.recover_a_key(block_known, type_known, key_known_bytes, block_target, type_target, args.sets)
         if key is None:
             print(f"{CY}No key found, you can retry.{C0}")
         else:
@@ -828,65 +1059,97 @@ class HFMFDarkside(ReaderRequiredUnit):
     def args_parser(self) -> ArgumentParserNoExit:
         parser = ArgumentParserNoExit()
         parser.description = 'Mifare Classic darkside recover key'
+        parser.add_argument('--sets', type=int, default=4, metavar="<dec>",
+                            help="Darkside sets acquired per run of the recovery, 1 to 16 (default 4)")
         return parser
 
-    def recover_key(self, block_target, type_target):
+    def verify_keys(self, block_target, type_target, key_list):
+        """
+            Find the key which authenticates among the candidates, in one command per frame of keys if the device can.
+        """
+        if Command.MF1_CHECK_KEYS_ON_BLOCK in self.device_com.commands:
+            step = self.cmd.mf1_check_keys_on_block_max()
+            for i in range(0, len(key_list), step):
+                keys = [bytes.fromhex(key) for key in key_list[i:i + step]]
+                key_bytes = self.cmd.mf1_check_keys_on_block(block_target, type_target, keys)
+                if key_bytes is not None:
+                    return key_bytes.hex()
+            return None
+        for key in key_list:
+            key_bytes = bytearray.fromhex(key)
+            if self.cmd.mf1_auth_one_key_block(block_target, type_target, key_bytes):
+                return key
+        return None
+
+    def recover_key(self, block_target, type_target, sets=1):
         """
             Execute darkside acquisition and decryption.
 
         :param block_target:
         :param type_target:
+        :param sets: sets acquired by the device before each decryption, needs MF1_DARKSIDE_ACQUIRE_BATCH if > 1
         :return:
         """
+        batch = Command.MF1_DARKSIDE_ACQUIRE_BATCH in self.device_com.commands
         first_recover = True
         retry_count = 0
+        self.darkside_list.clear()
         while retry_count < 0xFF:
-            darkside_resp = self.cmd.mf1_darkside_acquire(block_target, type_target, first_recover, 30)
+            if batch:
+                darkside_status, darkside_objs = self.cmd.mf1_darkside_acquire_batch(
+                    block_target, type_target, first_recover, 30, min(sets, 0xFF - retry_count))
+            else:
+                darkside_resp = self.cmd.mf1_darkside_acquire(block_target, type_target, first_recover, 30)
+                darkside_status = darkside_resp[0]
+                darkside_objs = [darkside_resp[1]] if darkside_status == MifareClassicDarksideStatus.OK else []
             first_recover = False  # not first run.
-            if darkside_resp[0] != MifareClassicDarksideStatus.OK:
-                print(f"Darkside error: {MifareClassicDarksideStatus(darkside_resp[0])}")
-                break
-            darkside_obj = darkside_resp[1]
 
-            if darkside_obj['par'] != 0:  # NXP tag workaround.
-                self.darkside_list.clear()
-
-            self.darkside_list.append(darkside_obj)
-            recover_params = f"{darkside_obj['uid']}"
-            for darkside_item in self.darkside_list:
-                recover_params += f" {darkside_item['nt1']} {darkside_item['ks1']} {darkside_item['par']}"
-                recover_params += f" {darkside_item['nr']} {darkside_item['ar']}"
-            if sys.platform == "win32":
-                cmd_recover = f"darkside.exe {recover_params}"
-            else:
-                cmd_recover = f"./darkside {recover_params}"
-            # subprocess.run(cmd_recover, cwd=os.path.abspath("../bin/"), shell=True)
-            # print(f"   Executing {cmd_recover}")
-            # start a decrypt process
-            process = self.sub_process(cmd_recover)
-            # wait end
-            process.wait_process()
-            # get output
-            output_str = process.get_output_sync()
-            if 'key not found' in output_str:
-                print(f" - No key found, retrying({retry_count})...")
-                retry_count += 1
-                continue  # retry
-            else:
-                key_list = []
-                for line in output_str.split('\n'):
-                    sea_obj = re.search(r"([a-fA-F0-9]{12})", line)
-                    if sea_obj is not None:
-                        key_list.append(sea_obj[1])
-                # auth key
-                for key in key_list:
-                    key_bytes = bytearray.fromhex(key)
-                    if self.cmd.mf1_auth_one_key_block(block_target, type_target, key_bytes):
+            for darkside_obj in darkside_objs:
+                if darkside_obj['par'] != 0:  # NXP tag workaround.
+                    self.darkside_list.clear()
+                self.darkside_list.append(darkside_obj)
+
+            if len(darkside_objs) > 0:
+                recover_params = f"{self.darkside_list[0]['uid']}"
+                for darkside_item in self.darkside_list:
+                    recover_params += f" {darkside_item['nt1']} {darkside_item['ks1']} {darkside_item['par']}"
+                    recover_params += f" {darkside_item['nr']} {darkside_item['ar']}"
+                if sys.platform == "win32":
+                    cmd_recover = f"darkside.exe {recover_params}"
+                else:
+                    cmd_recover = f"./darkside {recover_params}"
+                # subprocess.run(cmd_recover, cwd=os.path.abspath("../bin/"), shell=True)
+                # print(f"   Executing {cmd_recover}")
+                # start a decrypt process
+                process = self.sub_process(cmd_recover)
+                # wait end
+                process.wait_process()
+                # get output
+                output_str = process.get_output_sync()
+                if 'key not found' in output_str:
+                    print(f" - No key found, retrying({retry_count})...")
+                else:
+                    key_list = []
+                    for line in output_str.split('\n'):
+                        sea_obj = re.search(r"([a-fA-F0-9]{12})", line)
+                        if sea_obj is not None:
+                            key_list.append(sea_obj[1])
+                    # auth key
+                    key = self.verify_keys(block_target, type_target, key_list)
+                    if key is not None:
                         return key
+                retry_count += len(darkside_objs)
+
+            if darkside_status != MifareClassicDarksideStatus.OK:
+                print(f"Darkside error: {MifareClassicDarksideStatus(darkside_status)}")
+                break
         return None
 
     def on_exec(self, args: argparse.Namespace):
-        key = self.recover_key(0x03, MfcKeyType.A)
+        if not 1 <= args.sets <= 16:
+            print("sets must be between 1 and 16")
+            return
+        key = self.recover_key(0x03, MfcKeyType.A, args.sets)
         if key is not None:
             print(f" - Key Found: {key}")
         else:
@@ -916,9 +1179,11 @@ class HFMFHardNested(ReaderRequiredUnit):
         # Add max acquisition attempts
         parser.add_argument('--max-attempts', type=int, default=3, metavar="<dec>",
                             help="Maximum acquisition attempts if MSB sum is invalid (default: 3)")
+        parser.add_argument('--nonces', type=int, default=0, metavar="<dec>",
+                            help="Minimum nonces to acquire when the device streams the acquisition (default: 0, stop once all MSBs are seen)")
         return parser
 
-    def recover_key(self, slow_mode, block_known, type_known, key_known, block_target, type_target, keep_nonce_file, max_runs, max_attempts):
+    def recover_key(self, slow_mode, block_known, type_known, key_known, block_target, type_target, keep_nonce_file, max_runs, max_attempts, nonces_target=0):
         """
         Recover a key using the HardNested attack via a nonce file, with dynamic MSB-based acquisition and restart on invalid sum.
 
@@ -973,7 +1238,8 @@ class HFMFHardNested(ReaderRequiredUnit):
                     print(f"{CR}   Maximum attempts reached without finding tag. Attack failed.{C0}")
                     return None
             if len(scan_resp) > 1:
-                print(f"{CR}   Error: Multiple tags found. Please present only one tag.{C0}")
+                print(f"{CR}   Error: Multiple tags found. Please present only one tag or select one with "
+                      f"'hf 14a target -u <uid>'.{C0}")
                 # Fail immediately if multiple tags are present
                 return None
 
@@ -997,9 +1263,38 @@ class HFMFHardNested(ReaderRequiredUnit):
             print(f"   Nonce file header prepared: {nonces_buffer.hex().upper()}")
 
 
-            # 2. Acquire nonces dynamically based on MSB criteria (Inner loop for runs)
-            print(f"   Acquiring nonces (slow mode: {slow_mode}, max runs: {max_runs}). This may take a while...")
-            while run_count < max_runs:
+            # 2a. Streamed acquisition: the device keeps the tag selected and tracks the MSBs itself
+            streamed = Command.MF1_HARDNESTED_ACQUIRE_STREAM in self.device_com.commands
+            if streamed:
+                print(f"   Acquiring nonces on device (slow mode: {slow_mode}, max nonces: {max_runs * 110}). This may take a while...")
+
+                def on_progress(progress):
+                    print(f"\r   Unique MSBs: {progress['msb_count']}/256 | Current Sum: {progress['msb_sum']}"
+                          f" | Nonces: {progress['nonces']}   ", end="")
+
+                run_count = 1
+                try:
+                    result = self.cmd.mf1_hard_nested_acquire_stream(
+                        slow_mode, block_known, type_known, key_known, block_target, type_target,
+                        nonces_target, max_runs * 110, on_progress
+                    )
+                    total_raw_nonces_bytes.extend(result['nonces_data'])
+                    unique_msb_count = result['msb_count']
+                    msb_parity_sum = result['msb_sum']
+                    print(f"\n   {CG}All 256 unique MSBs found.{C0} Final parity sum: {msb_parity_sum}")
+                    if msb_parity_sum in hardnested_utils.hardnested_sums:
+                        print(f"   {CG}Parity sum {msb_parity_sum} is VALID.{C0}")
+                        acquisition_goal_met = True
+                        acquisition_success = True
+                    else:
+                        print(f"   {CR}Parity sum {msb_parity_sum} is INVALID (Expected one of {hardnested_utils.hardnested_sums}).{C0}")
+                except (UnexpectedResponseError, TimeoutError) as e:
+                    print(f"\n{CR}   Error acquiring nonces: {e}{C0}")
+
+            # 2b. Acquire nonces dynamically based on MSB criteria (Inner loop for runs)
+            if not streamed:
+                print(f"   Acquiring nonces (slow mode: {slow_mode}, max runs: {max_runs}). This may take a while...")
+            while not streamed and run_count < max_runs:
                 run_count += 1
                 print(f"   Starting acquisition run {run_count}/{max_runs}...")
                 try:
@@ -1324,7 +1619,7 @@ class HFMFHardNested(ReaderRequiredUnit):
         # Pass the max_runs and max_attempts arguments
         recovered_key = self.recover_key(
             args.slow, block_known, type_known, key_known_bytes, block_target, type_target,
-            args.keep_nonce_file, args.max_runs, args.max_attempts
+            args.keep_nonce_file, args.max_runs, args.max_attempts, args.nonces
         )
 
         if recovered_key:
@@ -1352,18 +1647,111 @@ class HFMFFCHK(ReaderRequiredUnit):
         parser.add_argument('--export-dic', type=argparse.FileType('w', encoding='utf8'), help=f'Export result as .dic format, file will be {CR}OVERWRITTEN{C0} if exists')
 
         parser.add_argument('-m', '--mask', help='Which sectorKey to be skip, 1 bit per sectorKey. `0b1` represent to skip to check. (in hex[20] format)', type=str, default='00000000000000000000', metavar='<hex>')
+        parser.add_argument('--key-stats', type=str, metavar='<file>', help='Hit counts of keys from past runs, the most hit keys are tried first. The file is updated with the keys found')
+
+        nested_group = parser.add_argument_group('nested check', 'check the keys offline against nested nonces, only the survivors are checked on the card')
+        nested_group.add_argument('--known-blk', type=int, metavar='<dec>', help='Block of the known key')
+        nested_group.add_argument('--known-b', action='store_true', help='Known key is B key (default: A key)')
+        nested_group.add_argument('--known-key', type=str, metavar='<hex>', help='Known key (as hex[12] format)')
+        nested_group.add_argument('--nonces', type=int, default=4, metavar='<dec>', help='Nonces per sectorKey, 1 to 8 (default: 4)')
 
         parser.set_defaults(maxSectors=16)
         return parser
+
+    def check_keys_nested(self, args: argparse.Namespace, mask: bytearray, keys: list[bytes]):
+        """
+        Check the keys offline against nested nonces of every sectorKey with the nesteddict tool,
+        then confirm the surviving keys on the card.
+        """
+        if not re.match(r'^[a-fA-F0-9]{12}$', args.known_key):
+            raise ArgsParserError("Known key must include 12 HEX symbols")
+        if args.known_blk is None:
+            raise ArgsParserError("Known key needs --known-blk")
+        known_type = MfcKeyType.B if args.known_b else MfcKeyType.A
+        known_key = bytes.fromhex(args.known_key)
+
+        weak_prng = self.cmd.mf1_detect_prng() == MifareClassicPrngType.WEAK
+        print(f' - acquiring {args.nonces} nested nonces per sectorKey...')
+        resp = self.cmd.mf1_nested_nonces_of_sectors(args.known_blk, known_type, known_key, args.maxSectors, args.nonces, mask)
+
+        dic_file = tempfile.NamedTemporaryFile(suffix='.dic', prefix='nesteddict_', delete=False, mode='w', dir='.')
+        try:
+            dic_file.write(''.join(key.hex() + '\n' for key in keys))
+            dic_file.close()
+            cmd_param = f'{resp["uid"]} {dic_file.name} {int(weak_prng)}'
+            for target, nonces in resp['nonces'].items():
+                cmd_param += f' {target} {len(nonces)}'
+                for nt_enc, par in nonces:
+                    cmd_param += f' {nt_enc} {par}'
+            tool_name = 'nesteddict.exe' if sys.platform == 'win32' else './nesteddict'
+            print(f' - checking {len(keys)} keys offline...')
+            process = self.sub_process(f'{tool_name} {cmd_param}')
+            while process.is_running():
+                time.sleep(0.1)
+            if process.get_ret_code() != 0:
+                print(f' - {CR}nesteddict failed{C0}')
+                return dict()
+            output_str = process.get_output_sync()
+        finally:
+            os.remove(dic_file.name)
+
+        survivors = set()
+        check_mask = bytearray(b'\xff' * 10)
+        for line in output_str.split('\n'):
+            sea_obj = re.search(r'^(\d+) ([a-fA-F0-9]{12})', line.strip())
+            if sea_obj is None:
+                continue
+            target = int(sea_obj[1])
+            survivors.add(bytes.fromhex(sea_obj[2]))
+            check_mask[target // 8] &= ~(0x80 >> (target % 8))
+        print(f' - {CG}{len(survivors)}{C0} keys survived the offline check')
+        if len(survivors) == 0:
+            return dict()
+        return self.check_keys(check_mask, list(survivors))
+
+    @staticmethod
+    def load_key_stats(path):
+        """
+        Load the hit counts of the keys from past runs, one "<key as hex[12]> <count>" per line
+        """
+        hits = dict()
+        if path is None or not os.path.exists(path):
+            return hits
+        with open(path, 'r', encoding='utf8') as file:
+            for line in file:
+                sea_obj = re.match(r'^([a-fA-F0-9]{12})\s+(\d+)', line.strip())
+                if sea_obj is not None:
+                    hits[bytes.fromhex(sea_obj[1])] = int(sea_obj[2])
+        return hits
+
+    def find_keys(self, args: argparse.Namespace, mask: bytearray, keys: list[bytes]):
+        # the keys which hit most in past runs are tried first, the firmware keeps the given order
+        hits = self.load_key_stats(args.key_stats)
+        keys = sorted(keys, key=lambda k: -hits.get(k, 0))
+
+        if args.known_key is not None:
+            sectorKeys = self.check_keys_nested(args, mask, keys)
+        else:
+            sectorKeys = self.check_keys(mask, keys)
+
+        if args.key_stats is not None:
+            for key in sectorKeys.values():
+                hits[bytes(key)] = hits.get(bytes(key), 0) + 1
+            with open(args.key_stats, 'w', encoding='utf8') as file:
+                for key, count in sorted(hits.items(), key=lambda item: -item[1]):
+                    file.write(f'{key.hex().upper()} {count}\n')
+        return sectorKeys
     
     def check_keys(self, mask: bytearray, keys: list[bytes], chunkSize=20):
         sectorKeys = dict()
+        auths = 0
+        sectorKeysChecked = 0
 
         for i in range(0, len(keys), chunkSize):
             # print("mask = {}".format(mask.hex(sep=' ', bytes_per_sep=1)))
             chunkKeys = keys[i:i+chunkSize]
             print(f' - progress of checking keys... {CY}{i}{C0} / {len(keys)} ({CY}{100 * i / len(keys):.1f}{C0} %)')
-            resp = self.cmd.mf1_check_keys_of_sectors(mask, chunkKeys)
+            resp = self.cmd.mf1_check_keys_of_sectors(mask, chunkKeys, stats=True)
             # print(resp)
 
             if resp["status"] != Status.HF_TAG_OK:
@@ -1376,12 +1764,14 @@ class HFMFFCHK(ReaderRequiredUnit):
             for j in range(10):
                 mask[j] |= resp['found'][j]
             sectorKeys.update(resp['sectorKeys'])
+            auths += resp.get('auths', 0)
+            sectorKeysChecked += resp.get('sectorKeysChecked', 0)
 
+        if sectorKeysChecked > 0:
+            print(f' - auths per sectorKey: {CY}{auths / sectorKeysChecked:.1f}{C0} ({auths} auths)')
         return sectorKeys
 
-    def on_exec(self, args: argparse.Namespace):
-        # print(args)
-
+    def load_keys(self, args: argparse.Namespace):
         keys = set()
 
         # keys from args
@@ -1394,29 +1784,42 @@ class HFMFFCHK(ReaderRequiredUnit):
         # read keys from key format file
         if args.import_key is not None:
             if not load_key_file(args.import_key, keys):
-                return
+                return None
 
         if args.import_dic is not None:
             if not load_dic_file(args.import_dic, keys):
-                return
+                return None
 
         if len(keys) == 0:
             print(f' - {CR}No keys{C0}')
-            return
+            return None
 
         print(f" - loaded {CG}{len(keys)}{C0} keys")
+        return keys
 
-        # mask
+    def load_mask(self, args: argparse.Namespace):
         if not re.match(r'^[a-fA-F0-9]{1,20}$', args.mask):
             print(f' - {CR}mask should in hex[20] format{C0}, mask = "{args.mask}"')
-            return
+            return None
         mask = bytearray.fromhex(f'{args.mask:0<20}')
         for i in range(args.maxSectors, 40):
             mask[i // 4] |= 3 << (6 - i % 4 * 2)
+        return mask
+
+    def on_exec(self, args: argparse.Namespace):
+        # print(args)
+
+        keys = self.load_keys(args)
+        if keys is None:
+            return
+
+        mask = self.load_mask(args)
+        if mask is None:
+            return
 
         # check keys
         startedAt = datetime.now()
-        sectorKeys = self.check_keys(mask, list(keys))
+        sectorKeys = self.find_keys(args, mask, list(keys))
         endedAt = datetime.now()
         duration = endedAt - startedAt
         print(f" - elapsed time: {CY}{duration.total_seconds():.3f}s{C0}")
@@ -1450,6 +1853,78 @@ class HFMFFCHK(ReaderRequiredUnit):
         print(f"( {CR}0{C0}: Failed, {CG}1{C0}: Success )\n\n")
 
 
+@hf_mf.command('dump')
+class HFMFDump(HFMFFCHK):
+    def args_parser(self) -> ArgumentParserNoExit:
+        parser = super().args_parser()
+        parser.description = 'Mifare Classic check keys then dump the whole card on device'
+        parser.add_argument('-f', '--file', type=str, required=True, help="file path")
+        parser.add_argument('-t', '--type', type=str, required=False, help="content type", choices=['bin', 'hex'])
+        return parser
+
+    def on_exec(self, args: argparse.Namespace):
+        file = args.file
+        if args.type is None:
+            if file.endswith('.bin'):
+                content_type = 'bin'
+            elif file.endswith('.eml'):
+                content_type = 'hex'
+            else:
+                raise Exception("Unknown file format, Specify content type with -t option")
+        else:
+            content_type = args.type
+
+        keys = self.load_keys(args)
+        if keys is None:
+            return
+
+        mask = self.load_mask(args)
+        if mask is None:
+            return
+
+        startedAt = datetime.now()
+        sectorKeys = self.find_keys(args, mask, list(keys))
+        if len(sectorKeys) == 0:
+            print(f' - {CR}No key found, nothing to dump{C0}')
+            return
+
+        resp = self.cmd.mf1_dump(args.maxSectors, sectorKeys)
+        duration = datetime.now() - startedAt
+        print(f" - elapsed time: {CY}{duration.total_seconds():.3f}s{C0}")
+        if resp['status'] != Status.HF_TAG_OK:
+            print(f' - dump interrupted, reason: {CR}{str(Status(resp["status"]))}{C0}')
+
+        # unread blocks are left zeroed in the dump
+        data = bytearray()
+        print("-----+-----+-------+-------+--------------------")
+        print(" Sec | Blk | key A | key B | blocks read ")
+        print("-----+-----+-------+-------+--------------------")
+        for sectorNo in range(args.maxSectors):
+            blk = (sectorNo * 4) if sectorNo < 32 else (sectorNo * 16 - 384)
+            block_count = 4 if sectorNo < 32 else 16
+            sector = resp['sectors'].get(sectorNo, None)
+            if sector is None:
+                data.extend(bytes(16 * block_count))
+                print(f" {CY}{sectorNo:03d}{C0} | {blk:03d} |   {CR}0{C0}   |   {CR}0{C0}   | {CR}{'-' * block_count}{C0}")
+                continue
+            for block in sector['blocks']:
+                data.extend(block)
+            keyA = f"{CG}1{C0}" if sector['keyA'] else f"{CR}0{C0}"
+            keyB = f"{CG}1{C0}" if sector['keyB'] else f"{CR}0{C0}"
+            blocks = ''.join(f"{CG}R{C0}" if sector['read_mask'] & (1 << i) else f"{CR}-{C0}" for i in range(block_count))
+            print(f" {CY}{sectorNo:03d}{C0} | {blk:03d} |   {keyA}   |   {keyB}   | {blocks}")
+        print("-----+-----+-------+-------+--------------------")
+        print(f"( {CR}0{C0}: Failed, {CG}1{C0}: Success, {CG}R{C0}: Block read )\n")
+
+        with open(file, 'wb') as fd:
+            if content_type == 'hex':
+                for i in range(len(data) // 16):
+                    fd.write(binascii.hexlify(data[i*16:(i+1)*16])+b'\n')
+            else:
+                fd.write(data)
+        print(f" - Dump saved to: {CG}{file}{C0}")
+
+
 @hf_mf.command('rdbl')
 class HFMFRDBL(MF1AuthArgsUnit):
     def args_parser(self) -> ArgumentParserNoExit:
@@ -1787,11 +2262,23 @@ class HFMFELog(DeviceRequiredUnit):
         while index < count:
             tmp = self.cmd.mf1_get_detection_log(index)
             recv_count = len(tmp)
+            if recv_count == 0:
+                # a log in ring mode may lose its oldest records meanwhile
+                break
             index += recv_count
             result_list.extend(tmp)
             print("."*recv_count, end="")
         print()
         print(f" - Download done ({len(result_list)} records), start parse and decrypt")
+        self.decrypt_records(result_list)
+
+    def decrypt_records(self, result_list: list):
+        """
+            Group the records by uid, block and key type and decrypt the keys of each group
+
+        :param result_list: records in the format of mf1_get_detection_log
+        :return:
+        """
         # classify
         result_maps = {}
         for item in result_list:
@@ -1871,7 +2358,7 @@ class HFMFELoad(SlotIndexArgsAndGoUnit, DeviceRequiredUnit):
 
         index = 0
         block = 0
-        max_blocks = (self.device_com.data_max_length - 1) // 16
+        max_blocks = min((self.device_com.data_max_length - 1) // 16, 255)
         while index + 16 < len(buffer):
             # split a block from buffer
             block_data = buffer[index: index + 16*max_blocks]
@@ -1922,7 +2409,8 @@ class HFMFESave(SlotIndexArgsAndGoUnit, DeviceRequiredUnit):
 
         index = 0
         data = bytearray(0)
-        max_blocks = self.device_com.data_max_length // 16
+        # block count is sent as a single byte
+        max_blocks = min(self.device_com.data_max_length // 16, 255)
         while block_count > 0:
             chunk_count = min(block_count, max_blocks)
             data.extend(self.cmd.mf1_read_emu_block_data(index, chunk_count))
@@ -1963,7 +2451,8 @@ class HFMFEView(SlotIndexArgsAndGoUnit, DeviceRequiredUnit):
             raise Exception("Card in current slot is not Mifare Classic/Plus in SL1 mode")
         index = 0
         data = bytearray(0)
-        max_blocks = self.device_com.data_max_length // 16
+        # block count is sent as a single byte
+        max_blocks = min(self.device_com.data_max_length // 16, 255)
         while block_count > 0:
             # read all the blocks
             chunk_count = min(block_count, max_blocks)
@@ -1995,6 +2484,8 @@ class HFMFEConfig(SlotIndexArgsAndGoUnit, HF14AAntiCollArgsUnit, DeviceRequiredU
         log_group = parser.add_mutually_exclusive_group()
         log_group.add_argument('--enable-log', action='store_true', help="Enable logging of MFC authentication data")
         log_group.add_argument('--disable-log', action='store_true', help="Disable logging of MFC authentication data")
+        parser.add_argument('--log-ring', action='store_true',
+                            help="With --enable-log, overwrite the oldest records once the log is full")
         return parser
 
     def on_exec(self, args: argparse.Namespace):
@@ -2084,9 +2575,9 @@ class HFMFEConfig(SlotIndexArgsAndGoUnit, HF14AAntiCollArgsUnit, DeviceRequiredU
                 print(f'{CY}Requested write mode already set{C0}')
         if args.enable_log:
             change_requested = True
-            if not detection:
+            if not detection or args.log_ring:
                 detection = True
-                self.cmd.mf1_set_detection_enable(detection)
+                self.cmd.mf1_set_detection_enable(detection, args.log_ring)
                 change_done = True
             else:
                 print(f'{CY}Requested logging of MFC authentication data already enabled{C0}')
@@ -2509,7 +3000,87 @@ class HFMFUDUMP(MFUAuthArgsUnit):
                             help="Force writing as either raw binary or hex.")
         return parser
     
+    @staticmethod
+    def tag_from_version(version: bytes):
+        """
+        Tag name and page count from the GET_VERSION answer, (None, None) if unknown.
+        """
+        is_mikron_ulev1 = version[1] == 0x34 and version[2] == 0x21
+        if (version[2] == 3 or is_mikron_ulev1) and version[4] == 1 and version[5] == 0:
+            # Ultralight EV1 V0
+            size_map = {
+                0x0B: ('Mifare Ultralight EV1 48b', 20),
+                0x0E: ('Mifare Ultralight EV1 128b', 41),
+            }
+        elif version[2] == 4 and version[4] == 1 and version[5] == 0:
+            # NTAG 210/212/213/215/216 V0
+            size_map = {
+                0x0B: ('NTAG 210', 20),
+                0x0E: ('NTAG 212', 41),
+                0x0F: ('NTAG 213', 45),
+                0x11: ('NTAG 215', 135),
+                0x13: ('NTAG 216', 231),
+            }
+        else:
+            size_map = {}
+        return size_map.get(version[6], (None, None))
+
+    def write_page(self, fd, save_as_eml, i, data):
+        print(f" - Page {i:2}: {data.hex()}")
+        if fd is not None:
+            if save_as_eml:
+                fd.write(data.hex()+'\n')
+            else:
+                fd.write(data)
+
+    def do_dump_on_device(self, args: argparse.Namespace, param, fd, save_as_eml):
+        """
+        One select and FAST_READ over page ranges on device, without a round trip per page.
+        """
+        if args.qty is not None:
+            stop_page = min(args.page + args.qty, 256)
+        else:
+            # read until the tag refuses a page
+            stop_page = 256
+
+        dump = self.cmd.mf0_ntag_dump(args.page, stop_page, param.key)
+        if dump['status'] == Status.HF_TAG_NO and dump['version'] is None:
+            print(f'- {CR}No tag detected.{C0}')
+            return
+
+        expected_stop = None
+        if dump['version'] is not None:
+            print(f" - Version: {dump['version'].hex()}")
+            tag_name, expected_stop = self.tag_from_version(dump['version'])
+            if tag_name is not None:
+                print(f' - Detected tag type as {tag_name}.')
+        if dump['signature'] is not None:
+            print(f" - Signature: {dump['signature'].hex()}")
+        if param.key is not None:
+            if dump['pack'] is None:
+                print(f" - {CR}Auth failed{C0}")
+                return
+            print(f" - PACK: {dump['pack'].hex()}")
+        if dump['status'] != Status.HF_TAG_OK:
+            print(f" - {CR}Dump failed: {Status(dump['status'])}{C0}")
+            return
+
+        pages = dump['pages']
+        for i in sorted(pages):
+            self.write_page(fd, save_as_eml, i, pages[i])
+
+        if args.qty is not None:
+            expected_stop = stop_page
+        if expected_stop is not None and args.page + len(pages) < expected_stop:
+            print(f' - {CY}Dump is shorter than expected.{C0}')
+        if args.file != '':
+            print(f" - {CG}Dump written in {args.file}.{C0}")
+
     def do_dump(self, args: argparse.Namespace, param, fd, save_as_eml):
+        if Command.MF0_NTAG_DUMP in self.device_com.commands:
+            self.do_dump_on_device(args, param, fd, save_as_eml)
+            return
+
         if args.qty is not None:
             stop_page = min(args.page + args.qty, 256)
         else:
@@ -2556,28 +3127,7 @@ class HFMFUDUMP(MFUAuthArgsUnit):
             if version is not None and not supports_auth:
                 # either ULEV1 or NTAG
                 assert len(version) == 8
-
-                is_mikron_ulev1 = version[1] == 0x34 and version[2] == 0x21
-                if (version[2] == 3 or is_mikron_ulev1) and version[4] == 1 and version[5] == 0:
-                    # Ultralight EV1 V0
-                    size_map = {
-                        0x0B: ('Mifare Ultralight EV1 48b', 20),
-                        0x0E: ('Mifare Ultralight EV1 128b', 41),
-                    }
-                elif version[2] == 4 and version[4] == 1 and version[5] == 0:
-                    # NTAG 210/212/213/215/216 V0
-                    size_map = {
-                        0x0B: ('NTAG 210', 20),
-                        0x0E: ('NTAG 212', 41),
-                        0x0F: ('NTAG 213', 45),
-                        0x11: ('NTAG 215', 135),
-                        0x13: ('NTAG 216', 231),
-                    }
-                else:
-                    size_map = {}
-                
-                if version[6] in size_map:
-                    tag_name, stop_page = size_map[version[6]]
+                tag_name, stop_page = self.tag_from_version(version)
             elif version is None and supports_auth:
                 # Ultralight C
                 tag_name = 'Mifare Ultralight C'
@@ -2656,13 +3206,7 @@ class HFMFUDUMP(MFUAuthArgsUnit):
 
             # TODO: can be optimized as we get 4 pages at once but beware of wrapping
             # in case of end of memory or LOCK on ULC and no key provided
-            data = resp[:4]
-            print(f" - Page {i:2}: {data.hex()}")
-            if fd is not None:
-                if save_as_eml:
-                    fd.write(data.hex()+'\n')
-                else:
-                    fd.write(data)
+            self.write_page(fd, save_as_eml, i, resp[:4])
         
         if needs_stop and stop_page != 256:
             print(f' - {CY}Dump is shorter than expected.{C0}')
@@ -2932,15 +3476,34 @@ class HWSlotList(DeviceRequiredUnit):
                             help="Hide slot nicknames and Mifare Classic emulator settings")
         return parser
 
-    def get_slot_name(self, slot, sense):
-        try:
-            name = self.cmd.get_slot_tag_nick(slot, sense)
-            return {'baselen': len(name), 'metalen': len(CC+C0), 'name': f'{CC}{name}{C0}'}
-        except UnexpectedResponseError:
+    def get_slot_nicks(self):
+        """
+            HF and LF nicknames of all slots, in slot order, or the exception raised while getting them
+        """
+        if Command.BATCH in self.device_com.commands:
+            # one round trip instead of two per slot
+            with self.cmd.batch() as batch:
+                for slot in SlotNumber:
+                    batch.get_slot_tag_nick(slot, TagSenseType.HF)
+                    batch.get_slot_tag_nick(slot, TagSenseType.LF)
+            return batch.results
+        nicks = []
+        for slot in SlotNumber:
+            for sense in (TagSenseType.HF, TagSenseType.LF):
+                try:
+                    nicks.append(self.cmd.get_slot_tag_nick(slot, sense))
+                except (UnexpectedResponseError, UnicodeDecodeError) as e:
+                    nicks.append(e)
+        return nicks
+
+    def get_slot_name(self, name):
+        if isinstance(name, UnexpectedResponseError):
             return {'baselen': 0, 'metalen': 0, 'name': ''}
-        except UnicodeDecodeError:
+        if isinstance(name, UnicodeDecodeError):
             name = "UTF8 Err"
-            return {'baselen': len(name), 'metalen': len(CC+C0), 'name': f'{CC}{name}{C0}'}
+        elif isinstance(name, Exception):
+            raise name
+        return {'baselen': len(name), 'metalen': len(CC+C0), 'name': f'{CC}{name}{C0}'}
 
     def on_exec(self, args: argparse.Namespace):
         slotinfo = self.cmd.get_slot_info()
@@ -2949,9 +3512,10 @@ class HWSlotList(DeviceRequiredUnit):
         enabled = self.cmd.get_enabled_slots()
         maxnamelength = 0
         slotnames = []
+        nicks = iter(self.get_slot_nicks())
         for slot in SlotNumber:
-            hfn = self.get_slot_name(slot, TagSenseType.HF)
-            lfn = self.get_slot_name(slot, TagSenseType.LF)
+            hfn = self.get_slot_name(next(nicks))
+            lfn = self.get_slot_name(next(nicks))
             m = max(hfn['baselen'], lfn['baselen'])
             maxnamelength = m if m > maxnamelength else maxnamelength
             slotnames.append({'hf': hfn, 'lf': lfn})
@@ -3256,8 +3820,11 @@ class HWSlotUpdate(DeviceRequiredUnit):
         return parser
 
     def on_exec(self, args: argparse.Namespace):
-        self.cmd.slot_data_config_save()
+        stats = self.cmd.slot_data_config_save()
         print(' - Store slots config and data from device memory to flash success.')
+        if stats is not None:
+            print(f'   {stats["bytes_last"]} bytes written, {stats["chunks_last"]} of {stats["chunk_count"]} chunks changed'
+                  f' ({stats["bytes_total"]} bytes in {stats["saves"]} saves since power on)')
 
 
 @hw_slot.command('openall')
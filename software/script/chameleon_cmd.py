@@ -117,6 +117,33 @@ class ChameleonCMD:
             resp.parsed = data
         return resp
 
+    @expect_response(Status.SUCCESS)
+    def hf14a_set_reader_target(self, uid: bytes):
+        """
+        Select the tag the reader commands use when several tags are in the field.
+
+        :param uid: 4, 7 or 10 bytes, empty to use whichever tag answers
+        :return:
+        """
+        if len(uid) not in (0, 4, 7, 10):
+            raise ValueError("uid should be 4, 7 or 10 bytes")
+        return self.device.send_cmd_sync(Command.HF14A_SET_READER_TARGET, uid)
+
+    @expect_response(Status.SUCCESS)
+    def hf14a_reader_timing(self, reset=False):
+        """
+        Get the timing log of the 14a reader communication.
+
+        :param reset: clear the counters after reading them
+        :return:
+        """
+        data = struct.pack('!?', reset)
+        resp = self.device.send_cmd_sync(Command.HF14A_READER_TIMING, data)
+        if resp.status == Status.SUCCESS:
+            resp.parsed = dict(zip(('transfers', 'transfer_us', 'auths', 'auths_ok', 'auth_us', 'timeouts',
+                                    'auth_timeout_us'), struct.unpack('!7I', resp.data)))
+        return resp
+
     def mf1_detect_support(self):
         """
         Detect whether it is mifare classic tag.
@@ -165,6 +192,32 @@ class ChameleonCMD:
                            for nt, nt_enc, par in struct.iter_unpack('!IIB', resp.data)]
         return resp
 
+    @expect_response(Status.HF_TAG_OK)
+    def mf1_nested_acquire_stream(self, block_known, type_known, key_known, block_target, type_target, sets: int,
+                                  on_set=None):
+        """
+        Collect a variable number of Nested sets, each set is streamed as soon as it is captured.
+
+        :param sets: number of sets, 2 to 32
+        :param on_set: called with each set while the acquisition still runs
+        :return: the sets captured
+        """
+        if not 2 <= sets <= 32:
+            raise ValueError("sets should be between 2 and 32")
+        data = struct.pack('!BB6sBBB', type_known, block_known, key_known, type_target, block_target, sets)
+        nt_sets = []
+
+        def on_stream(chunk):
+            nt, nt_enc, par = struct.unpack('!IIB', chunk)
+            nt_sets.append({'nt': nt, 'nt_enc': nt_enc, 'par': par})
+            if on_set is not None:
+                on_set(nt_sets[-1])
+
+        # each streamed set restarts the timeout
+        resp = self.device.send_cmd_sync(Command.MF1_NESTED_ACQUIRE_STREAM, data, timeout=5, on_stream=on_stream)
+        resp.parsed = nt_sets
+        return resp
+
     @expect_response(Status.HF_TAG_OK)
     def mf1_darkside_acquire(self, block_target, type_target, first_recover: Union[int, bool], sync_max):
         """
@@ -186,6 +239,56 @@ class ChameleonCMD:
                 resp.parsed = (resp.data[0],)
         return resp
 
+    @expect_response(Status.HF_TAG_OK)
+    def mf1_darkside_acquire_batch(self, block_target, type_target, first_recover: Union[int, bool], sync_max,
+                                   sets: int):
+        """
+        Collect several sets of Darkside parameters in one command, each set is streamed as soon as it is captured.
+
+        :param sets: number of sets, 1 to 16, the batch ends early if the darkside status is not OK
+        :return: the darkside status which ended the batch and the sets captured
+        """
+        if not 1 <= sets <= 16:
+            raise ValueError("sets should be between 1 and 16")
+        data = struct.pack('!BBBBB', type_target, block_target, first_recover, sync_max, sets)
+        darkside_list = []
+
+        def on_stream(chunk):
+            uid, nt1, par, ks1, nr, ar = struct.unpack('!IIQQII', chunk)
+            darkside_list.append({'uid': uid, 'nt1': nt1, 'par': par, 'ks1': ks1, 'nr': nr, 'ar': ar})
+
+        # each streamed set restarts the timeout
+        resp = self.device.send_cmd_sync(Command.MF1_DARKSIDE_ACQUIRE_BATCH, data, timeout=sync_max * 10,
+                                         on_stream=on_stream)
+        if resp.status == Status.HF_TAG_OK:
+            resp.parsed = (resp.data[0], darkside_list)
+        return resp
+
+    def mf1_check_keys_on_block_max(self) -> int:
+        """
+        Keys one MF1_CHECK_KEYS_ON_BLOCK can take: as many as the negotiated frame length holds
+        after the type and the block, 255 at most as the firmware counts them in a byte.
+        """
+        return min((self.device.data_max_length - 2) // 6, 255)
+
+    @expect_response([Status.HF_TAG_OK, Status.MF_ERR_AUTH])
+    def mf1_check_keys_on_block(self, block, type_value: MfcKeyType, keys: list[bytes]):
+        """
+        Try a list of keys on one block, the first key which authenticates is returned.
+
+        :param keys: 1 to mf1_check_keys_on_block_max() keys of 6 bytes
+        :return: the key found or None
+        """
+        if len(keys) < 1 or len(keys) > self.mf1_check_keys_on_block_max():
+            raise ValueError("Invalid len(keys)")
+        data = struct.pack(f'!BB{6*len(keys)}s', type_value, block, b''.join(keys))
+        # base timeout: 1s, auth: 0.1s per key
+        resp = self.device.send_cmd_sync(Command.MF1_CHECK_KEYS_ON_BLOCK, data, timeout=1 + len(keys) * 0.1)
+        resp.parsed = None
+        if resp.status == Status.HF_TAG_OK:
+            resp.parsed = resp.data[1:7]
+        return resp
+
     @expect_response([Status.HF_TAG_OK, Status.MF_ERR_AUTH])
     def mf1_auth_one_key_block(self, block, type_value: MfcKeyType, key):
         """
@@ -301,9 +404,10 @@ class ChameleonCMD:
         return resp
 
     @expect_response([Status.HF_TAG_OK, Status.HF_TAG_NO])
-    def mf1_check_keys_of_sectors(self, mask: bytes, keys: list[bytes]):
+    def mf1_check_keys_of_sectors(self, mask: bytes, keys: list[bytes], stats: bool = False):
         """
         Check keys of sectors.
+        :param stats: also get the auths tried and the sectorKeys searched, the firmware of before does not know this flag
         :return:
         """
         if len(mask) != 10:
@@ -311,6 +415,8 @@ class ChameleonCMD:
         if len(keys) < 1 or len(keys) > 83:
             raise ValueError("Invalid len(keys)")
         data = struct.pack(f'!10s{6*len(keys)}s', mask, b''.join(keys))
+        if stats:
+            data += b'\x01'
 
         bitsCnt = 80 # maximum sectorKey_to_be_checked
         for b in mask:
@@ -330,13 +436,123 @@ class ChameleonCMD:
 
         resp = self.device.send_cmd_sync(Command.MF1_CHECK_KEYS_OF_SECTORS, data, timeout=timeout)
         resp.parsed = { 'status': resp.status }
-        if len(resp.data) == 490:
+        if len(resp.data) in (490, 494):
             found = ''.join([format(i, '08b') for i in resp.data[0:10]])
             # print(f'{found = }')
             resp.parsed.update({
                 'found': resp.data[0:10],
                 'sectorKeys': {k: resp.data[6 * k + 10:6 * k + 16] for k, v in enumerate(found) if v == '1'}
             })
+        # the auths tried and the sectorKeys searched, when asked for
+        if len(resp.data) == 494:
+            resp.parsed['auths'], resp.parsed['sectorKeysChecked'] = struct.unpack_from('!HH', resp.data, 490)
+        return resp
+
+    @expect_response(Status.HF_TAG_OK)
+    def mf1_nested_nonces_of_sectors(self, block_known, type_known, key_known, sectors: int, count: int, mask: bytes):
+        """
+        Collect nested encrypted nonces with parity of every sectorKey not masked, for checking keys offline.
+
+        :param sectors: number of sectors of the card, 40 at most
+        :param count: nonces per sectorKey, 8 at most
+        :param mask: which sectorKey to skip, in the format of mf1_check_keys_of_sectors
+        :return: uid and the nonces (nt_enc, par) of each sectorKey, 2 * sector + (0: key A, 1: key B)
+        """
+        if len(mask) != 10:
+            raise ValueError("len(mask) should be 10")
+        data = struct.pack('!BB6sBB10s', type_known, block_known, key_known, sectors, count, mask)
+        # base timeout: 5s, each streamed chunk restarts it
+        resp = self.device.send_cmd_sync(Command.MF1_NESTED_NONCES_OF_SECTORS, data, timeout=5)
+        if resp.status == Status.HF_TAG_OK:
+            uid = 0
+            nonces = {}
+            for chunk in resp.stream + [resp.data]:
+                uid, = struct.unpack_from('!I', chunk)
+                pos = 4
+                while pos + 3 <= len(chunk):
+                    sector, key_type, n = struct.unpack_from('!BBB', chunk, pos)
+                    pos += 3
+                    nonces[2 * sector + (key_type & 0x01)] = list(struct.iter_unpack('!IB', chunk[pos:pos + 5 * n]))
+                    pos += 5 * n
+            resp.parsed = {'uid': uid, 'nonces': nonces}
+        return resp
+
+    @expect_response([Status.HF_TAG_OK, Status.HF_TAG_NO])
+    def mf1_dump(self, sectors: int, sector_keys: dict[int, bytes]):
+        """
+        Read all sectors of the card on device, with the keys found by mf1_check_keys_of_sectors.
+        The sectors are streamed while they are read, so a lost card still returns the sectors read before.
+
+        :param sectors: number of sectors of the card, 40 at most
+        :param sector_keys: sectorKeys as returned by mf1_check_keys_of_sectors, 2 * sector + (0: key A, 1: key B)
+        :return:
+        """
+        if sectors < 1 or sectors > 40:
+            raise ValueError("Invalid sectors")
+        found = bytearray(10)
+        keys = bytearray(480)
+        for k, key in sector_keys.items():
+            if k >= 2 * sectors:
+                continue
+            found[k // 8] |= 0x80 >> (k % 8)
+            keys[6 * k:6 * k + 6] = key
+        data = struct.pack('!B10s480s', sectors, found, keys)
+
+        # base timeout: 5s, each streamed chunk restarts it
+        resp = self.device.send_cmd_sync(Command.MF1_DUMP, data, timeout=5)
+        dumped = {}
+        for chunk in resp.stream + [resp.data]:
+            pos = 0
+            while pos + 4 <= len(chunk):
+                sector, authed, read_mask = struct.unpack_from('!BBH', chunk, pos)
+                block_count = 4 if sector < 32 else 16
+                pos += 4
+                dumped[sector] = {
+                    'keyA': (authed & 0b10) > 0,
+                    'keyB': (authed & 0b01) > 0,
+                    'read_mask': read_mask,
+                    'blocks': [bytes(chunk[pos + 16 * i:pos + 16 * i + 16]) for i in range(block_count)],
+                }
+                pos += 16 * block_count
+        resp.parsed = {'status': resp.status, 'sectors': dumped}
+        return resp
+
+    @expect_response([Status.HF_TAG_OK, Status.HF_TAG_NO, Status.MF_ERR_AUTH, Status.HF_ERR_STAT, Status.HF_ERR_CRC])
+    def mf0_ntag_dump(self, page: int, stop: int, key: bytes = None):
+        """
+        Read the pages of a Mifare Ultralight / NTAG on device, with GET_VERSION and READ_SIG in the same select.
+        The pages are streamed while they are read, the dump ends at the first page the tag refuses.
+
+        :param page: first page
+        :param stop: page after the last page, 256 at most
+        :param key: password for PWD_AUTH, 4 bytes
+        :return: version, signature and pack, None if the tag didn't answer, and the pages read
+        """
+        if not 0 <= page < stop <= 256:
+            raise ValueError("Invalid page range")
+        data = struct.pack('!BH?4s', page, stop, key is not None, key or bytes(4))
+        # base timeout: 5s, each streamed chunk restarts it
+        resp = self.device.send_cmd_sync(Command.MF0_NTAG_DUMP, data, timeout=5)
+        flags, version, signature, pack = 0, None, None, None
+        pages = {}
+        for chunk in resp.stream + [resp.data]:
+            if len(chunk) < 43:
+                continue
+            flags, version, signature, pack = struct.unpack_from('!B8s32s2s', chunk)
+            pos = 43
+            while pos + 2 <= len(chunk):
+                first, count = struct.unpack_from('!BB', chunk, pos)
+                pos += 2
+                for i in range(count):
+                    pages[first + i] = bytes(chunk[pos + 4 * i:pos + 4 * i + 4])
+                pos += 4 * count
+        resp.parsed = {
+            'status': resp.status,
+            'version': version if flags & 0x01 else None,
+            'signature': signature if flags & 0x02 else None,
+            'pack': pack if flags & 0x04 else None,
+            'pages': pages,
+        }
         return resp
 
     @expect_response(Status.HF_TAG_OK)
@@ -371,6 +587,40 @@ class ChameleonCMD:
             resp.parsed = resp.data  # we can return the raw nonces bytes
         return resp
 
+    @expect_response(Status.HF_TAG_OK)
+    def mf1_hard_nested_acquire_stream(self, slow, block_known, type_known, key_known, block_target, type_target,
+                                       nonces_target, nonces_max, on_progress=None):
+        """
+        Collect the NT_ENC list for HardNested decryption in one long running acquisition.
+        The device keeps the tag selected, tracks the first bytes and Sum(a0) of the nonces,
+        and stops once all 256 first bytes are seen and nonces_target nonces are acquired.
+
+        :param nonces_target: nonces to acquire at least
+        :param nonces_max: nonces to give up at
+        :param on_progress: called with the progress dict of each streamed chunk
+        :return: progress dict with the raw nonces bytes in 'nonces_data'
+        """
+        data = struct.pack('!BBB6sBBII', slow, type_known, block_known, key_known, type_target, block_target,
+                           nonces_target, nonces_max)
+        nonces_data = bytearray()
+
+        def parse_chunk(chunk):
+            msb_count, msb_sum, nonces = struct.unpack_from('!HHI', chunk)
+            nonces_data.extend(chunk[8:])
+            return {'msb_count': msb_count, 'msb_sum': msb_sum, 'nonces': nonces}
+
+        def on_stream(chunk):
+            progress = parse_chunk(chunk)
+            if on_progress is not None:
+                on_progress(progress)
+
+        # each streamed chunk restarts the timeout
+        resp = self.device.send_cmd_sync(Command.MF1_HARDNESTED_ACQUIRE_STREAM, data, timeout=30, on_stream=on_stream)
+        if resp.status == Status.HF_TAG_OK:
+            resp.parsed = parse_chunk(resp.data)
+            resp.parsed['nonces_data'] = bytes(nonces_data)
+        return resp
+
     @expect_response(Status.LF_TAG_OK)
     def em410x_scan(self):
         """
@@ -554,14 +804,18 @@ class ChameleonCMD:
         return resp
 
     @expect_response(Status.SUCCESS)
-    def mf1_set_detection_enable(self, enabled: bool):
+    def mf1_set_detection_enable(self, enabled: bool, ring: bool = False):
         """
-        Set whether to enable the detection of the current card slot.
+        Set whether to enable the detection of the current card slot, the log is cleared.
 
         :param enable: Whether to enable
+        :param ring: Overwrite the oldest records once the log is full, instead of dropping the new ones
         :return:
         """
-        data = struct.pack('!B', enabled)
+        if ring:
+            data = struct.pack('!BB', enabled, 1)
+        else:
+            data = struct.pack('!B', enabled)
         return self.device.send_cmd_sync(Command.MF1_SET_DETECTION_ENABLE, data)
 
     @expect_response(Status.SUCCESS)
@@ -580,11 +834,17 @@ class ChameleonCMD:
     def mf1_get_detection_log(self, index: int):
         """
         Get detection logs from the specified index position.
+        The compact form of the log is used when the firmware knows it, else the records of 18 bytes.
 
         :param index: start index
         :return:
         """
         data = struct.pack('!I', index)
+        if Command.MF1_GET_DETECTION_LOG_COMPACT in self.device.commands:
+            resp = self.device.send_cmd_sync(Command.MF1_GET_DETECTION_LOG_COMPACT, data)
+            if resp.status == Status.SUCCESS:
+                resp.parsed = self.parse_detection_log_compact(resp.data)['records']
+            return resp
         resp = self.device.send_cmd_sync(Command.MF1_GET_DETECTION_LOG, data)
         if resp.status == Status.SUCCESS:
             # convert
@@ -605,6 +865,34 @@ class ChameleonCMD:
             resp.parsed = result_list
         return resp
 
+    @staticmethod
+    def parse_detection_log_compact(data: bytes):
+        """
+        Decode the compact detection log: the count of records, the count dropped, a table of uids,
+        then the records as block, flags (bit0 key B, bit1 nested, bits 3-7 uid index), nt, nr and ar.
+
+        :param data: payload of MF1_GET_DETECTION_LOG_COMPACT
+        :return: dict with count, dropped and the records in the format of mf1_get_detection_log
+        """
+        count, dropped, uid_count = struct.unpack_from('!IIB', data)
+        pos = struct.calcsize('!IIB')
+        uids = [data[pos + i * 4:pos + i * 4 + 4].hex() for i in range(uid_count)]
+        pos += uid_count * 4
+        result_list = []
+        while pos + struct.calcsize('!BB4s4s4s') <= len(data):
+            block, flags, nt, nr, ar = struct.unpack_from('!BB4s4s4s', data, pos)
+            pos += struct.calcsize('!BB4s4s4s')
+            result_list.append({
+                'block': block,
+                'type': ['A', 'B'][flags & 0x01],
+                'is_nested': bool(flags & 0x02),
+                'uid': uids[flags >> 3],
+                'nt': nt.hex(),
+                'nr': nr.hex(),
+                'ar': ar.hex()
+            })
+        return {'count': count, 'dropped': dropped, 'records': result_list}
+
     @expect_response(Status.SUCCESS)
     def mf1_write_emu_block_data(self, block_start: int, block_data: bytes):
         """
@@ -808,9 +1096,13 @@ class ChameleonCMD:
     def slot_data_config_save(self):
         """
         Update the configuration and data of the card slot to flash.
-        :return:
+        :return: save statistics, None on firmwares without them
         """
-        return self.device.send_cmd_sync(Command.SLOT_DATA_CONFIG_SAVE)
+        resp = self.device.send_cmd_sync(Command.SLOT_DATA_CONFIG_SAVE)
+        if resp.status == Status.SUCCESS and len(resp.data) >= 12:
+            resp.parsed = dict(zip(('saves', 'bytes_total', 'bytes_last', 'chunks_last', 'chunk_count'),
+                                   struct.unpack('!IIHBB', resp.data[:12])))
+        return resp
 
     def enter_bootloader(self):
         """
@@ -1090,6 +1382,40 @@ class ChameleonCMD:
         data = struct.pack('!B', mode)
         return self.device.send_cmd_sync(Command.MF0_NTAG_SET_WRITE_MODE, data)
 
+    @expect_response(Status.SUCCESS)
+    def hf14a_set_emu_trace(self, enable: bool, live: bool = False):
+        """
+        Enable the trace of the frames exchanged while emulating a 14a tag, it starts empty.
+
+        :param enable: trace the frames
+        :param live: push the frames with HF14A_EMU_TRACE_LIVE while emulating
+        :return:
+        """
+        data = struct.pack('!??', enable, live)
+        return self.device.send_cmd_sync(Command.HF14A_SET_EMU_TRACE, data)
+
+    @staticmethod
+    def parse_emu_trace(data: bytes):
+        """
+        Split a frame of the emulation trace, @see trace_utils
+
+        :return: dict with the records overwritten since the last frame, the bytes still pending and the records
+        """
+        dropped, pending = struct.unpack_from('!IH', data)
+        return {'dropped': dropped, 'pending': pending, 'records': data[struct.calcsize('!IH'):]}
+
+    @expect_response(Status.SUCCESS)
+    def hf14a_get_emu_trace(self):
+        """
+        Take the oldest records of the emulation trace, call again while 'pending' is not 0.
+
+        :return:
+        """
+        resp = self.device.send_cmd_sync(Command.HF14A_GET_EMU_TRACE)
+        if resp.status == Status.SUCCESS:
+            resp.parsed = self.parse_emu_trace(resp.data)
+        return resp
+
     @expect_response(Status.SUCCESS)
     def get_ble_pairing_enable(self):
         """
@@ -1107,6 +1433,145 @@ class ChameleonCMD:
         data = struct.pack('!B', enabled)
         return self.device.send_cmd_sync(Command.SET_BLE_PAIRING_ENABLE, data)
 
+    @expect_response(Status.SUCCESS)
+    def set_max_data_length(self, max_length: int):
+        """
+            Negotiate the max data length of a frame, answer is the length accepted by the device
+        """
+        data = struct.pack('!H', max_length)
+        resp = self.device.send_cmd_sync(Command.SET_MAX_DATA_LENGTH, data)
+        if resp.status == Status.SUCCESS:
+            resp.parsed = struct.unpack('!H', resp.data)[0]
+        return resp
+
+    def batch(self) -> "ChameleonBatch":
+        """
+            Collect commands and run them on the device in a single BATCH round trip, see ChameleonBatch
+        """
+        return ChameleonBatch(self)
+
+
+class _RecordedCommand(Exception):
+    """
+        Raised by _BatchRecorder to stop a ChameleonCMD method once its command is known
+    """
+
+    def __init__(self, cmd, data):
+        super().__init__()
+        self.cmd = cmd
+        self.data = data if data is not None else b''
+
+
+class _BatchRecorder:
+    """
+        Stand-in device recording the command a ChameleonCMD method sends
+    """
+
+    def send_cmd_sync(self, cmd, data=None, status=0, timeout=3, on_stream=None):
+        raise _RecordedCommand(cmd, data)
+
+
+class _BatchReplayer:
+    """
+        Stand-in device answering a ChameleonCMD method with the response collected by the batch
+    """
+
+    def __init__(self, response: chameleon_com.Response):
+        self.response = response
+
+    def send_cmd_sync(self, cmd, data=None, status=0, timeout=3, on_stream=None):
+        if callable(on_stream):
+            for chunk in self.response.stream:
+                on_stream(chunk)
+        return self.response
+
+
+class ChameleonBatch:
+    """
+        Run several ChameleonCMD calls with a single BATCH command, the device executes them back to back.
+
+        with cmd.batch() as batch:
+            batch.set_active_slot(1)
+            batch.hf14a_get_anti_coll_data()
+        anti_coll_data = batch.results[1]
+
+        Each call made on the batch returns its index in results. Once the block exits, results holds what the
+        ChameleonCMD method would have returned, or the exception it would have raised.
+        Only methods sending a single command can be batched.
+    """
+
+    def __init__(self, cmd: ChameleonCMD):
+        self.cmd = cmd
+        self.device = cmd.device
+        self.calls = []
+        self.results = []
+
+    def __getattr__(self, name):
+        method = getattr(ChameleonCMD, name)
+
+        def record(*args, **kwargs):
+            try:
+                method(ChameleonCMD(_BatchRecorder()), *args, **kwargs)
+            except _RecordedCommand as recorded:
+                self.calls.append((recorded.cmd, recorded.data, method, args, kwargs))
+                return len(self.calls) - 1
+            raise ValueError(f"{name} does not send a command to the device")
+
+        return record
+
+    def __enter__(self) -> "ChameleonBatch":
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        if exc_type is None:
+            self.run()
+
+    def run(self):
+        """
+            Send the recorded calls, split over several BATCH commands if they do not fit in one frame
+        """
+        responses = []
+        payload = b''
+        count = 0
+        for cmd, data, _, _, _ in self.calls:
+            record = struct.pack('!HH', cmd, len(data)) + data
+            if len(payload) + len(record) > self.device.data_max_length and count > 0:
+                responses.extend(self._send(payload, count))
+                payload = b''
+                count = 0
+            payload += record
+            count += 1
+        if count > 0:
+            responses.extend(self._send(payload, count))
+
+        self.results = []
+        for response, (_, _, method, args, kwargs) in zip(responses, self.calls):
+            try:
+                self.results.append(method(ChameleonCMD(_BatchReplayer(response)), *args, **kwargs))
+            except Exception as e:
+                self.results.append(e)
+        return self.results
+
+    def _send(self, payload: bytes, count: int) -> list:
+        resp = self.device.send_cmd_sync(Command.BATCH, payload, timeout=max(3, count))
+        if resp.status != Status.SUCCESS:
+            raise chameleon_com.CMDInvalidException(f"Batch refused by the device: {resp.status}")
+        stream = b''.join(resp.stream) + resp.data
+        responses = []
+        partial = []
+        offset = 0
+        while offset < len(stream):
+            cmd, status, length = struct.unpack_from('!HHH', stream, offset)
+            offset += struct.calcsize('!HHH')
+            data = stream[offset: offset + length]
+            offset += length
+            if status == Status.STREAM_DATA:
+                partial.append(data)
+            else:
+                responses.append(chameleon_com.Response(cmd, status, data, stream=partial))
+                partial = []
+        return responses
+
 
 def test_fn():
     # connect to chameleon
@@ -37,11 +37,13 @@ class Response:
         Chameleon Response Data
     """
 
-    def __init__(self, cmd, status, data=b'', parsed=None):
+    def __init__(self, cmd, status, data=b'', parsed=None, stream=None):
         self.cmd = cmd
         self.status = status
         self.data: bytes = data
         self.parsed = parsed
+        # data of the intermediate frames of a streamed response, in order
+        self.stream: list[bytes] = stream if stream is not None else []
 
 
 class ChameleonCom:
@@ -51,6 +53,8 @@ class ChameleonCom:
     """
     data_frame_sof = 0x11
     data_max_length = 512
+    # largest frame payload the firmware can negotiate, see SET_MAX_DATA_LENGTH
+    data_max_length_limit = 4096
     commands = []
 
     def __init__(self):
@@ -60,6 +64,8 @@ class ChameleonCom:
         self.serial_instance: Union[serial.Serial, None] = None
         self.send_data_queue = queue.Queue()
         self.wait_response_map = {}
+        # frames the device sends without being asked, cmd -> callable(data)
+        self.listeners = {}
         self.event_closing = threading.Event()
 
     def isOpen(self) -> bool:
@@ -121,12 +127,8 @@ class ChameleonCom:
         :param array: value array
         :return: u8 result
         """
-        # add and cut byte and return
-        ret = 0x00
-        for b in array:
-            ret += b
-            ret &= 0xFF
-        return (0x100 - ret) & 0xFF
+        # sum() adds the bytes in C, a loop in Python was most of the cost of the large frames
+        return (0x100 - sum(array)) & 0xFF
 
     def close(self):
         """
@@ -144,6 +146,8 @@ class ChameleonCom:
             self.serial_instance = None
         self.wait_response_map.clear()
         self.send_data_queue.queue.clear()
+        # the firmware falls back to the default frame size when the port is closed
+        self.data_max_length = ChameleonCom.data_max_length
 
     def thread_data_receive(self):
         """
@@ -220,7 +224,15 @@ class ChameleonCom:
                                     status_string = f"{CR}{data_status:30x}{C0}"
                                 print(f'<= {CC}{command_string:40}{C0}{status_string}'
                                       f'{CY}{data_response.hex() if data_response is not None else ""}{C0}')
-                            if data_cmd in self.wait_response_map:
+                            if data_cmd in self.wait_response_map and data_status == Status.STREAM_DATA:
+                                # intermediate frame, the device is alive so restart the timeout
+                                task = self.wait_response_map[data_cmd]
+                                task['end_time'] = time.time() + task['timeout']
+                                if callable(task['on_stream']):
+                                    task['on_stream'](data_response)
+                                else:
+                                    task['stream'].append(data_response)
+                            elif data_cmd in self.wait_response_map:
                                 # call processor
                                 if 'callback' in self.wait_response_map[data_cmd]:
                                     fn_call = self.wait_response_map[data_cmd]['callback']
@@ -231,8 +243,11 @@ class ChameleonCom:
                                     del self.wait_response_map[data_cmd]
                                     fn_call(data_cmd, data_status, data_response)
                                 else:
-                                    self.wait_response_map[data_cmd]['response'] = Response(data_cmd, data_status,
-                                                                                            data_response)
+                                    self.wait_response_map[data_cmd]['response'] = Response(
+                                        data_cmd, data_status, data_response,
+                                        stream=self.wait_response_map[data_cmd]['stream'])
+                            elif data_cmd in self.listeners:
+                                self.listeners[data_cmd](data_response)
                             else:
                                 print(f"No task wait process: ${data_cmd}")
                         else:
@@ -267,6 +282,9 @@ class ChameleonCom:
             self.wait_response_map[task_cmd]['start_time'] = start_time
             self.wait_response_map[task_cmd]['end_time'] = start_time + task_timeout
             self.wait_response_map[task_cmd]['is_timeout'] = False
+            self.wait_response_map[task_cmd]['timeout'] = task_timeout
+            self.wait_response_map[task_cmd]['on_stream'] = task.get('on_stream')
+            self.wait_response_map[task_cmd]['stream'] = []
             try:
                 assert self.serial_instance is not None
                 # send to device
@@ -317,7 +335,7 @@ class ChameleonCom:
         return bytes(frame)
 
     def send_cmd_auto(self, cmd: int, data: Union[bytes, None] = None, status: int = 0, callback=None, timeout: int = 3,
-                      close: bool = False):
+                      close: bool = False, on_stream=None):
         """
             Send cmd to device
 
@@ -325,8 +343,9 @@ class ChameleonCom:
         :param data: bytes data (optional)
         :param status: status (optional)
         :param callback: call on response
-        :param timeout: wait response timeout
+        :param timeout: wait response timeout, restarted by each intermediate frame of a streamed response
         :param close: close connection after executing
+        :param on_stream: call with the data of each intermediate frame (optional), else collected in Response.stream
         :return:
         """
         self.check_open()
@@ -347,17 +366,33 @@ class ChameleonCom:
         task = {'cmd': cmd, 'frame': data_frame, 'timeout': timeout, 'close': close}
         if callable(callback):
             task['callback'] = callback
+        if callable(on_stream):
+            task['on_stream'] = on_stream
         self.send_data_queue.put(task)
 
+    def set_listener(self, cmd: int, listener=None):
+        """
+            Call listener with the data of each frame of cmd the device sends without being asked.
+
+        :param cmd: cmd
+        :param listener: callable(data), None to remove it
+        :return:
+        """
+        if listener is None:
+            self.listeners.pop(cmd, None)
+        else:
+            self.listeners[cmd] = listener
+
     def send_cmd_sync(self, cmd: int, data: Union[bytes, None] = None, status: int = 0,
-                      timeout: int = 3) -> Response:
+                      timeout: int = 3, on_stream=None) -> Response:
         """
             Send cmd to device, and block receive data.
 
         :param cmd: cmd
         :param data: bytes data (optional)
         :param status: status (optional)
-        :param timeout: wait response timeout
+        :param timeout: wait response timeout, restarted by each intermediate frame of a streamed response
+        :param on_stream: call with the data of each intermediate frame (optional), else collected in Response.stream
         :return: response data
         """
         if len(self.commands):
@@ -366,7 +401,7 @@ class ChameleonCom:
                 raise CMDInvalidException(f"This device doesn't declare that it can support this command: {cmd}.\n"
                                           f"Make sure firmware is up to date and matches client")
         # first to send cmd, no callback mode(sync)
-        self.send_cmd_auto(cmd, data, status, None, timeout)
+        self.send_cmd_auto(cmd, data, status, None, timeout, on_stream=on_stream)
         # wait cmd start process
         while cmd not in self.wait_response_map:
             time.sleep(0.01)
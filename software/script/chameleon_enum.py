@@ -55,6 +55,8 @@ class Command(enum.IntEnum):
     GET_DEVICE_CAPABILITIES = 1035
     GET_BLE_PAIRING_ENABLE = 1036
     SET_BLE_PAIRING_ENABLE = 1037
+    SET_MAX_DATA_LENGTH = 1038
+    BATCH = 1039
 
     HF14A_SCAN = 2000
     MF1_DETECT_SUPPORT = 2001
@@ -70,6 +72,15 @@ class Command(enum.IntEnum):
     MF1_MANIPULATE_VALUE_BLOCK = 2011
     MF1_CHECK_KEYS_OF_SECTORS = 2012
     DATA_CMD_MF1_HARDNESTED_ACQUIRE = 2013
+    MF1_DUMP = 2014
+    MF1_HARDNESTED_ACQUIRE_STREAM = 2015
+    MF1_NESTED_NONCES_OF_SECTORS = 2016
+    HF14A_READER_TIMING = 2017
+    MF0_NTAG_DUMP = 2018
+    MF1_NESTED_ACQUIRE_STREAM = 2019
+    MF1_DARKSIDE_ACQUIRE_BATCH = 2020
+    MF1_CHECK_KEYS_ON_BLOCK = 2021
+    HF14A_SET_READER_TARGET = 2022
 
     EM410X_SCAN = 3000
     EM410X_WRITE_TO_T55XX = 3001
@@ -111,6 +122,10 @@ class Command(enum.IntEnum):
     MF0_NTAG_GET_PAGE_COUNT = 4030
     MF0_NTAG_GET_WRITE_MODE = 4031
     MF0_NTAG_SET_WRITE_MODE = 4032
+    HF14A_SET_EMU_TRACE = 4033
+    HF14A_GET_EMU_TRACE = 4034
+    HF14A_EMU_TRACE_LIVE = 4035
+    MF1_GET_DETECTION_LOG_COMPACT = 4036
 
     EM410X_SET_EMU_ID = 5000
     EM410X_GET_EMU_ID = 5001
@@ -146,6 +161,7 @@ class Status(enum.IntEnum):
     FLASH_WRITE_FAIL = 0x70
     FLASH_READ_FAIL = 0x71
     INVALID_SLOT_TYPE = 0x72
+    STREAM_DATA = 0x73
 
     def __str__(self):
         if self == Status.HF_TAG_OK:
@@ -186,6 +202,8 @@ class Status(enum.IntEnum):
             return "Flash read failed"
         elif self == Status.INVALID_SLOT_TYPE:
             return "Invalid card type in slot"
+        elif self == Status.STREAM_DATA:
+            return "Streamed data, more to come"
         return "Invalid status"
 
 
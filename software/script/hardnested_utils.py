@@ -9,11 +9,7 @@ def evenparity32(n):
     calc evenparity32, can replace to any fast native impl...
     @param n - NT_ENC
     """
-    ret = 0
-    for i in range(32):
-        if (n & (1 << i)) != 0:
-            ret += 1
-    return ret % 2
+    return bin(n & 0xffffffff).count('1') & 1
 
 
 def check_nonce_unique_sum(nt, par):
@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+
+import os
+import sys
+import unittest
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+
+from chameleon_com import ChameleonCom   # noqa: E402
+import trace_utils                       # noqa: E402
+
+# Same file as the firmware test crc_test.c
+VECTORS = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                       '..', '..', '..', 'firmware', 'application', 'test', 'vectors', 'checksums.txt')
+
+
+def vector_data(text):
+    """Data of a vector: hex, '-' for none, or @<length> for the bytes (i * 31 + 7) & 0xFF"""
+    if text == '-':
+        return b''
+    if text.startswith('@'):
+        return bytes((i * 31 + 7) & 0xFF for i in range(int(text[1:])))
+    return bytes.fromhex(text)
+
+
+def read_vectors(kind):
+    with open(VECTORS) as file:
+        for number, line in enumerate(file, 1):
+            words = line.split()
+            if len(words) == 3 and not line.startswith('#') and words[0] == kind:
+                yield number, vector_data(words[1]), bytes.fromhex(words[2])
+
+
+class TestChecksums(unittest.TestCase):
+    """LRC of the data frames and CRC_A of the client against the vectors shared with the firmware"""
+
+    def test_lrc(self):
+        vectors = list(read_vectors('lrc'))
+        self.assertTrue(vectors)
+        for number, data, expected in vectors:
+            with self.subTest(line=number):
+                self.assertEqual(ChameleonCom.lrc_calc(data), expected[0])
+                self.assertEqual(ChameleonCom.lrc_calc(bytearray(data)), expected[0])
+
+    def test_crc_a(self):
+        vectors = list(read_vectors('crc_a'))
+        self.assertTrue(vectors)
+        for number, data, expected in vectors:
+            with self.subTest(line=number):
+                self.assertEqual(trace_utils.crc_a(data), expected)
+                self.assertEqual(trace_utils.crc_a(list(data)), expected)
+
+
+if __name__ == '__main__':
+    unittest.main()
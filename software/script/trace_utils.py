@@ -0,0 +1,167 @@
+"""
+Frames of the 14a emulation trace, as sent by HF14A_GET_EMU_TRACE and HF14A_EMU_TRACE_LIVE,
+and the binary trace file written by 'hf 14a trace'.
+
+A record is a '!IH' header, RTC ticks at 32768 Hz (24 bits that wrap) and the frame bits with the flags below,
+followed by the data and, with TRACE_PARITY, one parity bit per byte, LSB first.
+The file is TRACE_FILE_MAGIC, the version and 3 reserved bytes, then the records as the device sent them.
+A record of 0 bits is a gap, its timestamp is the number of records the device overwrote before the next one.
+"""
+import binascii
+import struct
+
+TRACE_FROM_TAG = 0x8000
+TRACE_PARITY = 0x4000
+TRACE_CRC = 0x2000
+TRACE_BITS_MASK = 0x1FFF
+
+TRACE_HEADER = struct.Struct('!IH')
+TRACE_TICKS_PER_SECOND = 32768
+TRACE_TICKS_MASK = 0xFFFFFF
+
+TRACE_FILE_MAGIC = b'CUTR'
+TRACE_FILE_VERSION = 1
+TRACE_FILE_HEADER = struct.Struct('!4sB3x')
+
+
+# The CRC_A is the CRC-16 of binascii.crc_hqx taken LSB first: with the bits of each byte reversed it runs in C,
+# 0xC6C6 being the 0x6363 preset reversed
+BIT_REVERSE = bytes(int(f'{i:08b}'[::-1], 2) for i in range(256))
+
+
+def crc_a(data):
+    """
+    ISO14443-A CRC of data, as the 2 bytes sent after it
+    """
+    crc = binascii.crc_hqx(bytes(data).translate(BIT_REVERSE), 0xC6C6)
+    return bytes([BIT_REVERSE[crc >> 8], BIT_REVERSE[crc & 0xFF]])
+
+
+def record_length(bits):
+    """
+    Length of a record from its bits field
+    """
+    data_length = ((bits & TRACE_BITS_MASK) + 7) // 8
+    length = TRACE_HEADER.size + data_length
+    if bits & TRACE_PARITY:
+        length += (data_length + 7) // 8
+    return length
+
+
+def gap_record(dropped):
+    """
+    Record telling that the device overwrote dropped records
+    """
+    return TRACE_HEADER.pack(dropped, 0)
+
+
+def parse_records(data):
+    """
+    Split the records of a trace
+
+    :param data: records as sent by the device or read from a trace file
+    :return: list of dict, a gap has only 'dropped'
+    """
+    records = []
+    pos = 0
+    while pos + TRACE_HEADER.size <= len(data):
+        timestamp, bits = TRACE_HEADER.unpack_from(data, pos)
+        if bits == 0:
+            records.append({'dropped': timestamp})
+            pos += TRACE_HEADER.size
+            continue
+        length = record_length(bits)
+        if pos + length > len(data):
+            break
+        data_length = ((bits & TRACE_BITS_MASK) + 7) // 8
+        start = pos + TRACE_HEADER.size
+        parity = None
+        if bits & TRACE_PARITY:
+            parity_bytes = data[start + data_length:pos + length]
+            parity = [(parity_bytes[i // 8] >> (i % 8)) & 1 for i in range(data_length)]
+        records.append({
+            'timestamp': timestamp,
+            'from_tag': bool(bits & TRACE_FROM_TAG),
+            'bits': bits & TRACE_BITS_MASK,
+            'data': bytes(data[start:start + data_length]),
+            'parity': parity,
+            'crc': bool(bits & TRACE_CRC),
+        })
+        pos += length
+    return records
+
+
+class TraceWriter:
+    """
+    Binary trace file, the records are written as they come from the device
+    """
+
+    def __init__(self, path):
+        self.file = open(path, 'wb')
+        self.file.write(TRACE_FILE_HEADER.pack(TRACE_FILE_MAGIC, TRACE_FILE_VERSION))
+        self.count = 0
+
+    def write(self, records, dropped=0):
+        if dropped > 0:
+            self.file.write(gap_record(dropped))
+        self.file.write(records)
+        self.count += len(parse_records(records))
+
+    def close(self):
+        self.file.close()
+
+
+def read_file(path):
+    """
+    Records of a binary trace file
+    """
+    with open(path, 'rb') as f:
+        data = f.read()
+    if len(data) < TRACE_FILE_HEADER.size:
+        raise ValueError("Not a trace file")
+    magic, version = TRACE_FILE_HEADER.unpack_from(data)
+    if magic != TRACE_FILE_MAGIC or version != TRACE_FILE_VERSION:
+        raise ValueError("Not a trace file or unsupported version")
+    return data[TRACE_FILE_HEADER.size:]
+
+
+def mf1_auths(records):
+    """
+    Authentications in plain found in a trace, in the format of the MF1 detection log for mfkey32.
+    Nested authentications are encrypted and skipped.
+
+    :param records: list of parse_records
+    :return: list of dict with block, type, is_nested, uid, nt, nr, ar (hex strings)
+    """
+    auths = []
+    uid = None
+    auth = None
+    encrypted = False
+    for record in records:
+        if 'dropped' in record:
+            auth = None
+            continue
+        data = record['data']
+        if not record['from_tag']:
+            if record['bits'] == 7:
+                # REQA / WUPA, a new session in plain
+                encrypted = False
+                auth = None
+            elif encrypted:
+                continue
+            elif len(data) == 9 and data[0] in (0x93, 0x95, 0x97) and data[1] == 0x70:
+                # SELECT, the last cascade level holds the uid used by crypto1
+                uid = data[2:6].hex()
+            elif len(data) == 4 and data[0] in (0x60, 0x61) and data[2:] == crc_a(data[:2]):
+                auth = {'block': data[1], 'type': ['A', 'B'][data[0] & 0x01], 'is_nested': False, 'uid': uid}
+            elif len(data) == 8 and auth is not None and 'nt' in auth:
+                auth['nr'] = data[:4].hex()
+                auth['ar'] = data[4:].hex()
+                if auth['uid'] is not None:
+                    auths.append(auth)
+                auth = None
+                # the tag answers encrypted if the key was right, else the reader starts again
+                encrypted = True
+        elif auth is not None and 'nt' not in auth and len(data) == 4:
+            auth['nt'] = data.hex()
+    return auths
@@ -5,45 +5,177 @@
 #include "common.h"
 #include "nested_util.h"
 
+
+// Append the keystream candidates of one set which pass the parity check
+static bool set_to_ntp_ks1(uint32_t nt1, uint32_t nt2, uint8_t par_int, uint32_t dist, NtpKs1 **pNK, uint32_t *sizePNK) {
+    uint32_t m, nttest, ks1;
+    uint8_t par_arr[3] = { 0x00 };
+
+    if (par_int != 0) {
+        for (m = 0; m < 3; m++) {
+            par_arr[m] = (par_int >> m) & 0x01;
+        }
+    }
+    // Try to recover the keystream1
+    nttest = prng_successor(nt1, dist - 14);
+    for (m = dist - 14; m <= dist + 14; m += 1) {
+        ks1 = nt2 ^ nttest;
+        if (valid_nonce(nttest, nt2, ks1, par_arr)) {
+            // append to list
+            void *tmp = realloc(*pNK, sizeof(NtpKs1) * (*sizePNK + 1));
+            if (tmp == NULL) {
+                return false;
+            }
+            *pNK = tmp;
+            (*pNK)[*sizePNK].ntp = nttest;
+            (*pNK)[*sizePNK].ks1 = ks1;
+            (*sizePNK)++;
+        }
+        nttest = prng_successor(nttest, 1);
+    }
+    return true;
+}
+
+static int compar_key(const void *a, const void *b) {
+    if (*(uint64_t *)b == *(uint64_t *)a) return 0;
+    if (*(uint64_t *)b < *(uint64_t *)a) return 1;
+    return -1;
+}
+
+// Keys of all sets seen so far, sorted, with the number of sets each key was found in
+static uint64_t *seenKeys = NULL;
+static uint8_t *seenSets = NULL;
+static uint32_t seenCount = 0;
+
+// Merge the keys of one more set and find the keys found in the most sets, bestKey is the last of them
+static bool merge_set_keys(uint64_t *keys, uint32_t keyCount, uint8_t *bestSets, uint32_t *bestCount, uint64_t *bestKey) {
+    uint32_t i, j, k, n;
+
+    qsort(keys, keyCount, sizeof(uint64_t), compar_key);
+    // a set counts once for a key, even if several of its keystreams give it
+    for (i = 0, n = 0; i < keyCount; i++) {
+        if (n == 0 || keys[n - 1] != keys[i]) {
+            keys[n++] = keys[i];
+        }
+    }
+
+    if (seenCount + n == 0) {
+        return true;
+    }
+    uint64_t *mergedKeys = malloc(sizeof(uint64_t) * (seenCount + n));
+    uint8_t *mergedSets = malloc(seenCount + n);
+    if (mergedKeys == NULL || mergedSets == NULL) {
+        free(mergedKeys);
+        free(mergedSets);
+        return false;
+    }
+    for (i = 0, j = 0, k = 0; i < seenCount || j < n; k++) {
+        if (j == n || (i < seenCount && seenKeys[i] < keys[j])) {
+            mergedKeys[k] = seenKeys[i];
+            mergedSets[k] = seenSets[i++];
+        } else if (i == seenCount || keys[j] < seenKeys[i]) {
+            mergedKeys[k] = keys[j++];
+            mergedSets[k] = 1;
+        } else {
+            mergedKeys[k] = keys[j++];
+            mergedSets[k] = seenSets[i++] + 1;
+        }
+        if (mergedSets[k] > *bestSets) {
+            *bestSets = mergedSets[k];
+            *bestCount = 0;
+        }
+        if (mergedSets[k] == *bestSets) {
+            (*bestCount)++;
+            *bestKey = mergedKeys[k];
+        }
+    }
+    free(seenKeys);
+    free(seenSets);
+    seenKeys = mergedKeys;
+    seenSets = mergedSets;
+    seenCount = k;
+    return true;
+}
+
+// Read one set "<nt> <nt_enc> <par>" per line until a single key is found in more sets than any other key.
+// The answer to each line is either the key or the number of candidates left, so the sets can be
+// fed while they are still acquired and the acquisition can stop at the first unique key.
+static int nested_stream(uint32_t authuid, uint32_t dist) {
+    char line[128];
+    uint32_t sets = 0;
+
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        char *nt1Str = strtok(line, " \t\r\n");
+        char *nt2Str = strtok(NULL, " \t\r\n");
+        char *parStr = strtok(NULL, " \t\r\n");
+        if (nt1Str == NULL || nt2Str == NULL || parStr == NULL) {
+            continue;
+        }
+
+        NtpKs1 *pNK = NULL;
+        uint32_t sizePNK = 0, keyCount = 0;
+        if (!set_to_ntp_ks1(atoui(nt1Str), atoui(nt2Str), atoui(parStr), dist, &pNK, &sizePNK)) {
+            free(pNK);
+            return EXIT_FAILURE;
+        }
+        sets++;
+        uint64_t *keys = sizePNK ? nested_candidates(pNK, sizePNK, authuid, &keyCount) : NULL;
+        free(pNK);
+
+        uint8_t bestSets = 0;
+        uint32_t bestCount = 0;
+        uint64_t bestKey = 0;
+        bool ok = merge_set_keys(keys, keyCount, &bestSets, &bestCount, &bestKey);
+        free(keys);
+        if (!ok) {
+            printf("Cannot allocate memory to merge keys.\r\n");
+            return EXIT_FAILURE;
+        }
+        if (bestSets >= 2 && bestCount == 1) {
+            printf("Key 1... %012" PRIx64 " \r\n", bestKey);
+            fflush(stdout);
+            return EXIT_SUCCESS;
+        }
+        printf("Sets %" PRIu32 ", %" PRIu32 " candidate key(s) in %d set(s)\r\n", sets, bestCount, bestSets);
+        fflush(stdout);
+    }
+
+    // No unique key, give the keys found in the most sets to be tried on the card
+    uint32_t found = 0;
+    for (uint32_t n = sets; n >= 2 && found < TRY_KEYS; n--) {
+        for (uint32_t i = 0; i < seenCount && found < TRY_KEYS; i++) {
+            if (seenSets[i] == n) {
+                printf("Key %" PRIu32 "... %012" PRIx64 " \r\n", ++found, seenKeys[i]);
+            }
+        }
+    }
+    fflush(stdout);
+    return EXIT_SUCCESS;
+}
+
+// Usage: nested <uid> <dist> [<nt> <nt_enc> <par>]...
+// Without sets on the command line the sets are read from stdin, @see nested_stream
 int main(int argc, char *const argv[]) {
     NtpKs1 *pNK = NULL;
-    uint32_t i, j, m;
-    uint32_t nt1, nt2, nttest, ks1, dist;
-    uint8_t par_int;
-    uint8_t par_arr[3] = { 0x00 };
+    uint32_t i, j = 0;
+    uint32_t dist;
 
+    if (argc < 3) {
+        printf("Usage: %s <uid> <dist> [<nt> <nt_enc> <par>]...\r\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
     uint32_t authuid = atoui(argv[1]);   // uid
     dist = atoui(argv[2]);  // dist
 
+    if (argc == 3) {
+        exit(nested_stream(authuid, dist));
+    }
+
     // process all args.
-    for (i = 3, j = 0; i < argc; i += 3) {
+    for (i = 3; i + 2 < argc; i += 3) {
         // nt + par
-        nt1 = atoui(argv[i]);
-        nt2 = atoui(argv[i + 1]);
-        par_int = atoui(argv[i + 2]);
-        if (par_int != 0) {
-            for (m = 0; m < 3; m++) {
-                par_arr[m] = (par_int >> m) & 0x01;
-            }
-        } else {
-            memset(par_arr, 0, 3);
-        }
-        // Try to recover the keystream1
-        nttest = prng_successor(nt1, dist - 14);
-        for (m = dist - 14; m <= dist + 14; m += 1) {
-            ks1 = nt2 ^ nttest;
-            if (valid_nonce(nttest, nt2, ks1, par_arr)) {
-                ++j;
-                // append to list
-                void *tmp = realloc(pNK, sizeof(NtpKs1) * j);
-                if (tmp == NULL) {
-                    goto error;
-                }
-                pNK = tmp;
-                pNK[j - 1].ntp = nttest;
-                pNK[j - 1].ks1 = ks1;
-            }
-            nttest = prng_successor(nttest, 1);
+        if (!set_to_ntp_ks1(atoui(argv[i]), atoui(argv[i + 1]), atoui(argv[i + 2]), dist, &pNK, &j)) {
+            goto error;
         }
     }
 
@@ -17,7 +17,6 @@
 
 
 #define MEM_CHUNK               10000
-#define TRY_KEYS                50
 
 
 typedef struct {
@@ -151,7 +150,8 @@ static void *nested_revover(void *args) {
     return NULL;
 }
 
-uint64_t *nested(NtpKs1 *pNK, uint32_t sizePNK, uint32_t authuid, uint32_t *keyCount) {
+// All the key candidates of the nonces, a key can be found several times
+uint64_t *nested_candidates(NtpKs1 *pNK, uint32_t sizePNK, uint32_t authuid, uint32_t *keyCount) {
 #define THREAD_MAX 4
 
     *keyCount = 0;
@@ -215,37 +215,49 @@ uint64_t *nested(NtpKs1 *pNK, uint32_t sizePNK, uint32_t authuid, uint32_t *keyC
                     }
                 }
             }
-
-            countKeys *ck = uniqsort(keys, *keyCount);
-            free(keys);
-            keys = (uint64_t *)NULL;
+        } else {
             *keyCount = 0;
+            printf("Cannot allocate memory to merge keys.\r\n");
+        }
+    }
+    free(pRPs);
+    return keys;
+}
 
-            if (ck != NULL) {
-                for (i = 0; i < TRY_KEYS; i++) {
-                    // We don't known this key, try to break it
-                    // This key can be found here two or more times
-                    if (ck[i].count > 0) {
-                        *keyCount += 1;
-                        void *tmp = realloc(keys, sizeof(uint64_t) * (*keyCount));
-                        if (tmp != NULL) {
-                            keys = tmp;
-                            keys[*keyCount - 1] = ck[i].key;
-                        } else {
-                            printf("Cannot allocate memory for keys on merge.");
-                            free(keys);
-                            break;
-                        }
-                    }
+uint64_t *nested(NtpKs1 *pNK, uint32_t sizePNK, uint32_t authuid, uint32_t *keyCount) {
+    uint32_t i, candidateCount;
+    uint64_t *keys = (uint64_t *)NULL;
+
+    *keyCount = 0;
+    uint64_t *candidates = nested_candidates(pNK, sizePNK, authuid, &candidateCount);
+    if (candidates == NULL) {
+        return NULL;
+    }
+
+    countKeys *ck = uniqsort(candidates, candidateCount);
+    free(candidates);
+
+    if (ck != NULL) {
+        for (i = 0; i < TRY_KEYS; i++) {
+            // We don't known this key, try to break it
+            // This key can be found here two or more times
+            if (ck[i].count > 0) {
+                *keyCount += 1;
+                void *tmp = realloc(keys, sizeof(uint64_t) * (*keyCount));
+                if (tmp != NULL) {
+                    keys = tmp;
+                    keys[*keyCount - 1] = ck[i].key;
+                } else {
+                    printf("Cannot allocate memory for keys on merge.");
+                    free(keys);
+                    break;
                 }
-            } else {
-                printf("Cannot allocate memory for ck on uniqsort.");
             }
-        } else {
-            printf("Cannot allocate memory to merge keys.\r\n");
         }
+        free(ck);
+    } else {
+        printf("Cannot allocate memory for ck on uniqsort.");
     }
-    free(pRPs);
     return keys;
 }
 
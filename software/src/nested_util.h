@@ -3,12 +3,15 @@
 
 #include "crapto1.h"
 
+#define TRY_KEYS                50      // Candidate keys given at most, the ones found in the most sets first
+
 typedef struct {
     uint32_t ntp;
     uint32_t ks1;
 } NtpKs1;
 
 uint8_t valid_nonce(uint32_t Nt, uint32_t NtEnc, uint32_t Ks1, uint8_t *parity);
+uint64_t *nested_candidates(NtpKs1 *pNK, uint32_t sizePNK, uint32_t authuid, uint32_t *keyCount);
 uint64_t *nested(NtpKs1 *pNK, uint32_t sizePNK, uint32_t authuid, uint32_t *keyCount);
 
 #endif
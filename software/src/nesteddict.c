@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include "common.h"
+#include "crapto1.h"
+#include "parity.h"
+
+#if WIN32
+#include "windows.h"
+#else
+#include "unistd.h"
+#endif
+
+#include "pthread.h"
+
+
+#define THREAD_MAX              16
+#define NONCES_MAX              8
+#define TARGETS_MAX             80
+
+
+typedef struct {
+    uint32_t nt_enc;
+    uint8_t par;    // encrypted parity bits, the parity of the first byte at bit 3
+} EncNonce;
+
+typedef struct {
+    uint32_t target;    // 2 * sector + (0 for key A, 1 for key B)
+    uint32_t count;
+    EncNonce nonces[NONCES_MAX];
+} Target;
+
+typedef struct {
+    uint64_t key;
+    uint32_t target;
+} Survivor;
+
+typedef struct {
+    uint64_t *keys;
+    uint32_t startPos;
+    uint32_t endPos;
+
+    Survivor *survivors;
+    uint32_t survivorCount;
+} CheckPar;
+
+
+static uint32_t authuid;
+static bool checkPrng;
+static Target targets[TARGETS_MAX];
+static uint32_t targetCount;
+
+
+// Decrypt the nonces with the key, a wrong key fails each parity bit with a chance of 1/2
+static bool key_matches(uint64_t key, const Target *t) {
+    struct Crypto1State s;
+    uint32_t i, ks1, nt;
+
+    for (i = 0; i < t->count; i++) {
+        crypto1_init(&s, key);
+        ks1 = crypto1_word(&s, authuid ^ t->nonces[i].nt_enc, 1);
+        nt = t->nonces[i].nt_enc ^ ks1;
+        // the parity bit of a byte is encrypted with the keystream bit of the first bit of the next byte
+        if ((oddparity8(nt >> 24) ^ BIT(ks1, 16)) != BIT(t->nonces[i].par, 3) ||
+                (oddparity8(nt >> 16) ^ BIT(ks1, 8)) != BIT(t->nonces[i].par, 2) ||
+                (oddparity8(nt >> 8) ^ BIT(ks1, 0)) != BIT(t->nonces[i].par, 1) ||
+                (oddparity8(nt) ^ filter(s.odd)) != BIT(t->nonces[i].par, 0)) {
+            return false;
+        }
+        // a weak prng only gives nonces which are valid lfsr states
+        if (checkPrng && !validate_prng_nonce(nt)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void *check_keys(void *args) {
+    CheckPar *cp = (CheckPar *)args;
+    uint32_t i, j;
+
+    for (i = cp->startPos; i < cp->endPos; i++) {
+        for (j = 0; j < targetCount; j++) {
+            if (!key_matches(cp->keys[i], &targets[j])) {
+                continue;
+            }
+            void *tmp = realloc(cp->survivors, sizeof(Survivor) * (cp->survivorCount + 1));
+            if (tmp == NULL) {
+                printf("Memory allocation error for survivors");
+                return NULL;
+            }
+            cp->survivors = tmp;
+            cp->survivors[cp->survivorCount].key = cp->keys[i];
+            cp->survivors[cp->survivorCount].target = targets[j].target;
+            cp->survivorCount++;
+        }
+    }
+    return NULL;
+}
+
+// Load the keys of a .dic file, one key as hex[12] per line, anything else is skipped
+static uint64_t *load_dic(const char *path, uint32_t *keyCount) {
+    char line[64];
+    uint64_t *keys = NULL;
+    uint32_t size = 0;
+
+    *keyCount = 0;
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return NULL;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        uint64_t key = 0;
+        int i;
+        for (i = 0; i < 12 && isxdigit((unsigned char)line[i]); i++) {
+            key = key << 4 | (uint64_t)(isdigit((unsigned char)line[i]) ? line[i] - '0' : (tolower((unsigned char)line[i]) - 'a' + 10));
+        }
+        if (i != 12 || isxdigit((unsigned char)line[i])) {
+            continue;
+        }
+        if (*keyCount == size) {
+            size = size ? size * 2 : 1024;
+            void *tmp = realloc(keys, sizeof(uint64_t) * size);
+            if (tmp == NULL) {
+                free(keys);
+                fclose(fp);
+                return NULL;
+            }
+            keys = tmp;
+        }
+        keys[(*keyCount)++] = key;
+    }
+    fclose(fp);
+    return keys;
+}
+
+static uint32_t thread_count(void) {
+#if WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long n = info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (n < 1) return 1;
+    if (n > THREAD_MAX) return THREAD_MAX;
+    return (uint32_t)n;
+}
+
+// Usage: nesteddict <uid> <dic file> <check prng> [<target> <count> [<nt_enc> <par>]...]...
+// Prints "<target> <key>" for every key which decrypts all nonces of a target consistently.
+int main(int argc, char *const argv[]) {
+    uint32_t i, j, keyCount, manyThread;
+
+    if (argc < 4) {
+        printf("Usage: %s <uid> <dic file> <check prng> [<target> <count> [<nt_enc> <par>]...]...\r\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    authuid = atoui(argv[1]);
+    checkPrng = atoui(argv[3]) != 0;
+
+    // process all targets.
+    for (i = 4, targetCount = 0; i + 1 < (uint32_t)argc && targetCount < TARGETS_MAX; targetCount++) {
+        Target *t = &targets[targetCount];
+        t->target = atoui(argv[i]);
+        t->count = atoui(argv[i + 1]);
+        i += 2;
+        if (t->count > NONCES_MAX || i + t->count * 2 > (uint32_t)argc) {
+            printf("Invalid nonces of target %" PRIu32 "\r\n", t->target);
+            exit(EXIT_FAILURE);
+        }
+        for (j = 0; j < t->count; j++, i += 2) {
+            t->nonces[j].nt_enc = atoui(argv[i]);
+            t->nonces[j].par = atoui(argv[i + 1]);
+        }
+        // a target without nonces can't rule out any key
+        if (t->count == 0) {
+            targetCount--;
+        }
+    }
+
+    uint64_t *keys = load_dic(argv[2], &keyCount);
+    if (keys == NULL || keyCount == 0 || targetCount == 0) {
+        free(keys);
+        exit(EXIT_SUCCESS);
+    }
+
+    manyThread = thread_count();
+    if (manyThread > keyCount) {
+        manyThread = keyCount;
+    }
+
+    pthread_t threads[THREAD_MAX];
+    CheckPar pCPs[THREAD_MAX];
+    memset(pCPs, 0, sizeof(pCPs));
+
+    uint32_t average = keyCount / manyThread;
+    uint32_t modules = keyCount % manyThread;
+
+    // Assign tasks
+    for (i = 0, j = 0; i < manyThread; i++, j += average) {
+        pCPs[i].keys = keys;
+        pCPs[i].startPos = j;
+        pCPs[i].endPos = j + average;
+        // last thread checks the keys left over
+        if (i == (manyThread - 1)) {
+            pCPs[i].endPos += modules;
+        }
+        pthread_create(&threads[i], NULL, check_keys, &pCPs[i]);
+    }
+
+    for (i = 0; i < manyThread; i++) {
+        pthread_join(threads[i], NULL);
+        for (j = 0; j < pCPs[i].survivorCount; j++) {
+            printf("%" PRIu32 " %012" PRIx64 "\r\n", pCPs[i].survivors[j].target, pCPs[i].survivors[j].key);
+        }
+        free(pCPs[i].survivors);
+    }
+    fflush(stdout);
+    free(keys);
+    exit(EXIT_SUCCESS);
+}